@@ -87,6 +87,9 @@ IF %ERRORLEVEL% NEQ 0 GOTO ERROR
 ECHO running extractor-tests.exe ...
 %Configuration%\extractor-tests.exe
 IF %ERRORLEVEL% NEQ 0 GOTO ERROR
+ECHO running contractor-tests.exe ...
+%Configuration%\contractor-tests.exe
+IF %ERRORLEVEL% NEQ 0 GOTO ERROR
 ECHO running util-tests.exe ...
 %Configuration%\util-tests.exe
 IF %ERRORLEVEL% NEQ 0 GOTO ERROR
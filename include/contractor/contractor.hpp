@@ -2,6 +2,7 @@
 #define CONTRACTOR_CONTRACTOR_HPP
 
 #include "extractor/edge_based_edge.hpp"
+#include "extractor/edge_expanded_graph.hpp"
 #include "extractor/node_based_edge.hpp"
 #include "contractor/contractor.hpp"
 #include "contractor/contractor_config.hpp"
@@ -40,7 +41,9 @@ class Contractor
     Contractor(const Contractor &) = delete;
     Contractor& operator=(const Contractor &) = delete;
 
-    int Run();
+    // Contracts the edge-expanded graph handed over by the extractor if given, otherwise the one
+    // in the .ebg and .enw files
+    int Run(extractor::EdgeExpandedGraph *edge_expanded_graph = nullptr);
 
   protected:
     void ContractGraph(const unsigned max_edge_id,
@@ -63,10 +66,11 @@ class Contractor
     ContractorConfig config;
     std::size_t
     LoadEdgeExpandedGraph(const std::string &edge_based_graph_path,
-                          util::DeallocatingVector<extractor::EdgeBasedEdge> &edge_based_edge_list,
-                          const std::string &edge_segment_lookup_path,
-                          const std::string &edge_penalty_path,
-                          const std::string &segment_speed_path);
+                          util::DeallocatingVector<extractor::EdgeBasedEdge> &edge_based_edge_list);
+    void UpdateEdgeWeights(util::DeallocatingVector<extractor::EdgeBasedEdge> &edge_based_edge_list,
+                           const std::string &edge_segment_lookup_path,
+                           const std::string &edge_penalty_path,
+                           const std::string &segment_speed_path) const;
 };
 }
 }
@@ -7,7 +7,6 @@
 #include "util/percent.hpp"
 #include "contractor/query_edge.hpp"
 #include "util/xor_fast_hash.hpp"
-#include "util/xor_fast_hash_storage.hpp"
 #include "util/integer_range.hpp"
 #include "util/simple_logger.hpp"
 #include "util/timing_util.hpp"
@@ -22,6 +21,7 @@
 #include <tbb/parallel_sort.h>
 
 #include <algorithm>
+#include <cstdint>
 #include <limits>
 #include <memory>
 #include <vector>
@@ -71,21 +71,35 @@ class GraphContractor
     };
 
     using ContractorGraph = util::DynamicGraph<ContractorEdgeData>;
-    //    using ContractorHeap = util::BinaryHeap<NodeID, NodeID, int, ContractorHeapData,
-    //    ArrayStorage<NodeID, NodeID>
-    //    >;
+    // The witness searches use a dense index into the heap. Stale entries never need to be
+    // reset: BinaryHeap validates every index against its list of inserted nodes, so clearing
+    // the heap is O(1) instead of a sweep over the hash table.
     using ContractorHeap = util::BinaryHeap<NodeID,
                                             NodeID,
                                             int,
                                             ContractorHeapData,
-                                            util::XORFastHashStorage<NodeID, NodeID>>;
+                                            util::ArrayStorage<NodeID, NodeID>>;
     using ContractorEdge = ContractorGraph::InputEdge;
 
+    // Shortcuts found by a simulated contraction of `node`, stored as the range
+    // [begin, end) of the simulated_shortcuts of the thread that ran the simulation.
+    struct CachedContraction
+    {
+        NodeID node;
+        std::uint32_t begin;
+        std::uint32_t end;
+        const std::vector<ContractorEdge> *shortcuts;
+
+        bool operator<(const CachedContraction &other) const { return node < other.node; }
+    };
+
     struct ContractorThreadData
     {
         ContractorHeap heap;
         std::vector<ContractorEdge> inserted_edges;
         std::vector<NodeID> neighbours;
+        std::vector<ContractorEdge> simulated_shortcuts;
+        std::vector<CachedContraction> cached_contractions;
         explicit ContractorThreadData(NodeID nodes) : heap(nodes) {}
     };
 
@@ -97,9 +111,12 @@ class GraphContractor
         int edges_added_count;
         int original_edges_deleted_count;
         int original_edges_added_count;
+        // set if a witness search stopped at its settled node limit. The outcome of such a
+        // simulation may differ from the real contraction and must not be cached.
+        bool search_truncated;
         ContractionStats()
             : edges_deleted_count(0), edges_added_count(0), original_edges_deleted_count(0),
-              original_edges_added_count(0)
+              original_edges_added_count(0), search_truncated(false)
         {
         }
     };
@@ -330,6 +347,8 @@ class GraphContractor
 
                 // Delete old heap data to free memory that we need for the coming operations
                 thread_data_list.data.clear();
+                // cached simulations refer to the deleted thread data and to the old node ids
+                cached_contractions.clear();
 
                 // Create new priority array
                 std::vector<float> new_node_priority(remaining_nodes.size());
@@ -485,7 +504,8 @@ class GraphContractor
                                        position != end; ++position)
                                   {
                                       const NodeID x = remaining_nodes[position].id;
-                                      this->ContractNode<false>(data, x);
+                                      this->ContractNode<false>(data, x, nullptr,
+                                                                this->FindCachedContraction(x));
                                   }
                               });
 
@@ -538,6 +558,14 @@ class GraphContractor
                 data->inserted_edges.clear();
             }
 
+            // the graph changed, all cached simulations are outdated now
+            cached_contractions.clear();
+            for (auto &data : thread_data_list.data)
+            {
+                data->simulated_shortcuts.clear();
+                data->cached_contractions.clear();
+            }
+
             if (!use_cached_node_priorities)
             {
                 tbb::parallel_for(
@@ -554,6 +582,25 @@ class GraphContractor
                             this->UpdateNodeNeighbours(node_priorities, node_depth, data, x);
                         }
                     });
+
+                // The graph is not modified until the next round contracts its independent nodes,
+                // so these simulations can stand in for their witness searches.
+                for (const auto &data : thread_data_list.data)
+                {
+                    cached_contractions.insert(cached_contractions.end(),
+                                               data->cached_contractions.begin(),
+                                               data->cached_contractions.end());
+                }
+                tbb::parallel_sort(cached_contractions.begin(), cached_contractions.end());
+                // A node re-evaluated more than once was simulated on the same graph each time,
+                // any of its simulations will do. Keep one so the lookup is unambiguous.
+                cached_contractions.erase(
+                    std::unique(cached_contractions.begin(), cached_contractions.end(),
+                                [](const CachedContraction &lhs, const CachedContraction &rhs)
+                                {
+                                    return lhs.node == rhs.node;
+                                }),
+                    cached_contractions.end());
             }
 
             // remove contracted nodes from the pool
@@ -594,6 +641,20 @@ class GraphContractor
         }
         else
         {
+            // the few remaining nodes are not marked as core but lie above all others, give each
+            // a round of its own so the levels order the whole hierarchy
+            if (!use_cached_node_priorities)
+            {
+                for (const auto position : util::irange<std::size_t>(0, remaining_nodes.size()))
+                {
+                    const NodeID x = remaining_nodes[position].id;
+                    const NodeID orig_id = orig_node_id_from_new_node_id_map.size() > 0
+                                               ? orig_node_id_from_new_node_id_map[x]
+                                               : x;
+                    node_levels[orig_id] = current_level + position;
+                }
+            }
+
             // in this case we don't need core markers since we fully contracted
             // the graph
             is_core_node.clear();
@@ -603,6 +664,7 @@ class GraphContractor
                                      << contractor_graph->GetNumberOfEdges() << " edges."
                                      << std::endl;
 
+        cached_contractions.clear();
         thread_data_list.data.clear();
     }
 
@@ -678,7 +740,13 @@ class GraphContractor
                           const int distance,
                           ContractorHeap &heap)
     {
+        // Witnesses with more hops are not worth the search, we rather add the shortcut.
+        const constexpr short MAX_WITNESS_HOPS = 16;
         const short current_hop = heap.GetData(node).hop + 1;
+        if (current_hop > MAX_WITNESS_HOPS)
+        {
+            return;
+        }
         for (auto edge : contractor_graph->GetAdjacentEdgeRange(node))
         {
             const ContractorEdgeData &data = contractor_graph->GetEdgeData(edge);
@@ -707,7 +775,8 @@ class GraphContractor
         }
     }
 
-    inline void Dijkstra(const int max_distance,
+    // Returns false if the search was stopped by the limit on settled nodes.
+    inline bool Dijkstra(const int max_distance,
                          const unsigned number_of_targets,
                          const int maxNodes,
                          ContractorThreadData &data,
@@ -724,11 +793,11 @@ class GraphContractor
             const auto distance = heap.GetKey(node);
             if (++nodes > maxNodes)
             {
-                return;
+                return false;
             }
             if (distance > max_distance)
             {
-                return;
+                return true;
             }
 
             // Destination settled?
@@ -737,22 +806,118 @@ class GraphContractor
                 ++number_of_targets_found;
                 if (number_of_targets_found >= number_of_targets)
                 {
-                    return;
+                    return true;
                 }
             }
 
             RelaxNode(node, middleNode, distance, heap);
         }
+        return true;
+    }
+
+    // Lowers the key of an already inserted node if the path is shorter.
+    inline void RelaxWitness(const NodeID to, const int distance, const short hop, ContractorHeap &heap)
+    {
+        if (heap.WasInserted(to) && distance < heap.GetKey(to))
+        {
+            heap.DecreaseKey(to, distance);
+            heap.GetData(to).hop = hop;
+        }
+    }
+
+    inline bool AllTargetsWitnessed(const NodeID node,
+                                    const NodeID source,
+                                    const ContractorEdgeData &in_data,
+                                    ContractorHeap &heap)
+    {
+        for (auto out_edge : contractor_graph->GetAdjacentEdgeRange(node))
+        {
+            const ContractorEdgeData &out_data = contractor_graph->GetEdgeData(out_edge);
+            if (!out_data.forward)
+            {
+                continue;
+            }
+            const NodeID target = contractor_graph->GetTarget(out_edge);
+            if (target == node || target == source)
+            {
+                continue;
+            }
+            const int path_distance = in_data.distance + out_data.distance;
+            if (heap.GetKey(target) > path_distance)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Most witnesses in road networks consist of one or two edges. Checks those paths before
+    // falling back to the full Dijkstra search. The keys of the targets are only lowered to the
+    // lengths of real paths that avoid the contracted node, so the search stays exact if it
+    // needs to run afterwards. Returns true if every target already has a witness.
+    inline bool FindShortWitnesses(const NodeID node,
+                                   const NodeID source,
+                                   const ContractorEdgeData &in_data,
+                                   ContractorHeap &heap)
+    {
+        // one hop: direct edges from source to the targets
+        for (auto edge : contractor_graph->GetAdjacentEdgeRange(source))
+        {
+            const ContractorEdgeData &data = contractor_graph->GetEdgeData(edge);
+            const NodeID to = contractor_graph->GetTarget(edge);
+            if (data.forward && to != node)
+            {
+                RelaxWitness(to, data.distance, 1, heap);
+            }
+        }
+        if (AllTargetsWitnessed(node, source, in_data, heap))
+        {
+            return true;
+        }
+
+        // two hops: source -> middle -> target
+        for (auto first_edge : contractor_graph->GetAdjacentEdgeRange(source))
+        {
+            const ContractorEdgeData &first_data = contractor_graph->GetEdgeData(first_edge);
+            const NodeID middle = contractor_graph->GetTarget(first_edge);
+            if (!first_data.forward || middle == node || middle == source)
+            {
+                continue;
+            }
+            for (auto second_edge : contractor_graph->GetAdjacentEdgeRange(middle))
+            {
+                const ContractorEdgeData &second_data = contractor_graph->GetEdgeData(second_edge);
+                const NodeID to = contractor_graph->GetTarget(second_edge);
+                if (second_data.forward && to != node)
+                {
+                    RelaxWitness(to, first_data.distance + second_data.distance, 2, heap);
+                }
+            }
+        }
+        return AllTargetsWitnessed(node, source, in_data, heap);
     }
 
     inline float EvaluateNodePriority(ContractorThreadData *const data,
                                       const NodeDepth node_depth,
-                                      const NodeID node)
+                                      const NodeID node,
+                                      const bool cache_contraction = false)
     {
         ContractionStats stats;
 
         // perform simulated contraction
+        const auto shortcuts_begin = data->simulated_shortcuts.size();
         ContractNode<true>(data, node, &stats);
+        if (cache_contraction && !stats.search_truncated)
+        {
+            data->cached_contractions.push_back(
+                {node, static_cast<std::uint32_t>(shortcuts_begin),
+                 static_cast<std::uint32_t>(data->simulated_shortcuts.size()),
+                 &data->simulated_shortcuts});
+        }
+        else
+        {
+            data->simulated_shortcuts.resize(shortcuts_begin);
+        }
 
         // Result will contain the priority
         float result;
@@ -771,13 +936,32 @@ class GraphContractor
         return result;
     }
 
+    inline const CachedContraction *FindCachedContraction(const NodeID node) const
+    {
+        const auto iter = std::lower_bound(cached_contractions.begin(), cached_contractions.end(),
+                                           CachedContraction{node, 0, 0, nullptr});
+        if (iter != cached_contractions.end() && iter->node == node)
+        {
+            return &*iter;
+        }
+        return nullptr;
+    }
+
+    // If `cached` is set the witness searches are skipped and the shortcuts of the simulation
+    // are used instead. Self-loops depend on the node weights and are always re-evaluated.
     template <bool RUNSIMULATION>
-    inline bool
-    ContractNode(ContractorThreadData *data, const NodeID node, ContractionStats *stats = nullptr)
+    inline bool ContractNode(ContractorThreadData *data,
+                             const NodeID node,
+                             ContractionStats *stats = nullptr,
+                             const CachedContraction *cached = nullptr)
     {
+        BOOST_ASSERT(!RUNSIMULATION || cached == nullptr);
         ContractorHeap &heap = data->heap;
         std::size_t inserted_edges_size = data->inserted_edges.size();
         std::vector<ContractorEdge> &inserted_edges = data->inserted_edges;
+        // simulated shortcuts are recorded so that the real contraction can reuse them
+        std::vector<ContractorEdge> &shortcuts =
+            RUNSIMULATION ? data->simulated_shortcuts : data->inserted_edges;
         const constexpr bool SHORTCUT_ARC = true;
         const constexpr bool FORWARD_DIRECTION_ENABLED = true;
         const constexpr bool FORWARD_DIRECTION_DISABLED = false;
@@ -802,8 +986,11 @@ class GraphContractor
                 continue;
             }
 
-            heap.Clear();
-            heap.Insert(source, 0, ContractorHeapData {});
+            if (cached == nullptr)
+            {
+                heap.Clear();
+                heap.Insert(source, 0, ContractorHeapData {});
+            }
             int max_distance = 0;
             unsigned number_of_targets = 0;
 
@@ -855,6 +1042,10 @@ class GraphContractor
                     }
                     continue;
                 }
+                if (cached != nullptr)
+                {
+                    continue;
+                }
                 max_distance = std::max(max_distance, path_distance);
                 if (!heap.WasInserted(target))
                 {
@@ -863,16 +1054,28 @@ class GraphContractor
                 }
             }
 
-            if (RUNSIMULATION)
+            // nothing to witness or the simulation already did it
+            if (cached != nullptr || 0 == number_of_targets)
             {
-                const int constexpr SIMULATION_SEARCH_SPACE_SIZE = 1000;
-                Dijkstra(max_distance, number_of_targets, SIMULATION_SEARCH_SPACE_SIZE, *data,
-                         node);
+                continue;
             }
-            else
+
+            if (!FindShortWitnesses(node, source, in_data, heap))
             {
-                const int constexpr FULL_SEARCH_SPACE_SIZE = 2000;
-                Dijkstra(max_distance, number_of_targets, FULL_SEARCH_SPACE_SIZE, *data, node);
+                if (RUNSIMULATION)
+                {
+                    const int constexpr SIMULATION_SEARCH_SPACE_SIZE = 1000;
+                    if (!Dijkstra(max_distance, number_of_targets, SIMULATION_SEARCH_SPACE_SIZE,
+                                  *data, node))
+                    {
+                        stats->search_truncated = true;
+                    }
+                }
+                else
+                {
+                    const int constexpr FULL_SEARCH_SPACE_SIZE = 2000;
+                    Dijkstra(max_distance, number_of_targets, FULL_SEARCH_SPACE_SIZE, *data, node);
+                }
             }
             for (auto out_edge : contractor_graph->GetAdjacentEdgeRange(node))
             {
@@ -895,21 +1098,26 @@ class GraphContractor
                         stats->original_edges_added_count +=
                             2 * (out_data.originalEdges + in_data.originalEdges);
                     }
-                    else
-                    {
-                        inserted_edges.emplace_back(source, target, path_distance,
-                                                    out_data.originalEdges + in_data.originalEdges,
-                                                    node, SHORTCUT_ARC, FORWARD_DIRECTION_ENABLED,
-                                                    REVERSE_DIRECTION_DISABLED);
-
-                        inserted_edges.emplace_back(target, source, path_distance,
-                                                    out_data.originalEdges + in_data.originalEdges,
-                                                    node, SHORTCUT_ARC, FORWARD_DIRECTION_DISABLED,
-                                                    REVERSE_DIRECTION_ENABLED);
-                    }
+                    shortcuts.emplace_back(source, target, path_distance,
+                                           out_data.originalEdges + in_data.originalEdges, node,
+                                           SHORTCUT_ARC, FORWARD_DIRECTION_ENABLED,
+                                           REVERSE_DIRECTION_DISABLED);
+
+                    shortcuts.emplace_back(target, source, path_distance,
+                                           out_data.originalEdges + in_data.originalEdges, node,
+                                           SHORTCUT_ARC, FORWARD_DIRECTION_DISABLED,
+                                           REVERSE_DIRECTION_ENABLED);
                 }
             }
         }
+
+        if (cached != nullptr)
+        {
+            inserted_edges.insert(inserted_edges.end(),
+                                  cached->shortcuts->begin() + cached->begin,
+                                  cached->shortcuts->begin() + cached->end);
+        }
+
         // Check For One-Way Streets to decide on the creation of self-loops
 
         if (!RUNSIMULATION)
@@ -1001,7 +1209,7 @@ class GraphContractor
         // re-evaluate priorities of neighboring nodes
         for (const NodeID u : neighbours)
         {
-            priorities[u] = EvaluateNodePriority(data, node_depth[u], u);
+            priorities[u] = EvaluateNodePriority(data, node_depth[u], u, true);
         }
         return true;
     }
@@ -1096,6 +1304,8 @@ class GraphContractor
     // self-loops are added.
     std::vector<EdgeWeight> node_weights;
     std::vector<bool> is_core_node;
+    // simulated contractions of the last round, sorted by node
+    std::vector<CachedContraction> cached_contractions;
     util::XORFastHash<> fast_hash;
 };
 }
@@ -53,6 +53,20 @@ struct QueryEdge
                 data.id == right.data.id);
     }
 };
+
+// The two edges a shortcut of the query graph replaces, in the direction the shortcut is stored:
+// first connects its source with the middle node, second the middle node with its target.
+// Original edges and shortcuts that are unpacked by scanning adjacency lists have no children.
+struct ShortcutChildren
+{
+    ShortcutChildren() : first(SPECIAL_EDGEID), second(SPECIAL_EDGEID) {}
+    ShortcutChildren(const EdgeID first, const EdgeID second) : first(first), second(second) {}
+
+    bool IsValid() const { return first != SPECIAL_EDGEID && second != SPECIAL_EDGEID; }
+
+    EdgeID first;
+    EdgeID second;
+};
 }
 }
 
@@ -4,10 +4,13 @@
 #include "guidance/segment_list.hpp"
 #include "guidance/textual_route_annotation.hpp"
 
+#include "engine/binary_response.hpp"
 #include "engine/internal_route_result.hpp"
 #include "engine/object_encoder.hpp"
 #include "engine/phantom_node.hpp"
+#include "engine/polyline_compressor.hpp"
 #include "engine/polyline_formatter.hpp"
+#include "engine/query_statistics.hpp"
 #include "engine/route_name_extraction.hpp"
 #include "engine/segment_information.hpp"
 #include "extractor/turn_instructions.hpp"
@@ -57,6 +60,12 @@ template <typename DataFacadeT> class ApiResponseGenerator
                        const InternalRouteResult &raw_route,
                        util::json::Object &json_result);
 
+    // Writes summary, encoded geometry, via points and hints of the main route for
+    // output=binary. Instructions, names and alternatives are only part of the JSON output.
+    void DescribeRoute(const RouteParameters &config,
+                       const InternalRouteResult &raw_route,
+                       BinaryResponse &binary_result);
+
     // The following functions allow access to the different parts of the Describe Route
     // functionality.
     // For own responses, they can be used to generate only subsets of the information.
@@ -70,7 +79,9 @@ template <typename DataFacadeT> class ApiResponseGenerator
     util::json::Array ListViaPoints(const InternalRouteResult &raw_route) const;
     util::json::Array ListViaIndices(const Segments &segment_list) const;
 
-    util::json::Value GetGeometry(const bool return_encoded, const Segments &segments) const;
+    util::json::Value GetGeometry(const bool return_encoded,
+                                  const unsigned precision,
+                                  const Segments &segments) const;
 
     // TODO this dedicated creation seems unnecessary? Only used for route names
     std::vector<Segment> BuildRouteSegments(const Segments &segment_list) const;
@@ -98,6 +109,7 @@ void ApiResponseGenerator<DataFacadeT>::DescribeRoute(const RouteParameters &con
     {
         return;
     }
+    ScopedQueryPhase annotate_phase(QueryPhase::Annotate);
     const constexpr bool ALLOW_SIMPLIFICATION = true;
     const constexpr bool EXTRACT_ROUTE = false;
     const constexpr bool EXTRACT_ALTERNATIVE = true;
@@ -109,7 +121,8 @@ void ApiResponseGenerator<DataFacadeT>::DescribeRoute(const RouteParameters &con
 
     if (config.geometry)
     {
-        json_result.values["route_geometry"] = GetGeometry(config.compression, segment_list);
+        json_result.values["route_geometry"] =
+            GetGeometry(config.compression, config.polyline_precision, segment_list);
     }
 
     if (config.print_instructions)
@@ -136,7 +149,8 @@ void ApiResponseGenerator<DataFacadeT>::DescribeRoute(const RouteParameters &con
         if (config.geometry)
         {
             auto alternate_geometry_string =
-                GetGeometry(config.compression, alternate_segment_list);
+                GetGeometry(config.compression, config.polyline_precision,
+                            alternate_segment_list);
             util::json::Array json_alternate_geometries_array;
             json_alternate_geometries_array.values.emplace_back(
                 std::move(alternate_geometry_string));
@@ -158,8 +172,8 @@ void ApiResponseGenerator<DataFacadeT>::DescribeRoute(const RouteParameters &con
 
         util::json::Array json_alternate_names_array;
         util::json::Array json_alternate_names;
-        json_alternate_names.values.push_back(route_names.alternative_path_name_1);
-        json_alternate_names.values.push_back(route_names.alternative_path_name_2);
+        json_alternate_names.values.push_back(route_names.alternative_path_name_1.to_string());
+        json_alternate_names.values.push_back(route_names.alternative_path_name_2.to_string());
         json_alternate_names_array.values.emplace_back(std::move(json_alternate_names));
         json_result.values["alternative_names"] = json_alternate_names_array;
         json_result.values["found_alternative"] = util::json::True();
@@ -174,13 +188,54 @@ void ApiResponseGenerator<DataFacadeT>::DescribeRoute(const RouteParameters &con
     }
 
     util::json::Array json_route_names;
-    json_route_names.values.push_back(route_names.shortest_path_name_1);
-    json_route_names.values.push_back(route_names.shortest_path_name_2);
-    json_result.values["route_name"] = json_route_names;
+    json_route_names.values.push_back(route_names.shortest_path_name_1.to_string());
+    json_route_names.values.push_back(route_names.shortest_path_name_2.to_string());
+    json_result.values["route_name"] = std::move(json_route_names);
 
     json_result.values["hint_data"] = BuildHintData(raw_route);
 }
 
+template <typename DataFacadeT>
+void ApiResponseGenerator<DataFacadeT>::DescribeRoute(const RouteParameters &config,
+                                                      const InternalRouteResult &raw_route,
+                                                      BinaryResponse &binary_result)
+{
+    if (!raw_route.is_valid())
+    {
+        return;
+    }
+    ScopedQueryPhase annotate_phase(QueryPhase::Annotate);
+    const constexpr bool ALLOW_SIMPLIFICATION = true;
+    const constexpr bool EXTRACT_ROUTE = false;
+    Segments segment_list(raw_route, EXTRACT_ROUTE, config.zoom_level, ALLOW_SIMPLIFICATION,
+                          facade);
+    binary_result.WriteRouteSummary(segment_list.GetDuration(), segment_list.GetDistance());
+
+    if (config.geometry)
+    {
+        binary_result.WriteString(BinarySection::RouteGeometry,
+                                  polylineEncode(segment_list.Get(), config.polyline_precision));
+    }
+
+    std::vector<util::FixedPointCoordinate> via_points;
+    std::vector<std::string> hints;
+    via_points.reserve(raw_route.segment_end_coordinates.size() + 1);
+    hints.reserve(raw_route.segment_end_coordinates.size() + 1);
+    std::string hint;
+    for (const PhantomNodes &nodes : raw_route.segment_end_coordinates)
+    {
+        via_points.push_back(nodes.source_phantom.location);
+        ObjectEncoder::EncodeToBase64(nodes.source_phantom, hint);
+        hints.push_back(hint);
+    }
+    via_points.push_back(raw_route.segment_end_coordinates.back().target_phantom.location);
+    ObjectEncoder::EncodeToBase64(raw_route.segment_end_coordinates.back().target_phantom, hint);
+    hints.emplace_back(std::move(hint));
+
+    binary_result.WriteCoordinates(BinarySection::ViaPoints, via_points);
+    binary_result.WriteHints(facade->GetCheckSum(), hints);
+}
+
 template <typename DataFacadeT>
 util::json::Object
 ApiResponseGenerator<DataFacadeT>::SummarizeRoute(const InternalRouteResult &raw_route,
@@ -190,10 +245,12 @@ ApiResponseGenerator<DataFacadeT>::SummarizeRoute(const InternalRouteResult &raw
     if (!raw_route.segment_end_coordinates.empty())
     {
         const auto start_name_id = raw_route.segment_end_coordinates.front().source_phantom.name_id;
-        json_route_summary.values["start_point"] = facade->get_name_for_id(start_name_id);
+        json_route_summary.values["start_point"] =
+            facade->GetNameForID(start_name_id).to_string();
         const auto destination_name_id =
             raw_route.segment_end_coordinates.back().target_phantom.name_id;
-        json_route_summary.values["end_point"] = facade->get_name_for_id(destination_name_id);
+        json_route_summary.values["end_point"] =
+            facade->GetNameForID(destination_name_id).to_string();
     }
     json_route_summary.values["total_time"] = segment_list.GetDuration();
     json_route_summary.values["total_distance"] = segment_list.GetDistance();
@@ -238,10 +295,11 @@ ApiResponseGenerator<DataFacadeT>::ListViaIndices(const Segments &segment_list)
 
 template <typename DataFacadeT>
 util::json::Value ApiResponseGenerator<DataFacadeT>::GetGeometry(const bool return_encoded,
+                                                                 const unsigned precision,
                                                                  const Segments &segments) const
 {
     if (return_encoded)
-        return polylineEncodeAsJSON(segments.Get());
+        return polylineEncodeAsJSON(segments.Get(), precision);
     else
         return polylineUnencodedAsJSON(segments.Get());
 }
@@ -0,0 +1,185 @@
+#ifndef BINARY_RESPONSE_HPP
+#define BINARY_RESPONSE_HPP
+
+#include "osrm/coordinate.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/utility/string_ref.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+
+// Sections of a binary response, clients skip the ones they do not know
+enum class BinarySection : std::uint16_t
+{
+    StatusMessage = 1,          // string
+    DistanceTable = 2,          // u32 rows, u32 columns, row-major i32 weights in deciseconds
+    SourceCoordinates = 3,      // u32 count, i32 lat/lon pairs in 1e-6 degrees
+    DestinationCoordinates = 4, // as SourceCoordinates
+    RouteSummary = 5,           // u32 total_time in seconds, u32 total_distance in meters
+    RouteGeometry = 6,          // string, encoded polyline
+    ViaPoints = 7,              // as SourceCoordinates
+    Hints = 8,                  // u32 checksum, u32 count, strings
+    Names = 9                   // u32 count, strings
+};
+
+// Writes the output=binary response format: a header followed by framed sections.
+//
+//   header:  "OSRB", u16 version, u16 status
+//   section: u16 tag, u32 payload size in bytes, payload
+//   string:  u32 size in bytes, UTF-8 bytes
+//
+// All integers are little endian. Plugins write their results directly, large tables go out as
+// one block of weights instead of a JSON document.
+class BinaryResponse
+{
+  public:
+    static const constexpr std::uint16_t VERSION = 1;
+    static const constexpr std::size_t HEADER_SIZE = 8;
+
+    BinaryResponse() { Clear(); }
+
+    // Drops all sections, e.g. those a plugin wrote before its query was aborted
+    void Clear()
+    {
+        buffer.clear();
+        buffer.insert(buffer.end(), {'O', 'S', 'R', 'B'});
+        AppendUInt16(VERSION);
+        AppendUInt16(0);
+    }
+
+    void SetStatus(const int status)
+    {
+        buffer[6] = static_cast<char>(status & 0xff);
+        buffer[7] = static_cast<char>((status >> 8) & 0xff);
+    }
+
+    void WriteStatusMessage(const std::string &message)
+    {
+        const auto section = BeginSection(BinarySection::StatusMessage);
+        AppendString(message);
+        EndSection(section);
+    }
+
+    void WriteTable(const std::uint32_t rows, const std::uint32_t columns, const std::int32_t *data)
+    {
+        const auto section = BeginSection(BinarySection::DistanceTable);
+        AppendUInt32(rows);
+        AppendUInt32(columns);
+        const std::size_t number_of_entries = static_cast<std::size_t>(rows) * columns;
+        buffer.reserve(buffer.size() + number_of_entries * sizeof(std::int32_t));
+        for (std::size_t i = 0; i < number_of_entries; ++i)
+        {
+            AppendUInt32(static_cast<std::uint32_t>(data[i]));
+        }
+        EndSection(section);
+    }
+
+    void WriteCoordinates(const BinarySection tag,
+                          const std::vector<util::FixedPointCoordinate> &coordinates)
+    {
+        const auto section = BeginSection(tag);
+        AppendUInt32(static_cast<std::uint32_t>(coordinates.size()));
+        for (const auto &coordinate : coordinates)
+        {
+            AppendUInt32(static_cast<std::uint32_t>(coordinate.lat));
+            AppendUInt32(static_cast<std::uint32_t>(coordinate.lon));
+        }
+        EndSection(section);
+    }
+
+    void WriteRouteSummary(const std::uint32_t total_time, const std::uint32_t total_distance)
+    {
+        const auto section = BeginSection(BinarySection::RouteSummary);
+        AppendUInt32(total_time);
+        AppendUInt32(total_distance);
+        EndSection(section);
+    }
+
+    void WriteString(const BinarySection tag, const std::string &value)
+    {
+        const auto section = BeginSection(tag);
+        AppendString(value);
+        EndSection(section);
+    }
+
+    void WriteHints(const std::uint32_t checksum, const std::vector<std::string> &hints)
+    {
+        const auto section = BeginSection(BinarySection::Hints);
+        AppendUInt32(checksum);
+        AppendStrings(hints);
+        EndSection(section);
+    }
+
+    void WriteNames(const std::vector<boost::string_ref> &names)
+    {
+        const auto section = BeginSection(BinarySection::Names);
+        AppendStrings(names);
+        EndSection(section);
+    }
+
+    std::vector<char> &Buffer() { return buffer; }
+    const std::vector<char> &Buffer() const { return buffer; }
+
+  private:
+    std::size_t BeginSection(const BinarySection tag)
+    {
+        AppendUInt16(static_cast<std::uint16_t>(tag));
+        const std::size_t size_position = buffer.size();
+        AppendUInt32(0);
+        return size_position;
+    }
+
+    void EndSection(const std::size_t size_position)
+    {
+        const std::size_t payload_size = buffer.size() - size_position - sizeof(std::uint32_t);
+        BOOST_ASSERT(payload_size <= UINT32_MAX);
+        for (const auto i : {0u, 1u, 2u, 3u})
+        {
+            buffer[size_position + i] = static_cast<char>((payload_size >> (8 * i)) & 0xff);
+        }
+    }
+
+    void AppendUInt16(const std::uint16_t value)
+    {
+        buffer.push_back(static_cast<char>(value & 0xff));
+        buffer.push_back(static_cast<char>(value >> 8));
+    }
+
+    void AppendUInt32(const std::uint32_t value)
+    {
+        buffer.push_back(static_cast<char>(value & 0xff));
+        buffer.push_back(static_cast<char>((value >> 8) & 0xff));
+        buffer.push_back(static_cast<char>((value >> 16) & 0xff));
+        buffer.push_back(static_cast<char>(value >> 24));
+    }
+
+    void AppendString(const boost::string_ref value)
+    {
+        AppendUInt32(static_cast<std::uint32_t>(value.size()));
+        buffer.insert(buffer.end(), value.begin(), value.end());
+    }
+
+    template <typename StringT> void AppendStrings(const std::vector<StringT> &values)
+    {
+        AppendUInt32(static_cast<std::uint32_t>(values.size()));
+        for (const auto &value : values)
+        {
+            AppendString(value);
+        }
+    }
+
+    std::vector<char> buffer;
+};
+}
+}
+
+#endif // BINARY_RESPONSE_HPP
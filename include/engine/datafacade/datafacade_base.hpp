@@ -3,19 +3,24 @@
 
 // Exposes all data access interfaces to the algorithms via base class ptr
 
+#include "contractor/query_edge.hpp"
 #include "extractor/edge_based_node.hpp"
 #include "extractor/external_memory_node.hpp"
 #include "engine/phantom_node.hpp"
 #include "extractor/turn_instructions.hpp"
 #include "util/integer_range.hpp"
 #include "util/osrm_exception.hpp"
+#include "util/packed_geometry.hpp"
+#include "util/search_graph.hpp"
 #include "util/string_util.hpp"
+#include "util/sweep_order.hpp"
 #include "util/typedefs.hpp"
 
 #include "osrm/coordinate.hpp"
 
 #include <string>
 #include <boost/optional.hpp>
+#include <boost/utility/string_ref.hpp>
 
 namespace osrm
 {
@@ -51,6 +56,16 @@ template <class EdgeDataT> class BaseDataFacade
 
     virtual EdgeRange GetAdjacentEdgeRange(const NodeID node) const = 0;
 
+    // edges a search in the given direction relaxes, without the data needed for unpacking
+    virtual util::SearchEdgeRange<EdgeDataT> GetSearchEdges(const NodeID node,
+                                                            const bool forward_direction) const = 0;
+
+    // all nodes in the order of the downward sweep of PHAST, empty if no levels were loaded
+    virtual util::SweepOrderRange GetSweepOrder() const = 0;
+
+    // children of a shortcut, invalid if the graph was prepared without them
+    virtual contractor::ShortcutChildren GetShortcutChildren(const EdgeID e) const = 0;
+
     // searches for a specific edge
     virtual EdgeID FindEdge(const NodeID from, const NodeID to) const = 0;
 
@@ -66,8 +81,14 @@ template <class EdgeDataT> class BaseDataFacade
 
     virtual unsigned GetGeometryIndexForEdgeID(const unsigned id) const = 0;
 
-    virtual void GetUncompressedGeometry(const unsigned id,
-                                         std::vector<unsigned> &result_nodes) const = 0;
+    // nodes of a compressed edge, decoded while iterating
+    virtual util::PackedGeometryView GetPackedGeometry(const unsigned id) const = 0;
+
+    // decodes into a buffer of the caller that is only reallocated if it has to grow
+    void GetUncompressedGeometry(const unsigned id, std::vector<unsigned> &result_nodes) const
+    {
+        GetPackedGeometry(id).DecodeInto(result_nodes);
+    }
 
     virtual extractor::TurnInstruction GetTurnInstructionForEdgeID(const unsigned id) const = 0;
 
@@ -96,7 +117,13 @@ template <class EdgeDataT> class BaseDataFacade
 
     virtual unsigned GetNameIndexFromEdgeID(const unsigned id) const = 0;
 
-    virtual std::string get_name_for_id(const unsigned name_id) const = 0;
+    // points into the name table of the facade, no copy is made
+    virtual boost::string_ref GetNameForID(const unsigned name_id) const = 0;
+
+    std::string get_name_for_id(const unsigned name_id) const
+    {
+        return GetNameForID(name_id).to_string();
+    }
 
     virtual std::size_t GetCoreSize() const = 0;
 
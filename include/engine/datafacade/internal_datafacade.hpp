@@ -10,8 +10,10 @@
 #include "extractor/query_node.hpp"
 #include "contractor/query_edge.hpp"
 #include "util/shared_memory_vector_wrapper.hpp"
+#include "util/search_graph.hpp"
 #include "util/static_graph.hpp"
 #include "util/static_rtree.hpp"
+#include "util/sweep_order.hpp"
 #include "util/range_table.hpp"
 #include "util/graph_loader.hpp"
 #include "util/simple_logger.hpp"
@@ -46,6 +48,7 @@ template <class EdgeDataT> class InternalDataFacade final : public BaseDataFacad
     unsigned m_check_sum;
     unsigned m_number_of_nodes;
     std::unique_ptr<QueryGraph> m_query_graph;
+    util::SearchGraph<false> m_search_graph;
     std::string m_timestamp;
 
     std::shared_ptr<util::ShM<util::FixedPointCoordinate, false>::vector> m_coordinate_list;
@@ -56,8 +59,10 @@ template <class EdgeDataT> class InternalDataFacade final : public BaseDataFacad
     util::ShM<char, false>::vector m_names_char_list;
     util::ShM<bool, false>::vector m_edge_is_compressed;
     util::ShM<unsigned, false>::vector m_geometry_indices;
-    util::ShM<unsigned, false>::vector m_geometry_list;
+    util::ShM<unsigned char, false>::vector m_geometry_list;
     util::ShM<bool, false>::vector m_is_core_node;
+    util::ShM<NodeID, false>::vector m_sweep_order;
+    util::ShM<contractor::ShortcutChildren, false>::vector m_shortcut_children;
 
     boost::thread_specific_ptr<InternalRTree> m_static_rtree;
     boost::thread_specific_ptr<InternalGeospatialQuery> m_geospatial_query;
@@ -88,19 +93,40 @@ template <class EdgeDataT> class InternalDataFacade final : public BaseDataFacad
         }
     }
 
-    void LoadGraph(const boost::filesystem::path &hsgr_path)
+    void LoadGraph(const boost::filesystem::path &hsgr_path, const bool build_search_graph)
     {
         typename util::ShM<typename QueryGraph::NodeArrayEntry, false>::vector node_list;
         typename util::ShM<typename QueryGraph::EdgeArrayEntry, false>::vector edge_list;
 
         util::SimpleLogger().Write() << "loading graph from " << hsgr_path.string();
 
-        m_number_of_nodes = readHSGRFromStream(hsgr_path, node_list, edge_list, &m_check_sum);
+        m_number_of_nodes = readHSGRFromStream(hsgr_path, node_list, edge_list,
+                                               m_shortcut_children, &m_check_sum);
 
         BOOST_ASSERT_MSG(0 != node_list.size(), "node list empty");
         // BOOST_ASSERT_MSG(0 != edge_list.size(), "edge list empty");
         util::SimpleLogger().Write() << "loaded " << node_list.size() << " nodes and "
                                      << edge_list.size() << " edges";
+        if (build_search_graph)
+        {
+            std::size_t number_of_forward_edges = 0;
+            std::size_t number_of_backward_edges = 0;
+            util::SearchGraph<false>::CountEdges(edge_list.data(), edge_list.size(),
+                                                 number_of_forward_edges,
+                                                 number_of_backward_edges);
+            util::SearchGraph<false>::OffsetVector forward_offsets(node_list.size());
+            util::SearchGraph<false>::EdgeVector forward_edges(number_of_forward_edges);
+            util::SearchGraph<false>::OffsetVector backward_offsets(node_list.size());
+            util::SearchGraph<false>::EdgeVector backward_edges(number_of_backward_edges);
+            util::SearchGraph<false>::Build(node_list.data(), node_list.size(), edge_list.data(),
+                                            forward_offsets.data(), forward_edges.data(),
+                                            backward_offsets.data(), backward_edges.data());
+            m_search_graph = util::SearchGraph<false>(forward_offsets, forward_edges,
+                                                      backward_offsets, backward_edges);
+            util::SimpleLogger().Write() << "split " << number_of_forward_edges << " forward and "
+                                         << number_of_backward_edges << " backward search edges";
+        }
+
         m_query_graph = std::unique_ptr<QueryGraph>(new QueryGraph(node_list, edge_list));
 
         BOOST_ASSERT_MSG(0 == node_list.size(), "node list not flushed");
@@ -181,11 +207,35 @@ template <class EdgeDataT> class InternalDataFacade final : public BaseDataFacad
         }
     }
 
+    void LoadSweepOrder(const boost::filesystem::path &level_data_file)
+    {
+        boost::filesystem::ifstream level_stream(level_data_file, std::ios::binary);
+        unsigned number_of_levels = 0;
+        level_stream.read((char *)&number_of_levels, sizeof(unsigned));
+
+        std::vector<float> node_levels(number_of_levels);
+        level_stream.read((char *)node_levels.data(), sizeof(float) * number_of_levels);
+        if (!level_stream || number_of_levels != GetNumberOfNodes())
+        {
+            util::SimpleLogger().Write(logWARNING) << level_data_file
+                                                   << " does not match the graph, PHAST disabled";
+            return;
+        }
+
+        m_sweep_order.resize(number_of_levels);
+        util::BuildSweepOrder(node_levels,
+                              [this](const NodeID node)
+                              {
+                                  return IsCoreNode(node);
+                              },
+                              m_sweep_order.data());
+    }
+
     void LoadGeometries(const boost::filesystem::path &geometry_file)
     {
         std::ifstream geometry_stream(geometry_file.string().c_str(), std::ios::binary);
         unsigned number_of_indices = 0;
-        unsigned number_of_compressed_geometries = 0;
+        unsigned number_of_packed_bytes = 0;
 
         geometry_stream.read((char *)&number_of_indices, sizeof(unsigned));
 
@@ -196,15 +246,15 @@ template <class EdgeDataT> class InternalDataFacade final : public BaseDataFacad
                                  number_of_indices * sizeof(unsigned));
         }
 
-        geometry_stream.read((char *)&number_of_compressed_geometries, sizeof(unsigned));
+        // the geometries are packed into bytes, the indices are byte offsets
+        geometry_stream.read((char *)&number_of_packed_bytes, sizeof(unsigned));
 
-        BOOST_ASSERT(m_geometry_indices.back() == number_of_compressed_geometries);
-        m_geometry_list.resize(number_of_compressed_geometries);
+        BOOST_ASSERT(m_geometry_indices.back() == number_of_packed_bytes);
+        m_geometry_list.resize(number_of_packed_bytes);
 
-        if (number_of_compressed_geometries > 0)
+        if (number_of_packed_bytes > 0)
         {
-            geometry_stream.read((char *)&(m_geometry_list[0]),
-                                 number_of_compressed_geometries * sizeof(unsigned));
+            geometry_stream.read((char *)&(m_geometry_list[0]), number_of_packed_bytes);
         }
         geometry_stream.close();
     }
@@ -242,8 +292,11 @@ template <class EdgeDataT> class InternalDataFacade final : public BaseDataFacad
         m_geospatial_query.reset();
     }
 
+    // build_search_graph trades 8 bytes per edge and direction for faster searches, see
+    // util::SearchGraph
     explicit InternalDataFacade(
-        const std::unordered_map<std::string, boost::filesystem::path> &server_paths)
+        const std::unordered_map<std::string, boost::filesystem::path> &server_paths,
+        const bool build_search_graph = false)
     {
         // cache end iterator to quickly check .find against
         const auto end_it = end(server_paths);
@@ -260,7 +313,7 @@ template <class EdgeDataT> class InternalDataFacade final : public BaseDataFacad
         file_index_path = file_for("fileindex");
 
         util::SimpleLogger().Write() << "loading graph data";
-        LoadGraph(file_for("hsgrdata"));
+        LoadGraph(file_for("hsgrdata"), build_search_graph);
 
         util::SimpleLogger().Write() << "loading edge information";
         LoadNodeAndEdgeInformation(file_for("nodesdata"), file_for("edgesdata"));
@@ -268,6 +321,14 @@ template <class EdgeDataT> class InternalDataFacade final : public BaseDataFacad
         util::SimpleLogger().Write() << "loading core information";
         LoadCoreInformation(file_for("coredata"));
 
+        // the levels are optional, without them there is no one-to-many search
+        const auto levels_iterator = server_paths.find("levelsdata");
+        if (levels_iterator != end_it && boost::filesystem::is_regular_file(levels_iterator->second))
+        {
+            util::SimpleLogger().Write() << "loading contraction levels";
+            LoadSweepOrder(levels_iterator->second);
+        }
+
         util::SimpleLogger().Write() << "loading geometries";
         LoadGeometries(file_for("geometries"));
 
@@ -304,6 +365,31 @@ template <class EdgeDataT> class InternalDataFacade final : public BaseDataFacad
         return m_query_graph->GetAdjacentEdgeRange(node);
     };
 
+    util::SearchEdgeRange<EdgeDataT>
+    GetSearchEdges(const NodeID node, const bool forward_direction) const override final
+    {
+        return m_search_graph.GetEdges(*m_query_graph, node, forward_direction);
+    }
+
+    util::SweepOrderRange GetSweepOrder() const override final
+    {
+        if (m_sweep_order.empty())
+        {
+            return {};
+        }
+        const NodeID *first = &m_sweep_order[0];
+        return {first, first + m_sweep_order.size()};
+    }
+
+    contractor::ShortcutChildren GetShortcutChildren(const EdgeID e) const override final
+    {
+        if (m_shortcut_children.empty())
+        {
+            return {};
+        }
+        return m_shortcut_children[e];
+    }
+
     // searches for a specific edge
     EdgeID FindEdge(const NodeID from, const NodeID to) const override final
     {
@@ -396,23 +482,18 @@ template <class EdgeDataT> class InternalDataFacade final : public BaseDataFacad
         return m_name_ID_list.at(id);
     }
 
-    std::string get_name_for_id(const unsigned name_id) const override final
+    boost::string_ref GetNameForID(const unsigned name_id) const override final
     {
         if (std::numeric_limits<unsigned>::max() == name_id)
         {
-            return "";
+            return {};
         }
-        auto range = m_name_table.GetRange(name_id);
-
-        std::string result;
-        result.reserve(range.size());
-        if (range.begin() != range.end())
+        const auto range = m_name_table.GetRange(name_id);
+        if (range.size() == 0)
         {
-            result.resize(range.back() - range.front() + 1);
-            std::copy(m_names_char_list.begin() + range.front(),
-                      m_names_char_list.begin() + range.back() + 1, result.begin());
+            return {};
         }
-        return result;
+        return boost::string_ref(&m_names_char_list[range.front()], range.size());
     }
 
     virtual unsigned GetGeometryIndexForEdgeID(const unsigned id) const override final
@@ -434,15 +515,18 @@ template <class EdgeDataT> class InternalDataFacade final : public BaseDataFacad
         }
     }
 
-    virtual void GetUncompressedGeometry(const unsigned id,
-                                         std::vector<unsigned> &result_nodes) const override final
+    virtual util::PackedGeometryView GetPackedGeometry(const unsigned id) const override final
     {
         const unsigned begin = m_geometry_indices.at(id);
         const unsigned end = m_geometry_indices.at(id + 1);
+        if (begin == end)
+        {
+            return {};
+        }
+        BOOST_ASSERT(end <= m_geometry_list.size());
 
-        result_nodes.clear();
-        result_nodes.insert(result_nodes.begin(), m_geometry_list.begin() + begin,
-                            m_geometry_list.begin() + end);
+        const unsigned char *packed_geometry = &m_geometry_list[begin];
+        return util::PackedGeometryView(packed_geometry, packed_geometry + (end - begin));
     }
 
     std::string GetTimestamp() const override final { return m_timestamp; }
@@ -9,8 +9,10 @@
 
 #include "engine/geospatial_query.hpp"
 #include "util/range_table.hpp"
+#include "util/search_graph.hpp"
 #include "util/static_graph.hpp"
 #include "util/static_rtree.hpp"
+#include "util/sweep_order.hpp"
 #include "util/make_unique.hpp"
 #include "util/simple_logger.hpp"
 
@@ -47,16 +49,21 @@ template <class EdgeDataT> class SharedDataFacade final : public BaseDataFacade<
 
     storage::SharedDataLayout *data_layout;
     char *shared_memory;
+    // holds the blocks written by osrm-prepare, see SharedDataLayout::IsGraphBlock
+    char *graph_memory;
     storage::SharedDataTimestamp *data_timestamp_ptr;
 
     storage::SharedDataType CURRENT_LAYOUT;
     storage::SharedDataType CURRENT_DATA;
+    storage::SharedDataType CURRENT_GRAPH;
     unsigned CURRENT_TIMESTAMP;
 
     unsigned m_check_sum;
     std::unique_ptr<QueryGraph> m_query_graph;
+    util::SearchGraph<true> m_search_graph;
     std::unique_ptr<storage::SharedMemory> m_layout_memory;
     std::unique_ptr<storage::SharedMemory> m_large_memory;
+    std::unique_ptr<storage::SharedMemory> m_graph_memory;
     std::string m_timestamp;
 
     std::shared_ptr<util::ShM<util::FixedPointCoordinate, true>::vector> m_coordinate_list;
@@ -68,8 +75,10 @@ template <class EdgeDataT> class SharedDataFacade final : public BaseDataFacade<
     util::ShM<unsigned, true>::vector m_name_begin_indices;
     util::ShM<bool, true>::vector m_edge_is_compressed;
     util::ShM<unsigned, true>::vector m_geometry_indices;
-    util::ShM<unsigned, true>::vector m_geometry_list;
+    util::ShM<unsigned char, true>::vector m_geometry_list;
     util::ShM<bool, true>::vector m_is_core_node;
+    util::ShM<NodeID, true>::vector m_sweep_order;
+    util::ShM<contractor::ShortcutChildren, true>::vector m_shortcut_children;
 
     boost::thread_specific_ptr<std::pair<unsigned, std::shared_ptr<SharedRTree>>> m_static_rtree;
     boost::thread_specific_ptr<SharedGeospatialQuery> m_geospatial_query;
@@ -79,7 +88,7 @@ template <class EdgeDataT> class SharedDataFacade final : public BaseDataFacade<
 
     void LoadChecksum()
     {
-        m_check_sum = *data_layout->GetBlockPtr<unsigned>(shared_memory,
+        m_check_sum = *data_layout->GetBlockPtr<unsigned>(graph_memory,
                                                           storage::SharedDataLayout::HSGR_CHECKSUM);
         util::SimpleLogger().Write() << "set checksum: " << m_check_sum;
     }
@@ -112,16 +121,49 @@ template <class EdgeDataT> class SharedDataFacade final : public BaseDataFacade<
     void LoadGraph()
     {
          auto graph_nodes_ptr = data_layout->GetBlockPtr<GraphNode>(
-            shared_memory, storage::SharedDataLayout::GRAPH_NODE_LIST);
+            graph_memory, storage::SharedDataLayout::GRAPH_NODE_LIST);
 
         auto graph_edges_ptr = data_layout->GetBlockPtr<GraphEdge>(
-            shared_memory, storage::SharedDataLayout::GRAPH_EDGE_LIST);
+            graph_memory, storage::SharedDataLayout::GRAPH_EDGE_LIST);
 
         typename util::ShM<GraphNode, true>::vector node_list(
             graph_nodes_ptr, data_layout->num_entries[storage::SharedDataLayout::GRAPH_NODE_LIST]);
         typename util::ShM<GraphEdge, true>::vector edge_list(
             graph_edges_ptr, data_layout->num_entries[storage::SharedDataLayout::GRAPH_EDGE_LIST]);
         m_query_graph.reset(new QueryGraph(node_list, edge_list));
+
+        using storage::SharedDataLayout;
+        typename util::ShM<unsigned, true>::vector forward_offsets(
+            data_layout->GetBlockPtr<unsigned>(graph_memory,
+                                               SharedDataLayout::SEARCH_FORWARD_OFFSETS),
+            data_layout->num_entries[SharedDataLayout::SEARCH_FORWARD_OFFSETS]);
+        typename util::ShM<util::SearchEdge, true>::vector forward_edges(
+            data_layout->GetBlockPtr<util::SearchEdge>(graph_memory,
+                                                       SharedDataLayout::SEARCH_FORWARD_EDGES),
+            data_layout->num_entries[SharedDataLayout::SEARCH_FORWARD_EDGES]);
+        typename util::ShM<unsigned, true>::vector backward_offsets(
+            data_layout->GetBlockPtr<unsigned>(graph_memory,
+                                               SharedDataLayout::SEARCH_BACKWARD_OFFSETS),
+            data_layout->num_entries[SharedDataLayout::SEARCH_BACKWARD_OFFSETS]);
+        typename util::ShM<util::SearchEdge, true>::vector backward_edges(
+            data_layout->GetBlockPtr<util::SearchEdge>(graph_memory,
+                                                       SharedDataLayout::SEARCH_BACKWARD_EDGES),
+            data_layout->num_entries[SharedDataLayout::SEARCH_BACKWARD_EDGES]);
+        m_search_graph = util::SearchGraph<true>(forward_offsets, forward_edges, backward_offsets,
+                                                 backward_edges);
+
+        // empty unless osrm-datastore was given the contraction levels
+        typename util::ShM<NodeID, true>::vector sweep_order(
+            data_layout->GetBlockPtr<NodeID>(graph_memory, SharedDataLayout::SWEEP_ORDER),
+            data_layout->num_entries[SharedDataLayout::SWEEP_ORDER]);
+        m_sweep_order.swap(sweep_order);
+
+        auto shortcut_children_ptr = data_layout->GetBlockPtr<contractor::ShortcutChildren>(
+            graph_memory, storage::SharedDataLayout::SHORTCUT_CHILDREN);
+        typename util::ShM<contractor::ShortcutChildren, true>::vector shortcut_children(
+            shortcut_children_ptr,
+            data_layout->num_entries[storage::SharedDataLayout::SHORTCUT_CHILDREN]);
+        m_shortcut_children.swap(shortcut_children);
     }
 
     void LoadNodeAndEdgeInformation()
@@ -194,7 +236,7 @@ template <class EdgeDataT> class SharedDataFacade final : public BaseDataFacade<
         }
 
         auto core_marker_ptr = data_layout->GetBlockPtr<unsigned>(
-            shared_memory, storage::SharedDataLayout::CORE_MARKER);
+            graph_memory, storage::SharedDataLayout::CORE_MARKER);
         typename util::ShM<bool, true>::vector is_core_node(
             core_marker_ptr, data_layout->num_entries[storage::SharedDataLayout::CORE_MARKER]);
         m_is_core_node.swap(is_core_node);
@@ -216,9 +258,9 @@ template <class EdgeDataT> class SharedDataFacade final : public BaseDataFacade<
             data_layout->num_entries[storage::SharedDataLayout::GEOMETRIES_INDEX]);
         m_geometry_indices.swap(geometry_begin_indices);
 
-        auto geometries_list_ptr = data_layout->GetBlockPtr<unsigned>(
+        auto geometries_list_ptr = data_layout->GetBlockPtr<unsigned char>(
             shared_memory, storage::SharedDataLayout::GEOMETRIES_LIST);
-        typename util::ShM<unsigned, true>::vector geometry_list(
+        typename util::ShM<unsigned char, true>::vector geometry_list(
             geometries_list_ptr,
             data_layout->num_entries[storage::SharedDataLayout::GEOMETRIES_LIST]);
         m_geometry_list.swap(geometry_list);
@@ -242,6 +284,7 @@ template <class EdgeDataT> class SharedDataFacade final : public BaseDataFacade<
                 ->Ptr());
         CURRENT_LAYOUT = storage::LAYOUT_NONE;
         CURRENT_DATA = storage::DATA_NONE;
+        CURRENT_GRAPH = storage::GRAPH_NONE;
         CURRENT_TIMESTAMP = 0;
 
         // load data
@@ -252,6 +295,7 @@ template <class EdgeDataT> class SharedDataFacade final : public BaseDataFacade<
     {
         if (CURRENT_LAYOUT != data_timestamp_ptr->layout ||
             CURRENT_DATA != data_timestamp_ptr->data ||
+            CURRENT_GRAPH != data_timestamp_ptr->graph ||
             CURRENT_TIMESTAMP != data_timestamp_ptr->timestamp)
         {
             // Get exclusive lock
@@ -259,14 +303,23 @@ template <class EdgeDataT> class SharedDataFacade final : public BaseDataFacade<
             boost::unique_lock<boost::shared_mutex> lock(data_mutex);
 
             if (CURRENT_LAYOUT != data_timestamp_ptr->layout ||
-                CURRENT_DATA != data_timestamp_ptr->data)
+                CURRENT_DATA != data_timestamp_ptr->data ||
+                CURRENT_GRAPH != data_timestamp_ptr->graph)
             {
-                // release the previous shared memory segments
+                // release the previous shared memory segments, a new graph may share the data
                 storage::SharedMemory::Remove(CURRENT_LAYOUT);
-                storage::SharedMemory::Remove(CURRENT_DATA);
+                if (CURRENT_DATA != data_timestamp_ptr->data)
+                {
+                    storage::SharedMemory::Remove(CURRENT_DATA);
+                }
+                if (CURRENT_GRAPH != data_timestamp_ptr->graph)
+                {
+                    storage::SharedMemory::Remove(CURRENT_GRAPH);
+                }
 
                 CURRENT_LAYOUT = data_timestamp_ptr->layout;
                 CURRENT_DATA = data_timestamp_ptr->data;
+                CURRENT_GRAPH = data_timestamp_ptr->graph;
                 CURRENT_TIMESTAMP = 0; // Force trigger a reload
 
                 util::SimpleLogger().Write(logDEBUG)
@@ -289,6 +342,8 @@ template <class EdgeDataT> class SharedDataFacade final : public BaseDataFacade<
 
                 m_large_memory.reset(storage::makeSharedMemory(CURRENT_DATA));
                 shared_memory = (char *)(m_large_memory->Ptr());
+                m_graph_memory.reset(storage::makeSharedMemory(CURRENT_GRAPH));
+                graph_memory = (char *)(m_graph_memory->Ptr());
 
                 const auto file_index_ptr = data_layout->GetBlockPtr<char>(
                     shared_memory, storage::SharedDataLayout::FILE_INDEX_PATH);
@@ -350,6 +405,31 @@ template <class EdgeDataT> class SharedDataFacade final : public BaseDataFacade<
         return m_query_graph->GetAdjacentEdgeRange(node);
     };
 
+    util::SearchEdgeRange<EdgeDataT>
+    GetSearchEdges(const NodeID node, const bool forward_direction) const override final
+    {
+        return m_search_graph.GetEdges(*m_query_graph, node, forward_direction);
+    }
+
+    util::SweepOrderRange GetSweepOrder() const override final
+    {
+        if (m_sweep_order.empty())
+        {
+            return {};
+        }
+        const NodeID *first = &m_sweep_order[0];
+        return {first, first + m_sweep_order.size()};
+    }
+
+    contractor::ShortcutChildren GetShortcutChildren(const EdgeID e) const override final
+    {
+        if (m_shortcut_children.empty())
+        {
+            return {};
+        }
+        return m_shortcut_children[e];
+    }
+
     // searches for a specific edge
     EdgeID FindEdge(const NodeID from, const NodeID to) const override final
     {
@@ -378,15 +458,18 @@ template <class EdgeDataT> class SharedDataFacade final : public BaseDataFacade<
         return m_edge_is_compressed.at(id);
     }
 
-    virtual void GetUncompressedGeometry(const unsigned id,
-                                         std::vector<unsigned> &result_nodes) const override final
+    virtual util::PackedGeometryView GetPackedGeometry(const unsigned id) const override final
     {
         const unsigned begin = m_geometry_indices.at(id);
         const unsigned end = m_geometry_indices.at(id + 1);
+        if (begin == end)
+        {
+            return {};
+        }
+        BOOST_ASSERT(end <= m_geometry_list.size());
 
-        result_nodes.clear();
-        result_nodes.insert(result_nodes.begin(), m_geometry_list.begin() + begin,
-                            m_geometry_list.begin() + end);
+        const unsigned char *packed_geometry = &m_geometry_list[begin];
+        return util::PackedGeometryView(packed_geometry, packed_geometry + (end - begin));
     }
 
     virtual unsigned GetGeometryIndexForEdgeID(const unsigned id) const override final
@@ -458,23 +541,18 @@ template <class EdgeDataT> class SharedDataFacade final : public BaseDataFacade<
         return m_name_ID_list.at(id);
     };
 
-    std::string get_name_for_id(const unsigned name_id) const override final
+    boost::string_ref GetNameForID(const unsigned name_id) const override final
     {
         if (std::numeric_limits<unsigned>::max() == name_id)
         {
-            return "";
+            return {};
         }
-        auto range = m_name_table->GetRange(name_id);
-
-        std::string result;
-        result.reserve(range.size());
-        if (range.begin() != range.end())
+        const auto range = m_name_table->GetRange(name_id);
+        if (range.size() == 0)
         {
-            result.resize(range.back() - range.front() + 1);
-            std::copy(m_names_char_list.begin() + range.front(),
-                      m_names_char_list.begin() + range.back() + 1, result.begin());
+            return {};
         }
-        return result;
+        return boost::string_ref(&m_names_char_list[range.front()], range.size());
     }
 
     bool IsCoreNode(const NodeID id) const override final
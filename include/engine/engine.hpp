@@ -6,6 +6,9 @@
 #include "osrm/json_container.hpp"
 #include "osrm/osrm.hpp"
 
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <unordered_map>
 #include <string>
@@ -28,6 +31,7 @@ struct Object;
 
 namespace engine
 {
+class BinaryResponse;
 struct EngineConfig;
 struct RouteParameters;
 namespace plugins
@@ -51,14 +55,21 @@ class Engine final
     Engine &operator=(const Engine &) = delete;
 
     int RunQuery(const RouteParameters &route_parameters, util::json::Object &json_result);
+    int RunQuery(const RouteParameters &route_parameters, BinaryResponse &binary_result);
 
   private:
+    // Runs a plugin under the data lock and the query budget, returns its status
+    int RunPlugin(const std::function<int()> &handle_request,
+                  const std::function<void(const char *)> &report_abort);
     void RegisterPlugin(plugins::BasePlugin *plugin);
     PluginMap plugin_map;
     // will only be initialized if shared memory is used
     std::unique_ptr<storage::SharedBarriers> barrier;
     // base class pointer to the objects
     datafacade::BaseDataFacade<contractor::QueryEdge::EdgeData> *query_data_facade;
+    // budget of every query, zero is unlimited
+    std::chrono::milliseconds max_query_duration;
+    std::uint64_t max_settled_nodes;
 
     // decrease number of concurrent queries
     void decrease_concurrent_query_count();
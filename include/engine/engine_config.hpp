@@ -46,7 +46,16 @@ struct EngineConfig
     int max_locations_viaroute = -1;
     int max_locations_distance_table = -1;
     int max_locations_map_matching = -1;
+    // tables with at least this many entries run RPHAST if the contraction levels are loaded
+    int min_rphast_table_size = 500 * 500;
+    // memory for cached route and table results in MiB, 0 disables caching
+    int max_result_cache_size = 0;
+    // queries running longer or settling more nodes are aborted, 0 disables the limit
+    int max_query_duration = 0; // milliseconds
+    int max_settled_nodes = 0;
     bool use_shared_memory = true;
+    // split the graph into per-direction search lists, costs 8 bytes per edge and direction
+    bool use_search_graph = false;
 };
 
 }
@@ -4,6 +4,7 @@
 #include "util/coordinate_calculation.hpp"
 #include "util/typedefs.hpp"
 #include "engine/phantom_node.hpp"
+#include "engine/query_statistics.hpp"
 #include "util/bearing.hpp"
 
 #include "osrm/coordinate.hpp"
@@ -40,10 +41,13 @@ template <typename RTreeT> class GeospatialQuery
                                const int bearing = 0,
                                const int bearing_range = 180)
     {
+        ScopedQueryPhase snap_phase(QueryPhase::Snap);
+        auto &statistics = QueryStatistics::Get();
         auto results =
             rtree.Nearest(input_coordinate,
-                          [this, bearing, bearing_range, max_distance](const EdgeData &data)
+                          [this, bearing, bearing_range, &statistics](const EdgeData &data)
                           {
+                              statistics.Count(QueryCounter::SnappingCandidates);
                               return checkSegmentBearing(data, bearing, bearing_range);
                           },
                           [max_distance](const std::size_t, const double min_dist)
@@ -62,9 +66,12 @@ template <typename RTreeT> class GeospatialQuery
                         const int bearing = 0,
                         const int bearing_range = 180)
     {
+        ScopedQueryPhase snap_phase(QueryPhase::Snap);
+        auto &statistics = QueryStatistics::Get();
         auto results = rtree.Nearest(input_coordinate,
-                                     [this, bearing, bearing_range](const EdgeData &data)
+                                     [this, bearing, bearing_range, &statistics](const EdgeData &data)
                                      {
+                                         statistics.Count(QueryCounter::SnappingCandidates);
                                          return checkSegmentBearing(data, bearing, bearing_range);
                                      },
                                      [max_results](const std::size_t num_results, const double)
@@ -82,13 +89,16 @@ template <typename RTreeT> class GeospatialQuery
         const int bearing = 0,
         const int bearing_range = 180)
     {
+        ScopedQueryPhase snap_phase(QueryPhase::Snap);
+        auto &statistics = QueryStatistics::Get();
         bool has_small_component = false;
         bool has_big_component = false;
         auto results = rtree.Nearest(
             input_coordinate,
-            [this, bearing, bearing_range, &has_big_component, &has_small_component](
+            [this, bearing, bearing_range, &has_big_component, &has_small_component, &statistics](
                 const EdgeData &data)
             {
+                statistics.Count(QueryCounter::SnappingCandidates);
                 auto use_segment =
                     (!has_small_component || (!has_big_component && !data.component.is_tiny));
                 auto use_directions = std::make_pair(use_segment, use_segment);
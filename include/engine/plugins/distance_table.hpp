@@ -4,11 +4,14 @@
 #include "engine/plugins/plugin_base.hpp"
 
 #include "engine/object_encoder.hpp"
+#include "engine/result_cache.hpp"
 #include "engine/search_engine.hpp"
+#include "util/integer_range.hpp"
 #include "util/make_unique.hpp"
 #include "util/string_util.hpp"
 #include "osrm/json_container.hpp"
 
+#include <cstdint>
 #include <cstdlib>
 
 #include <algorithm>
@@ -28,13 +31,26 @@ template <class DataFacadeT> class DistanceTablePlugin final : public BasePlugin
   private:
     std::unique_ptr<SearchEngine<DataFacadeT>> search_engine_ptr;
     int max_locations_distance_table;
+    // number of table entries from which RPHAST is used
+    std::size_t min_rphast_table_size;
+    using TableRow = std::vector<EdgeWeight>;
+    // rows keyed by their source and all targets, nullptr if caching is disabled
+    std::unique_ptr<ResultCache<TableRow>> row_cache;
 
   public:
-    explicit DistanceTablePlugin(DataFacadeT *facade, const int max_locations_distance_table)
-        : max_locations_distance_table(max_locations_distance_table), descriptor_string("table"),
+    explicit DistanceTablePlugin(DataFacadeT *facade,
+                                 const int max_locations_distance_table,
+                                 const std::size_t min_rphast_table_size,
+                                 const std::size_t row_cache_size = 0)
+        : max_locations_distance_table(max_locations_distance_table),
+          min_rphast_table_size(min_rphast_table_size), descriptor_string("table"),
           facade(facade)
     {
         search_engine_ptr = util::make_unique<SearchEngine<DataFacadeT>>(facade);
+        if (row_cache_size > 0)
+        {
+            row_cache = util::make_unique<ResultCache<TableRow>>(row_cache_size);
+        }
     }
 
     virtual ~DistanceTablePlugin() {}
@@ -43,10 +59,114 @@ template <class DataFacadeT> class DistanceTablePlugin final : public BasePlugin
 
     Status HandleRequest(const RouteParameters &route_parameters,
                          util::json::Object &json_result) override final
+    {
+        std::string status_message;
+        std::vector<PhantomNode> snapped_source_phantoms;
+        std::vector<PhantomNode> snapped_target_phantoms;
+        std::shared_ptr<std::vector<EdgeWeight>> result_table;
+        const auto status = ComputeResult(route_parameters, status_message,
+                                          snapped_source_phantoms, snapped_target_phantoms,
+                                          result_table);
+        if (Status::Ok != status)
+        {
+            json_result.values["status_message"] = status_message;
+            return status;
+        }
+        const auto number_of_sources = snapped_source_phantoms.size();
+        const auto number_of_destination = snapped_target_phantoms.size();
+
+        util::json::Array matrix_json_array;
+        for (const auto row : util::irange<std::size_t>(0, number_of_sources))
+        {
+            util::json::Array json_row;
+            auto row_begin_iterator = result_table->begin() + (row * number_of_destination);
+            auto row_end_iterator = result_table->begin() + ((row + 1) * number_of_destination);
+            json_row.values.insert(json_row.values.end(), row_begin_iterator, row_end_iterator);
+            matrix_json_array.values.push_back(json_row);
+        }
+        json_result.values["distance_table"] = matrix_json_array;
+
+        util::json::Array target_coord_json_array;
+        for (const auto &phantom : snapped_target_phantoms)
+        {
+            util::json::Array json_coord;
+            json_coord.values.push_back(phantom.location.lat / COORDINATE_PRECISION);
+            json_coord.values.push_back(phantom.location.lon / COORDINATE_PRECISION);
+            target_coord_json_array.values.push_back(json_coord);
+        }
+        json_result.values["destination_coordinates"] = target_coord_json_array;
+        util::json::Array source_coord_json_array;
+        for (const auto &phantom : snapped_source_phantoms)
+        {
+            util::json::Array json_coord;
+            json_coord.values.push_back(phantom.location.lat / COORDINATE_PRECISION);
+            json_coord.values.push_back(phantom.location.lon / COORDINATE_PRECISION);
+            source_coord_json_array.values.push_back(json_coord);
+        }
+        json_result.values["source_coordinates"] = source_coord_json_array;
+        return Status::Ok;
+    }
+
+    Status HandleBinaryRequest(const RouteParameters &route_parameters,
+                               BinaryResponse &binary_result) override final
+    {
+        std::string status_message;
+        std::vector<PhantomNode> snapped_source_phantoms;
+        std::vector<PhantomNode> snapped_target_phantoms;
+        std::shared_ptr<std::vector<EdgeWeight>> result_table;
+        const auto status = ComputeResult(route_parameters, status_message,
+                                          snapped_source_phantoms, snapped_target_phantoms,
+                                          result_table);
+        if (Status::Ok != status)
+        {
+            binary_result.WriteStatusMessage(status_message);
+            return status;
+        }
+
+        binary_result.WriteTable(static_cast<std::uint32_t>(snapped_source_phantoms.size()),
+                                 static_cast<std::uint32_t>(snapped_target_phantoms.size()),
+                                 result_table->data());
+        const auto locations = [](const std::vector<PhantomNode> &phantoms)
+        {
+            std::vector<util::FixedPointCoordinate> coordinates;
+            coordinates.reserve(phantoms.size());
+            for (const auto &phantom : phantoms)
+            {
+                coordinates.push_back(phantom.location);
+            }
+            return coordinates;
+        };
+        binary_result.WriteCoordinates(BinarySection::SourceCoordinates,
+                                       locations(snapped_source_phantoms));
+        binary_result.WriteCoordinates(BinarySection::DestinationCoordinates,
+                                       locations(snapped_target_phantoms));
+
+        // sources first, then targets: sending them back skips the snapping
+        std::vector<std::string> hints;
+        hints.reserve(snapped_source_phantoms.size() + snapped_target_phantoms.size());
+        for (const auto *phantoms : {&snapped_source_phantoms, &snapped_target_phantoms})
+        {
+            for (const auto &phantom : *phantoms)
+            {
+                hints.emplace_back();
+                ObjectEncoder::EncodeToBase64(phantom, hints.back());
+            }
+        }
+        binary_result.WriteHints(facade->GetCheckSum(), hints);
+        return Status::Ok;
+    }
+
+  private:
+    // Snaps the locations and computes the table, sets the status message on failure
+    Status ComputeResult(const RouteParameters &route_parameters,
+                         std::string &status_message,
+                         std::vector<PhantomNode> &snapped_source_phantoms,
+                         std::vector<PhantomNode> &snapped_target_phantoms,
+                         std::shared_ptr<std::vector<EdgeWeight>> &result_table)
     {
         if (!check_all_coordinates(route_parameters.coordinates))
         {
-            json_result.values["status_message"] = "Coordinates are invalid";
+            status_message = "Coordinates are invalid";
             return Status::Error;
         }
 
@@ -54,8 +174,7 @@ template <class DataFacadeT> class DistanceTablePlugin final : public BasePlugin
         if (input_bearings.size() > 0 &&
             route_parameters.coordinates.size() != input_bearings.size())
         {
-            json_result.values["status_message"] =
-                "Number of bearings does not match number of coordinates";
+            status_message = "Number of bearings does not match number of coordinates";
             return Status::Error;
         }
 
@@ -76,7 +195,7 @@ template <class DataFacadeT> class DistanceTablePlugin final : public BasePlugin
             (number_of_sources * number_of_destination >
              max_locations_distance_table * max_locations_distance_table))
         {
-            json_result.values["status_message"] =
+            status_message =
                 "Number of entries " + std::to_string(number_of_sources * number_of_destination) +
                 " is higher than current maximum (" +
                 std::to_string(max_locations_distance_table * max_locations_distance_table) + ")";
@@ -132,7 +251,7 @@ template <class DataFacadeT> class DistanceTablePlugin final : public BasePlugin
                 // we didn't found a fitting node, return error
                 if (!phantom_node_source_out_iter->first.IsValid(facade->GetNumberOfNodes()))
                 {
-                    json_result.values["status_message"] =
+                    status_message =
                         std::string("Could not find a matching segment for coordinate ") +
                         std::to_string(i);
                     return Status::NoSegment;
@@ -155,7 +274,7 @@ template <class DataFacadeT> class DistanceTablePlugin final : public BasePlugin
                 // we didn't found a fitting node, return error
                 if (!phantom_node_target_out_iter->first.IsValid(facade->GetNumberOfNodes()))
                 {
-                    json_result.values["status_message"] =
+                    status_message =
                         std::string("Could not find a matching segment for coordinate ") +
                         std::to_string(i);
                     return Status::NoSegment;
@@ -171,51 +290,105 @@ template <class DataFacadeT> class DistanceTablePlugin final : public BasePlugin
 
         // FIXME we should clear phantom_node_source_vector and phantom_node_target_vector after
         // this
-        auto snapped_source_phantoms = snapPhantomNodes(phantom_node_source_vector);
-        auto snapped_target_phantoms = snapPhantomNodes(phantom_node_target_vector);
+        snapped_source_phantoms = snapPhantomNodes(phantom_node_source_vector);
+        snapped_target_phantoms = snapPhantomNodes(phantom_node_target_vector);
 
-        auto result_table =
-            search_engine_ptr->distance_table(snapped_source_phantoms, snapped_target_phantoms);
+        result_table = ComputeTable(snapped_source_phantoms, snapped_target_phantoms);
 
         if (!result_table)
         {
-            json_result.values["status_message"] = "No distance table found";
+            status_message = "No distance table found";
             return Status::EmptyResult;
         }
 
-        util::json::Array matrix_json_array;
-        for (const auto row : util::irange<std::size_t>(0, number_of_sources))
+        return Status::Ok;
+    }
+
+    // Only computes the rows that are not cached yet
+    std::shared_ptr<std::vector<EdgeWeight>>
+    ComputeTable(const std::vector<PhantomNode> &snapped_source_phantoms,
+                 const std::vector<PhantomNode> &snapped_target_phantoms)
+    {
+        if (!row_cache || snapped_source_phantoms.empty())
         {
-            util::json::Array json_row;
-            auto row_begin_iterator = result_table->begin() + (row * number_of_destination);
-            auto row_end_iterator = result_table->begin() + ((row + 1) * number_of_destination);
-            json_row.values.insert(json_row.values.end(), row_begin_iterator, row_end_iterator);
-            matrix_json_array.values.push_back(json_row);
+            return ComputeRows(snapped_source_phantoms, snapped_target_phantoms);
         }
-        json_result.values["distance_table"] = matrix_json_array;
 
-        util::json::Array target_coord_json_array;
+        const auto dataset = ResultCacheDataset(facade->GetCheckSum(), facade->GetTimestamp());
+        const auto number_of_targets = snapped_target_phantoms.size();
+
+        auto target_words = std::make_shared<std::vector<std::uint32_t>>();
         for (const auto &phantom : snapped_target_phantoms)
         {
-            util::json::Array json_coord;
-            json_coord.values.push_back(phantom.location.lat / COORDINATE_PRECISION);
-            json_coord.values.push_back(phantom.location.lon / COORDINATE_PRECISION);
-            target_coord_json_array.values.push_back(json_coord);
+            AppendPhantomNodeWeights(phantom, *target_words);
         }
-        json_result.values["destination_coordinates"] = target_coord_json_array;
-        util::json::Array source_coord_json_array;
-        for (const auto &phantom : snapped_source_phantoms)
+        // all rows share the target words, each one pays its part
+        const std::size_t row_bytes =
+            sizeof(TableRow) + number_of_targets * sizeof(EdgeWeight) +
+            target_words->size() * sizeof(std::uint32_t) / snapped_source_phantoms.size();
+
+        auto result_table = std::make_shared<std::vector<EdgeWeight>>(
+            snapped_source_phantoms.size() * number_of_targets);
+        std::vector<std::size_t> missing_rows;
+        std::vector<PhantomNode> missing_sources;
+        std::vector<ResultCacheKey> missing_keys;
+        for (const auto row : util::irange<std::size_t>(0, snapped_source_phantoms.size()))
         {
-            util::json::Array json_coord;
-            json_coord.values.push_back(phantom.location.lat / COORDINATE_PRECISION);
-            json_coord.values.push_back(phantom.location.lon / COORDINATE_PRECISION);
-            source_coord_json_array.values.push_back(json_coord);
+            ResultCacheKey key;
+            AppendPhantomNodeWeights(snapped_source_phantoms[row], key.words);
+            key.shared_words = target_words;
+
+            const auto cached_row = row_cache->Find(dataset, key);
+            if (cached_row)
+            {
+                std::copy(cached_row->begin(), cached_row->end(),
+                          result_table->begin() + row * number_of_targets);
+            }
+            else
+            {
+                missing_rows.push_back(row);
+                missing_sources.push_back(snapped_source_phantoms[row]);
+                missing_keys.push_back(std::move(key));
+            }
         }
-        json_result.values["source_coordinates"] = source_coord_json_array;
-        return Status::Ok;
+
+        if (missing_sources.empty())
+        {
+            return result_table;
+        }
+
+        const auto missing_table = ComputeRows(missing_sources, snapped_target_phantoms);
+        if (!missing_table)
+        {
+            return missing_table;
+        }
+        for (const auto index : util::irange<std::size_t>(0, missing_rows.size()))
+        {
+            const auto row_begin = missing_table->begin() + index * number_of_targets;
+            auto computed_row =
+                std::make_shared<const TableRow>(row_begin, row_begin + number_of_targets);
+            std::copy(computed_row->begin(), computed_row->end(),
+                      result_table->begin() + missing_rows[index] * number_of_targets);
+            row_cache->Insert(dataset, std::move(missing_keys[index]), std::move(computed_row),
+                              row_bytes);
+        }
+        return result_table;
+    }
+
+    // Large tables run RPHAST if the levels are loaded: it selects the part of the hierarchy the
+    // targets need once and sweeps over it for each source instead of scanning buckets
+    std::shared_ptr<std::vector<EdgeWeight>>
+    ComputeRows(const std::vector<PhantomNode> &source_phantoms,
+                const std::vector<PhantomNode> &target_phantoms)
+    {
+        if (source_phantoms.size() * target_phantoms.size() >= min_rphast_table_size &&
+            search_engine_ptr->one_to_many.IsAvailable())
+        {
+            return search_engine_ptr->one_to_many(source_phantoms, target_phantoms);
+        }
+        return search_engine_ptr->distance_table(source_phantoms, target_phantoms);
     }
 
-  private:
     std::string descriptor_string;
     DataFacadeT *facade;
 };
@@ -0,0 +1,207 @@
+#ifndef ISOCHRONE_HPP
+#define ISOCHRONE_HPP
+
+#include "engine/plugins/plugin_base.hpp"
+
+#include "engine/query_budget.hpp"
+#include "engine/search_engine.hpp"
+#include "util/integer_range.hpp"
+#include "util/make_unique.hpp"
+#include "osrm/json_container.hpp"
+
+#include <boost/thread/tss.hpp>
+
+#include <cstdint>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace plugins
+{
+
+/*
+ * Returns the travel times from one location to all road network nodes reachable within
+ * max_duration seconds, computed with one PHAST query. Isochrones and catchment areas are built
+ * from these points on the client side.
+ *
+ * Every request sweeps and scans the whole graph, O(V+E) no matter how small max_duration is.
+ */
+
+template <class DataFacadeT> class IsochronePlugin final : public BasePlugin
+{
+  private:
+    std::unique_ptr<SearchEngine<DataFacadeT>> search_engine_ptr;
+
+    // node sized buffers of a query thread, kept to not allocate them for every request
+    struct QueryBuffers
+    {
+        std::vector<EdgeWeight> distances;
+        std::vector<bool> is_located;
+    };
+    boost::thread_specific_ptr<QueryBuffers> query_buffers;
+
+  public:
+    explicit IsochronePlugin(DataFacadeT *facade)
+        : descriptor_string("isochrone"), facade(facade)
+    {
+        search_engine_ptr = util::make_unique<SearchEngine<DataFacadeT>>(facade);
+    }
+
+    virtual ~IsochronePlugin() {}
+
+    const std::string GetDescriptor() const override final { return descriptor_string; }
+
+    Status HandleRequest(const RouteParameters &route_parameters,
+                         util::json::Object &json_result) override final
+    {
+        if (!search_engine_ptr->one_to_many.IsAvailable())
+        {
+            json_result.values["status_message"] =
+                "Service needs the .level file of the contraction";
+            return Status::Error;
+        }
+
+        if (!check_all_coordinates(route_parameters.coordinates, 1) ||
+            route_parameters.coordinates.size() != 1)
+        {
+            json_result.values["status_message"] = "Expected exactly one valid coordinate";
+            return Status::Error;
+        }
+
+        if (0 == route_parameters.max_duration)
+        {
+            json_result.values["status_message"] = "Parameter max_duration is missing";
+            return Status::Error;
+        }
+
+        const auto &input_bearings = route_parameters.bearings;
+        const int bearing = input_bearings.size() > 0 ? input_bearings.front().first : 0;
+        const int range =
+            input_bearings.size() > 0
+                ? (input_bearings.front().second ? *input_bearings.front().second : 10)
+                : 180;
+        const auto phantom_node_pair = facade->NearestPhantomNodeWithAlternativeFromBigComponent(
+            route_parameters.coordinates.front(), bearing, range);
+        if (!phantom_node_pair.first.IsValid(facade->GetNumberOfNodes()))
+        {
+            json_result.values["status_message"] =
+                std::string("Could not find a matching segment for coordinate");
+            return Status::NoSegment;
+        }
+        // a tiny component would only give a tiny isochrone
+        const PhantomNode &source_phantom =
+            (phantom_node_pair.first.component.is_tiny && phantom_node_pair.second.IsValid())
+                ? phantom_node_pair.second
+                : phantom_node_pair.first;
+
+        if (!query_buffers.get())
+        {
+            query_buffers.reset(new QueryBuffers());
+        }
+        auto &distances = query_buffers->distances;
+        search_engine_ptr->one_to_many(source_phantom, distances);
+        // weights are in deciseconds
+        const EdgeWeight max_distance = static_cast<EdgeWeight>(std::min<std::uint64_t>(
+            route_parameters.max_duration * 10ull, INVALID_EDGE_WEIGHT - 1));
+
+        util::json::Array json_points;
+        for (const auto &point :
+             ReachedLocations(distances, max_distance, query_buffers->is_located))
+        {
+            const auto coordinate = facade->GetCoordinateOfNode(point.first);
+            util::json::Array json_point;
+            json_point.values.push_back(coordinate.lat / COORDINATE_PRECISION);
+            json_point.values.push_back(coordinate.lon / COORDINATE_PRECISION);
+            json_point.values.push_back(point.second / 10.);
+            json_points.values.push_back(json_point);
+        }
+
+        util::json::Array json_source;
+        json_source.values.push_back(source_phantom.location.lat / COORDINATE_PRECISION);
+        json_source.values.push_back(source_phantom.location.lon / COORDINATE_PRECISION);
+        json_result.values["source_coordinate"] = json_source;
+        json_result.values["isochrone"] = json_points;
+        return json_points.values.empty() ? Status::EmptyResult : Status::Ok;
+    }
+
+  private:
+    // Every road segment starts where the original edges leading into it leave their source
+    // segment. Reports these nodes with the earliest time any segment starting at them is reached.
+    std::unordered_map<NodeID, EdgeWeight>
+    ReachedLocations(const std::vector<EdgeWeight> &distances,
+                     const EdgeWeight max_distance,
+                     std::vector<bool> &is_located) const
+    {
+        const auto is_reached = [&](const NodeID node)
+        {
+            return distances[node] >= 0 && distances[node] <= max_distance;
+        };
+
+        is_located.assign(distances.size(), false);
+        std::unordered_map<NodeID, EdgeWeight> reached_locations;
+        auto &budget = QueryBudget::Get();
+        for (const auto node : util::irange(0u, facade->GetNumberOfNodes()))
+        {
+            // scans the whole graph like the sweep, so it keeps to the budget the same way
+            if ((node + 1) % QueryBudget::CHECK_INTERVAL == 0)
+            {
+                budget.Poll();
+            }
+            for (const auto edge : facade->GetAdjacentEdgeRange(node))
+            {
+                const auto &data = facade->GetEdgeData(edge);
+                if (data.shortcut)
+                {
+                    continue;
+                }
+                // edges are stored at one of their ends, forward ones lead to the target
+                const NodeID segment = data.forward ? facade->GetTarget(edge) : node;
+                if (is_located[segment] || !is_reached(segment))
+                {
+                    continue;
+                }
+                is_located[segment] = true;
+
+                const NodeID location = GetSegmentStart(data.id);
+                const auto inserted = reached_locations.emplace(location, distances[segment]);
+                if (!inserted.second)
+                {
+                    inserted.first->second = std::min(inserted.first->second, distances[segment]);
+                }
+            }
+        }
+        return reached_locations;
+    }
+
+    // the node at which the original edge enters its target segment
+    NodeID GetSegmentStart(const unsigned original_edge_id) const
+    {
+        const auto geometry_index = facade->GetGeometryIndexForEdgeID(original_edge_id);
+        if (!facade->EdgeIsCompressed(original_edge_id))
+        {
+            return geometry_index;
+        }
+        NodeID last_node = SPECIAL_NODEID;
+        for (const NodeID node : facade->GetPackedGeometry(geometry_index))
+        {
+            last_node = node;
+        }
+        BOOST_ASSERT(SPECIAL_NODEID != last_node);
+        return last_node;
+    }
+
+    std::string descriptor_string;
+    DataFacadeT *facade;
+};
+}
+}
+}
+
+#endif // ISOCHRONE_HPP
@@ -5,6 +5,7 @@
 
 #include "engine/map_matching/bayes_classifier.hpp"
 #include "engine/object_encoder.hpp"
+#include "engine/query_statistics.hpp"
 #include "engine/search_engine.hpp"
 #include "engine/guidance/textual_route_annotation.hpp"
 #include "engine/guidance/segment_list.hpp"
@@ -192,6 +193,7 @@ template <class DataFacadeT> class MapMatchingPlugin : public BasePlugin
                                          const RouteParameters &route_parameters,
                                          const InternalRouteResult &raw_route)
     {
+        ScopedQueryPhase annotate_phase(QueryPhase::Annotate);
         util::json::Object subtrace;
 
         if (route_parameters.classify)
@@ -217,7 +219,9 @@ template <class DataFacadeT> class MapMatchingPlugin : public BasePlugin
             if (route_parameters.geometry)
             {
                 subtrace.values["geometry"] =
-                    response_generator.GetGeometry(route_parameters.compression, segment_list);
+                    response_generator.GetGeometry(route_parameters.compression,
+                                                   route_parameters.polyline_precision,
+                                                   segment_list);
             }
 
             if (route_parameters.print_instructions)
@@ -246,7 +250,7 @@ template <class DataFacadeT> class MapMatchingPlugin : public BasePlugin
         util::json::Array names;
         for (const auto &node : sub.nodes)
         {
-            names.values.emplace_back(facade->get_name_for_id(node.name_id));
+            names.values.emplace_back(facade->GetNameForID(node.name_id).to_string());
         }
         subtrace.values["matched_names"] = names;
 
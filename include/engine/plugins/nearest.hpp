@@ -6,7 +6,11 @@
 #include "util/integer_range.hpp"
 #include "osrm/json_container.hpp"
 
+#include <boost/utility/string_ref.hpp>
+
+#include <algorithm>
 #include <string>
+#include <vector>
 
 namespace osrm
 {
@@ -29,9 +33,76 @@ template <class DataFacadeT> class NearestPlugin final : public BasePlugin
     Status HandleRequest(const RouteParameters &route_parameters,
                          util::json::Object &json_result) override final
     {
-        // check number of parameters
+        std::string status_message;
+        std::vector<PhantomNode> phantoms;
+        const auto status = FindNearest(route_parameters, status_message, phantoms);
+        json_result.values["status_message"] = status_message;
+        if (Status::Ok != status)
+        {
+            return status;
+        }
+
+        if (route_parameters.num_results > 1)
+        {
+            util::json::Array results;
+            for (const auto &node : phantoms)
+            {
+                util::json::Array json_coordinate;
+                util::json::Object result;
+                json_coordinate.values.push_back(node.location.lat / COORDINATE_PRECISION);
+                json_coordinate.values.push_back(node.location.lon / COORDINATE_PRECISION);
+                result.values["mapped coordinate"] = json_coordinate;
+                result.values["name"] = facade->GetNameForID(node.name_id).to_string();
+                results.values.push_back(result);
+            }
+            json_result.values["results"] = results;
+        }
+        else
+        {
+            util::json::Array json_coordinate;
+            json_coordinate.values.push_back(phantoms.front().location.lat / COORDINATE_PRECISION);
+            json_coordinate.values.push_back(phantoms.front().location.lon / COORDINATE_PRECISION);
+            json_result.values["mapped_coordinate"] = json_coordinate;
+            json_result.values["name"] = facade->GetNameForID(phantoms.front().name_id).to_string();
+        }
+        return Status::Ok;
+    }
+
+    Status HandleBinaryRequest(const RouteParameters &route_parameters,
+                               BinaryResponse &binary_result) override final
+    {
+        std::string status_message;
+        std::vector<PhantomNode> phantoms;
+        const auto status = FindNearest(route_parameters, status_message, phantoms);
+        binary_result.WriteStatusMessage(status_message);
+        if (Status::Ok != status)
+        {
+            return status;
+        }
+
+        // mapped coordinates and names of all results, in the order of their distance
+        std::vector<util::FixedPointCoordinate> coordinates;
+        std::vector<boost::string_ref> names;
+        for (const auto &node : phantoms)
+        {
+            coordinates.push_back(node.location);
+            names.push_back(facade->GetNameForID(node.name_id));
+        }
+        binary_result.WriteCoordinates(BinarySection::SourceCoordinates, coordinates);
+        binary_result.WriteNames(names);
+        return Status::Ok;
+    }
+
+  private:
+    // Snaps the first coordinate to the num_results closest segments, at least one, nearest
+    // first. Both output formats answer from these.
+    Status FindNearest(const RouteParameters &route_parameters,
+                       std::string &status_message,
+                       std::vector<PhantomNode> &phantoms) const
+    {
         if (route_parameters.coordinates.empty() || !route_parameters.coordinates.front().IsValid())
         {
+            status_message = "Invalid coordinates";
             return Status::Error;
         }
 
@@ -39,60 +110,31 @@ template <class DataFacadeT> class NearestPlugin final : public BasePlugin
         if (input_bearings.size() > 0 &&
             route_parameters.coordinates.size() != input_bearings.size())
         {
-            json_result.values["status_message"] =
-                "Number of bearings does not match number of coordinates";
+            status_message = "Number of bearings does not match number of coordinates";
             return Status::Error;
         }
 
-        auto number_of_results = static_cast<std::size_t>(route_parameters.num_results);
+        const auto number_of_results =
+            static_cast<std::size_t>(std::max<int>(1, route_parameters.num_results));
         const int bearing = input_bearings.size() > 0 ? input_bearings.front().first : 0;
         const int range =
             input_bearings.size() > 0
                 ? (input_bearings.front().second ? *input_bearings.front().second : 10)
                 : 180;
-        auto phantom_node_vector = facade->NearestPhantomNodes(route_parameters.coordinates.front(),
-                                                               number_of_results, bearing, range);
-
+        const auto phantom_node_vector = facade->NearestPhantomNodes(
+            route_parameters.coordinates.front(), number_of_results, bearing, range);
         if (phantom_node_vector.empty())
         {
-            json_result.values["status_message"] =
-                std::string("Could not find a matching segments for coordinate");
+            status_message = "Could not find a matching segments for coordinate";
             return Status::NoSegment;
         }
-        else
+
+        const auto number_of_entries = std::min(number_of_results, phantom_node_vector.size());
+        for (const auto i : util::irange<std::size_t>(0, number_of_entries))
         {
-            json_result.values["status_message"] = "Found nearest edge";
-            if (number_of_results > 1)
-            {
-                util::json::Array results;
-
-                auto vector_length = phantom_node_vector.size();
-                for (const auto i :
-                     util::irange<std::size_t>(0, std::min(number_of_results, vector_length)))
-                {
-                    const auto &node = phantom_node_vector[i].phantom_node;
-                    util::json::Array json_coordinate;
-                    util::json::Object result;
-                    json_coordinate.values.push_back(node.location.lat / COORDINATE_PRECISION);
-                    json_coordinate.values.push_back(node.location.lon / COORDINATE_PRECISION);
-                    result.values["mapped coordinate"] = json_coordinate;
-                    result.values["name"] = facade->get_name_for_id(node.name_id);
-                    results.values.push_back(result);
-                }
-                json_result.values["results"] = results;
-            }
-            else
-            {
-                util::json::Array json_coordinate;
-                json_coordinate.values.push_back(
-                    phantom_node_vector.front().phantom_node.location.lat / COORDINATE_PRECISION);
-                json_coordinate.values.push_back(
-                    phantom_node_vector.front().phantom_node.location.lon / COORDINATE_PRECISION);
-                json_result.values["mapped_coordinate"] = json_coordinate;
-                json_result.values["name"] =
-                    facade->get_name_for_id(phantom_node_vector.front().phantom_node.name_id);
-            }
+            phantoms.push_back(phantom_node_vector[i].phantom_node);
         }
+        status_message = "Found nearest edge";
         return Status::Ok;
     }
 
@@ -1,6 +1,7 @@
 #ifndef BASE_PLUGIN_HPP
 #define BASE_PLUGIN_HPP
 
+#include "engine/binary_response.hpp"
 #include "engine/phantom_node.hpp"
 
 #include "osrm/coordinate.hpp"
@@ -26,7 +27,8 @@ class BasePlugin
         Ok = 200,
         EmptyResult = 207,
         NoSegment = 208,
-        Error = 400
+        Error = 400,
+        Aborted = 504
     };
 
     BasePlugin() {}
@@ -34,6 +36,12 @@ class BasePlugin
     virtual ~BasePlugin() {}
     virtual const std::string GetDescriptor() const = 0;
     virtual Status HandleRequest(const RouteParameters &, util::json::Object &) = 0;
+    // Answers output=binary requests, writing the result without building a JSON document
+    virtual Status HandleBinaryRequest(const RouteParameters &, BinaryResponse &binary_result)
+    {
+        binary_result.WriteStatusMessage("Service has no binary output format");
+        return Status::Error;
+    }
     virtual bool check_all_coordinates(const std::vector<util::FixedPointCoordinate> &coordinates,
                                        const unsigned min = 2) const final
     {
@@ -4,12 +4,12 @@
 #include "engine/plugins/plugin_base.hpp"
 
 #include "engine/object_encoder.hpp"
-#include "extractor/tarjan_scc.hpp"
+#include "extractor/parallel_scc.hpp"
 #include "engine/trip/trip_nearest_neighbour.hpp"
 #include "engine/trip/trip_farthest_insertion.hpp"
 #include "engine/trip/trip_brute_force.hpp"
 #include "engine/search_engine.hpp"
-#include "util/matrix_graph_wrapper.hpp" // wrapper to use tarjan scc on dist table
+#include "util/matrix_graph_wrapper.hpp" // wrapper to use the scc search on dist table
 #include "engine/api_response_generator.hpp"
 #include "util/make_unique.hpp"
 #include "util/dist_table_wrapper.hpp" // to access the dist table more easily
@@ -141,10 +141,10 @@ template <class DataFacadeT> class RoundTripPlugin final : public BasePlugin
             return SCC_Component(std::move(location_ids), std::move(range));
         }
 
-        // Run TarjanSCC
+        // Run ParallelSCC
         auto wrapper = std::make_shared<util::MatrixGraphWrapper<EdgeWeight>>(
             result_table.GetTable(), number_of_locations);
-        auto scc = extractor::TarjanSCC<util::MatrixGraphWrapper<EdgeWeight>>(wrapper);
+        auto scc = extractor::ParallelSCC<util::MatrixGraphWrapper<EdgeWeight>>(wrapper);
         scc.run();
 
         const auto number_of_components = scc.get_number_of_components();
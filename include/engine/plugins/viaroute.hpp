@@ -5,6 +5,7 @@
 
 #include "engine/api_response_generator.hpp"
 #include "engine/object_encoder.hpp"
+#include "engine/result_cache.hpp"
 #include "engine/search_engine.hpp"
 #include "util/for_each_pair.hpp"
 #include "util/integer_range.hpp"
@@ -35,13 +36,21 @@ template <class DataFacadeT> class ViaRoutePlugin final : public BasePlugin
     std::unique_ptr<SearchEngine<DataFacadeT>> search_engine_ptr;
     DataFacadeT *facade;
     int max_locations_viaroute;
+    // routes keyed by their snapped phantom nodes, nullptr if caching is disabled
+    std::unique_ptr<ResultCache<InternalRouteResult>> route_cache;
 
   public:
-    explicit ViaRoutePlugin(DataFacadeT *facade, int max_locations_viaroute)
+    explicit ViaRoutePlugin(DataFacadeT *facade,
+                            int max_locations_viaroute,
+                            const std::size_t route_cache_size = 0)
         : descriptor_string("viaroute"), facade(facade),
           max_locations_viaroute(max_locations_viaroute)
     {
         search_engine_ptr = util::make_unique<SearchEngine<DataFacadeT>>(facade);
+        if (route_cache_size > 0)
+        {
+            route_cache = util::make_unique<ResultCache<InternalRouteResult>>(route_cache_size);
+        }
     }
 
     virtual ~ViaRoutePlugin() {}
@@ -50,11 +59,44 @@ template <class DataFacadeT> class ViaRoutePlugin final : public BasePlugin
 
     Status HandleRequest(const RouteParameters &route_parameters,
                          util::json::Object &json_result) override final
+    {
+        std::string status_message;
+        std::shared_ptr<const InternalRouteResult> route;
+        const auto status = FindRoute(route_parameters, status_message, route);
+        if (Status::Ok == status)
+        {
+            auto generator = MakeApiResponseGenerator(facade);
+            generator.DescribeRoute(route_parameters, *route, json_result);
+        }
+        json_result.values["status_message"] = status_message;
+        return status;
+    }
+
+    Status HandleBinaryRequest(const RouteParameters &route_parameters,
+                               BinaryResponse &binary_result) override final
+    {
+        std::string status_message;
+        std::shared_ptr<const InternalRouteResult> route;
+        const auto status = FindRoute(route_parameters, status_message, route);
+        binary_result.WriteStatusMessage(status_message);
+        if (Status::Ok == status)
+        {
+            auto generator = MakeApiResponseGenerator(facade);
+            generator.DescribeRoute(route_parameters, *route, binary_result);
+        }
+        return status;
+    }
+
+  private:
+    // Snaps the locations and finds the route, sets the status message in any case
+    Status FindRoute(const RouteParameters &route_parameters,
+                     std::string &status_message,
+                     std::shared_ptr<const InternalRouteResult> &route)
     {
         if (max_locations_viaroute > 0 &&
             (static_cast<int>(route_parameters.coordinates.size()) > max_locations_viaroute))
         {
-            json_result.values["status_message"] =
+            status_message =
                 "Number of entries " + std::to_string(route_parameters.coordinates.size()) +
                 " is higher than current maximum (" + std::to_string(max_locations_viaroute) + ")";
             return Status::Error;
@@ -62,7 +104,7 @@ template <class DataFacadeT> class ViaRoutePlugin final : public BasePlugin
 
         if (!check_all_coordinates(route_parameters.coordinates))
         {
-            json_result.values["status_message"] = "Invalid coordinates";
+            status_message = "Invalid coordinates";
             return Status::Error;
         }
 
@@ -70,7 +112,7 @@ template <class DataFacadeT> class ViaRoutePlugin final : public BasePlugin
         if (input_bearings.size() > 0 &&
             route_parameters.coordinates.size() != input_bearings.size())
         {
-            json_result.values["status_message"] =
+            status_message =
                 "Number of bearings does not match number of coordinate";
             return Status::Error;
         }
@@ -99,7 +141,7 @@ template <class DataFacadeT> class ViaRoutePlugin final : public BasePlugin
             // we didn't found a fitting node, return error
             if (!phantom_node_pair_list[i].first.IsValid(facade->GetNumberOfNodes()))
             {
-                json_result.values["status_message"] =
+                status_message =
                     std::string("Could not find a matching segment for coordinate ") +
                     std::to_string(i);
                 return Status::NoSegment;
@@ -110,7 +152,56 @@ template <class DataFacadeT> class ViaRoutePlugin final : public BasePlugin
 
         auto snapped_phantoms = snapPhantomNodes(phantom_node_pair_list);
 
-        InternalRouteResult raw_route;
+        std::size_t dataset = 0;
+        ResultCacheKey cache_key;
+        if (route_cache)
+        {
+            dataset = ResultCacheDataset(facade->GetCheckSum(), facade->GetTimestamp());
+            cache_key = MakeCacheKey(route_parameters, snapped_phantoms);
+            route = route_cache->Find(dataset, cache_key);
+        }
+
+        if (!route)
+        {
+            auto computed_route = std::make_shared<InternalRouteResult>();
+            ComputeRoute(route_parameters, snapped_phantoms, *computed_route);
+            route = std::move(computed_route);
+            if (route_cache)
+            {
+                route_cache->Insert(dataset, std::move(cache_key), route,
+                                    EstimateMemoryUsage(*route));
+            }
+        }
+
+        // we can only know this after the fact, different SCC ids still
+        // allow for connection in one direction.
+        if (route->is_valid())
+        {
+            status_message = "Found route between points";
+            return Status::Ok;
+        }
+
+        auto first_component_id = snapped_phantoms.front().component.id;
+        auto not_in_same_component =
+            std::any_of(snapped_phantoms.begin(), snapped_phantoms.end(),
+                        [first_component_id](const PhantomNode &node)
+                        {
+                            return node.component.id != first_component_id;
+                        });
+
+        if (not_in_same_component)
+        {
+            status_message = "Impossible route between points";
+            return Status::EmptyResult;
+        }
+        status_message = "No route found between points";
+        return Status::Error;
+    }
+
+    void ComputeRoute(const RouteParameters &route_parameters,
+                      const std::vector<PhantomNode> &snapped_phantoms,
+                      InternalRouteResult &raw_route)
+    {
         auto build_phantom_pairs = [&raw_route](const PhantomNode &first_node,
                                                 const PhantomNode &second_node)
         {
@@ -136,38 +227,36 @@ template <class DataFacadeT> class ViaRoutePlugin final : public BasePlugin
             search_engine_ptr->shortest_path(raw_route.segment_end_coordinates,
                                              route_parameters.uturns, raw_route);
         }
+    }
 
-        // we can only know this after the fact, different SCC ids still
-        // allow for connection in one direction.
-        if (raw_route.is_valid())
+    // Everything the search depends on: the snapped phantom nodes, uturns and the algorithm
+    static ResultCacheKey MakeCacheKey(const RouteParameters &route_parameters,
+                                       const std::vector<PhantomNode> &snapped_phantoms)
+    {
+        ResultCacheKey key;
+        key.words.push_back(route_parameters.alternate_route ? 1 : 0);
+        key.words.push_back(static_cast<std::uint32_t>(snapped_phantoms.size()));
+        for (const auto &phantom : snapped_phantoms)
         {
-            auto generator = MakeApiResponseGenerator(facade);
-            generator.DescribeRoute(route_parameters, raw_route, json_result);
-            json_result.values["status_message"] = "Found route between points";
+            AppendPhantomNode(phantom, key.words);
         }
-        else
+        for (const bool uturn : route_parameters.uturns)
         {
-            auto first_component_id = snapped_phantoms.front().component.id;
-            auto not_in_same_component =
-                std::any_of(snapped_phantoms.begin(), snapped_phantoms.end(),
-                            [first_component_id](const PhantomNode &node)
-                            {
-                                return node.component.id != first_component_id;
-                            });
-
-            if (not_in_same_component)
-            {
-                json_result.values["status_message"] = "Impossible route between points";
-                return Status::EmptyResult;
-            }
-            else
-            {
-                json_result.values["status_message"] = "No route found between points";
-                return Status::Error;
-            }
+            key.words.push_back(uturn ? 1 : 0);
         }
+        return key;
+    }
 
-        return Status::Ok;
+    static std::size_t EstimateMemoryUsage(const InternalRouteResult &raw_route)
+    {
+        std::size_t bytes = sizeof(InternalRouteResult) +
+                            raw_route.unpacked_alternative.size() * sizeof(PathData) +
+                            raw_route.segment_end_coordinates.size() * sizeof(PhantomNodes);
+        for (const auto &path : raw_route.unpacked_path_segments)
+        {
+            bytes += sizeof(path) + path.size() * sizeof(PathData);
+        }
+        return bytes;
     }
 };
 }
@@ -11,13 +11,23 @@ namespace osrm
 {
 namespace engine
 {
-// Encodes geometry into polyline format.
+// Number of decimal places of encoded coordinates, Google uses five
+const constexpr unsigned POLYLINE_PRECISION_5 = 5;
+const constexpr unsigned POLYLINE_PRECISION_6 = 6;
+
+// Encodes the necessary points of a geometry into polyline format, appending to output.
 // See: https://developers.google.com/maps/documentation/utilities/polylinealgorithm
-std::string polylineEncode(const std::vector<SegmentInformation> &geometry);
+void polylineEncode(const std::vector<SegmentInformation> &geometry,
+                    const unsigned precision,
+                    std::string &output);
+
+std::string polylineEncode(const std::vector<SegmentInformation> &geometry,
+                           const unsigned precision = POLYLINE_PRECISION_6);
 
-// Decodes geometry from polyline format
+// Decodes geometry from polyline format, a truncated last coordinate is dropped
 // See: https://developers.google.com/maps/documentation/utilities/polylinealgorithm
-std::vector<util::FixedPointCoordinate> polylineDecode(const std::string &polyline);
+std::vector<util::FixedPointCoordinate>
+polylineDecode(const std::string &polyline, const unsigned precision = POLYLINE_PRECISION_6);
 }
 }
 
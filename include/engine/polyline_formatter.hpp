@@ -1,6 +1,7 @@
 #ifndef POLYLINE_FORMATTER_HPP
 #define POLYLINE_FORMATTER_HPP
 
+#include "engine/polyline_compressor.hpp"
 #include "engine/segment_information.hpp"
 #include "osrm/json_container.hpp"
 
@@ -14,7 +15,8 @@ namespace engine
 
 // Encodes geometry into polyline format, returning an encoded JSON object
 // See: https://developers.google.com/maps/documentation/utilities/polylinealgorithm
-util::json::String polylineEncodeAsJSON(const std::vector<SegmentInformation> &geometry);
+util::json::String polylineEncodeAsJSON(const std::vector<SegmentInformation> &geometry,
+                                        const unsigned precision);
 
 // Does not encode the geometry in polyline format, instead returning an unencoded JSON object
 util::json::Array polylineUnencodedAsJSON(const std::vector<SegmentInformation> &geometry);
@@ -0,0 +1,98 @@
+#ifndef QUERY_BUDGET_HPP
+#define QUERY_BUDGET_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+
+namespace osrm
+{
+namespace engine
+{
+
+// Thrown out of the search loops when a request used up its budget or was cancelled
+class QueryAborted final : public std::exception
+{
+  public:
+    enum class Reason
+    {
+        TimeLimit,
+        NodeLimit,
+        Cancelled
+    };
+
+    explicit QueryAborted(const Reason reason) : reason(reason) {}
+
+    const char *what() const noexcept override;
+
+    const Reason reason;
+};
+
+// Bounds the work of the request running on one thread.
+//
+// The search loops charge every settled node. Charging is an increment and a compare, the clock
+// and the cancellation flag are only consulted every CHECK_INTERVAL nodes. Outside of a request
+// nothing is ever checked.
+class QueryBudget
+{
+  public:
+    static constexpr std::uint64_t CHECK_INTERVAL = 1024;
+
+    // Returns the budget of the calling thread
+    static QueryBudget &Get();
+
+    // The request is cancelled once *flag turns true, nullptr removes the flag
+    void SetCancellationFlag(const std::atomic<bool> *flag);
+
+    // Arms the budget for a new request, a zero limit means no limit
+    void Start(const std::chrono::milliseconds max_duration,
+               const std::uint64_t max_settled_nodes);
+    void Stop();
+
+    inline void Charge()
+    {
+        if (++settled_nodes >= next_check)
+        {
+            Check();
+        }
+    }
+
+    // Checks right away, for loops that do much work per iteration without settling nodes
+    void Poll();
+
+  private:
+    void Check();
+
+    // plain members only, so the budget can live in POD thread local storage
+    std::uint64_t settled_nodes;
+    std::uint64_t next_check;
+    std::uint64_t max_settled_nodes;
+    // steady clock nanoseconds, 0 for no deadline
+    std::int64_t deadline;
+    const std::atomic<bool> *cancelled;
+    bool running;
+};
+
+// Arms the budget of the calling thread for its scope
+class ScopedQueryBudget
+{
+  public:
+    ScopedQueryBudget(const std::chrono::milliseconds max_duration,
+                      const std::uint64_t max_settled_nodes)
+        : budget(QueryBudget::Get())
+    {
+        budget.Start(max_duration, max_settled_nodes);
+    }
+    ~ScopedQueryBudget() { budget.Stop(); }
+
+    ScopedQueryBudget(const ScopedQueryBudget &) = delete;
+    ScopedQueryBudget &operator=(const ScopedQueryBudget &) = delete;
+
+  private:
+    QueryBudget &budget;
+};
+}
+}
+
+#endif // QUERY_BUDGET_HPP
@@ -0,0 +1,152 @@
+#ifndef QUERY_STATISTICS_HPP
+#define QUERY_STATISTICS_HPP
+
+#include "osrm/json_container.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace osrm
+{
+namespace engine
+{
+
+// Work done while answering a single request
+enum class QueryCounter : std::uint8_t
+{
+    SettledNodes,
+    RelaxedEdges,
+    HeapInserts,
+    StalledNodes,
+    UnpackedShortcuts,
+    SnappingCandidates,
+    CacheHits,
+    CacheMisses,
+    NumberOfCounters
+};
+
+// Phases of a request. Phases are timed exclusively: entering a nested phase (e.g. unpacking
+// inside a search) pauses the enclosing one.
+enum class QueryPhase : std::uint8_t
+{
+    Parse,
+    Snap,
+    Search,
+    Unpack,
+    Annotate,
+    Render,
+    Compress,
+    NumberOfPhases
+};
+
+// Accumulates the counters and phase timings of the requests answered by one thread.
+//
+// The values of the running request are plain integers only touched by the owning thread.
+// EndRequest() folds them into per-thread histograms made of relaxed atomics that are written by
+// the owner only, so RenderMetrics() can read them from any thread without stalling queries.
+class QueryStatistics
+{
+  public:
+    static constexpr std::size_t NUMBER_OF_COUNTERS =
+        static_cast<std::size_t>(QueryCounter::NumberOfCounters);
+    static constexpr std::size_t NUMBER_OF_PHASES =
+        static_cast<std::size_t>(QueryPhase::NumberOfPhases);
+    // powers of four from 1 to 4^12 plus +Inf
+    static constexpr std::size_t NUMBER_OF_COUNTER_BUCKETS = 14;
+    // 100us to 5s plus +Inf
+    static constexpr std::size_t NUMBER_OF_PHASE_BUCKETS = 16;
+
+    // Returns the accumulator of the calling thread, creating it on first use
+    static QueryStatistics &Get();
+
+    inline void Count(const QueryCounter counter, const std::uint64_t value = 1)
+    {
+        request_counters[static_cast<std::size_t>(counter)] += value;
+    }
+
+    void BeginRequest();
+    // Marks the running request as a query handed to a plugin. EndRequest() only observes such
+    // requests, metrics scrapes and rejected requests would skew the distributions.
+    inline void MarkQuery() { request_is_query = true; }
+    void EndRequest();
+
+    inline std::uint64_t RequestCounter(const QueryCounter counter) const
+    {
+        return request_counters[static_cast<std::size_t>(counter)];
+    }
+
+    // Counters and phase timings of the running request
+    util::json::Object RequestStatistics() const;
+
+    // Sums the histograms of all threads in the Prometheus text exposition format
+    static std::string RenderMetrics();
+
+  private:
+    friend class ScopedQueryPhase;
+    using Clock = std::chrono::steady_clock;
+
+    QueryStatistics();
+
+    QueryPhase EnterPhase(const QueryPhase phase);
+    void LeavePhase(const QueryPhase previous_phase);
+    void ChargeCurrentPhase(const Clock::time_point now);
+
+    template <std::size_t NUMBER_OF_BUCKETS> struct Histogram
+    {
+        Histogram()
+        {
+            for (auto &bucket : buckets)
+            {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+            sum.store(0, std::memory_order_relaxed);
+        }
+
+        // single writer: the owning thread
+        void Observe(const std::size_t bucket, const std::uint64_t value)
+        {
+            buckets[bucket].store(buckets[bucket].load(std::memory_order_relaxed) + 1,
+                                  std::memory_order_relaxed);
+            sum.store(sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+        std::array<std::atomic<std::uint64_t>, NUMBER_OF_BUCKETS> buckets;
+        std::atomic<std::uint64_t> sum;
+    };
+
+    std::array<std::uint64_t, NUMBER_OF_COUNTERS> request_counters;
+    std::array<std::uint64_t, NUMBER_OF_PHASES> request_phase_nanoseconds;
+    std::uint32_t request_phases_entered;
+    bool request_is_query;
+    QueryPhase current_phase;
+    Clock::time_point phase_start;
+
+    std::array<Histogram<NUMBER_OF_COUNTER_BUCKETS>, NUMBER_OF_COUNTERS> counter_histograms;
+    std::array<Histogram<NUMBER_OF_PHASE_BUCKETS>, NUMBER_OF_PHASES> phase_histograms;
+};
+
+// Charges the time spent in its scope to the given phase of the calling thread's request
+class ScopedQueryPhase
+{
+  public:
+    explicit ScopedQueryPhase(const QueryPhase phase)
+        : statistics(QueryStatistics::Get()), previous_phase(statistics.EnterPhase(phase))
+    {
+    }
+    ~ScopedQueryPhase() { statistics.LeavePhase(previous_phase); }
+
+    ScopedQueryPhase(const ScopedQueryPhase &) = delete;
+    ScopedQueryPhase &operator=(const ScopedQueryPhase &) = delete;
+
+  private:
+    QueryStatistics &statistics;
+    const QueryPhase previous_phase;
+};
+}
+}
+
+#endif // QUERY_STATISTICS_HPP
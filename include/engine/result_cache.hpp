@@ -0,0 +1,213 @@
+#ifndef RESULT_CACHE_HPP
+#define RESULT_CACHE_HPP
+
+#include "engine/phantom_node.hpp"
+#include "engine/query_statistics.hpp"
+#include "util/std_hash.hpp"
+
+#include <boost/assert.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+
+// Identifies the inputs of a query: equal keys on the same dataset give equal results
+struct ResultCacheKey
+{
+    std::vector<std::uint32_t> words;
+    // words common to many keys, e.g. the targets of all rows of a distance table
+    std::shared_ptr<const std::vector<std::uint32_t>> shared_words;
+
+    bool operator==(const ResultCacheKey &other) const
+    {
+        if (words != other.words)
+        {
+            return false;
+        }
+        if (shared_words == other.shared_words)
+        {
+            return true;
+        }
+        return shared_words && other.shared_words && *shared_words == *other.shared_words;
+    }
+};
+
+struct ResultCacheKeyHash
+{
+    std::size_t operator()(const ResultCacheKey &key) const
+    {
+        std::size_t seed = key.words.size();
+        for (const auto word : key.words)
+        {
+            hash_combine(seed, word);
+        }
+        if (key.shared_words)
+        {
+            for (const auto word : *key.shared_words)
+            {
+                hash_combine(seed, word);
+            }
+        }
+        return seed;
+    }
+};
+
+// Everything about a phantom node that influences a route through it
+inline void AppendPhantomNode(const PhantomNode &phantom, std::vector<std::uint32_t> &words)
+{
+    words.insert(words.end(),
+                 {phantom.forward_node_id, phantom.reverse_node_id, phantom.name_id,
+                  static_cast<std::uint32_t>(phantom.forward_weight),
+                  static_cast<std::uint32_t>(phantom.reverse_weight),
+                  static_cast<std::uint32_t>(phantom.forward_offset),
+                  static_cast<std::uint32_t>(phantom.reverse_offset), phantom.packed_geometry_id,
+                  static_cast<std::uint32_t>(phantom.component.id) |
+                      (static_cast<std::uint32_t>(phantom.component.is_tiny) << 31),
+                  static_cast<std::uint32_t>(phantom.location.lat),
+                  static_cast<std::uint32_t>(phantom.location.lon),
+                  static_cast<std::uint32_t>(phantom.fwd_segment_position) |
+                      (static_cast<std::uint32_t>(phantom.forward_travel_mode) << 16) |
+                      (static_cast<std::uint32_t>(phantom.backward_travel_mode) << 24)});
+}
+
+// Everything about a phantom node that influences a distance from or to it
+inline void AppendPhantomNodeWeights(const PhantomNode &phantom,
+                                     std::vector<std::uint32_t> &words)
+{
+    words.insert(words.end(),
+                 {phantom.forward_node_id, phantom.reverse_node_id,
+                  static_cast<std::uint32_t>(phantom.GetForwardWeightPlusOffset()),
+                  static_cast<std::uint32_t>(phantom.GetReverseWeightPlusOffset())});
+}
+
+// Entries of a different dataset are dropped the next time they are looked at
+inline std::size_t ResultCacheDataset(const unsigned checksum, const std::string &timestamp)
+{
+    return hash_val(checksum, timestamp);
+}
+
+// Least recently used cache of query results with a memory limit.
+//
+// The cache is split into shards with a lock each, so concurrent queries only contend if their
+// keys fall into the same shard. Hits and misses are counted in the QueryStatistics of the
+// calling thread.
+template <typename ValueT> class ResultCache
+{
+  public:
+    explicit ResultCache(const std::size_t memory_limit)
+        : shard_memory_limit(memory_limit / NUMBER_OF_SHARDS)
+    {
+    }
+
+    ResultCache(const ResultCache &) = delete;
+    ResultCache &operator=(const ResultCache &) = delete;
+
+    std::shared_ptr<const ValueT> Find(const std::size_t dataset, const ResultCacheKey &key)
+    {
+        auto &shard = shards[ResultCacheKeyHash()(key) % NUMBER_OF_SHARDS];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.Validate(dataset);
+
+        const auto entry = shard.entries.find(key);
+        if (entry == shard.entries.end())
+        {
+            QueryStatistics::Get().Count(QueryCounter::CacheMisses);
+            return {};
+        }
+        QueryStatistics::Get().Count(QueryCounter::CacheHits);
+        shard.lru.splice(shard.lru.begin(), shard.lru, entry->second.lru_position);
+        return entry->second.value;
+    }
+
+    // value_bytes is the memory held by the value, the cache adds the cost of key and bookkeeping
+    void Insert(const std::size_t dataset,
+                ResultCacheKey key,
+                std::shared_ptr<const ValueT> value,
+                const std::size_t value_bytes)
+    {
+        const std::size_t bytes =
+            value_bytes + key.words.size() * sizeof(std::uint32_t) + ENTRY_OVERHEAD;
+        if (bytes > shard_memory_limit)
+        {
+            return;
+        }
+
+        auto &shard = shards[ResultCacheKeyHash()(key) % NUMBER_OF_SHARDS];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.Validate(dataset);
+
+        const auto inserted =
+            shard.entries.emplace(std::move(key), Entry{std::move(value), bytes, {}});
+        if (!inserted.second)
+        {
+            // a concurrent query computed the same result
+            return;
+        }
+        shard.lru.push_front(&inserted.first->first);
+        inserted.first->second.lru_position = shard.lru.begin();
+        shard.used_bytes += bytes;
+
+        while (shard.used_bytes > shard_memory_limit)
+        {
+            const auto evicted = shard.entries.find(*shard.lru.back());
+            BOOST_ASSERT(evicted != shard.entries.end());
+            shard.used_bytes -= evicted->second.bytes;
+            shard.lru.pop_back();
+            shard.entries.erase(evicted);
+        }
+    }
+
+  private:
+    static constexpr std::size_t NUMBER_OF_SHARDS = 16;
+    // hash node, list node and the Entry itself
+    static constexpr std::size_t ENTRY_OVERHEAD = 128;
+
+    using LRUList = std::list<const ResultCacheKey *>;
+
+    struct Entry
+    {
+        std::shared_ptr<const ValueT> value;
+        std::size_t bytes;
+        typename LRUList::iterator lru_position;
+    };
+
+    struct Shard
+    {
+        void Validate(const std::size_t current_dataset)
+        {
+            if (current_dataset != dataset)
+            {
+                entries.clear();
+                lru.clear();
+                used_bytes = 0;
+                dataset = current_dataset;
+            }
+        }
+
+        std::mutex mutex;
+        std::unordered_map<ResultCacheKey, Entry, ResultCacheKeyHash> entries;
+        // most recently used first, points to the keys of entries
+        LRUList lru;
+        std::size_t used_bytes = 0;
+        std::size_t dataset = 0;
+    };
+
+    const std::size_t shard_memory_limit;
+    std::array<Shard, NUMBER_OF_SHARDS> shards;
+};
+}
+}
+
+#endif // RESULT_CACHE_HPP
@@ -2,9 +2,9 @@
 #define EXTRACT_ROUTE_NAMES_H
 
 #include <boost/assert.hpp>
+#include <boost/utility/string_ref.hpp>
 
 #include <algorithm>
-#include <string>
 #include <utility>
 #include <vector>
 
@@ -13,12 +13,13 @@ namespace osrm
 namespace engine
 {
 
+// Views into the name table of the facade the names were extracted from
 struct RouteNames
 {
-    std::string shortest_path_name_1;
-    std::string shortest_path_name_2;
-    std::string alternative_path_name_1;
-    std::string alternative_path_name_2;
+    boost::string_ref shortest_path_name_1;
+    boost::string_ref shortest_path_name_2;
+    boost::string_ref alternative_path_name_1;
+    boost::string_ref alternative_path_name_2;
 };
 
 namespace detail
@@ -130,15 +131,15 @@ RouteNames extractRouteNames(std::vector<SegmentT> &shortest_path_segments,
     }
 
     // fetching names for the selected segments
-    route_names.shortest_path_name_1 = facade->get_name_for_id(shortest_segment_1.name_id);
-    route_names.shortest_path_name_2 = facade->get_name_for_id(shortest_segment_2.name_id);
+    route_names.shortest_path_name_1 = facade->GetNameForID(shortest_segment_1.name_id);
+    route_names.shortest_path_name_2 = facade->GetNameForID(shortest_segment_2.name_id);
 
     if (!alternative_path_segments.empty())
     {
         route_names.alternative_path_name_1 =
-            facade->get_name_for_id(alternative_segment_1.name_id);
+            facade->GetNameForID(alternative_segment_1.name_id);
         route_names.alternative_path_name_2 =
-            facade->get_name_for_id(alternative_segment_2.name_id);
+            facade->GetNameForID(alternative_segment_2.name_id);
     }
 
     return route_names;
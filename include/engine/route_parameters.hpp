@@ -60,6 +60,8 @@ struct RouteParameters
 
     void SetGPSPrecision(const double precision);
 
+    void SetMaxDuration(const unsigned duration);
+
     void SetDeprecatedAPIFlag(const std::string &);
 
     void SetChecksum(const unsigned check_sum);
@@ -84,30 +86,44 @@ struct RouteParameters
 
     void SetCompressionFlag(const bool flag);
 
+    // false for precisions other than POLYLINE_PRECISION_5 and POLYLINE_PRECISION_6
+    bool SetPolylinePrecision(const unsigned precision);
+
+    void SetDebugStatsFlag(const bool flag);
+
     void AddCoordinate(const double latitude, const double longitude);
 
     void AddDestination(const double latitude, const double longitude);
 
     void AddSource(const double latitude, const double longitude);
 
+    // Keeps the polyline of locs=, it is decoded once the precision is known
     void SetCoordinatesFromGeometry(const std::string &geometry_string);
 
+    // Decodes the polyline of locs= with the requested precision, called after the whole
+    // query string is parsed since polyline_precision may follow locs=
+    void DecodeGeometry();
+
     short zoom_level;
     bool print_instructions;
     bool alternate_route;
     bool geometry;
     bool compression;
+    unsigned polyline_precision;
+    bool debug_stats;
     bool deprecatedAPI;
     bool uturn_default;
     bool classify;
     double matching_beta;
     double gps_precision;
+    unsigned max_duration;
     unsigned check_sum;
     short num_results;
     std::string service;
     std::string output_format;
     std::string jsonp_parameter;
     std::string language;
+    std::string geometry_string;
     std::vector<std::string> hints;
     std::vector<unsigned> timestamps;
     std::vector<std::pair<const int, const boost::optional<int>>> bearings;
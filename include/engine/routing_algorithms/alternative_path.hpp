@@ -2,6 +2,8 @@
 #define ALTERNATIVE_PATH_ROUTING_HPP
 
 #include "engine/routing_algorithms/routing_base.hpp"
+#include "engine/query_budget.hpp"
+#include "engine/query_statistics.hpp"
 #include "engine/search_engine_data.hpp"
 #include "util/integer_range.hpp"
 
@@ -10,6 +12,7 @@
 #include <algorithm>
 #include <iterator>
 #include <unordered_map>
+#include <stack>
 #include <unordered_set>
 
 #include <vector>
@@ -63,6 +66,8 @@ class AlternativeRouting final
 
     void operator()(const PhantomNodes &phantom_node_pair, InternalRouteResult &raw_route_data)
     {
+        ScopedQueryPhase search_phase(QueryPhase::Search);
+
         std::vector<NodeID> alternative_path;
         std::vector<NodeID> via_node_candidate_list;
         std::vector<SearchSpaceEdge> forward_search_space;
@@ -590,6 +595,10 @@ class AlternativeRouting final
         QueryHeap &forward_heap = (is_forward_directed ? heap1 : heap2);
         QueryHeap &reverse_heap = (is_forward_directed ? heap2 : heap1);
 
+        auto &statistics = QueryStatistics::Get();
+        statistics.Count(QueryCounter::SettledNodes);
+        QueryBudget::Get().Charge();
+
         const NodeID node = forward_heap.DeleteMin();
         const int distance = forward_heap.GetKey(node);
         // const NodeID parentnode = forward_heap.GetData(node).parent;
@@ -641,33 +650,28 @@ class AlternativeRouting final
             }
         }
 
-        for (auto edge : facade->GetAdjacentEdgeRange(node))
+        for (const auto &edge : facade->GetSearchEdges(node, is_forward_directed))
         {
-            const EdgeData &data = facade->GetEdgeData(edge);
-            const bool edge_is_forward_directed =
-                (is_forward_directed ? data.forward : data.backward);
-            if (edge_is_forward_directed)
-            {
+            const NodeID to = edge.target;
+            const int edge_weight = edge.weight;
 
-                const NodeID to = facade->GetTarget(edge);
-                const int edge_weight = data.distance;
+            BOOST_ASSERT(edge_weight > 0);
+            const int to_distance = distance + edge_weight;
+            statistics.Count(QueryCounter::RelaxedEdges);
 
-                BOOST_ASSERT(edge_weight > 0);
-                const int to_distance = distance + edge_weight;
-
-                // New Node discovered -> Add to Heap + Node Info Storage
-                if (!forward_heap.WasInserted(to))
-                {
-                    forward_heap.Insert(to, to_distance, node);
-                }
-                // Found a shorter Path -> Update distance
-                else if (to_distance < forward_heap.GetKey(to))
-                {
-                    // new parent
-                    forward_heap.GetData(to).parent = node;
-                    // decreased distance
-                    forward_heap.DecreaseKey(to, to_distance);
-                }
+            // New Node discovered -> Add to Heap + Node Info Storage
+            if (!forward_heap.WasInserted(to))
+            {
+                forward_heap.Insert(to, to_distance, node);
+                statistics.Count(QueryCounter::HeapInserts);
+            }
+            // Found a shorter Path -> Update distance
+            else if (to_distance < forward_heap.GetKey(to))
+            {
+                // new parent
+                forward_heap.GetData(to).parent = node;
+                // decreased distance
+                forward_heap.DecreaseKey(to, to_distance);
             }
         }
     }
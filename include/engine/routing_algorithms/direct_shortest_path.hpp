@@ -5,6 +5,7 @@
 #include <iterator>
 
 #include "engine/routing_algorithms/routing_base.hpp"
+#include "engine/query_statistics.hpp"
 #include "engine/search_engine_data.hpp"
 #include "util/integer_range.hpp"
 #include "util/timing_util.hpp"
@@ -44,6 +45,7 @@ class DirectShortestPathRouting final
                     InternalRouteResult &raw_route_data) const
     {
         (void)uturn_indicators; // unused
+        ScopedQueryPhase search_phase(QueryPhase::Search);
 
         // Get distance to next pair of target nodes.
         BOOST_ASSERT_MSG(1 == phantom_nodes_vector.size(),
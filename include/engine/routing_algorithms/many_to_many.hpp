@@ -2,6 +2,8 @@
 #define MANY_TO_MANY_ROUTING_HPP
 
 #include "engine/routing_algorithms/routing_base.hpp"
+#include "engine/query_budget.hpp"
+#include "engine/query_statistics.hpp"
 #include "engine/search_engine_data.hpp"
 #include "util/typedefs.hpp"
 
@@ -50,6 +52,8 @@ class ManyToManyRouting final
     operator()(const std::vector<PhantomNode> &phantom_sources_array,
                const std::vector<PhantomNode> &phantom_targets_array) const
     {
+        ScopedQueryPhase search_phase(QueryPhase::Search);
+
         const auto number_of_sources = phantom_sources_array.size();
         const auto number_of_targets = phantom_targets_array.size();
         std::shared_ptr<std::vector<EdgeWeight>> result_table =
@@ -125,6 +129,8 @@ class ManyToManyRouting final
                             const SearchSpaceWithBuckets &search_space_with_buckets,
                             std::shared_ptr<std::vector<EdgeWeight>> result_table) const
     {
+        QueryStatistics::Get().Count(QueryCounter::SettledNodes);
+        QueryBudget::Get().Charge();
         const NodeID node = query_heap.DeleteMin();
         const int source_distance = query_heap.GetKey(node);
 
@@ -168,6 +174,8 @@ class ManyToManyRouting final
                              QueryHeap &query_heap,
                              SearchSpaceWithBuckets &search_space_with_buckets) const
     {
+        QueryStatistics::Get().Count(QueryCounter::SettledNodes);
+        QueryBudget::Get().Charge();
         const NodeID node = query_heap.DeleteMin();
         const int target_distance = query_heap.GetKey(node);
 
@@ -186,30 +194,28 @@ class ManyToManyRouting final
     inline void
     RelaxOutgoingEdges(const NodeID node, const EdgeWeight distance, QueryHeap &query_heap) const
     {
-        for (auto edge : super::facade->GetAdjacentEdgeRange(node))
+        auto &statistics = QueryStatistics::Get();
+        for (const auto &edge : super::facade->GetSearchEdges(node, forward_direction))
         {
-            const auto &data = super::facade->GetEdgeData(edge);
-            const bool direction_flag = (forward_direction ? data.forward : data.backward);
-            if (direction_flag)
-            {
-                const NodeID to = super::facade->GetTarget(edge);
-                const int edge_weight = data.distance;
+            const NodeID to = edge.target;
+            const int edge_weight = edge.weight;
 
-                BOOST_ASSERT_MSG(edge_weight > 0, "edge_weight invalid");
-                const int to_distance = distance + edge_weight;
+            BOOST_ASSERT_MSG(edge_weight > 0, "edge_weight invalid");
+            const int to_distance = distance + edge_weight;
+            statistics.Count(QueryCounter::RelaxedEdges);
 
-                // New Node discovered -> Add to Heap + Node Info Storage
-                if (!query_heap.WasInserted(to))
-                {
-                    query_heap.Insert(to, to_distance, node);
-                }
-                // Found a shorter Path -> Update distance
-                else if (to_distance < query_heap.GetKey(to))
-                {
-                    // new parent
-                    query_heap.GetData(to).parent = node;
-                    query_heap.DecreaseKey(to, to_distance);
-                }
+            // New Node discovered -> Add to Heap + Node Info Storage
+            if (!query_heap.WasInserted(to))
+            {
+                query_heap.Insert(to, to_distance, node);
+                statistics.Count(QueryCounter::HeapInserts);
+            }
+            // Found a shorter Path -> Update distance
+            else if (to_distance < query_heap.GetKey(to))
+            {
+                // new parent
+                query_heap.GetData(to).parent = node;
+                query_heap.DecreaseKey(to, to_distance);
             }
         }
     }
@@ -219,21 +225,15 @@ class ManyToManyRouting final
     inline bool
     StallAtNode(const NodeID node, const EdgeWeight distance, QueryHeap &query_heap) const
     {
-        for (auto edge : super::facade->GetAdjacentEdgeRange(node))
+        for (const auto &edge : super::facade->GetSearchEdges(node, !forward_direction))
         {
-            const auto &data = super::facade->GetEdgeData(edge);
-            const bool reverse_flag = ((!forward_direction) ? data.forward : data.backward);
-            if (reverse_flag)
+            BOOST_ASSERT_MSG(edge.weight > 0, "edge_weight invalid");
+            if (query_heap.WasInserted(edge.target))
             {
-                const NodeID to = super::facade->GetTarget(edge);
-                const int edge_weight = data.distance;
-                BOOST_ASSERT_MSG(edge_weight > 0, "edge_weight invalid");
-                if (query_heap.WasInserted(to))
+                if (query_heap.GetKey(edge.target) + edge.weight < distance)
                 {
-                    if (query_heap.GetKey(to) + edge_weight < distance)
-                    {
-                        return true;
-                    }
+                    QueryStatistics::Get().Count(QueryCounter::StalledNodes);
+                    return true;
                 }
             }
         }
@@ -3,6 +3,8 @@
 
 #include "engine/routing_algorithms/routing_base.hpp"
 
+#include "engine/query_budget.hpp"
+#include "engine/query_statistics.hpp"
 #include "util/coordinate_calculation.hpp"
 #include "engine/map_matching/hidden_markov_model.hpp"
 #include "util/json_logger.hpp"
@@ -77,6 +79,8 @@ class MapMatching final : public BasicRoutingInterface<DataFacadeT, MapMatching<
                     const double gps_precision,
                     SubMatchingList &sub_matchings) const
     {
+        ScopedQueryPhase search_phase(QueryPhase::Search);
+
         BOOST_ASSERT(candidates_list.size() == trace_coordinates.size());
         BOOST_ASSERT(candidates_list.size() > 1);
 
@@ -204,6 +208,8 @@ class MapMatching final : public BasicRoutingInterface<DataFacadeT, MapMatching<
                 {
                     continue;
                 }
+                // every candidate pair runs a search, long traces must not outlive their budget
+                QueryBudget::Get().Poll();
 
                 for (const auto s_prime : util::irange<std::size_t>(0u, current_viterbi.size()))
                 {
@@ -0,0 +1,277 @@
+#ifndef PHAST_HPP
+#define PHAST_HPP
+
+#include "engine/routing_algorithms/routing_base.hpp"
+#include "engine/query_budget.hpp"
+#include "engine/query_statistics.hpp"
+#include "engine/search_engine_data.hpp"
+#include "util/integer_range.hpp"
+#include "util/sweep_order.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+
+#include <cstdint>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+namespace routing_algorithms
+{
+
+// One-to-many searches with PHAST: an upward search from the source followed by one linear sweep
+// over the nodes in descending contraction level, in which every node takes its distance from the
+// higher nodes its backward edges lead to. RPHAST restricts the sweep to the nodes the targets
+// depend on, so that a table pays the selection once and a small sweep per source.
+template <class DataFacadeT>
+class PHASTRouting final : public BasicRoutingInterface<DataFacadeT, PHASTRouting<DataFacadeT>>
+{
+    using super = BasicRoutingInterface<DataFacadeT, PHASTRouting<DataFacadeT>>;
+    using QueryHeap = SearchEngineData::QueryHeap;
+    SearchEngineData &engine_working_data;
+
+  public:
+    PHASTRouting(DataFacadeT *facade, SearchEngineData &engine_working_data)
+        : super(facade), engine_working_data(engine_working_data)
+    {
+    }
+
+    ~PHASTRouting() {}
+
+    // the sweep needs the contraction levels, which are optional
+    bool IsAvailable() const
+    {
+        return super::facade->GetSweepOrder().size() == super::facade->GetNumberOfNodes();
+    }
+
+    // Distances from the source to the start of every node like the keys of the other searches,
+    // INVALID_EDGE_WEIGHT for unreachable nodes. The sweep visits every node and edge of the
+    // graph; distances is overwritten and can be kept between queries to save its allocation.
+    void operator()(const PhantomNode &phantom_source, std::vector<EdgeWeight> &distances) const
+    {
+        BOOST_ASSERT(IsAvailable());
+        ScopedQueryPhase search_phase(QueryPhase::Search);
+
+        distances.assign(super::facade->GetNumberOfNodes(), INVALID_EDGE_WEIGHT);
+        std::vector<NodeID> reached_nodes;
+        UpwardSearch(phantom_source, distances, reached_nodes);
+        DownwardSweep(super::facade->GetSweepOrder(), distances);
+    }
+
+    // Same result as ManyToManyRouting, computed with RPHAST
+    std::shared_ptr<std::vector<EdgeWeight>>
+    operator()(const std::vector<PhantomNode> &phantom_sources_array,
+               const std::vector<PhantomNode> &phantom_targets_array) const
+    {
+        BOOST_ASSERT(IsAvailable());
+        ScopedQueryPhase search_phase(QueryPhase::Search);
+
+        const auto number_of_sources = phantom_sources_array.size();
+        const auto number_of_targets = phantom_targets_array.size();
+        std::shared_ptr<std::vector<EdgeWeight>> result_table =
+            std::make_shared<std::vector<EdgeWeight>>(number_of_targets * number_of_sources,
+                                                      std::numeric_limits<EdgeWeight>::max());
+
+        const std::vector<NodeID> sweep_nodes = SelectSweepNodes(phantom_targets_array);
+        const util::SweepOrderRange restricted_sweep_order =
+            sweep_nodes.empty() ? util::SweepOrderRange()
+                                : util::SweepOrderRange(&sweep_nodes[0],
+                                                        &sweep_nodes[0] + sweep_nodes.size());
+
+        // only the entries written by a source are reset for the next one
+        std::vector<EdgeWeight> distances(super::facade->GetNumberOfNodes(),
+                                          INVALID_EDGE_WEIGHT);
+        std::vector<NodeID> reached_nodes;
+        for (const auto source_id : util::irange<std::size_t>(0, number_of_sources))
+        {
+            UpwardSearch(phantom_sources_array[source_id], distances, reached_nodes);
+            DownwardSweep(restricted_sweep_order, distances);
+
+            for (const auto target_id : util::irange<std::size_t>(0, number_of_targets))
+            {
+                const auto &phantom = phantom_targets_array[target_id];
+                auto &current_distance = (*result_table)[source_id * number_of_targets + target_id];
+                if (SPECIAL_NODEID != phantom.forward_node_id)
+                {
+                    UpdateDistance(phantom.forward_node_id, distances[phantom.forward_node_id],
+                                   phantom.GetForwardWeightPlusOffset(), current_distance);
+                }
+                if (SPECIAL_NODEID != phantom.reverse_node_id)
+                {
+                    UpdateDistance(phantom.reverse_node_id, distances[phantom.reverse_node_id],
+                                   phantom.GetReverseWeightPlusOffset(), current_distance);
+                }
+            }
+
+            for (const auto node : reached_nodes)
+            {
+                distances[node] = INVALID_EDGE_WEIGHT;
+            }
+            for (const auto node : sweep_nodes)
+            {
+                distances[node] = INVALID_EDGE_WEIGHT;
+            }
+            reached_nodes.clear();
+        }
+        return result_table;
+    }
+
+  private:
+    // Plain upward search without stall-on-demand, the core needs exact distances
+    void UpwardSearch(const PhantomNode &phantom,
+                      std::vector<EdgeWeight> &distances,
+                      std::vector<NodeID> &reached_nodes) const
+    {
+        engine_working_data.InitializeOrClearFirstThreadLocalStorage(
+            super::facade->GetNumberOfNodes());
+        QueryHeap &query_heap = *(engine_working_data.forward_heap_1);
+
+        if (SPECIAL_NODEID != phantom.forward_node_id)
+        {
+            query_heap.Insert(phantom.forward_node_id, -phantom.GetForwardWeightPlusOffset(),
+                              phantom.forward_node_id);
+        }
+        if (SPECIAL_NODEID != phantom.reverse_node_id)
+        {
+            query_heap.Insert(phantom.reverse_node_id, -phantom.GetReverseWeightPlusOffset(),
+                              phantom.reverse_node_id);
+        }
+
+        auto &statistics = QueryStatistics::Get();
+        auto &budget = QueryBudget::Get();
+        while (!query_heap.Empty())
+        {
+            statistics.Count(QueryCounter::SettledNodes);
+            budget.Charge();
+            const NodeID node = query_heap.DeleteMin();
+            const EdgeWeight distance = query_heap.GetKey(node);
+            distances[node] = distance;
+            reached_nodes.push_back(node);
+
+            for (const auto &edge : super::facade->GetSearchEdges(node, true))
+            {
+                BOOST_ASSERT_MSG(edge.weight > 0, "edge_weight invalid");
+                const EdgeWeight to_distance = distance + edge.weight;
+                statistics.Count(QueryCounter::RelaxedEdges);
+
+                if (!query_heap.WasInserted(edge.target))
+                {
+                    query_heap.Insert(edge.target, to_distance, node);
+                    statistics.Count(QueryCounter::HeapInserts);
+                }
+                else if (to_distance < query_heap.GetKey(edge.target))
+                {
+                    query_heap.GetData(edge.target).parent = node;
+                    query_heap.DecreaseKey(edge.target, to_distance);
+                }
+            }
+        }
+    }
+
+    // The backward edges of a node lead to nodes that come earlier in the sweep order or belong
+    // to the core, whose distances the upward search already settled. The sweep settles no
+    // nodes, it polls the deadline and the cancellation of the budget every block of nodes.
+    void DownwardSweep(const util::SweepOrderRange &sweep_order,
+                       std::vector<EdgeWeight> &distances) const
+    {
+        auto &budget = QueryBudget::Get();
+        std::uint64_t relaxed_edges = 0;
+        std::uint64_t swept_nodes = 0;
+        for (const NodeID node : sweep_order)
+        {
+            if (++swept_nodes % QueryBudget::CHECK_INTERVAL == 0)
+            {
+                budget.Poll();
+            }
+            EdgeWeight distance = distances[node];
+            for (const auto &edge : super::facade->GetSearchEdges(node, false))
+            {
+                const EdgeWeight from_distance = distances[edge.target];
+                if (INVALID_EDGE_WEIGHT != from_distance)
+                {
+                    distance = std::min(distance, from_distance + edge.weight);
+                }
+                ++relaxed_edges;
+            }
+            distances[node] = distance;
+        }
+        QueryStatistics::Get().Count(QueryCounter::RelaxedEdges, relaxed_edges);
+    }
+
+    // Contracted nodes the targets depend on, in sweep order. The core ends the selection as its
+    // distances come from the upward search.
+    std::vector<NodeID> SelectSweepNodes(const std::vector<PhantomNode> &phantom_targets) const
+    {
+        std::vector<bool> is_selected(super::facade->GetNumberOfNodes(), false);
+        std::vector<NodeID> stack;
+        const auto select = [&](const NodeID node)
+        {
+            if (SPECIAL_NODEID != node && !is_selected[node] && !super::facade->IsCoreNode(node))
+            {
+                is_selected[node] = true;
+                stack.push_back(node);
+            }
+        };
+        for (const auto &phantom : phantom_targets)
+        {
+            select(phantom.forward_node_id);
+            select(phantom.reverse_node_id);
+        }
+        while (!stack.empty())
+        {
+            const NodeID node = stack.back();
+            stack.pop_back();
+            for (const auto &edge : super::facade->GetSearchEdges(node, false))
+            {
+                select(edge.target);
+            }
+        }
+
+        std::vector<NodeID> sweep_nodes;
+        for (const NodeID node : super::facade->GetSweepOrder())
+        {
+            if (is_selected[node])
+            {
+                sweep_nodes.push_back(node);
+            }
+        }
+        return sweep_nodes;
+    }
+
+    // combines the distance of a node with the offset of a target on it like ManyToManyRouting
+    void UpdateDistance(const NodeID node,
+                        const EdgeWeight source_distance,
+                        const EdgeWeight target_distance,
+                        EdgeWeight &current_distance) const
+    {
+        if (INVALID_EDGE_WEIGHT == source_distance)
+        {
+            return;
+        }
+        const EdgeWeight new_distance = source_distance + target_distance;
+        if (new_distance < 0)
+        {
+            const EdgeWeight loop_weight = super::GetLoopWeight(node);
+            const EdgeWeight new_distance_with_loop = new_distance + loop_weight;
+            if (loop_weight != INVALID_EDGE_WEIGHT && new_distance_with_loop >= 0)
+            {
+                current_distance = std::min(current_distance, new_distance_with_loop);
+            }
+        }
+        else if (new_distance < current_distance)
+        {
+            current_distance = new_distance;
+        }
+    }
+};
+}
+}
+}
+
+#endif // PHAST_HPP
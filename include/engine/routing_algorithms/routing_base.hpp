@@ -3,6 +3,8 @@
 
 #include "util/coordinate_calculation.hpp"
 #include "engine/internal_route_result.hpp"
+#include "engine/query_budget.hpp"
+#include "engine/query_statistics.hpp"
 #include "engine/search_engine_data.hpp"
 #include "extractor/turn_instructions.hpp"
 #include "util/typedefs.hpp"
@@ -16,20 +18,11 @@
 #include <iterator>
 #include <utility>
 #include <vector>
-#include <stack>
 
 namespace osrm
 {
 namespace engine
 {
-
-SearchEngineData::SearchEngineHeapPtr SearchEngineData::forward_heap_1;
-SearchEngineData::SearchEngineHeapPtr SearchEngineData::reverse_heap_1;
-SearchEngineData::SearchEngineHeapPtr SearchEngineData::forward_heap_2;
-SearchEngineData::SearchEngineHeapPtr SearchEngineData::reverse_heap_2;
-SearchEngineData::SearchEngineHeapPtr SearchEngineData::forward_heap_3;
-SearchEngineData::SearchEngineHeapPtr SearchEngineData::reverse_heap_3;
-
 namespace routing_algorithms
 {
 
@@ -38,6 +31,85 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
   private:
     using EdgeData = typename DataFacadeT::EdgeData;
 
+    // An edge of a packed path, edge_id is SPECIAL_EDGEID until it is known
+    struct UnpackingStep
+    {
+        NodeID from;
+        NodeID to;
+        EdgeID edge_id;
+    };
+
+    static const constexpr std::size_t INITIAL_UNPACKING_STACK_SIZE = 64;
+
+    // Finds the cheapest edge that can be used to get from one node to the other
+    EdgeID FindUnpackingEdge(const NodeID from, const NodeID to) const
+    {
+        // from                 to
+        //     *------------------>*
+        //            edge_id
+        EdgeID smaller_edge_id = SPECIAL_EDGEID;
+        EdgeWeight edge_weight = std::numeric_limits<EdgeWeight>::max();
+        for (const auto edge_id : facade->GetAdjacentEdgeRange(from))
+        {
+            const EdgeWeight weight = facade->GetEdgeData(edge_id).distance;
+            if ((facade->GetTarget(edge_id) == to) && (weight < edge_weight) &&
+                facade->GetEdgeData(edge_id).forward)
+            {
+                smaller_edge_id = edge_id;
+                edge_weight = weight;
+            }
+        }
+
+        // from                 to
+        //     *<------------------*
+        //            edge_id
+        if (SPECIAL_EDGEID == smaller_edge_id)
+        {
+            for (const auto edge_id : facade->GetAdjacentEdgeRange(to))
+            {
+                const EdgeWeight weight = facade->GetEdgeData(edge_id).distance;
+                if ((facade->GetTarget(edge_id) == from) && (weight < edge_weight) &&
+                    facade->GetEdgeData(edge_id).backward)
+                {
+                    smaller_edge_id = edge_id;
+                    edge_weight = weight;
+                }
+            }
+        }
+        return smaller_edge_id;
+    }
+
+    // Replaces a shortcut by its two halves, in reversed order because the stack is LIFO.
+    // The children precomputed by osrm-prepare save searching the adjacency lists for them.
+    void PushShortcutChildren(const UnpackingStep &edge,
+                              const EdgeID shortcut_id,
+                              const EdgeData &shortcut,
+                              std::vector<UnpackingStep> &recursion_stack) const
+    {
+        const NodeID middle_node_id = shortcut.id;
+        const auto children = facade->GetShortcutChildren(shortcut_id);
+        if (!children.IsValid())
+        {
+            recursion_stack.push_back({middle_node_id, edge.to, SPECIAL_EDGEID});
+            recursion_stack.push_back({edge.from, middle_node_id, SPECIAL_EDGEID});
+            return;
+        }
+
+        // children are stored in the direction of the shortcut
+        const bool traversed_in_reverse =
+            !shortcut.forward || facade->GetTarget(shortcut_id) != edge.to;
+        if (traversed_in_reverse)
+        {
+            recursion_stack.push_back({middle_node_id, edge.to, children.first});
+            recursion_stack.push_back({edge.from, middle_node_id, children.second});
+        }
+        else
+        {
+            recursion_stack.push_back({middle_node_id, edge.to, children.second});
+            recursion_stack.push_back({edge.from, middle_node_id, children.first});
+        }
+    }
+
   protected:
     DataFacadeT *facade;
 
@@ -87,6 +159,10 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
                      const bool force_loop_forward,
                      const bool force_loop_reverse) const
     {
+        auto &statistics = QueryStatistics::Get();
+        statistics.Count(QueryCounter::SettledNodes);
+        QueryBudget::Get().Charge();
+
         const NodeID node = forward_heap.DeleteMin();
         const std::int32_t distance = forward_heap.GetKey(node);
 
@@ -108,23 +184,15 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
                 else
                 {
                     // check whether there is a loop present at the node
-                    for (const auto edge : facade->GetAdjacentEdgeRange(node))
+                    for (const auto &edge : facade->GetSearchEdges(node, forward_direction))
                     {
-                        const EdgeData &data = facade->GetEdgeData(edge);
-                        bool forward_directionFlag =
-                            (forward_direction ? data.forward : data.backward);
-                        if (forward_directionFlag)
+                        if (edge.target == node)
                         {
-                            const NodeID to = facade->GetTarget(edge);
-                            if (to == node)
+                            const std::int32_t loop_distance = new_distance + edge.weight;
+                            if (loop_distance >= 0 && loop_distance < upper_bound)
                             {
-                                const EdgeWeight edge_weight = data.distance;
-                                const std::int32_t loop_distance = new_distance + edge_weight;
-                                if (loop_distance >= 0 && loop_distance < upper_bound)
-                                {
-                                    middle_node_id = node;
-                                    upper_bound = loop_distance;
-                                }
+                                middle_node_id = node;
+                                upper_bound = loop_distance;
                             }
                         }
                     }
@@ -144,53 +212,42 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
         // Stalling
         if (stalling)
         {
-            for (const auto edge : facade->GetAdjacentEdgeRange(node))
+            for (const auto &edge : facade->GetSearchEdges(node, !forward_direction))
             {
-                const EdgeData &data = facade->GetEdgeData(edge);
-                const bool reverse_flag = ((!forward_direction) ? data.forward : data.backward);
-                if (reverse_flag)
-                {
-                    const NodeID to = facade->GetTarget(edge);
-                    const EdgeWeight edge_weight = data.distance;
-
-                    BOOST_ASSERT_MSG(edge_weight > 0, "edge_weight invalid");
+                BOOST_ASSERT_MSG(edge.weight > 0, "edge_weight invalid");
 
-                    if (forward_heap.WasInserted(to))
+                if (forward_heap.WasInserted(edge.target))
+                {
+                    if (forward_heap.GetKey(edge.target) + edge.weight < distance)
                     {
-                        if (forward_heap.GetKey(to) + edge_weight < distance)
-                        {
-                            return;
-                        }
+                        statistics.Count(QueryCounter::StalledNodes);
+                        return;
                     }
                 }
             }
         }
 
-        for (const auto edge : facade->GetAdjacentEdgeRange(node))
+        for (const auto &edge : facade->GetSearchEdges(node, forward_direction))
         {
-            const EdgeData &data = facade->GetEdgeData(edge);
-            bool forward_directionFlag = (forward_direction ? data.forward : data.backward);
-            if (forward_directionFlag)
-            {
-
-                const NodeID to = facade->GetTarget(edge);
-                const EdgeWeight edge_weight = data.distance;
+            const NodeID to = edge.target;
+            const EdgeWeight edge_weight = edge.weight;
 
-                BOOST_ASSERT_MSG(edge_weight > 0, "edge_weight invalid");
-                const int to_distance = distance + edge_weight;
+            BOOST_ASSERT_MSG(edge_weight > 0, "edge_weight invalid");
+            const int to_distance = distance + edge_weight;
+            statistics.Count(QueryCounter::RelaxedEdges);
 
-                // New Node discovered -> Add to Heap + Node Info Storage
-                if (!forward_heap.WasInserted(to))
-                {
-                    forward_heap.Insert(to, to_distance, node);
-                }
-                // Found a shorter Path -> Update distance
-                else if (to_distance < forward_heap.GetKey(to))
-                {
-                    // new parent
-                    forward_heap.GetData(to).parent = node;
-                    forward_heap.DecreaseKey(to, to_distance);
-                }
+            // New Node discovered -> Add to Heap + Node Info Storage
+            if (!forward_heap.WasInserted(to))
+            {
+                forward_heap.Insert(to, to_distance, node);
+                statistics.Count(QueryCounter::HeapInserts);
+            }
+            // Found a shorter Path -> Update distance
+            else if (to_distance < forward_heap.GetKey(to))
+            {
+                // new parent
+                forward_heap.GetData(to).parent = node;
+                forward_heap.DecreaseKey(to, to_distance);
             }
         }
     }
@@ -219,70 +276,43 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
                     const PhantomNodes &phantom_node_pair,
                     std::vector<PathData> &unpacked_path) const
     {
+        ScopedQueryPhase unpack_phase(QueryPhase::Unpack);
+        auto &statistics = QueryStatistics::Get();
+
         const bool start_traversed_in_reverse =
             (*packed_path_begin != phantom_node_pair.source_phantom.forward_node_id);
         const bool target_traversed_in_reverse =
             (*std::prev(packed_path_end) != phantom_node_pair.target_phantom.forward_node_id);
 
         BOOST_ASSERT(std::distance(packed_path_begin, packed_path_end) > 0);
-        std::stack<std::pair<NodeID, NodeID>> recursion_stack;
+        std::vector<UnpackingStep> recursion_stack;
+        recursion_stack.reserve(INITIAL_UNPACKING_STACK_SIZE);
 
         // We have to push the path in reverse order onto the stack because it's LIFO.
         for (auto current = std::prev(packed_path_end); current != packed_path_begin;
              current = std::prev(current))
         {
-            recursion_stack.emplace(*std::prev(current), *current);
+            recursion_stack.push_back({*std::prev(current), *current, SPECIAL_EDGEID});
         }
 
-        std::pair<NodeID, NodeID> edge;
         while (!recursion_stack.empty())
         {
-            // edge.first         edge.second
+            // edge.from            edge.to
             //     *------------------>*
             //            edge_id
-            edge = recursion_stack.top();
-            recursion_stack.pop();
-
-            // facade->FindEdge does not suffice here in case of shortcuts.
-            // The above explanation unclear? Think!
-            EdgeID smaller_edge_id = SPECIAL_EDGEID;
-            EdgeWeight edge_weight = std::numeric_limits<EdgeWeight>::max();
-            for (const auto edge_id : facade->GetAdjacentEdgeRange(edge.first))
-            {
-                const EdgeWeight weight = facade->GetEdgeData(edge_id).distance;
-                if ((facade->GetTarget(edge_id) == edge.second) && (weight < edge_weight) &&
-                    facade->GetEdgeData(edge_id).forward)
-                {
-                    smaller_edge_id = edge_id;
-                    edge_weight = weight;
-                }
-            }
+            const UnpackingStep edge = recursion_stack.back();
+            recursion_stack.pop_back();
 
-            // edge.first         edge.second
-            //     *<------------------*
-            //            edge_id
-            if (SPECIAL_EDGEID == smaller_edge_id)
-            {
-                for (const auto edge_id : facade->GetAdjacentEdgeRange(edge.second))
-                {
-                    const EdgeWeight weight = facade->GetEdgeData(edge_id).distance;
-                    if ((facade->GetTarget(edge_id) == edge.first) && (weight < edge_weight) &&
-                        facade->GetEdgeData(edge_id).backward)
-                    {
-                        smaller_edge_id = edge_id;
-                        edge_weight = weight;
-                    }
-                }
-            }
-            BOOST_ASSERT_MSG(edge_weight != INVALID_EDGE_WEIGHT, "edge id invalid");
+            const EdgeID smaller_edge_id = SPECIAL_EDGEID != edge.edge_id
+                                               ? edge.edge_id
+                                               : FindUnpackingEdge(edge.from, edge.to);
+            BOOST_ASSERT_MSG(smaller_edge_id != SPECIAL_EDGEID, "edge id invalid");
 
             const EdgeData &ed = facade->GetEdgeData(smaller_edge_id);
             if (ed.shortcut)
             { // unpack
-                const NodeID middle_node_id = ed.id;
-                // again, we need to this in reversed order
-                recursion_stack.emplace(middle_node_id, edge.second);
-                recursion_stack.emplace(edge.first, middle_node_id);
+                statistics.Count(QueryCounter::UnpackedShortcuts);
+                PushShortcutChildren(edge, smaller_edge_id, ed, recursion_stack);
             }
             else
             {
@@ -300,24 +330,24 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
                 }
                 else
                 {
-                    std::vector<unsigned> id_vector;
-                    facade->GetUncompressedGeometry(facade->GetGeometryIndexForEdgeID(ed.id),
-                                                    id_vector);
+                    // decoded while iterating, nothing is copied
+                    const auto geometry =
+                        facade->GetPackedGeometry(facade->GetGeometryIndexForEdgeID(ed.id));
 
                     const std::size_t start_index =
                         (unpacked_path.empty()
                              ? ((start_traversed_in_reverse)
-                                    ? id_vector.size() -
+                                    ? geometry.size() -
                                           phantom_node_pair.source_phantom.fwd_segment_position - 1
                                     : phantom_node_pair.source_phantom.fwd_segment_position)
                              : 0);
-                    const std::size_t end_index = id_vector.size();
 
-                    BOOST_ASSERT(start_index >= 0);
-                    BOOST_ASSERT(start_index <= end_index);
-                    for (std::size_t i = start_index; i < end_index; ++i)
+                    BOOST_ASSERT(start_index <= geometry.size());
+                    auto node_iter = geometry.begin();
+                    std::advance(node_iter, start_index);
+                    for (; node_iter != geometry.end(); ++node_iter)
                     {
-                        unpacked_path.emplace_back(id_vector[i], name_index,
+                        unpacked_path.emplace_back(*node_iter, name_index,
                                                    extractor::TurnInstruction::NoTurn, 0,
                                                    travel_mode);
                     }
@@ -395,56 +425,33 @@ template <class DataFacadeT, class Derived> class BasicRoutingInterface
 
     void UnpackEdge(const NodeID s, const NodeID t, std::vector<NodeID> &unpacked_path) const
     {
-        std::stack<std::pair<NodeID, NodeID>> recursion_stack;
-        recursion_stack.emplace(s, t);
+        ScopedQueryPhase unpack_phase(QueryPhase::Unpack);
+        auto &statistics = QueryStatistics::Get();
+
+        std::vector<UnpackingStep> recursion_stack;
+        recursion_stack.reserve(INITIAL_UNPACKING_STACK_SIZE);
+        recursion_stack.push_back({s, t, SPECIAL_EDGEID});
 
-        std::pair<NodeID, NodeID> edge;
         while (!recursion_stack.empty())
         {
-            edge = recursion_stack.top();
-            recursion_stack.pop();
-
-            EdgeID smaller_edge_id = SPECIAL_EDGEID;
-            EdgeWeight edge_weight = std::numeric_limits<EdgeWeight>::max();
-            for (const auto edge_id : facade->GetAdjacentEdgeRange(edge.first))
-            {
-                const EdgeWeight weight = facade->GetEdgeData(edge_id).distance;
-                if ((facade->GetTarget(edge_id) == edge.second) && (weight < edge_weight) &&
-                    facade->GetEdgeData(edge_id).forward)
-                {
-                    smaller_edge_id = edge_id;
-                    edge_weight = weight;
-                }
-            }
+            const UnpackingStep edge = recursion_stack.back();
+            recursion_stack.pop_back();
 
-            if (SPECIAL_EDGEID == smaller_edge_id)
-            {
-                for (const auto edge_id : facade->GetAdjacentEdgeRange(edge.second))
-                {
-                    const EdgeWeight weight = facade->GetEdgeData(edge_id).distance;
-                    if ((facade->GetTarget(edge_id) == edge.first) && (weight < edge_weight) &&
-                        facade->GetEdgeData(edge_id).backward)
-                    {
-                        smaller_edge_id = edge_id;
-                        edge_weight = weight;
-                    }
-                }
-            }
-            BOOST_ASSERT_MSG(edge_weight != std::numeric_limits<EdgeWeight>::max(),
-                             "edge weight invalid");
+            const EdgeID smaller_edge_id = SPECIAL_EDGEID != edge.edge_id
+                                               ? edge.edge_id
+                                               : FindUnpackingEdge(edge.from, edge.to);
+            BOOST_ASSERT_MSG(smaller_edge_id != SPECIAL_EDGEID, "edge weight invalid");
 
             const EdgeData &ed = facade->GetEdgeData(smaller_edge_id);
             if (ed.shortcut)
             { // unpack
-                const NodeID middle_node_id = ed.id;
-                // again, we need to this in reversed order
-                recursion_stack.emplace(middle_node_id, edge.second);
-                recursion_stack.emplace(edge.first, middle_node_id);
+                statistics.Count(QueryCounter::UnpackedShortcuts);
+                PushShortcutChildren(edge, smaller_edge_id, ed, recursion_stack);
             }
             else
             {
                 BOOST_ASSERT_MSG(!ed.shortcut, "edge must be shortcut");
-                unpacked_path.emplace_back(edge.first);
+                unpacked_path.emplace_back(edge.from);
             }
         }
         unpacked_path.emplace_back(t);
@@ -5,6 +5,7 @@
 
 #include "engine/routing_algorithms/routing_base.hpp"
 
+#include "engine/query_statistics.hpp"
 #include "engine/search_engine_data.hpp"
 #include "util/integer_range.hpp"
 
@@ -206,6 +207,8 @@ class ShortestPathRouting final
                     const std::vector<bool> &uturn_indicators,
                     InternalRouteResult &raw_route_data) const
     {
+        ScopedQueryPhase search_phase(QueryPhase::Search);
+
         BOOST_ASSERT(uturn_indicators.size() == phantom_nodes_vector.size() + 1);
         engine_working_data.InitializeOrClearFirstThreadLocalStorage(
             super::facade->GetNumberOfNodes());
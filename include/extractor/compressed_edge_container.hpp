@@ -3,9 +3,11 @@
 
 #include "util/typedefs.hpp"
 
-#include <unordered_map>
+#include <boost/range/iterator_range.hpp>
 
+#include <cstddef>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace osrm
@@ -13,35 +15,36 @@ namespace osrm
 namespace extractor
 {
 
+// Geometries of the edges that were compressed by the GraphCompressor. All geometries are stored
+// back to back in one array, the geometry of an edge lists every node after its source together
+// with the weight of the segment leading to it.
 class CompressedEdgeContainer
 {
   public:
     using CompressedNode = std::pair<NodeID, EdgeWeight>;
-    using EdgeBucket = std::vector<CompressedNode>;
+    using EdgeBucket = boost::iterator_range<std::vector<CompressedNode>::const_iterator>;
 
     CompressedEdgeContainer();
-    void CompressEdge(const EdgeID surviving_edge_id,
-                      const EdgeID removed_edge_id,
-                      const NodeID via_node_id,
-                      const NodeID target_node,
-                      const EdgeWeight weight1,
-                      const EdgeWeight weight2);
+
+    // Takes all geometries at once: the geometry of edge_ids[i] is stored at position i and
+    // consists of the nodes from offsets[i] up to offsets[i + 1].
+    void SetGeometries(std::vector<EdgeID> edge_ids,
+                       std::vector<std::size_t> offsets,
+                       std::vector<CompressedNode> nodes);
 
     bool HasEntryForID(const EdgeID edge_id) const;
     void PrintStatistics() const;
     void SerializeInternalVector(const std::string &path) const;
     unsigned GetPositionForID(const EdgeID edge_id) const;
-    const EdgeBucket &GetBucketReference(const EdgeID edge_id) const;
+    EdgeBucket GetBucketReference(const EdgeID edge_id) const;
     NodeID GetFirstEdgeTargetID(const EdgeID edge_id) const;
     NodeID GetLastEdgeSourceID(const EdgeID edge_id) const;
 
   private:
-    int free_list_maximum = 0;
-
-    void IncreaseFreeList();
-    std::vector<EdgeBucket> m_compressed_geometries;
-    std::vector<unsigned> m_free_list;
-    std::unordered_map<EdgeID, unsigned> m_edge_id_to_list_index_map;
+    std::vector<CompressedNode> m_compressed_nodes;
+    std::vector<std::size_t> m_geometry_offsets;
+    // position of the geometry of every edge, SPECIAL_EDGEID if the edge is not compressed
+    std::vector<unsigned> m_edge_id_to_position;
 };
 }
 }
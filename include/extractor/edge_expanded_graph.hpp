@@ -0,0 +1,32 @@
+#ifndef EDGE_EXPANDED_GRAPH_HPP
+#define EDGE_EXPANDED_GRAPH_HPP
+
+#include "extractor/edge_based_edge.hpp"
+#include "util/deallocating_vector.hpp"
+#include "util/typedefs.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace osrm
+{
+namespace extractor
+{
+
+// The edge-expanded graph as the extractor hands it to the contractor in memory, the same data
+// that otherwise goes through the .ebg and .enw files
+struct EdgeExpandedGraph
+{
+    EdgeExpandedGraph() : max_edge_id(SPECIAL_EDGEID) {}
+    // the edge list owns its buckets, copying it would free them twice
+    EdgeExpandedGraph(const EdgeExpandedGraph &) = delete;
+    EdgeExpandedGraph &operator=(const EdgeExpandedGraph &) = delete;
+
+    std::size_t max_edge_id;
+    util::DeallocatingVector<EdgeBasedEdge> edges;
+    std::vector<EdgeWeight> node_weights;
+};
+}
+}
+
+#endif // EDGE_EXPANDED_GRAPH_HPP
@@ -2,6 +2,7 @@
 #define EXTRACTOR_HPP
 
 #include "extractor/edge_based_edge.hpp"
+#include "extractor/edge_expanded_graph.hpp"
 #include "extractor/extractor_config.hpp"
 #include "extractor/edge_based_graph_factory.hpp"
 #include "extractor/graph_compressor.hpp"
@@ -17,7 +18,9 @@ class Extractor
 {
   public:
     Extractor(ExtractorConfig extractor_config) : config(std::move(extractor_config)) {}
-    int run();
+    // Hands the edge-expanded graph to the caller if edge_expanded_graph is given. The .ebg and
+    // .enw files are only written if config.write_edge_expanded_graph is set.
+    int run(EdgeExpandedGraph *edge_expanded_graph = nullptr);
 
   private:
     ExtractorConfig config;
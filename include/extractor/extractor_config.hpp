@@ -13,7 +13,7 @@ namespace extractor
 
 struct ExtractorConfig
 {
-    ExtractorConfig() noexcept : requested_num_threads(0) {}
+    ExtractorConfig() noexcept : requested_num_threads(0), write_edge_expanded_graph(true) {}
     void UseDefaultOutputNames()
     {
         std::string basepath = input_path.string();
@@ -66,6 +66,8 @@ struct ExtractorConfig
     unsigned small_component_size;
 
     bool generate_edge_lookup;
+    // .ebg and .enw are only needed by a separate osrm-prepare run
+    bool write_edge_expanded_graph;
     std::string edge_penalty_path;
     std::string edge_segment_lookup_path;
 #ifdef DEBUG_GEOMETRY
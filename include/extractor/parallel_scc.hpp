@@ -0,0 +1,600 @@
+#ifndef PARALLEL_SCC_HPP
+#define PARALLEL_SCC_HPP
+
+#include "util/integer_range.hpp"
+#include "util/simple_logger.hpp"
+#include "util/timing_util.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace extractor
+{
+
+/**
+ * Computes the strongly connected components of a graph using all cores. Has the interface of
+ * TarjanSCC and works on every graph that provides GetNumberOfNodes, GetAdjacentEdgeRange and
+ * GetTarget.
+ *
+ * The components are found in three steps:
+ *  - nodes without an incoming or outgoing edge are trimmed off as components of size one
+ *  - the largest component is the intersection of a parallel forward and backward search from a
+ *    node of high degree
+ *  - the remaining nodes are colored by propagating the largest node id along the edges. Every
+ *    color holds exactly one component rooted in the node that gave the color, which a backward
+ *    search within the color finds. Coloring is repeated on the nodes still without a component.
+ *    Rounds that assign only a few of them, e.g. one node of a long one-way chain each, leave the
+ *    rest to a sequential Tarjan run, which takes linear time.
+ *
+ * Component ids are numbered by their smallest node, so they do not depend on the scheduling.
+ */
+template <typename GraphT> class ParallelSCC
+{
+    // a dead end or a one-way stub makes its neighbour trimmable in the next round
+    static constexpr unsigned NUMBER_OF_TRIM_ROUNDS = 3;
+    static constexpr std::uint8_t FORWARD_VISITED = 1;
+    static constexpr std::uint8_t BACKWARD_VISITED = 2;
+    // a coloring round has to assign at least this fraction of the remaining nodes
+    static constexpr std::size_t MIN_ROUND_PROGRESS = 8;
+
+    using Frontier = std::vector<NodeID>;
+    using ThreadLocalFrontiers = tbb::enumerable_thread_specific<Frontier>;
+
+    // node id of a member of the component while running, the component id afterwards
+    std::vector<unsigned> components_index;
+    std::vector<NodeID> component_size_vector;
+    std::shared_ptr<const GraphT> m_graph;
+    std::size_t size_one_counter;
+
+    // incoming edges as compressed adjacency lists, only needed while running
+    std::vector<EdgeID> reverse_offsets;
+    std::vector<NodeID> reverse_sources;
+
+  public:
+    ParallelSCC(std::shared_ptr<const GraphT> graph)
+        : components_index(graph->GetNumberOfNodes(), SPECIAL_NODEID), m_graph(graph),
+          size_one_counter(0)
+    {
+        BOOST_ASSERT(m_graph->GetNumberOfNodes() > 0);
+    }
+
+    void run()
+    {
+        TIMER_START(SCC_RUN);
+
+        BuildReverseAdjacency();
+        TrimTrivialComponents();
+        FindLargestComponent();
+        AssignRemainingNodes();
+        NumberComponents();
+
+        reverse_offsets.clear();
+        reverse_offsets.shrink_to_fit();
+        reverse_sources.clear();
+        reverse_sources.shrink_to_fit();
+
+        TIMER_STOP(SCC_RUN);
+        util::SimpleLogger().Write() << "SCC run took: " << TIMER_MSEC(SCC_RUN) / 1000. << "s";
+
+        size_one_counter = std::count_if(component_size_vector.begin(), component_size_vector.end(),
+                                         [](unsigned value)
+                                         {
+                                             return 1 == value;
+                                         });
+    }
+
+    std::size_t get_number_of_components() const { return component_size_vector.size(); }
+
+    std::size_t get_size_one_count() const { return size_one_counter; }
+
+    unsigned get_component_size(const unsigned component_id) const
+    {
+        return component_size_vector[component_id];
+    }
+
+    unsigned get_component_id(const NodeID node) const { return components_index[node]; }
+
+  private:
+    NodeID GetNumberOfNodes() const { return static_cast<NodeID>(components_index.size()); }
+
+    bool IsAssigned(const NodeID node) const { return SPECIAL_NODEID != components_index[node]; }
+
+    template <typename CallbackT> void ForEachTarget(const NodeID node, CallbackT &&callback) const
+    {
+        for (const auto edge : m_graph->GetAdjacentEdgeRange(node))
+        {
+            callback(static_cast<NodeID>(m_graph->GetTarget(edge)));
+        }
+    }
+
+    template <typename CallbackT> void ForEachSource(const NodeID node, CallbackT &&callback) const
+    {
+        for (auto position = reverse_offsets[node]; position < reverse_offsets[node + 1];
+             ++position)
+        {
+            callback(reverse_sources[position]);
+        }
+    }
+
+    static void CollectFrontier(ThreadLocalFrontiers &local_frontiers, Frontier &frontier)
+    {
+        frontier.clear();
+        for (auto &local_frontier : local_frontiers)
+        {
+            frontier.insert(frontier.end(), local_frontier.begin(), local_frontier.end());
+            local_frontier.clear();
+        }
+    }
+
+    void BuildReverseAdjacency()
+    {
+        const auto number_of_nodes = GetNumberOfNodes();
+
+        std::vector<std::atomic<EdgeID>> insert_positions(number_of_nodes);
+        tbb::parallel_for(tbb::blocked_range<NodeID>(0, number_of_nodes),
+                          [&](const tbb::blocked_range<NodeID> &range)
+                          {
+                              for (const auto node : util::irange(range.begin(), range.end()))
+                              {
+                                  ForEachTarget(node, [&](const NodeID target)
+                                                {
+                                                    insert_positions[target].fetch_add(
+                                                        1, std::memory_order_relaxed);
+                                                });
+                              }
+                          });
+
+        reverse_offsets.resize(number_of_nodes + 1);
+        EdgeID number_of_edges = 0;
+        for (const auto node : util::irange(0u, number_of_nodes))
+        {
+            reverse_offsets[node] = number_of_edges;
+            number_of_edges += insert_positions[node].load(std::memory_order_relaxed);
+            insert_positions[node].store(reverse_offsets[node], std::memory_order_relaxed);
+        }
+        reverse_offsets[number_of_nodes] = number_of_edges;
+
+        reverse_sources.resize(number_of_edges);
+        tbb::parallel_for(tbb::blocked_range<NodeID>(0, number_of_nodes),
+                          [&](const tbb::blocked_range<NodeID> &range)
+                          {
+                              for (const auto node : util::irange(range.begin(), range.end()))
+                              {
+                                  ForEachTarget(node, [&](const NodeID target)
+                                                {
+                                                    const auto position =
+                                                        insert_positions[target].fetch_add(
+                                                            1, std::memory_order_relaxed);
+                                                    reverse_sources[position] = node;
+                                                });
+                              }
+                          });
+    }
+
+    void TrimTrivialComponents()
+    {
+        const auto number_of_nodes = GetNumberOfNodes();
+        std::vector<std::uint8_t> is_trivial(number_of_nodes, 0);
+
+        for (unsigned round = 0; round < NUMBER_OF_TRIM_ROUNDS; ++round)
+        {
+            // decide first and assign afterwards, so no node is read while it is written
+            tbb::parallel_for(tbb::blocked_range<NodeID>(0, number_of_nodes),
+                              [&](const tbb::blocked_range<NodeID> &range)
+                              {
+                                  for (const auto node : util::irange(range.begin(), range.end()))
+                                  {
+                                      if (IsAssigned(node))
+                                      {
+                                          continue;
+                                      }
+                                      bool has_target = false, has_source = false;
+                                      const auto check = [&](const NodeID neighbour, bool &found)
+                                      {
+                                          found |= neighbour != node && !IsAssigned(neighbour);
+                                      };
+                                      ForEachTarget(node, [&](const NodeID target)
+                                                    {
+                                                        check(target, has_target);
+                                                    });
+                                      ForEachSource(node, [&](const NodeID source)
+                                                    {
+                                                        check(source, has_source);
+                                                    });
+                                      is_trivial[node] = !has_target || !has_source;
+                                  }
+                              });
+
+            std::atomic<std::size_t> number_of_trimmed_nodes(0);
+            tbb::parallel_for(tbb::blocked_range<NodeID>(0, number_of_nodes),
+                              [&](const tbb::blocked_range<NodeID> &range)
+                              {
+                                  std::size_t trimmed_in_range = 0;
+                                  for (const auto node : util::irange(range.begin(), range.end()))
+                                  {
+                                      if (is_trivial[node])
+                                      {
+                                          components_index[node] = node;
+                                          is_trivial[node] = 0;
+                                          ++trimmed_in_range;
+                                      }
+                                  }
+                                  number_of_trimmed_nodes += trimmed_in_range;
+                              });
+
+            if (0 == number_of_trimmed_nodes)
+            {
+                break;
+            }
+        }
+    }
+
+    // level synchronous breadth first search over the unassigned nodes
+    void MarkReachable(const NodeID start,
+                       const std::uint8_t flag,
+                       std::vector<std::atomic<std::uint8_t>> &visited)
+    {
+        Frontier frontier(1, start);
+        visited[start].fetch_or(flag);
+        ThreadLocalFrontiers local_frontiers;
+        while (!frontier.empty())
+        {
+            tbb::parallel_for(tbb::blocked_range<std::size_t>(0, frontier.size()),
+                              [&](const tbb::blocked_range<std::size_t> &range)
+                              {
+                                  auto &next_frontier = local_frontiers.local();
+                                  const auto visit = [&](const NodeID next)
+                                  {
+                                      if (IsAssigned(next) || (visited[next].load() & flag))
+                                      {
+                                          return;
+                                      }
+                                      if (!(visited[next].fetch_or(flag) & flag))
+                                      {
+                                          next_frontier.push_back(next);
+                                      }
+                                  };
+                                  for (auto index = range.begin(); index != range.end(); ++index)
+                                  {
+                                      if (FORWARD_VISITED == flag)
+                                      {
+                                          ForEachTarget(frontier[index], visit);
+                                      }
+                                      else
+                                      {
+                                          ForEachSource(frontier[index], visit);
+                                      }
+                                  }
+                              });
+            CollectFrontier(local_frontiers, frontier);
+        }
+    }
+
+    void FindLargestComponent()
+    {
+        const auto number_of_nodes = GetNumberOfNodes();
+
+        // the node with the most in and out edges most likely lies in the largest component
+        using Candidate = std::pair<std::uint64_t, NodeID>;
+        const auto pivot = tbb::parallel_reduce(
+            tbb::blocked_range<NodeID>(0, number_of_nodes), Candidate(0, SPECIAL_NODEID),
+            [&](const tbb::blocked_range<NodeID> &range, Candidate best)
+            {
+                for (const auto node : util::irange(range.begin(), range.end()))
+                {
+                    if (IsAssigned(node))
+                    {
+                        continue;
+                    }
+                    std::uint64_t out_degree = 0;
+                    ForEachTarget(node, [&out_degree](const NodeID)
+                                  {
+                                      ++out_degree;
+                                  });
+                    const std::uint64_t in_degree =
+                        reverse_offsets[node + 1] - reverse_offsets[node];
+                    best = std::max(best, Candidate(out_degree * in_degree, node));
+                }
+                return best;
+            },
+            [](const Candidate &lhs, const Candidate &rhs)
+            {
+                return std::max(lhs, rhs);
+            });
+        if (SPECIAL_NODEID == pivot.second)
+        {
+            return;
+        }
+
+        std::vector<std::atomic<std::uint8_t>> visited(number_of_nodes);
+        MarkReachable(pivot.second, FORWARD_VISITED, visited);
+        MarkReachable(pivot.second, BACKWARD_VISITED, visited);
+
+        tbb::parallel_for(tbb::blocked_range<NodeID>(0, number_of_nodes),
+                          [&](const tbb::blocked_range<NodeID> &range)
+                          {
+                              for (const auto node : util::irange(range.begin(), range.end()))
+                              {
+                                  if ((FORWARD_VISITED | BACKWARD_VISITED) == visited[node].load())
+                                  {
+                                      components_index[node] = pivot.second;
+                                  }
+                              }
+                          });
+    }
+
+    void AssignRemainingNodes()
+    {
+        const auto number_of_nodes = GetNumberOfNodes();
+
+        Frontier remaining_nodes;
+        for (const auto node : util::irange(0u, number_of_nodes))
+        {
+            if (!IsAssigned(node))
+            {
+                remaining_nodes.push_back(node);
+            }
+        }
+
+        // allocated once, each round only touches the remaining nodes
+        std::vector<std::atomic<NodeID>> colors(number_of_nodes);
+        std::vector<std::atomic<std::uint8_t>> is_queued(number_of_nodes);
+        while (!remaining_nodes.empty())
+        {
+            const auto number_of_remaining_nodes = remaining_nodes.size();
+            SplitByColor(remaining_nodes, colors, is_queued);
+            remaining_nodes.erase(std::remove_if(remaining_nodes.begin(), remaining_nodes.end(),
+                                                 [this](const NodeID node)
+                                                 {
+                                                     return IsAssigned(node);
+                                                 }),
+                                  remaining_nodes.end());
+
+            if (number_of_remaining_nodes - remaining_nodes.size() <
+                number_of_remaining_nodes / MIN_ROUND_PROGRESS)
+            {
+                AssignSequentially(remaining_nodes);
+                return;
+            }
+        }
+    }
+
+    // Colors the given unassigned nodes and assigns the component of every color
+    void SplitByColor(const Frontier &remaining_nodes,
+                      std::vector<std::atomic<NodeID>> &colors,
+                      std::vector<std::atomic<std::uint8_t>> &is_queued)
+    {
+        ThreadLocalFrontiers local_frontiers;
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, remaining_nodes.size()),
+                          [&](const tbb::blocked_range<std::size_t> &range)
+                          {
+                              for (auto index = range.begin(); index != range.end(); ++index)
+                              {
+                                  const NodeID node = remaining_nodes[index];
+                                  colors[node].store(node);
+                              }
+                          });
+        // Push the largest color along the edges until no color changes anymore. Every thread
+        // follows the changes it made right away, long paths take no rounds of synchronization.
+        // A node is queued again if its color changes after it was taken off a stack.
+        tbb::parallel_for(
+            tbb::blocked_range<std::size_t>(0, remaining_nodes.size()),
+            [&](const tbb::blocked_range<std::size_t> &range)
+            {
+                auto &stack = local_frontiers.local();
+                const auto propagate = [&](const NodeID node)
+                {
+                    const NodeID color = colors[node].load();
+                    ForEachTarget(node, [&](const NodeID target)
+                                  {
+                                      if (IsAssigned(target))
+                                      {
+                                          return;
+                                      }
+                                      NodeID target_color = colors[target].load();
+                                      while (color > target_color)
+                                      {
+                                          if (colors[target].compare_exchange_weak(target_color,
+                                                                                   color))
+                                          {
+                                              if (!is_queued[target].exchange(1))
+                                              {
+                                                  stack.push_back(target);
+                                              }
+                                              break;
+                                          }
+                                      }
+                                  });
+                };
+                // largest colors first, they overwrite the smaller ones only once
+                for (auto index = range.begin(); index != range.end(); ++index)
+                {
+                    propagate(remaining_nodes[remaining_nodes.size() - 1 - index]);
+                    while (!stack.empty())
+                    {
+                        const NodeID node = stack.back();
+                        stack.pop_back();
+                        is_queued[node].store(0);
+                        propagate(node);
+                    }
+                }
+            });
+
+        Frontier roots;
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, remaining_nodes.size()),
+                          [&](const tbb::blocked_range<std::size_t> &range)
+                          {
+                              auto &local_roots = local_frontiers.local();
+                              for (auto index = range.begin(); index != range.end(); ++index)
+                              {
+                                  const NodeID node = remaining_nodes[index];
+                                  if (colors[node].load() == node)
+                                  {
+                                      local_roots.push_back(node);
+                                  }
+                              }
+                          });
+        CollectFrontier(local_frontiers, roots);
+
+        // Colors do not overlap, so every search owns the nodes of its color. Nodes of other
+        // colors are skipped before their component is looked at, assigned nodes may still
+        // carry the color of an earlier round.
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, roots.size()),
+                          [&](const tbb::blocked_range<std::size_t> &range)
+                          {
+                              auto &stack = local_frontiers.local();
+                              for (auto index = range.begin(); index != range.end(); ++index)
+                              {
+                                  const NodeID root = roots[index];
+                                  components_index[root] = root;
+                                  stack.push_back(root);
+                                  while (!stack.empty())
+                                  {
+                                      const NodeID node = stack.back();
+                                      stack.pop_back();
+                                      ForEachSource(node, [&](const NodeID source)
+                                                    {
+                                                        if (colors[source].load() == root &&
+                                                            !IsAssigned(source))
+                                                        {
+                                                            components_index[source] = root;
+                                                            stack.push_back(source);
+                                                        }
+                                                    });
+                                  }
+                              }
+                          });
+    }
+
+    // Iterative Tarjan on the subgraph of the given unassigned nodes
+    void AssignSequentially(const Frontier &remaining_nodes)
+    {
+        const auto number_of_nodes = GetNumberOfNodes();
+        using EdgeIterator =
+            typename std::decay<decltype(m_graph->GetAdjacentEdgeRange(NodeID{0}).begin())>::type;
+        struct Frame
+        {
+            NodeID node;
+            EdgeIterator next_edge;
+            EdgeIterator end_edge;
+        };
+
+        std::vector<unsigned> order(number_of_nodes, SPECIAL_NODEID);
+        std::vector<unsigned> low_link(number_of_nodes);
+        std::vector<bool> is_on_stack(number_of_nodes, false);
+        std::vector<Frame> call_stack;
+        Frontier component_stack;
+        unsigned next_order = 0;
+        const auto visit = [&](const NodeID node)
+        {
+            order[node] = low_link[node] = next_order++;
+            component_stack.push_back(node);
+            is_on_stack[node] = true;
+            const auto edges = m_graph->GetAdjacentEdgeRange(node);
+            call_stack.push_back({node, edges.begin(), edges.end()});
+        };
+
+        for (const auto start : remaining_nodes)
+        {
+            if (SPECIAL_NODEID != order[start])
+            {
+                continue;
+            }
+            visit(start);
+            while (!call_stack.empty())
+            {
+                auto &frame = call_stack.back();
+                if (frame.next_edge != frame.end_edge)
+                {
+                    const auto node = frame.node;
+                    const NodeID target = m_graph->GetTarget(*frame.next_edge);
+                    ++frame.next_edge;
+                    // nodes of finished components are assigned already
+                    if (IsAssigned(target))
+                    {
+                        continue;
+                    }
+                    if (SPECIAL_NODEID == order[target])
+                    {
+                        visit(target);
+                    }
+                    else if (is_on_stack[target])
+                    {
+                        low_link[node] = std::min(low_link[node], order[target]);
+                    }
+                    continue;
+                }
+
+                const NodeID node = frame.node;
+                call_stack.pop_back();
+                if (!call_stack.empty())
+                {
+                    const NodeID parent = call_stack.back().node;
+                    low_link[parent] = std::min(low_link[parent], low_link[node]);
+                }
+                if (low_link[node] == order[node])
+                {
+                    NodeID member;
+                    do
+                    {
+                        member = component_stack.back();
+                        component_stack.pop_back();
+                        is_on_stack[member] = false;
+                        components_index[member] = node;
+                    } while (member != node);
+                }
+            }
+        }
+    }
+
+    void NumberComponents()
+    {
+        const auto number_of_nodes = GetNumberOfNodes();
+
+        // every component is represented by one of its nodes, number them by their smallest node
+        std::vector<unsigned> component_ids(number_of_nodes, SPECIAL_NODEID);
+        for (const auto node : util::irange(0u, number_of_nodes))
+        {
+            BOOST_ASSERT(IsAssigned(node));
+            const auto representative = components_index[node];
+            if (SPECIAL_NODEID == component_ids[representative])
+            {
+                component_ids[representative] =
+                    static_cast<unsigned>(component_size_vector.size());
+                component_size_vector.push_back(0);
+            }
+            const auto component_id = component_ids[representative];
+            components_index[node] = component_id;
+            ++component_size_vector[component_id];
+        }
+
+        for (const auto component_id : util::irange<std::size_t>(0, component_size_vector.size()))
+        {
+            if (component_size_vector[component_id] > 1000)
+            {
+                util::SimpleLogger().Write() << "large component [" << component_id
+                                             << "]=" << component_size_vector[component_id];
+            }
+        }
+    }
+};
+}
+}
+
+#endif /* PARALLEL_SCC_HPP */
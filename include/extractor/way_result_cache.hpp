@@ -0,0 +1,99 @@
+#ifndef WAY_RESULT_CACHE_HPP
+#define WAY_RESULT_CACHE_HPP
+
+#include "extractor/extraction_way.hpp"
+
+#include <tbb/enumerable_thread_specific.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace osmium
+{
+class Way;
+}
+
+namespace osrm
+{
+namespace extractor
+{
+
+/**
+ * Memoizes the results of the profile's way_function by the values of the tags it reads.
+ *
+ * A profile opts in by listing these tags in the global `way_cache_keys`, promising that
+ * way_function looks at nothing else: no other tags, no way id, no geometry. Ways with the same
+ * values for all listed tags then get the same ExtractionWay, and Lua is only called once per
+ * distinct tag set and thread.
+ *
+ * Every thread has its own cache, lookups take no locks.
+ */
+class WayResultCache
+{
+  public:
+    // tag sets are collected up to this number per thread, then the cache starts over
+    static const constexpr std::size_t MAX_ENTRIES_PER_THREAD = 64 * 1024;
+
+    // no keys disable the cache, every way is passed to the profile
+    explicit WayResultCache(std::vector<std::string> keys);
+
+    bool Enabled() const { return !keys.empty(); }
+
+    // Fills result from the cache or by calling compute_result(result) on a miss
+    template <typename ComputeT>
+    void Get(const osmium::Way &way, ExtractionWay &result, const ComputeT &compute_result)
+    {
+        if (!Enabled())
+        {
+            compute_result(result);
+            return;
+        }
+
+        auto &cache = thread_caches.local();
+        BuildKey(way, cache.key);
+        const auto iter = cache.results.find(cache.key);
+        if (iter != cache.results.end())
+        {
+            ++cache.hits;
+            result = iter->second;
+            return;
+        }
+
+        ++cache.misses;
+        compute_result(result);
+        if (cache.results.size() >= MAX_ENTRIES_PER_THREAD)
+        {
+            cache.results.clear();
+        }
+        cache.results.emplace(cache.key, result);
+    }
+
+    // Sums over all threads
+    std::uint64_t Hits() const;
+    std::uint64_t Misses() const;
+
+  private:
+    // Concatenates the values of the keys, absent tags are distinct from empty values
+    void BuildKey(const osmium::Way &way, std::string &key) const;
+
+    struct ThreadCache
+    {
+        ThreadCache() : hits(0), misses(0) {}
+
+        std::unordered_map<std::string, ExtractionWay> results;
+        // reused to build the key of every way
+        std::string key;
+        std::uint64_t hits;
+        std::uint64_t misses;
+    };
+
+    const std::vector<std::string> keys;
+    tbb::enumerable_thread_specific<ThreadCache> thread_caches;
+};
+}
+}
+
+#endif // WAY_RESULT_CACHE_HPP
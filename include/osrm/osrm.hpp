@@ -45,6 +45,7 @@ struct Object;
 
 namespace engine
 {
+class BinaryResponse;
 class Engine;
 struct EngineConfig;
 struct RouteParameters;
@@ -63,6 +64,8 @@ class OSRM
     OSRM(EngineConfig &lib_config);
     ~OSRM(); // needed because we need to define it with the implementation of OSRM_impl
     int RunQuery(const RouteParameters &route_parameters, json::Object &json_result);
+    // answers in the compact binary format, see engine/binary_response.hpp
+    int RunQuery(const RouteParameters &route_parameters, engine::BinaryResponse &binary_result);
 };
 
 }
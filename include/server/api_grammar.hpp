@@ -23,6 +23,10 @@ template <typename Iterator, class HandlerT> struct APIGrammar : qi::grammar<Ite
             const boost::optional<int> range = boost::fusion::at_c<1>(received_bearing);
             pass = handler->AddBearing(bearing, range);
         };
+        const auto set_polyline_precision_wrapper = [this](const unsigned precision, bool &pass)
+        {
+            pass = handler->SetPolylinePrecision(precision);
+        };
         const auto add_coordinate_wrapper =
             [this](const boost::fusion::vector<double, double> &received_coordinate)
         {
@@ -43,11 +47,13 @@ template <typename Iterator, class HandlerT> struct APIGrammar : qi::grammar<Ite
         };
 
         api_call =
-            qi::lit('/') >> string[boost::bind(&HandlerT::SetService, handler, ::_1)] >> -query;
+            qi::lit('/') >> string[boost::bind(&HandlerT::SetService, handler, ::_1)] >> -query >>
+            qi::eps[boost::bind(&HandlerT::DecodeGeometry, handler)];
         query = ('?') >> +(zoom | output | jsonp | checksum | uturns | location_with_options |
-                           destination_with_options | source_with_options | cmp | language |
-                           instruction | geometry | alt_route | old_API | num_results |
-                           matching_beta | gps_precision | classify | locs);
+                           destination_with_options | source_with_options | cmp |
+                           polyline_precision | language | instruction | geometry | alt_route |
+                           old_API | num_results | matching_beta | gps_precision | classify |
+                           locs | debug_stats | max_duration);
         // all combinations of timestamp, uturn, hint and bearing without duplicates
         t_u = (u >> -timestamp) | (timestamp >> -u);
         t_h = (hint >> -timestamp) | (timestamp >> -hint);
@@ -74,6 +80,9 @@ template <typename Iterator, class HandlerT> struct APIGrammar : qi::grammar<Ite
                    qi::bool_[boost::bind(&HandlerT::SetGeometryFlag, handler, ::_1)];
         cmp = (-qi::lit('&')) >> qi::lit("compression") >> '=' >>
               qi::bool_[boost::bind(&HandlerT::SetCompressionFlag, handler, ::_1)];
+        polyline_precision =
+            (-qi::lit('&')) >> qi::lit("polyline_precision") >> '=' >>
+            qi::uint_[boost::bind<void>(set_polyline_precision_wrapper, ::_1, ::_3)];
         location = (-qi::lit('&')) >> qi::lit("loc") >> '=' >>
                    (qi::double_ >> qi::lit(',') >>
                     qi::double_)[boost::bind<void>(add_coordinate_wrapper, ::_1)];
@@ -106,8 +115,12 @@ template <typename Iterator, class HandlerT> struct APIGrammar : qi::grammar<Ite
                         qi::float_[boost::bind(&HandlerT::SetMatchingBeta, handler, ::_1)];
         gps_precision = (-qi::lit('&')) >> qi::lit("gps_precision") >> '=' >>
                         qi::float_[boost::bind(&HandlerT::SetGPSPrecision, handler, ::_1)];
+        max_duration = (-qi::lit('&')) >> qi::lit("max_duration") >> '=' >>
+                       qi::uint_[boost::bind(&HandlerT::SetMaxDuration, handler, ::_1)];
         classify = (-qi::lit('&')) >> qi::lit("classify") >> '=' >>
                    qi::bool_[boost::bind(&HandlerT::SetClassify, handler, ::_1)];
+        debug_stats = (-qi::lit('&')) >> qi::lit("debug_stats") >> '=' >>
+                      qi::bool_[boost::bind(&HandlerT::SetDebugStatsFlag, handler, ::_1)];
         locs = (-qi::lit('&')) >> qi::lit("locs") >> '=' >>
                stringforPolyline[boost::bind(&HandlerT::SetCoordinatesFromGeometry, handler, ::_1)];
 
@@ -122,8 +135,9 @@ template <typename Iterator, class HandlerT> struct APIGrammar : qi::grammar<Ite
         destination_with_options, source_with_options, t_u, t_h, u_h, t_u_h;
     qi::rule<Iterator, std::string()> service, zoom, output, string, jsonp, checksum, location,
         destination, source, hint, timestamp, bearing, stringwithDot, stringwithPercent, language,
-        geometry, cmp, alt_route, u, uturns, old_API, num_results, matching_beta, gps_precision,
-        classify, locs, instruction, stringforPolyline;
+        geometry, cmp, polyline_precision, alt_route, u, uturns, old_API, num_results,
+        matching_beta, gps_precision, classify, locs, instruction, stringforPolyline, debug_stats,
+        max_duration;
 
     HandlerT *handler;
 };
@@ -5,12 +5,14 @@
 #include "server/http/reply.hpp"
 #include "server/http/request.hpp"
 #include "server/request_parser.hpp"
+#include "server/worker_pool.hpp"
 
 #include <boost/array.hpp>
 #include <boost/asio.hpp>
 #include <boost/config.hpp>
 #include <boost/version.hpp>
 
+#include <atomic>
 #include <memory>
 #include <vector>
 
@@ -37,7 +39,9 @@ class RequestHandler;
 class Connection : public std::enable_shared_from_this<Connection>
 {
   public:
-    explicit Connection(boost::asio::io_service &io_service, RequestHandler &handler);
+    explicit Connection(boost::asio::io_service &io_service,
+                        RequestHandler &handler,
+                        WorkerPool &worker_pool);
     Connection(const Connection &) = delete;
     Connection &operator=(const Connection &) = delete;
 
@@ -49,15 +53,28 @@ class Connection : public std::enable_shared_from_this<Connection>
   private:
     void handle_read(const boost::system::error_code &e, std::size_t bytes_transferred);
 
+    /// Answers the parsed request, runs on a thread of the worker pool.
+    void handle_request(http::compression_type compression_type);
+
+    /// Sends the finished reply, runs on the io threads again.
+    void write_reply();
+
+    /// Reads on while the query runs, the socket only errors out if the client went away.
+    void watch_client();
+    void handle_watch(const boost::system::error_code &e);
+
     /// Handle completion of a write operation.
     void handle_write(const boost::system::error_code &e);
 
-    std::vector<char> compress_buffers(const std::vector<char> &uncompressed_data,
-                                       const http::compression_type compression_type);
+    // returns false if the reply could not be compressed and has to be sent as is
+    bool compress_buffers(const std::vector<char> &uncompressed_data,
+                          const http::compression_type compression_type,
+                          std::vector<char> &compressed_data);
 
     boost::asio::io_service::strand strand;
     boost::asio::ip::tcp::socket TCP_socket;
     RequestHandler &request_handler;
+    WorkerPool &worker_pool;
     RequestParser request_parser;
     boost::array<char, 8192> incoming_data_buffer;
     http::request current_request;
@@ -65,6 +82,8 @@ class Connection : public std::enable_shared_from_this<Connection>
     std::vector<char> compressed_output;
     // Header compression_header;
     std::vector<boost::asio::const_buffer> output_buffer;
+    // set on the io threads once the client is gone, read by the query through its budget
+    std::atomic<bool> cancelled;
 };
 }
 }
@@ -21,7 +21,9 @@ class reply
     {
         ok = 200,
         bad_request = 400,
-        internal_server_error = 500
+        internal_server_error = 500,
+        service_unavailable = 503,
+        gateway_timeout = 504
     } status;
 
     std::vector<header> headers;
@@ -1,7 +1,11 @@
 #ifndef REQUEST_HANDLER_HPP
 #define REQUEST_HANDLER_HPP
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <unordered_map>
 
 namespace osrm
 {
@@ -31,11 +35,46 @@ class RequestHandler
     RequestHandler &operator=(const RequestHandler &) = delete;
 
     void handle_request(const http::request &current_request, http::reply &current_reply);
-    void RegisterRoutingMachine(OSRM *osrm);
+    // Service the uri asks for, e.g. "table" for "/car/table?loc=...". The worker pool keys its
+    // queues by it, so it is read off the decoded uri without the dataset prefix just like the
+    // request is answered.
+    std::string GetService(const std::string &uri) const;
+    // Requests for /<dataset>/<service>?... go to the routing machine registered under that
+    // name, all other requests to the one registered without a name. Datasets are registered
+    // before the server runs. resident_bytes is reported in the metrics.
+    void RegisterRoutingMachine(OSRM *osrm,
+                                const std::string &dataset = "",
+                                const std::uint64_t resident_bytes = 0);
 
   private:
-    OSRM *routing_machine;
+    struct Dataset
+    {
+        Dataset(OSRM *routing_machine, const std::uint64_t resident_bytes)
+            : routing_machine(routing_machine), resident_bytes(resident_bytes), requests(0),
+              query_nanoseconds(0)
+        {
+        }
+
+        OSRM *routing_machine;
+        std::uint64_t resident_bytes;
+        std::atomic<std::uint64_t> requests;
+        std::atomic<std::uint64_t> query_nanoseconds;
+    };
+
+    // Strips the dataset prefix off the request, nullptr if no dataset serves it
+    Dataset *SelectDataset(std::string &request_string) const;
+    // Runs the query and accounts it to the dataset
+    template <typename ResultT>
+    int RunQuery(Dataset &dataset,
+                 const engine::RouteParameters &route_parameters,
+                 ResultT &result) const;
+    std::string RenderDatasetMetrics() const;
+
+    std::unordered_map<std::string, std::unique_ptr<Dataset>> datasets;
 };
+
+// Parses a dataset given as "name=base.osrm", the name must not contain any of "/?&="
+bool ParseDataset(const std::string &input, std::string &name, std::string &base_path);
 }
 }
 
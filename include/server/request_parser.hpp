@@ -5,6 +5,7 @@
 #include "server/http/header.hpp"
 #include "util/tribool.hpp"
 
+#include <string>
 #include <tuple>
 
 namespace osrm
@@ -36,6 +37,8 @@ class RequestParser
 
     bool is_digit(const int character) const;
 
+    http::compression_type select_compression(const std::string &accept_encoding) const;
+
     enum class internal_state : unsigned char
     {
         method_start,
@@ -3,8 +3,11 @@
 
 #include "server/connection.hpp"
 #include "server/request_handler.hpp"
+#include "server/thread_affinity.hpp"
+#include "server/worker_pool.hpp"
 
 #include "util/integer_range.hpp"
+#include "util/osrm_exception.hpp"
 #include "util/simple_logger.hpp"
 
 #include <boost/asio.hpp>
@@ -12,9 +15,11 @@
 
 #include <zlib.h>
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 #include <string>
 
@@ -28,41 +33,103 @@ class Server
   public:
     // Note: returns a shared instead of a unique ptr as it is captured in a lambda somewhere else
     static std::shared_ptr<Server>
-    CreateServer(std::string &ip_address, int ip_port, unsigned requested_num_threads)
+    CreateServer(std::string &ip_address,
+                 int ip_port,
+                 unsigned requested_num_io_threads,
+                 unsigned requested_num_threads,
+                 const std::unordered_map<std::string, ServiceLimit> &requested_service_limits,
+                 const bool reuse_port,
+                 const bool pin_threads)
     {
         util::SimpleLogger().Write() << "http 1.1 compression handled by zlib version "
                                      << zlibVersion();
         const unsigned hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+        const unsigned real_num_io_threads = std::min(hardware_threads, requested_num_io_threads);
         const unsigned real_num_threads = std::min(hardware_threads, requested_num_threads);
-        return std::make_shared<Server>(ip_address, ip_port, real_num_threads);
+
+        // Every routing service waits in a queue of its own, a burst of one of them cannot fill
+        // the queue of another. Tables, matchings and trips take far longer than routes, by
+        // default they may only occupy half of the workers so the short queries always find a
+        // free one.
+        const ServiceLimit default_limit{real_num_threads, DEFAULT_SERVICE_QUEUE_DEPTH};
+        const ServiceLimit heavy_limit{std::max(1u, real_num_threads / 2),
+                                       DEFAULT_SERVICE_QUEUE_DEPTH};
+        std::unordered_map<std::string, ServiceLimit> service_limits = {
+            {"nearest", default_limit}, {"viaroute", default_limit}, {"table", heavy_limit},
+            {"match", heavy_limit},     {"trip", heavy_limit}};
+        for (const auto &service_limit : requested_service_limits)
+        {
+            service_limits[service_limit.first] = service_limit.second;
+        }
+
+        return std::make_shared<Server>(ip_address, ip_port, real_num_io_threads,
+                                        real_num_threads, default_limit, service_limits,
+                                        reuse_port, pin_threads);
     }
 
-    explicit Server(const std::string &address, const int port, const unsigned thread_pool_size)
-        : thread_pool_size(thread_pool_size), acceptor(io_service),
-          new_connection(std::make_shared<Connection>(io_service, request_handler))
+    // With reuse_port every io thread gets an io_service and an acceptor of its own, bound to the
+    // same port with SO_REUSEPORT. The kernel then spreads the connections over the threads and
+    // they never contend on a shared reactor. Otherwise all io threads run one io_service.
+    explicit Server(const std::string &address,
+                    const int port,
+                    const unsigned io_thread_pool_size,
+                    const unsigned worker_pool_size,
+                    const ServiceLimit &default_limit,
+                    const std::unordered_map<std::string, ServiceLimit> &service_limits,
+                    const bool reuse_port,
+                    const bool pin_threads)
+        : io_thread_pool_size(io_thread_pool_size), pin_threads(pin_threads),
+          // the workers take the cores after the io threads
+          worker_pool(
+              worker_pool_size, default_limit, service_limits, pin_threads, io_thread_pool_size)
     {
+#ifndef SO_REUSEPORT
+        if (reuse_port)
+        {
+            throw util::exception("SO_REUSEPORT is not supported on this platform");
+        }
+#endif
         const auto port_string = std::to_string(port);
-
-        boost::asio::ip::tcp::resolver resolver(io_service);
-        boost::asio::ip::tcp::resolver::query query(address, port_string);
-        boost::asio::ip::tcp::endpoint endpoint = *resolver.resolve(query);
-
-        acceptor.open(endpoint.protocol());
-        acceptor.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
-        acceptor.bind(endpoint);
-        acceptor.listen();
-        acceptor.async_accept(
-            new_connection->socket(),
-            boost::bind(&Server::HandleAccept, this, boost::asio::placeholders::error));
+        const unsigned number_of_listeners = reuse_port ? io_thread_pool_size : 1;
+        for (unsigned i = 0; i < number_of_listeners; ++i)
+        {
+            listeners.emplace_back(new Listener());
+            auto &listener = *listeners.back();
+
+            boost::asio::ip::tcp::resolver resolver(listener.io_service);
+            boost::asio::ip::tcp::resolver::query query(address, port_string);
+            boost::asio::ip::tcp::endpoint endpoint = *resolver.resolve(query);
+
+            listener.acceptor.open(endpoint.protocol());
+            listener.acceptor.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
+#ifdef SO_REUSEPORT
+            if (reuse_port)
+            {
+                listener.acceptor.set_option(
+                    boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true));
+            }
+#endif
+            listener.acceptor.bind(endpoint);
+            listener.acceptor.listen();
+            Accept(listener);
+        }
     }
 
     void Run()
     {
         std::vector<std::shared_ptr<std::thread>> threads;
-        for (unsigned i = 0; i < thread_pool_size; ++i)
+        for (unsigned i = 0; i < io_thread_pool_size; ++i)
         {
-            std::shared_ptr<std::thread> thread = std::make_shared<std::thread>(
-                boost::bind(&boost::asio::io_service::run, &io_service));
+            auto &io_service = listeners[i % listeners.size()]->io_service;
+            std::shared_ptr<std::thread> thread =
+                std::make_shared<std::thread>([this, i, &io_service]()
+                                              {
+                                                  if (pin_threads)
+                                                  {
+                                                      PinCurrentThread(i);
+                                                  }
+                                                  io_service.run();
+                                              });
             threads.push_back(thread);
         }
         for (auto thread : threads)
@@ -71,28 +138,52 @@ class Server
         }
     }
 
-    void Stop() { io_service.stop(); }
+    void Stop()
+    {
+        for (auto &listener : listeners)
+        {
+            listener->io_service.stop();
+        }
+        worker_pool.Stop();
+    }
 
     RequestHandler &GetRequestHandlerPtr() { return request_handler; }
 
   private:
-    void HandleAccept(const boost::system::error_code &e)
+    struct Listener
+    {
+        Listener() : acceptor(io_service) {}
+
+        boost::asio::io_service io_service;
+        boost::asio::ip::tcp::acceptor acceptor;
+        std::shared_ptr<Connection> new_connection;
+    };
+
+    void Accept(Listener &listener)
+    {
+        listener.new_connection =
+            std::make_shared<Connection>(listener.io_service, request_handler, worker_pool);
+        listener.acceptor.async_accept(listener.new_connection->socket(),
+                                       boost::bind(&Server::HandleAccept, this,
+                                                   boost::ref(listener),
+                                                   boost::asio::placeholders::error));
+    }
+
+    void HandleAccept(Listener &listener, const boost::system::error_code &e)
     {
         if (!e)
         {
-            new_connection->start();
-            new_connection = std::make_shared<Connection>(io_service, request_handler);
-            acceptor.async_accept(
-                new_connection->socket(),
-                boost::bind(&Server::HandleAccept, this, boost::asio::placeholders::error));
+            listener.new_connection->start();
+            Accept(listener);
         }
     }
 
-    unsigned thread_pool_size;
-    boost::asio::io_service io_service;
-    boost::asio::ip::tcp::acceptor acceptor;
-    std::shared_ptr<Connection> new_connection;
+    unsigned io_thread_pool_size;
+    bool pin_threads;
+    std::vector<std::unique_ptr<Listener>> listeners;
     RequestHandler request_handler;
+    // last member: joins the workers before the connections they hold lose their io_service
+    WorkerPool worker_pool;
 };
 }
 }
@@ -0,0 +1,40 @@
+#ifndef THREAD_AFFINITY_HPP
+#define THREAD_AFFINITY_HPP
+
+#include "util/simple_logger.hpp"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <thread>
+
+namespace osrm
+{
+namespace server
+{
+
+// Binds the calling thread to one core, counted modulo the number of cores. Only supported on
+// Linux, elsewhere the scheduler keeps moving the thread around.
+inline void PinCurrentThread(const unsigned core)
+{
+#ifdef __linux__
+    const unsigned hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(core % hardware_threads, &cpu_set);
+    if (0 != pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set))
+    {
+        util::SimpleLogger().Write(logWARNING) << "could not pin thread to core "
+                                               << core % hardware_threads;
+    }
+#else
+    (void)core;
+#endif
+}
+}
+}
+
+#endif // THREAD_AFFINITY_HPP
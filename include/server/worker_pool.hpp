@@ -0,0 +1,80 @@
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace osrm
+{
+namespace server
+{
+
+// queries waiting for a worker per service, unless configured otherwise
+const constexpr unsigned DEFAULT_SERVICE_QUEUE_DEPTH = 256;
+
+// How many queries of one service run at once and how many may wait for a thread
+struct ServiceLimit
+{
+    unsigned max_concurrency;
+    unsigned max_queue_depth;
+};
+
+// Parses a limit given as "service=concurrency[:queue_depth]", keeps the queue depth if omitted
+bool ParseServiceLimit(const std::string &input, std::string &service, ServiceLimit &limit);
+
+// Runs the queries on compute threads of their own, so the threads serving the sockets never
+// wait for a search. Every configured service has its own queue with limits on the running and
+// the waiting queries; all other services share one queue with the default limits. A full queue
+// rejects new queries, a burst of heavy requests cannot hold up the cheap ones.
+class WorkerPool
+{
+  public:
+    using Task = std::function<void()>;
+
+    // With pin_threads the i-th worker is bound to core first_core + i
+    WorkerPool(const unsigned number_of_threads,
+               const ServiceLimit &default_limit,
+               const std::unordered_map<std::string, ServiceLimit> &service_limits,
+               const bool pin_threads = false,
+               const unsigned first_core = 0);
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+    ~WorkerPool();
+
+    // Queues the task, returns false without running it if the queue of the service is full
+    bool Submit(const std::string &service, Task task);
+
+    // Lets the threads finish their current tasks, the queued ones are dropped
+    void Stop();
+
+  private:
+    struct ServiceQueue
+    {
+        ServiceLimit limit;
+        unsigned running;
+        std::deque<Task> tasks;
+    };
+
+    void WorkerLoop(const bool pin_thread, const unsigned core);
+    // queue with a task that may start now, nullptr if there is none
+    ServiceQueue *NextRunnableQueue();
+
+    std::mutex mutex;
+    std::condition_variable task_available;
+    bool stopping;
+    // the last queue is shared by all services without a limit of their own
+    std::vector<ServiceQueue> queues;
+    std::unordered_map<std::string, std::size_t> queue_of_service;
+    std::size_t next_queue;
+    std::vector<std::thread> threads;
+};
+}
+}
+
+#endif // WORKER_POOL_HPP
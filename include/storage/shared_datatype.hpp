@@ -38,6 +38,13 @@ struct SharedDataLayout
         TIMESTAMP,
         FILE_INDEX_PATH,
         CORE_MARKER,
+        SHORTCUT_CHILDREN,
+        SEARCH_FORWARD_OFFSETS,
+        SEARCH_FORWARD_EDGES,
+        SEARCH_BACKWARD_OFFSETS,
+        SEARCH_BACKWARD_EDGES,
+        SWEEP_ORDER,
+        DATA_IDENTITY,
         NUM_BLOCKS
     };
 
@@ -63,17 +70,44 @@ struct SharedDataLayout
         return num_entries[bid] * entry_size[bid];
     }
 
-    inline uint64_t GetSizeOfLayout() const
+    // The blocks written by osrm-prepare live in a region of their own. After a traffic update
+    // only that region is rebuilt, the rest of the data is shared with the previous dataset.
+    static bool IsGraphBlock(BlockID bid)
     {
-        return GetBlockOffset(NUM_BLOCKS) + NUM_BLOCKS * 2 * sizeof(CANARY);
+        switch (bid)
+        {
+        case GRAPH_NODE_LIST:
+        case GRAPH_EDGE_LIST:
+        case HSGR_CHECKSUM:
+        case CORE_MARKER:
+        case SHORTCUT_CHILDREN:
+        case SEARCH_FORWARD_OFFSETS:
+        case SEARCH_FORWARD_EDGES:
+        case SEARCH_BACKWARD_OFFSETS:
+        case SEARCH_BACKWARD_EDGES:
+        case SWEEP_ORDER:
+            return true;
+        default:
+            return false;
+        }
     }
 
+    // Size of the data region
+    inline uint64_t GetSizeOfLayout() const { return GetSizeOfRegion(false); }
+
+    // Size of the graph region
+    inline uint64_t GetSizeOfGraph() const { return GetSizeOfRegion(true); }
+
+    // Offset into the region holding the block
     inline uint64_t GetBlockOffset(BlockID bid) const
     {
         uint64_t result = sizeof(CANARY);
         for (auto i = 0; i < bid; i++)
         {
-            result += GetBlockSize((BlockID)i) + 2 * sizeof(CANARY);
+            if (IsGraphBlock((BlockID)i) == IsGraphBlock(bid))
+            {
+                result += GetBlockSize((BlockID)i) + 2 * sizeof(CANARY);
+            }
         }
         return result;
     }
@@ -107,6 +141,20 @@ struct SharedDataLayout
 
         return ptr;
     }
+
+  private:
+    inline uint64_t GetSizeOfRegion(const bool graph) const
+    {
+        uint64_t result = sizeof(CANARY);
+        for (auto i = 0; i < NUM_BLOCKS; i++)
+        {
+            if (IsGraphBlock((BlockID)i) == graph)
+            {
+                result += GetBlockSize((BlockID)i) + 2 * sizeof(CANARY);
+            }
+        }
+        return result;
+    }
 };
 
 enum SharedDataType
@@ -117,13 +165,17 @@ enum SharedDataType
     LAYOUT_2,
     DATA_2,
     LAYOUT_NONE,
-    DATA_NONE
+    DATA_NONE,
+    GRAPH_1,
+    GRAPH_2,
+    GRAPH_NONE
 };
 
 struct SharedDataTimestamp
 {
     SharedDataType layout;
     SharedDataType data;
+    SharedDataType graph;
     unsigned timestamp;
 };
 }
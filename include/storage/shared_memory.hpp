@@ -15,7 +15,10 @@
 
 #ifdef __linux__
 #include <sys/ipc.h>
+#include <sys/mman.h>
 #include <sys/shm.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #endif
 
 // #include <cstring>
@@ -23,6 +26,9 @@
 
 #include <algorithm>
 #include <exception>
+#include <fstream>
+#include <string>
+#include <vector>
 
 namespace osrm
 {
@@ -39,6 +45,17 @@ struct OSRMLockFile
     }
 };
 
+// Page backing and NUMA placement of newly created regions. Only honoured on Linux, every
+// option falls back to plain pages with a warning if the system cannot provide it.
+struct SharedMemoryOptions
+{
+    // SHM_HUGETLB pages from the reserved pool. If none are reserved, transparent huge pages
+    // where the kernel's shmem_enabled setting allows them for shared memory.
+    bool huge_pages = false;
+    // spreads the pages over all memory nodes so no socket is left with only remote accesses
+    bool interleave = false;
+};
+
 #ifndef WIN32
 class SharedMemory
 {
@@ -86,7 +103,8 @@ class SharedMemory
                  const IdentifierT id,
                  const uint64_t size = 0,
                  bool read_write = false,
-                 bool remove_prev = true)
+                 bool remove_prev = true,
+                 const SharedMemoryOptions &options = SharedMemoryOptions())
         : key(lock_file.string().c_str(), id)
     {
         if (0 == size)
@@ -104,8 +122,20 @@ class SharedMemory
             {
                 Remove(key);
             }
-            shm = boost::interprocess::xsi_shared_memory(boost::interprocess::open_or_create, key,
-                                                         size);
+            bool huge_pages = false;
+#ifdef __linux__
+            // boost cannot pass SHM_HUGETLB, the segment is created here and opened by boost
+            huge_pages = options.huge_pages && CreateHugePageSegment(key, size);
+#endif
+            if (huge_pages)
+            {
+                shm = boost::interprocess::xsi_shared_memory(boost::interprocess::open_only, key);
+            }
+            else
+            {
+                shm = boost::interprocess::xsi_shared_memory(boost::interprocess::open_or_create,
+                                                             key, size);
+            }
 #ifdef __linux__
             if (-1 == shmctl(shm.get_shmid(), SHM_LOCK, nullptr))
             {
@@ -116,6 +146,19 @@ class SharedMemory
             }
 #endif
             region = boost::interprocess::mapped_region(shm, boost::interprocess::read_write);
+#ifdef __linux__
+            // both only affect pages not touched yet, i.e. all of them
+            if (options.huge_pages && !huge_pages)
+            {
+                AdviseTransparentHugePages(region.get_address(), region.get_size());
+            }
+            if (options.interleave)
+            {
+                InterleavePages(region.get_address(), region.get_size());
+            }
+#else
+            (void)options;
+#endif
 
             remover.SetID(shm.get_shmid());
             util::SimpleLogger().Write(logDEBUG) << "writeable memory allocated " << size
@@ -180,6 +223,113 @@ class SharedMemory
         return ret;
     }
 
+#ifdef __linux__
+    static bool CreateHugePageSegment(const boost::interprocess::xsi_key &key, const uint64_t size)
+    {
+        // the size has to be a multiple of the huge page size
+        const uint64_t huge_page_size = 2 * 1024 * 1024;
+        const uint64_t rounded_size = (size + huge_page_size - 1) / huge_page_size * huge_page_size;
+        if (-1 == shmget(key.get_key(), rounded_size, IPC_CREAT | SHM_HUGETLB | 0644))
+        {
+            util::SimpleLogger().Write(logWARNING)
+                << "could not allocate " << rounded_size
+                << " bytes of huge pages, check vm.nr_hugepages. Falling back to normal pages";
+            return false;
+        }
+        util::SimpleLogger().Write() << "shared memory backed by huge pages";
+        return true;
+    }
+
+    // madvise succeeds on shared memory even if the kernel never gives it transparent huge pages,
+    // that is only done if shmem_enabled is not set to never or deny
+    static void AdviseTransparentHugePages(void *address, const std::size_t size)
+    {
+        std::ifstream shmem_enabled("/sys/kernel/mm/transparent_hugepage/shmem_enabled");
+        std::string setting, active_setting;
+        while (shmem_enabled >> setting)
+        {
+            // the active setting is the one in brackets
+            if (setting.size() > 2 && '[' == setting.front() && ']' == setting.back())
+            {
+                active_setting = setting.substr(1, setting.size() - 2);
+            }
+        }
+        if (active_setting != "always" && active_setting != "within_size" &&
+            active_setting != "advise" && active_setting != "force")
+        {
+            util::SimpleLogger().Write(logWARNING)
+                << "transparent huge pages are disabled for shared memory, set "
+                   "/sys/kernel/mm/transparent_hugepage/shmem_enabled to advise. "
+                   "Using normal pages";
+            return;
+        }
+        if (0 != madvise(address, size, MADV_HUGEPAGE))
+        {
+            util::SimpleLogger().Write(logWARNING) << "transparent huge pages not available";
+            return;
+        }
+        util::SimpleLogger().Write() << "shared memory asks for transparent huge pages";
+    }
+
+    // memory nodes from /sys/devices/system/node/online, e.g. "0-1,3"
+    static std::vector<unsigned long> OnlineNodeMask()
+    {
+        const unsigned bits_per_word = 8 * sizeof(unsigned long);
+        std::vector<unsigned long> mask;
+        std::ifstream online_file("/sys/devices/system/node/online");
+        std::string range;
+        while (std::getline(online_file, range, ','))
+        {
+            const auto dash = range.find('-');
+            const unsigned first = std::stoul(range.substr(0, dash));
+            const unsigned last =
+                std::string::npos == dash ? first : std::stoul(range.substr(dash + 1));
+            for (unsigned node = first; node <= last; ++node)
+            {
+                mask.resize(std::max<std::size_t>(mask.size(), node / bits_per_word + 1), 0);
+                mask[node / bits_per_word] |= 1ul << (node % bits_per_word);
+            }
+        }
+        return mask;
+    }
+
+    static void InterleavePages(void *address, const std::size_t size)
+    {
+        // from <numaif.h>, which is only installed with libnuma
+        const int MPOL_INTERLEAVE_MODE = 3;
+
+        std::vector<unsigned long> mask;
+        try
+        {
+            mask = OnlineNodeMask();
+        }
+        catch (const std::exception &)
+        {
+            mask.clear();
+        }
+        unsigned number_of_nodes = 0;
+        for (const auto word : mask)
+        {
+            number_of_nodes += __builtin_popcountl(word);
+        }
+        if (number_of_nodes < 2)
+        {
+            util::SimpleLogger().Write(logDEBUG) << "single memory node, not interleaving";
+            return;
+        }
+        // the kernel ignores the last bit of the mask
+        const unsigned long max_node = mask.size() * 8 * sizeof(unsigned long) + 1;
+        if (0 != syscall(SYS_mbind, address, size, MPOL_INTERLEAVE_MODE, mask.data(), max_node, 0))
+        {
+            util::SimpleLogger().Write(logWARNING) << "could not interleave shared memory over "
+                                                   << number_of_nodes << " memory nodes";
+            return;
+        }
+        util::SimpleLogger().Write() << "shared memory interleaved over " << number_of_nodes
+                                     << " memory nodes";
+    }
+#endif
+
     boost::interprocess::xsi_key key;
     boost::interprocess::xsi_shared_memory shm;
     boost::interprocess::mapped_region region;
@@ -230,7 +380,8 @@ class SharedMemory
                  const int id,
                  const uint64_t size = 0,
                  bool read_write = false,
-                 bool remove_prev = true)
+                 bool remove_prev = true,
+                 const SharedMemoryOptions & = SharedMemoryOptions())
     {
         sprintf(key, "%s.%d", "osrm.lock", id);
         if (0 == size)
@@ -329,7 +480,8 @@ template <typename IdentifierT, typename LockFileT = OSRMLockFile>
 SharedMemory *makeSharedMemory(const IdentifierT &id,
                                const uint64_t size = 0,
                                bool read_write = false,
-                               bool remove_prev = true)
+                               bool remove_prev = true,
+                               const SharedMemoryOptions &options = SharedMemoryOptions())
 {
     try
     {
@@ -345,7 +497,7 @@ SharedMemory *makeSharedMemory(const IdentifierT &id,
                 boost::filesystem::ofstream ofs(lock_file());
             }
         }
-        return new SharedMemory(lock_file(), id, size, read_write, remove_prev);
+        return new SharedMemory(lock_file(), id, size, read_write, remove_prev, options);
     }
     catch (const boost::interprocess::interprocess_exception &e)
     {
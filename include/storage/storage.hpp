@@ -1,6 +1,8 @@
 #ifndef STORAGE_HPP
 #define STORAGE_HPP
 
+#include "storage/shared_memory.hpp"
+
 #include <boost/filesystem/path.hpp>
 
 #include <unordered_map>
@@ -14,10 +16,20 @@ using DataPaths = std::unordered_map<std::string, boost::filesystem::path>;
 class Storage
 {
 public:
-    Storage(const DataPaths& data_paths);
+    // graph_only replaces the data written by osrm-prepare and keeps the rest of the loaded
+    // dataset, e.g. after the weights were updated with a new --segment-speed-file.
+    // search_graph adds the per-direction lists of util::SearchGraph to the graph.
+    Storage(const DataPaths &data_paths,
+            const SharedMemoryOptions &memory_options = SharedMemoryOptions(),
+            const bool graph_only = false,
+            const bool search_graph = false);
     int Run();
 private:
     DataPaths paths;
+    // applies to the data and graph regions, the layout region is too small to matter
+    SharedMemoryOptions memory_options;
+    bool graph_only;
+    bool search_graph;
 };
 }
 }
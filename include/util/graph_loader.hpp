@@ -147,10 +147,11 @@ NodeID loadEdgesFromFile(std::istream &input_stream,
     return m;
 }
 
-template <typename NodeT, typename EdgeT>
+template <typename NodeT, typename EdgeT, typename ShortcutChildrenT>
 unsigned readHSGRFromStream(const boost::filesystem::path &hsgr_file,
                             std::vector<NodeT> &node_list,
                             std::vector<EdgeT> &edge_list,
+                            std::vector<ShortcutChildrenT> &shortcut_children_list,
                             unsigned *check_sum)
 {
     if (!boost::filesystem::exists(hsgr_file))
@@ -194,6 +195,22 @@ unsigned readHSGRFromStream(const boost::filesystem::path &hsgr_file,
         hsgr_input_stream.read(reinterpret_cast<char *>(&edge_list[0]),
                                number_of_edges * sizeof(EdgeT));
     }
+
+    // graphs prepared before shortcut children were stored end here
+    unsigned number_of_shortcut_children = 0;
+    if (!hsgr_input_stream.read(reinterpret_cast<char *>(&number_of_shortcut_children),
+                                sizeof(unsigned)))
+    {
+        number_of_shortcut_children = 0;
+    }
+    BOOST_ASSERT(0 == number_of_shortcut_children ||
+                 number_of_edges == number_of_shortcut_children);
+    shortcut_children_list.resize(number_of_shortcut_children);
+    if (number_of_shortcut_children > 0)
+    {
+        hsgr_input_stream.read(reinterpret_cast<char *>(&shortcut_children_list[0]),
+                               number_of_shortcut_children * sizeof(ShortcutChildrenT));
+    }
     hsgr_input_stream.close();
 
     return number_of_nodes;
@@ -79,8 +79,16 @@ struct ArrayRenderer : mapbox::util::static_visitor<>
     void operator()(const String &string) const
     {
         out.push_back('\"');
-        const auto string_to_insert = escape_JSON(string.value);
-        out.insert(std::end(out), std::begin(string_to_insert), std::end(string_to_insert));
+        // most strings, e.g. encoded geometries, need no escaping and are copied in one go
+        if (requires_JSON_escaping(string.value))
+        {
+            const auto string_to_insert = escape_JSON(string.value);
+            out.insert(std::end(out), std::begin(string_to_insert), std::end(string_to_insert));
+        }
+        else
+        {
+            out.insert(std::end(out), std::begin(string.value), std::end(string.value));
+        }
         out.push_back('\"');
     }
 
@@ -147,14 +155,14 @@ struct ArrayRenderer : mapbox::util::static_visitor<>
 
 inline void render(std::ostream &out, const Object &object)
 {
-    Value value = object;
-    mapbox::util::apply_visitor(Renderer(out), value);
+    const Renderer renderer(out);
+    renderer(object);
 }
 
 inline void render(std::vector<char> &out, const Object &object)
 {
-    Value value = object;
-    mapbox::util::apply_visitor(ArrayRenderer(out), value);
+    const ArrayRenderer renderer(out);
+    renderer(object);
 }
 
 } // namespace json
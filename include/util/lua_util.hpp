@@ -12,6 +12,7 @@ extern "C" {
 
 #include <iostream>
 #include <string>
+#include <vector>
 
 namespace osrm
 {
@@ -28,6 +29,21 @@ inline bool lua_function_exists(lua_State *lua_state, const char *name)
     return lua_function && (luabind::type(lua_function) == LUA_TFUNCTION);
 }
 
+// Returns the strings of the global table <name>, empty if the table is not defined
+inline std::vector<std::string> lua_string_list(lua_State *lua_state, const char *name)
+{
+    std::vector<std::string> strings;
+    luabind::object table = luabind::globals(lua_state)[name];
+    if (table && (luabind::type(table) == LUA_TTABLE))
+    {
+        for (luabind::iterator iter(table), end; iter != end; ++iter)
+        {
+            strings.push_back(luabind::object_cast<std::string>(*iter));
+        }
+    }
+    return strings;
+}
+
 // Add the folder contain the script to the lua load path, so script can easily require() other lua
 // scripts inside that folder, or subfolders.
 // See http://lua-users.org/wiki/PackagePath for details on the package.path syntax.
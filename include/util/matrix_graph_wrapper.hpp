@@ -12,8 +12,8 @@ namespace osrm
 namespace util
 {
 
-// This Wrapper provides all methods that are needed for extractor::TarjanSCC, when the graph is
-// given in a
+// This Wrapper provides all methods that are needed for extractor::TarjanSCC and
+// extractor::ParallelSCC, when the graph is given in a
 // matrix representation (e.g. as output from a distance table call)
 
 template <typename T> class MatrixGraphWrapper
@@ -0,0 +1,152 @@
+#ifndef PACKED_GEOMETRY_HPP
+#define PACKED_GEOMETRY_HPP
+
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+/**
+ * Compressed edge geometries are stored as byte strings: every node id is the zigzag encoded
+ * difference to its predecessor (zero for the first node) written as a little endian base 128
+ * varint. Nodes of a geometry are mostly numbered close to each other, so most entries take one
+ * or two bytes instead of four.
+ *
+ * A geometry is delimited by the byte offsets of its begin and end, so the nodes can be decoded
+ * on the fly without knowing their number.
+ */
+inline void AppendPackedGeometryNode(const NodeID previous_node,
+                                     const NodeID node,
+                                     std::vector<unsigned char> &packed_geometry)
+{
+    const auto delta = static_cast<std::int32_t>(node - previous_node);
+    auto zigzag =
+        (static_cast<std::uint32_t>(delta) << 1) ^ static_cast<std::uint32_t>(delta >> 31);
+    while (zigzag >= 0x80)
+    {
+        packed_geometry.push_back(static_cast<unsigned char>(zigzag | 0x80));
+        zigzag >>= 7;
+    }
+    packed_geometry.push_back(static_cast<unsigned char>(zigzag));
+}
+
+// Decodes the nodes of a packed geometry while iterating, never allocates
+class PackedGeometryIterator
+    : public boost::iterator_facade<PackedGeometryIterator,
+                                    NodeID,
+                                    std::forward_iterator_tag,
+                                    NodeID>
+{
+  public:
+    PackedGeometryIterator() : position(nullptr), next_position(nullptr), last(nullptr), node(0)
+    {
+    }
+
+    PackedGeometryIterator(const unsigned char *position, const unsigned char *last)
+        : position(position), next_position(position), last(last), node(0)
+    {
+        if (position != last)
+        {
+            Decode();
+        }
+    }
+
+  private:
+    friend class boost::iterator_core_access;
+
+    void Decode()
+    {
+        std::uint32_t zigzag = 0;
+        unsigned shift = 0;
+        unsigned char byte;
+        do
+        {
+            BOOST_ASSERT(next_position != last);
+            BOOST_ASSERT(shift < 32);
+            byte = *next_position++;
+            zigzag |= static_cast<std::uint32_t>(byte & 0x7f) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        node += (zigzag >> 1) ^ (0u - (zigzag & 1));
+    }
+
+    void increment()
+    {
+        BOOST_ASSERT(position != last);
+        position = next_position;
+        if (position != last)
+        {
+            Decode();
+        }
+    }
+
+    bool equal(const PackedGeometryIterator &other) const { return position == other.position; }
+
+    NodeID dereference() const
+    {
+        BOOST_ASSERT(position != last);
+        return node;
+    }
+
+    // first byte of the current node and of the node after it
+    const unsigned char *position;
+    const unsigned char *next_position;
+    const unsigned char *last;
+    NodeID node;
+};
+
+// The nodes of one compressed edge, pointing into the geometry block of a data facade
+class PackedGeometryView
+{
+  public:
+    using const_iterator = PackedGeometryIterator;
+
+    PackedGeometryView() : first(nullptr), last(nullptr) {}
+    PackedGeometryView(const unsigned char *first, const unsigned char *last)
+        : first(first), last(last)
+    {
+        BOOST_ASSERT(first <= last);
+        BOOST_ASSERT(first == last || (*(last - 1) & 0x80) == 0);
+    }
+
+    const_iterator begin() const { return const_iterator(first, last); }
+    const_iterator end() const { return const_iterator(last, last); }
+
+    bool empty() const { return first == last; }
+
+    // every node ends with a byte that has no continuation bit
+    std::size_t size() const
+    {
+        std::size_t number_of_nodes = 0;
+        for (auto byte = first; byte != last; ++byte)
+        {
+            number_of_nodes += (*byte & 0x80) == 0;
+        }
+        return number_of_nodes;
+    }
+
+    // decodes into a buffer owned by the caller, which only allocates if it has to grow
+    void DecodeInto(std::vector<NodeID> &nodes) const
+    {
+        nodes.clear();
+        nodes.insert(nodes.end(), begin(), end());
+    }
+
+  private:
+    const unsigned char *first;
+    const unsigned char *last;
+};
+}
+}
+
+#endif // PACKED_GEOMETRY_HPP
@@ -12,6 +12,7 @@
 #include <unordered_map>
 #include <fstream>
 #include <string>
+#include <vector>
 
 namespace osrm
 {
@@ -39,6 +40,8 @@ populate_base_path(std::unordered_map<std::string, boost::filesystem::path> &ser
         BOOST_ASSERT(server_paths.find("nodesdata") != server_paths.end());
         server_paths["coredata"] = base_string + ".core";
         BOOST_ASSERT(server_paths.find("coredata") != server_paths.end());
+        server_paths["levelsdata"] = base_string + ".level";
+        BOOST_ASSERT(server_paths.find("levelsdata") != server_paths.end());
         server_paths["edgesdata"] = base_string + ".edges";
         BOOST_ASSERT(server_paths.find("edgesdata") != server_paths.end());
         server_paths["geometries"] = base_string + ".geometry";
@@ -121,12 +124,22 @@ GenerateServerProgramOptions(const int argc,
                              std::string &ip_address,
                              int &ip_port,
                              int &requested_num_threads,
+                             int &requested_num_io_threads,
+                             std::vector<std::string> &service_limits,
+                             std::vector<std::string> &datasets,
+                             bool &reuse_port,
+                             bool &pin_threads,
                              bool &use_shared_memory,
+                             bool &use_search_graph,
                              bool &trial,
                              int &max_locations_trip,
                              int &max_locations_viaroute,
                              int &max_locations_distance_table,
-                             int &max_locations_map_matching)
+                             int &max_locations_map_matching,
+                             int &min_rphast_table_size,
+                             int &max_result_cache_size,
+                             int &max_query_duration,
+                             int &max_settled_nodes)
 {
     using boost::program_options::value;
     using boost::filesystem::path;
@@ -159,10 +172,24 @@ GenerateServerProgramOptions(const int argc,
         ("port,p", value<int>(&ip_port)->default_value(5000),
          "TCP/IP port") //
         ("threads,t", value<int>(&requested_num_threads)->default_value(8),
-         "Number of threads to use") //
+         "Number of threads answering queries") //
+        ("io-threads", value<int>(&requested_num_io_threads)->default_value(2),
+         "Number of threads serving the connections") //
+        ("service-limit", value<std::vector<std::string>>(&service_limits)->composing(),
+         "Limit of a service as <service>=<concurrency>[:<queue depth>], may be repeated") //
+        ("dataset", value<std::vector<std::string>>(&datasets)->composing(),
+         "Dataset as <name>=<base.osrm>, queried as /<name>/<service>?..., may be repeated") //
+        ("reuse-port", value<bool>(&reuse_port)->implicit_value(true)->default_value(false),
+         "Give every io thread its own SO_REUSEPORT socket") //
+        ("pin-threads", value<bool>(&pin_threads)->implicit_value(true)->default_value(false),
+         "Bind every io and query thread to its own core") //
         ("shared-memory,s",
          value<bool>(&use_shared_memory)->implicit_value(true)->default_value(false),
          "Load data from shared memory") //
+        ("search-graph",
+         value<bool>(&use_search_graph)->implicit_value(true)->default_value(false),
+         "Keep per-direction search lists, 8 more bytes per edge and direction for faster "
+         "searches. With shared memory this is up to osrm-datastore --search-graph") //
         ("max-viaroute-size", value<int>(&max_locations_viaroute)->default_value(500),
          "Max. locations supported in viaroute query") //
         ("max-trip-size", value<int>(&max_locations_trip)->default_value(100),
@@ -170,7 +197,15 @@ GenerateServerProgramOptions(const int argc,
         ("max-table-size", value<int>(&max_locations_distance_table)->default_value(100),
          "Max. locations supported in distance table query") //
         ("max-matching-size", value<int>(&max_locations_map_matching)->default_value(100),
-         "Max. locations supported in map matching query");
+         "Max. locations supported in map matching query") //
+        ("min-rphast-table-size", value<int>(&min_rphast_table_size)->default_value(500 * 500),
+         "Sources times destinations from which tables run RPHAST, needs the .level file") //
+        ("result-cache-size", value<int>(&max_result_cache_size)->default_value(0),
+         "Memory in MiB for caching route and table results, 0 disables the cache") //
+        ("max-query-time", value<int>(&max_query_duration)->default_value(0),
+         "Abort queries running longer than this many milliseconds, 0 for no limit") //
+        ("max-settled-nodes", value<int>(&max_settled_nodes)->default_value(0),
+         "Abort queries settling more nodes than this, 0 for no limit");
 
     // hidden options, will be allowed both on command line and in config
     // file, but will not be shown to the user
@@ -233,6 +268,10 @@ GenerateServerProgramOptions(const int argc,
     {
         throw exception("Number of threads must be a positive number");
     }
+    if (1 > requested_num_io_threads)
+    {
+        throw exception("Number of io threads must be a positive number");
+    }
     if (2 > max_locations_distance_table)
     {
         throw exception("Max location for distance table must be at least two");
@@ -241,6 +280,18 @@ GenerateServerProgramOptions(const int argc,
     {
         throw exception("Max location for map matching must be at least two");
     }
+    if (0 > min_rphast_table_size)
+    {
+        throw exception("Min. RPHAST table size must not be negative");
+    }
+    if (0 > max_result_cache_size)
+    {
+        throw exception("Result cache size must not be negative");
+    }
+    if (0 > max_query_duration || 0 > max_settled_nodes)
+    {
+        throw exception("Query limits must not be negative");
+    }
 
     if (!use_shared_memory && option_variables.count("base"))
     {
@@ -250,6 +301,11 @@ GenerateServerProgramOptions(const int argc,
     {
         return INIT_OK_START_ENGINE;
     }
+    else if (!use_shared_memory && !datasets.empty())
+    {
+        // only named datasets, requests without a dataset are rejected
+        return INIT_OK_START_ENGINE;
+    }
     else if (use_shared_memory && option_variables.count("base"))
     {
         SimpleLogger().Write(logWARNING) << "Shared memory settings conflict with path settings.";
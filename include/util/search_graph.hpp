@@ -0,0 +1,211 @@
+#ifndef SEARCH_GRAPH_HPP
+#define SEARCH_GRAPH_HPP
+
+#include "util/integer_range.hpp"
+#include "util/shared_memory_vector_wrapper.hpp"
+#include "util/static_graph.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/range/iterator_range.hpp>
+
+#include <cstddef>
+
+namespace osrm
+{
+namespace util
+{
+
+// An edge as it is relaxed by a search on the query graph
+struct SearchEdge
+{
+    NodeID target;
+    EdgeWeight weight;
+};
+
+// Walks the edges a search relaxes at a node, either over the lists of a SearchGraph or over the
+// node's edges in the StaticGraph, skipping those of the other direction.
+template <typename EdgeDataT>
+class SearchEdgeIterator : public boost::iterator_facade<SearchEdgeIterator<EdgeDataT>,
+                                                         SearchEdge,
+                                                         boost::forward_traversal_tag,
+                                                         SearchEdge>
+{
+  public:
+    using GraphEdge = StaticGraphEdge<EdgeDataT>;
+
+    SearchEdgeIterator() = default;
+
+    explicit SearchEdgeIterator(const SearchEdge *search_edge) : search_edge(search_edge) {}
+
+    SearchEdgeIterator(const GraphEdge *graph_edge,
+                       const GraphEdge *graph_end,
+                       const bool forward_direction)
+        : graph_edge(graph_edge), graph_end(graph_end), forward_direction(forward_direction)
+    {
+        SkipOtherDirection();
+    }
+
+  private:
+    friend class boost::iterator_core_access;
+
+    void increment()
+    {
+        if (search_edge)
+        {
+            ++search_edge;
+        }
+        else
+        {
+            ++graph_edge;
+            SkipOtherDirection();
+        }
+    }
+
+    bool equal(const SearchEdgeIterator &other) const
+    {
+        return search_edge == other.search_edge && graph_edge == other.graph_edge;
+    }
+
+    SearchEdge dereference() const
+    {
+        if (search_edge)
+        {
+            return *search_edge;
+        }
+        return {graph_edge->target, graph_edge->data.distance};
+    }
+
+    void SkipOtherDirection()
+    {
+        while (graph_edge != graph_end &&
+               !(forward_direction ? graph_edge->data.forward : graph_edge->data.backward))
+        {
+            ++graph_edge;
+        }
+    }
+
+    const SearchEdge *search_edge = nullptr;
+    const GraphEdge *graph_edge = nullptr;
+    const GraphEdge *graph_end = nullptr;
+    bool forward_direction = true;
+};
+
+template <typename EdgeDataT>
+using SearchEdgeRange = boost::iterator_range<SearchEdgeIterator<EdgeDataT>>;
+
+// The query graph as the searches see it. Every node has one list of the edges usable in forward
+// and one of the edges usable in backward direction, each edge only holding its target and
+// weight. Middle nodes and shortcut flags stay in the StaticGraph and are read for unpacking.
+//
+// The lists store every edge a second time, 8 bytes per direction it can be used in. They are
+// only built on request; an empty SearchGraph hands out the edges of the StaticGraph instead.
+template <bool UseSharedMemory = false> class SearchGraph
+{
+  public:
+    using OffsetVector = typename ShM<unsigned, UseSharedMemory>::vector;
+    using EdgeVector = typename ShM<SearchEdge, UseSharedMemory>::vector;
+
+    SearchGraph() = default;
+
+    SearchGraph(OffsetVector &forward_offsets,
+                EdgeVector &forward_edges,
+                OffsetVector &backward_offsets,
+                EdgeVector &backward_edges)
+    {
+        BOOST_ASSERT(forward_offsets.size() == backward_offsets.size());
+        m_forward_offsets.swap(forward_offsets);
+        m_forward_edges.swap(forward_edges);
+        m_backward_offsets.swap(backward_offsets);
+        m_backward_edges.swap(backward_edges);
+    }
+
+    // Counts the edges usable in each direction in the edge array of a query graph
+    template <typename EdgeArrayEntryT>
+    static void CountEdges(const EdgeArrayEntryT *edges,
+                           const std::size_t number_of_edges,
+                           std::size_t &number_of_forward_edges,
+                           std::size_t &number_of_backward_edges)
+    {
+        for (const auto edge : irange<std::size_t>(0, number_of_edges))
+        {
+            number_of_forward_edges += edges[edge].data.forward;
+            number_of_backward_edges += edges[edge].data.backward;
+        }
+    }
+
+    // Fills arrays sized by CountEdges from the node and edge array of a query graph. The offsets
+    // have an entry per node of the node array, including its sentinel.
+    template <typename NodeArrayEntryT, typename EdgeArrayEntryT>
+    static void Build(const NodeArrayEntryT *nodes,
+                      const std::size_t number_of_nodes,
+                      const EdgeArrayEntryT *edges,
+                      unsigned *forward_offsets,
+                      SearchEdge *forward_edges,
+                      unsigned *backward_offsets,
+                      SearchEdge *backward_edges)
+    {
+        BOOST_ASSERT(number_of_nodes > 0);
+        unsigned forward_position = 0;
+        unsigned backward_position = 0;
+        for (const auto node : irange<std::size_t>(0, number_of_nodes - 1))
+        {
+            forward_offsets[node] = forward_position;
+            backward_offsets[node] = backward_position;
+            for (const auto edge : irange(nodes[node].first_edge, nodes[node + 1].first_edge))
+            {
+                const auto &data = edges[edge].data;
+                if (data.forward)
+                {
+                    forward_edges[forward_position++] = {edges[edge].target, data.distance};
+                }
+                if (data.backward)
+                {
+                    backward_edges[backward_position++] = {edges[edge].target, data.distance};
+                }
+            }
+        }
+        forward_offsets[number_of_nodes - 1] = forward_position;
+        backward_offsets[number_of_nodes - 1] = backward_position;
+    }
+
+    // true if the lists were not built
+    bool Empty() const { return m_forward_offsets.empty(); }
+
+    // edges a search in the given direction relaxes at the node of the graph the lists were
+    // built from
+    template <typename GraphT>
+    SearchEdgeRange<typename GraphT::EdgeData>
+    GetEdges(const GraphT &graph, const NodeID node, const bool forward_direction) const
+    {
+        using Iterator = SearchEdgeIterator<typename GraphT::EdgeData>;
+        if (Empty())
+        {
+            const auto graph_edges = graph.GetAdjacentEdges(node);
+            return {Iterator(graph_edges.begin(), graph_edges.end(), forward_direction),
+                    Iterator(graph_edges.end(), graph_edges.end(), forward_direction)};
+        }
+
+        const auto &offsets = forward_direction ? m_forward_offsets : m_backward_offsets;
+        const auto &edges = forward_direction ? m_forward_edges : m_backward_edges;
+        const unsigned begin = offsets[node];
+        const unsigned end = offsets[node + 1];
+        if (begin == end)
+        {
+            return {};
+        }
+        const SearchEdge *first = &edges[begin];
+        return {Iterator(first), Iterator(first + (end - begin))};
+    }
+
+  private:
+    OffsetVector m_forward_offsets;
+    EdgeVector m_forward_edges;
+    OffsetVector m_backward_offsets;
+    EdgeVector m_backward_edges;
+};
+}
+}
+
+#endif // SEARCH_GRAPH_HPP
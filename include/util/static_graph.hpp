@@ -7,6 +7,7 @@
 #include "util/typedefs.hpp"
 
 #include <boost/assert.hpp>
+#include <boost/range/iterator_range.hpp>
 
 #include <algorithm>
 #include <limits>
@@ -18,6 +19,13 @@ namespace osrm
 namespace util
 {
 
+// An edge as the StaticGraph stores it, the same in and outside of shared memory
+template <typename EdgeDataT> struct StaticGraphEdge
+{
+    NodeID target;
+    EdgeDataT data;
+};
+
 template <typename EdgeDataT, bool UseSharedMemory = false> class StaticGraph
 {
   public:
@@ -54,11 +62,7 @@ template <typename EdgeDataT, bool UseSharedMemory = false> class StaticGraph
         EdgeIterator first_edge;
     };
 
-    struct EdgeArrayEntry
-    {
-        NodeID target;
-        EdgeDataT data;
-    };
+    using EdgeArrayEntry = StaticGraphEdge<EdgeDataT>;
 
     EdgeRange GetAdjacentEdgeRange(const NodeID node) const
     {
@@ -134,6 +138,19 @@ template <typename EdgeDataT, bool UseSharedMemory = false> class StaticGraph
         return EdgeIterator(node_array.at(n + 1).first_edge);
     }
 
+    // the entries of the edge array that belong to the node
+    boost::iterator_range<const EdgeArrayEntry *> GetAdjacentEdges(const NodeIterator n) const
+    {
+        const EdgeIterator begin = BeginEdges(n);
+        const EdgeIterator end = EndEdges(n);
+        if (begin == end)
+        {
+            return {};
+        }
+        const EdgeArrayEntry *first = &edge_array[begin];
+        return {first, first + (end - begin)};
+    }
+
     // searches for a specific edge
     EdgeIterator FindEdge(const NodeIterator from, const NodeIterator to) const
     {
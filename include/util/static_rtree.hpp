@@ -37,6 +37,11 @@ namespace util
 {
 
 // Static RTree for serving nearest neighbour queries
+//
+// The leaf file starts with the element count, followed by the leaves and then the elements in
+// leaf order. Leaves only hold the coordinate indices of the segments. The full element is read
+// from the second part when a segment is popped from the query queue, i.e. only for results and
+// segments that are filtered out.
 template <class EdgeDataT,
           class CoordinateListT = std::vector<FixedPointCoordinate>,
           bool UseSharedMemory = false,
@@ -50,6 +55,8 @@ class StaticRTree
     using CoordinateList = CoordinateListT;
 
     static constexpr std::size_t MAX_CHECKED_ELEMENTS = 4 * LEAF_NODE_SIZE;
+    // number of leaves that are packed in parallel and written at once
+    static constexpr uint64_t LEAF_BATCH_SIZE = 64;
 
     struct TreeNode
     {
@@ -79,14 +86,29 @@ class StaticRTree
         }
     };
 
+    // spatial part of an element, indices into the coordinate list
+    struct LeafObject
+    {
+        LeafObject() : u(SPECIAL_NODEID), v(SPECIAL_NODEID) {}
+        LeafObject(const NodeID u, const NodeID v) : u(u), v(v) {}
+        NodeID u;
+        NodeID v;
+    };
+
     struct LeafNode
     {
         LeafNode() : object_count(0), objects() {}
         uint32_t object_count;
-        std::array<EdgeDataT, LEAF_NODE_SIZE> objects;
+        std::array<LeafObject, LEAF_NODE_SIZE> objects;
+    };
+
+    // a segment of a leaf, its element is stored at data_index
+    struct SegmentCandidate
+    {
+        uint64_t data_index;
     };
 
-    using QueryNodeType = mapbox::util::variant<TreeNode, EdgeDataT>;
+    using QueryNodeType = mapbox::util::variant<TreeNode, SegmentCandidate>;
     struct QueryCandidate
     {
         inline bool operator<(const QueryCandidate &other) const
@@ -101,6 +123,8 @@ class StaticRTree
 
     typename ShM<TreeNode, UseSharedMemory>::vector m_search_tree;
     uint64_t m_element_count;
+    // byte offset of the elements in the leaf file
+    uint64_t m_data_offset;
     const std::string m_leaf_node_filename;
     std::shared_ptr<CoordinateListT> m_coordinate_list;
     boost::filesystem::ifstream leaves_stream;
@@ -115,7 +139,8 @@ class StaticRTree
                          const std::string &tree_node_filename,
                          const std::string &leaf_node_filename,
                          const std::vector<CoordinateT> &coordinate_list)
-        : m_element_count(input_data_vector.size()), m_leaf_node_filename(leaf_node_filename)
+        : m_element_count(input_data_vector.size()), m_data_offset(DataOffset(m_element_count)),
+          m_leaf_node_filename(leaf_node_filename)
     {
         std::vector<WrappedInputElement> input_wrapper_vector(m_element_count);
 
@@ -147,81 +172,118 @@ class StaticRTree
                 }
             });
 
+        // sort the hilbert-value representatives
+        tbb::parallel_sort(input_wrapper_vector.begin(), input_wrapper_vector.end());
+
         // open leaf file
         boost::filesystem::ofstream leaf_node_file(leaf_node_filename, std::ios::binary);
         leaf_node_file.write((char *)&m_element_count, sizeof(uint64_t));
 
-        // sort the hilbert-value representatives
-        tbb::parallel_sort(input_wrapper_vector.begin(), input_wrapper_vector.end());
-        std::vector<TreeNode> tree_nodes_in_level;
-
-        // pack M elements into leaf node and write to leaf file
-        uint64_t processed_objects_count = 0;
-        while (processed_objects_count < m_element_count)
+        // pack M elements into leaf nodes, a batch of leaves is filled in parallel and written
+        // to the leaf file at once
+        const uint64_t number_of_leaves = (m_element_count + LEAF_NODE_SIZE - 1) / LEAF_NODE_SIZE;
+        std::vector<TreeNode> tree_nodes_in_level(number_of_leaves);
+        std::vector<LeafNode> leaf_batch;
+        for (uint64_t first_leaf = 0; first_leaf < number_of_leaves;
+             first_leaf += LEAF_BATCH_SIZE)
         {
-
-            LeafNode current_leaf;
-            TreeNode current_node;
-            for (uint32_t current_element_index = 0; LEAF_NODE_SIZE > current_element_index;
-                 ++current_element_index)
-            {
-                if (m_element_count > (processed_objects_count + current_element_index))
+            const uint64_t last_leaf = std::min(first_leaf + LEAF_BATCH_SIZE, number_of_leaves);
+            leaf_batch.resize(last_leaf - first_leaf);
+            tbb::parallel_for(
+                tbb::blocked_range<uint64_t>(first_leaf, last_leaf),
+                [&](const tbb::blocked_range<uint64_t> &range)
                 {
-                    uint32_t index_of_next_object =
-                        input_wrapper_vector[processed_objects_count + current_element_index]
-                            .m_array_index;
-                    current_leaf.objects[current_element_index] =
-                        input_data_vector[index_of_next_object];
-                    ++current_leaf.object_count;
-                }
-            }
-
-            // generate tree node that resemble the objects in leaf and store it for next level
-            InitializeMBRectangle(current_node.minimum_bounding_rectangle, current_leaf.objects,
-                                  current_leaf.object_count, coordinate_list);
-            current_node.child_is_on_disk = true;
-            current_node.children[0] = tree_nodes_in_level.size();
-            tree_nodes_in_level.emplace_back(current_node);
-
-            // write leaf_node to leaf node file
-            leaf_node_file.write((char *)&current_leaf, sizeof(current_leaf));
-            processed_objects_count += current_leaf.object_count;
+                    for (auto leaf_id = range.begin(), end = range.end(); leaf_id != end;
+                         ++leaf_id)
+                    {
+                        LeafNode &current_leaf = leaf_batch[leaf_id - first_leaf];
+                        const uint64_t first_object = leaf_id * LEAF_NODE_SIZE;
+                        current_leaf.object_count = static_cast<uint32_t>(std::min<uint64_t>(
+                            LEAF_NODE_SIZE, m_element_count - first_object));
+                        for (const auto i : irange(0u, current_leaf.object_count))
+                        {
+                            const auto &current_element =
+                                input_data_vector[input_wrapper_vector[first_object + i]
+                                                      .m_array_index];
+                            current_leaf.objects[i] =
+                                LeafObject{current_element.u, current_element.v};
+                        }
+
+                        // generate tree node that resemble the objects in leaf and store it for
+                        // next level
+                        TreeNode &current_node = tree_nodes_in_level[leaf_id];
+                        InitializeMBRectangle(current_node.minimum_bounding_rectangle,
+                                              current_leaf.objects, current_leaf.object_count,
+                                              coordinate_list);
+                        current_node.child_is_on_disk = true;
+                        current_node.children[0] = leaf_id;
+                    }
+                });
+            leaf_node_file.write((char *)leaf_batch.data(), sizeof(LeafNode) * leaf_batch.size());
+        }
+        leaf_batch = std::vector<LeafNode>();
+        BOOST_ASSERT(static_cast<uint64_t>(leaf_node_file.tellp()) == m_data_offset);
+
+        // append the elements in the same order, the element of object i of leaf j is at
+        // position j * LEAF_NODE_SIZE + i
+        std::vector<EdgeDataT> data_batch;
+        for (uint64_t first_element = 0; first_element < m_element_count;
+             first_element += LEAF_BATCH_SIZE * LEAF_NODE_SIZE)
+        {
+            const uint64_t last_element =
+                std::min(first_element + LEAF_BATCH_SIZE * LEAF_NODE_SIZE, m_element_count);
+            data_batch.resize(last_element - first_element);
+            tbb::parallel_for(tbb::blocked_range<uint64_t>(first_element, last_element),
+                              [&](const tbb::blocked_range<uint64_t> &range)
+                              {
+                                  for (auto i = range.begin(), end = range.end(); i != end; ++i)
+                                  {
+                                      data_batch[i - first_element] =
+                                          input_data_vector[input_wrapper_vector[i].m_array_index];
+                                  }
+                              });
+            leaf_node_file.write((char *)data_batch.data(), sizeof(EdgeDataT) * data_batch.size());
         }
 
         // close leaf file
         leaf_node_file.close();
+        data_batch = std::vector<EdgeDataT>();
+        input_wrapper_vector = std::vector<WrappedInputElement>();
 
-        uint32_t processing_level = 0;
+        // every level is appended to the search tree and its parents are built in parallel
         while (1 < tree_nodes_in_level.size())
         {
-            std::vector<TreeNode> tree_nodes_in_next_level;
-            uint32_t processed_tree_nodes_in_level = 0;
-            while (processed_tree_nodes_in_level < tree_nodes_in_level.size())
-            {
-                TreeNode parent_node;
-                // pack BRANCHING_FACTOR elements into tree_nodes each
-                for (uint32_t current_child_node_index = 0;
-                     BRANCHING_FACTOR > current_child_node_index; ++current_child_node_index)
+            const uint32_t first_child_id = m_search_tree.size();
+            m_search_tree.insert(m_search_tree.end(), tree_nodes_in_level.begin(),
+                                 tree_nodes_in_level.end());
+
+            // pack BRANCHING_FACTOR elements into tree_nodes each
+            const std::size_t number_of_children = tree_nodes_in_level.size();
+            std::vector<TreeNode> tree_nodes_in_next_level(
+                (number_of_children + BRANCHING_FACTOR - 1) / BRANCHING_FACTOR);
+            tbb::parallel_for(
+                tbb::blocked_range<std::size_t>(0, tree_nodes_in_next_level.size()),
+                [&](const tbb::blocked_range<std::size_t> &range)
                 {
-                    if (processed_tree_nodes_in_level < tree_nodes_in_level.size())
+                    for (auto parent_id = range.begin(), end = range.end(); parent_id != end;
+                         ++parent_id)
                     {
-                        TreeNode &current_child_node =
-                            tree_nodes_in_level[processed_tree_nodes_in_level];
-                        // add tree node to parent entry
-                        parent_node.children[current_child_node_index] = m_search_tree.size();
-                        m_search_tree.emplace_back(current_child_node);
-                        // merge MBRs
-                        parent_node.minimum_bounding_rectangle.MergeBoundingBoxes(
-                            current_child_node.minimum_bounding_rectangle);
-                        // increase counters
-                        ++parent_node.child_count;
-                        ++processed_tree_nodes_in_level;
+                        TreeNode &parent_node = tree_nodes_in_next_level[parent_id];
+                        const std::size_t first_child = parent_id * BRANCHING_FACTOR;
+                        const std::size_t last_child =
+                            std::min<std::size_t>(first_child + BRANCHING_FACTOR,
+                                                  number_of_children);
+                        for (const auto child : irange(first_child, last_child))
+                        {
+                            // add tree node to parent entry and merge MBRs
+                            parent_node.children[parent_node.child_count++] =
+                                first_child_id + child;
+                            parent_node.minimum_bounding_rectangle.MergeBoundingBoxes(
+                                tree_nodes_in_level[child].minimum_bounding_rectangle);
+                        }
                     }
-                }
-                tree_nodes_in_next_level.emplace_back(parent_node);
-            }
+                });
             tree_nodes_in_level.swap(tree_nodes_in_next_level);
-            ++processing_level;
         }
         BOOST_ASSERT_MSG(1 == tree_nodes_in_level.size(), "tree broken, more than one root node");
         // last remaining entry is the root node, store it
@@ -296,6 +358,7 @@ class StaticRTree
 
         leaves_stream.open(leaf_file, std::ios::binary);
         leaves_stream.read((char *)&m_element_count, sizeof(uint64_t));
+        m_data_offset = DataOffset(m_element_count);
     }
 
     explicit StaticRTree(TreeNode *tree_node_ptr,
@@ -317,6 +380,7 @@ class StaticRTree
 
         leaves_stream.open(leaf_file, std::ios::binary);
         leaves_stream.read((char *)&m_element_count, sizeof(uint64_t));
+        m_data_offset = DataOffset(m_element_count);
     }
 
     // Override filter and terminator for the desired behaviour.
@@ -377,7 +441,10 @@ class StaticRTree
             else
             {
                 // inspecting an actual road segment
-                const auto &current_segment = current_query_node.node.template get<EdgeDataT>();
+                const auto &current_candidate =
+                    current_query_node.node.template get<SegmentCandidate>();
+                EdgeDataT current_segment;
+                LoadDataFromDisk(current_candidate.data_index, current_segment);
 
                 auto use_segment = filter(current_segment);
                 if (!use_segment.first && !use_segment.second)
@@ -413,9 +480,10 @@ class StaticRTree
         LoadLeafFromDisk(leaf_id, current_leaf_node);
 
         // current object represents a block on disk
+        const uint64_t first_data_index = static_cast<uint64_t>(leaf_id) * LEAF_NODE_SIZE;
         for (const auto i : irange(0u, current_leaf_node.object_count))
         {
-            auto &current_edge = current_leaf_node.objects[i];
+            const auto &current_edge = current_leaf_node.objects[i];
             const float current_perpendicular_distance =
                 coordinate_calculation::perpendicularDistanceFromProjectedCoordinate(
                     m_coordinate_list->at(current_edge.u), m_coordinate_list->at(current_edge.v),
@@ -423,8 +491,8 @@ class StaticRTree
             // distance must be non-negative
             BOOST_ASSERT(0.f <= current_perpendicular_distance);
 
-            traversal_queue.push(
-                QueryCandidate{current_perpendicular_distance, std::move(current_edge)});
+            traversal_queue.push(QueryCandidate{current_perpendicular_distance,
+                                                SegmentCandidate{first_data_index + i}});
         }
     }
 
@@ -460,9 +528,28 @@ class StaticRTree
         BOOST_ASSERT_MSG(leaves_stream.good(), "Reading from leaf file failed.");
     }
 
+    inline void LoadDataFromDisk(const uint64_t data_index, EdgeDataT &result_data)
+    {
+        BOOST_ASSERT(data_index < m_element_count);
+        if (!leaves_stream.good())
+        {
+            throw exception("Could not read from leaf file.");
+        }
+        leaves_stream.seekg(m_data_offset + data_index * sizeof(EdgeDataT));
+        BOOST_ASSERT_MSG(leaves_stream.good(), "Seeking to position in leaf file failed.");
+        leaves_stream.read((char *)&result_data, sizeof(EdgeDataT));
+        BOOST_ASSERT_MSG(leaves_stream.good(), "Reading from leaf file failed.");
+    }
+
+    static uint64_t DataOffset(const uint64_t element_count)
+    {
+        const uint64_t number_of_leaves = (element_count + LEAF_NODE_SIZE - 1) / LEAF_NODE_SIZE;
+        return sizeof(uint64_t) + number_of_leaves * sizeof(LeafNode);
+    }
+
     template <typename CoordinateT>
     void InitializeMBRectangle(Rectangle &rectangle,
-                               const std::array<EdgeDataT, LEAF_NODE_SIZE> &objects,
+                               const std::array<LeafObject, LEAF_NODE_SIZE> &objects,
                                const uint32_t element_count,
                                const std::vector<CoordinateT> &coordinate_list)
     {
@@ -1,6 +1,7 @@
 #ifndef STRING_UTIL_HPP
 #define STRING_UTIL_HPP
 
+#include <algorithm>
 #include <cctype>
 
 #include <random>
@@ -59,6 +60,27 @@ template <int length, int precision> char *printInt(char *buffer, int value)
     return buffer;
 }
 
+inline bool requires_JSON_escaping(const std::string &input)
+{
+    return std::any_of(input.begin(), input.end(), [](const char letter)
+                       {
+                           switch (letter)
+                           {
+                           case '\\':
+                           case '"':
+                           case '/':
+                           case '\b':
+                           case '\f':
+                           case '\n':
+                           case '\r':
+                           case '\t':
+                               return true;
+                           default:
+                               return false;
+                           }
+                       });
+}
+
 inline std::string escape_JSON(const std::string &input)
 {
     // escape and skip reallocations if possible
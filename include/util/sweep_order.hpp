@@ -0,0 +1,62 @@
+#ifndef SWEEP_ORDER_HPP
+#define SWEEP_ORDER_HPP
+
+#include "util/integer_range.hpp"
+#include "util/osrm_exception.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/range/iterator_range.hpp>
+
+#include <cstddef>
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+
+using SweepOrderRange = boost::iterator_range<const NodeID *>;
+
+// Orders the nodes of the query graph for the downward sweep of PHAST: the core nodes first,
+// followed by the contracted nodes by descending contraction level. The backward search edges
+// of a contracted node lead to nodes contracted in a later round or to the core, so every node
+// comes after all nodes it reads its distance from. The order has an entry for every level.
+template <typename IsCoreNodeT>
+void BuildSweepOrder(const std::vector<float> &node_levels,
+                     const IsCoreNodeT &is_core_node,
+                     NodeID *sweep_order)
+{
+    std::size_t number_of_rounds = 0;
+    for (const auto level : node_levels)
+    {
+        if (level < 0)
+        {
+            throw exception("Negative contraction level");
+        }
+        number_of_rounds = std::max(number_of_rounds, static_cast<std::size_t>(level) + 1);
+    }
+
+    // bucket sort by level, the core takes the bucket above the last round
+    std::vector<std::size_t> bucket_begin(number_of_rounds + 2, 0);
+    const auto bucket_of = [&](const NodeID node)
+    {
+        return is_core_node(node) ? 0
+                                  : number_of_rounds - static_cast<std::size_t>(node_levels[node]);
+    };
+    for (const auto node : irange<NodeID>(0, node_levels.size()))
+    {
+        ++bucket_begin[bucket_of(node) + 1];
+    }
+    std::partial_sum(bucket_begin.begin(), bucket_begin.end(), bucket_begin.begin());
+    for (const auto node : irange<NodeID>(0, node_levels.size()))
+    {
+        sweep_order[bucket_begin[bucket_of(node)]++] = node;
+    }
+}
+}
+}
+
+#endif // SWEEP_ORDER_HPP
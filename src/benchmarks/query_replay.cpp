@@ -0,0 +1,539 @@
+#include "extractor/query_node.hpp"
+#include "engine/query_statistics.hpp"
+#include "engine/route_parameters.hpp"
+#include "server/api_grammar.hpp"
+#include "util/coordinate_calculation.hpp"
+#include "util/hilbert_value.hpp"
+#include "util/integer_range.hpp"
+#include "util/json_renderer.hpp"
+#include "util/osrm_exception.hpp"
+#include "util/simple_logger.hpp"
+#include "util/string_util.hpp"
+
+#include "osrm/coordinate.hpp"
+#include "osrm/engine_config.hpp"
+#include "osrm/json_container.hpp"
+#include "osrm/osrm.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/program_options.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+// allocations of the calling thread, plain integer so it works before any initialization
+thread_local std::uint64_t thread_allocations = 0;
+}
+
+// Counts every allocation, the benchmark reports the allocations done per query
+void *operator new(std::size_t size)
+{
+    ++thread_allocations;
+    if (void *pointer = std::malloc(size == 0 ? 1 : size))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+
+namespace osrm
+{
+namespace benchmarks
+{
+
+// Choosen by a fair W20 dice roll (this value is completely arbitrary)
+constexpr unsigned RANDOM_SEED = 13;
+// local queries stay within this many nodes along the hilbert curve
+constexpr std::size_t LOCAL_WINDOW = 1000;
+// long-haul queries take the farthest of this many random targets
+constexpr unsigned LONG_HAUL_CANDIDATES = 16;
+
+using Clock = std::chrono::steady_clock;
+
+struct ServiceResult
+{
+    std::string service;
+    std::vector<double> latencies; // milliseconds
+    std::uint64_t settled_nodes = 0;
+    std::uint64_t allocations = 0;
+    std::uint64_t failures = 0;
+    // the service's throughput is taken over the span of its own queries
+    Clock::time_point first_start = Clock::time_point::max();
+    Clock::time_point last_end = Clock::time_point::min();
+};
+
+std::vector<util::FixedPointCoordinate> loadCoordinates(const boost::filesystem::path &nodes_file)
+{
+    boost::filesystem::ifstream nodes_input_stream(nodes_file, std::ios::binary);
+    if (!nodes_input_stream)
+    {
+        throw util::exception("Could not open " + nodes_file.string());
+    }
+
+    extractor::QueryNode current_node;
+    unsigned coordinate_count = 0;
+    nodes_input_stream.read((char *)&coordinate_count, sizeof(unsigned));
+    std::vector<util::FixedPointCoordinate> coordinates(coordinate_count);
+    for (const auto i : util::irange(0u, coordinate_count))
+    {
+        nodes_input_stream.read((char *)&current_node, sizeof(extractor::QueryNode));
+        coordinates[i] = util::FixedPointCoordinate(current_node.lat, current_node.lon);
+    }
+    return coordinates;
+}
+
+// Parses request lines as logged by osrm-routed or plain "/service?..." URIs
+std::vector<engine::RouteParameters> loadQueryLog(const boost::filesystem::path &log_file)
+{
+    using APIGrammarParser = server::APIGrammar<std::string::iterator, engine::RouteParameters>;
+
+    boost::filesystem::ifstream log_input_stream(log_file);
+    if (!log_input_stream)
+    {
+        throw util::exception("Could not open " + log_file.string());
+    }
+
+    std::vector<engine::RouteParameters> queries;
+    std::string line, request_string;
+    std::size_t skipped_lines = 0;
+    while (std::getline(log_input_stream, line))
+    {
+        const auto uri_begin = line.find('/') == 0 ? 0 : line.find(" /");
+        if (uri_begin == std::string::npos)
+        {
+            ++skipped_lines;
+            continue;
+        }
+        util::URIDecode(line.substr(uri_begin == 0 ? 0 : uri_begin + 1), request_string);
+
+        engine::RouteParameters query;
+        APIGrammarParser api_parser(&query);
+        auto api_iterator = request_string.begin();
+        const bool result =
+            boost::spirit::qi::parse(api_iterator, request_string.end(), api_parser);
+        if (!result || api_iterator != request_string.end())
+        {
+            ++skipped_lines;
+            continue;
+        }
+        queries.push_back(std::move(query));
+    }
+    if (skipped_lines > 0)
+    {
+        util::SimpleLogger().Write(logWARNING) << "skipped " << skipped_lines
+                                               << " malformed lines of the query log";
+    }
+    return queries;
+}
+
+// Generates queries between nodes of the dataset:
+//   random:    uniformly random nodes
+//   local:     nodes close to each other along the hilbert curve
+//   long-haul: the farthest of a few random targets
+std::vector<engine::RouteParameters>
+generateQueries(std::vector<util::FixedPointCoordinate> coordinates,
+                const std::string &workload,
+                const std::string &service,
+                const unsigned number_of_queries,
+                const unsigned table_size)
+{
+    if (coordinates.empty())
+    {
+        throw util::exception("Dataset has no nodes to generate queries from");
+    }
+    if (workload != "random" && workload != "local" && workload != "long-haul")
+    {
+        throw util::exception("Unknown workload " + workload);
+    }
+
+    if (workload == "local")
+    {
+        std::vector<std::pair<std::uint64_t, util::FixedPointCoordinate>> hilbert_order;
+        hilbert_order.reserve(coordinates.size());
+        for (const auto &coordinate : coordinates)
+        {
+            hilbert_order.emplace_back(util::hilbertCode(coordinate), coordinate);
+        }
+        std::sort(hilbert_order.begin(), hilbert_order.end(),
+                  [](const std::pair<std::uint64_t, util::FixedPointCoordinate> &lhs,
+                     const std::pair<std::uint64_t, util::FixedPointCoordinate> &rhs)
+                  {
+                      return lhs.first < rhs.first;
+                  });
+        for (const auto i : util::irange<std::size_t>(0, coordinates.size()))
+        {
+            coordinates[i] = hilbert_order[i].second;
+        }
+    }
+
+    std::mt19937 mt_rand(RANDOM_SEED);
+    std::uniform_int_distribution<std::size_t> node_udist(0, coordinates.size() - 1);
+    const auto window = std::min(LOCAL_WINDOW, coordinates.size() - 1);
+    std::uniform_int_distribution<std::size_t> window_udist(0, window);
+
+    const auto pick_target = [&](const std::size_t source)
+    {
+        if (workload == "local")
+        {
+            const auto first = source > window / 2 ? source - window / 2 : 0;
+            return std::min(first + window_udist(mt_rand), coordinates.size() - 1);
+        }
+        auto target = node_udist(mt_rand);
+        if (workload == "long-haul")
+        {
+            for (unsigned i = 1; i < LONG_HAUL_CANDIDATES; ++i)
+            {
+                const auto candidate = node_udist(mt_rand);
+                if (util::coordinate_calculation::greatCircleDistance(coordinates[source],
+                                                                      coordinates[candidate]) >
+                    util::coordinate_calculation::greatCircleDistance(coordinates[source],
+                                                                      coordinates[target]))
+                {
+                    target = candidate;
+                }
+            }
+        }
+        return target;
+    };
+    const auto add_coordinate =
+        [&coordinates](engine::RouteParameters &query, const std::size_t node)
+    {
+        query.AddCoordinate(coordinates[node].lat / COORDINATE_PRECISION,
+                            coordinates[node].lon / COORDINATE_PRECISION);
+    };
+
+    std::vector<engine::RouteParameters> queries(number_of_queries);
+    for (auto &query : queries)
+    {
+        query.SetService(service);
+        const auto source = node_udist(mt_rand);
+        add_coordinate(query, source);
+        if (service == "nearest")
+        {
+            continue;
+        }
+        // tables span the region between the first location and its targets
+        const unsigned number_of_targets =
+            service == "table" && table_size > 1 ? table_size - 1 : 1;
+        for (unsigned i = 0; i < number_of_targets; ++i)
+        {
+            add_coordinate(query, pick_target(source));
+        }
+    }
+    return queries;
+}
+
+// Replays the queries on the given number of threads, each thread takes the next query
+std::vector<ServiceResult>
+replay(OSRM &routing_machine,
+       const std::vector<engine::RouteParameters> &queries,
+       const unsigned threads)
+{
+    std::vector<std::string> services;
+    for (const auto &query : queries)
+    {
+        if (std::find(services.begin(), services.end(), query.service) ==
+            services.end())
+        {
+            services.push_back(query.service);
+        }
+    }
+
+    std::vector<std::vector<ServiceResult>> thread_results(threads);
+    std::atomic<std::size_t> next_query(0);
+    const auto run = [&](std::vector<ServiceResult> &results)
+    {
+        for (const auto &service : services)
+        {
+            results.emplace_back();
+            results.back().service = service;
+        }
+        auto &statistics = engine::QueryStatistics::Get();
+        for (auto index = next_query++; index < queries.size(); index = next_query++)
+        {
+            const auto &parameters = queries[index];
+            const auto service_index =
+                std::find(services.begin(), services.end(), parameters.service) - services.begin();
+            auto &result = results[service_index];
+
+            const auto allocations_before = thread_allocations;
+            statistics.BeginRequest();
+            const auto start = std::chrono::steady_clock::now();
+            {
+                json::Object json_result;
+                const int return_code = routing_machine.RunQuery(parameters, json_result);
+                if (return_code / 100 != 2)
+                {
+                    ++result.failures;
+                }
+            }
+            const auto end = std::chrono::steady_clock::now();
+            statistics.EndRequest();
+
+            result.latencies.push_back(
+                std::chrono::duration<double, std::milli>(end - start).count());
+            result.first_start = std::min(result.first_start, start);
+            result.last_end = std::max(result.last_end, end);
+            result.settled_nodes +=
+                statistics.RequestCounter(engine::QueryCounter::SettledNodes);
+            result.allocations += thread_allocations - allocations_before;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (auto &results : thread_results)
+    {
+        workers.emplace_back(run, std::ref(results));
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    // merge the per thread results
+    std::vector<ServiceResult> results = std::move(thread_results.front());
+    for (const auto &other_results : thread_results)
+    {
+        if (&other_results == &thread_results.front())
+        {
+            continue;
+        }
+        for (const auto i : util::irange<std::size_t>(0, results.size()))
+        {
+            results[i].latencies.insert(results[i].latencies.end(),
+                                        other_results[i].latencies.begin(),
+                                        other_results[i].latencies.end());
+            results[i].settled_nodes += other_results[i].settled_nodes;
+            results[i].allocations += other_results[i].allocations;
+            results[i].failures += other_results[i].failures;
+            results[i].first_start =
+                std::min(results[i].first_start, other_results[i].first_start);
+            results[i].last_end = std::max(results[i].last_end, other_results[i].last_end);
+        }
+    }
+    return results;
+}
+
+double percentile(const std::vector<double> &sorted_values, const double fraction)
+{
+    if (sorted_values.empty())
+    {
+        return 0.;
+    }
+    const auto rank = static_cast<std::size_t>(fraction * (sorted_values.size() - 1) + 0.5);
+    return sorted_values[rank];
+}
+
+util::json::Object summarize(ServiceResult &result)
+{
+    std::sort(result.latencies.begin(), result.latencies.end());
+    const double number_of_queries = std::max<std::size_t>(1, result.latencies.size());
+    const double seconds =
+        result.latencies.empty()
+            ? 0.
+            : std::chrono::duration<double>(result.last_end - result.first_start).count();
+
+    util::json::Object json_summary;
+    json_summary.values["service"] = result.service;
+    json_summary.values["queries"] = static_cast<double>(result.latencies.size());
+    json_summary.values["failures"] = static_cast<double>(result.failures);
+    json_summary.values["seconds"] = seconds;
+    json_summary.values["queries_per_second"] =
+        seconds > 0. ? result.latencies.size() / seconds : 0.;
+    util::json::Object json_latencies;
+    json_latencies.values["p50"] = percentile(result.latencies, 0.5);
+    json_latencies.values["p90"] = percentile(result.latencies, 0.9);
+    json_latencies.values["p99"] = percentile(result.latencies, 0.99);
+    json_latencies.values["max"] = result.latencies.empty() ? 0. : result.latencies.back();
+    json_summary.values["latency_milliseconds"] = json_latencies;
+    json_summary.values["settled_nodes_per_query"] = result.settled_nodes / number_of_queries;
+    json_summary.values["allocations_per_query"] = result.allocations / number_of_queries;
+    return json_summary;
+}
+
+void printSummary(const util::json::Object &json_summary)
+{
+    const auto number = [](const util::json::Value &value)
+    {
+        return mapbox::util::get<util::json::Number>(value).value;
+    };
+    const auto &values = json_summary.values;
+    const auto &latencies =
+        mapbox::util::get<util::json::Object>(values.at("latency_milliseconds")).values;
+
+    std::cout << mapbox::util::get<util::json::String>(values.at("service")).value << ": "
+              << number(values.at("queries")) << " queries ("
+              << number(values.at("failures")) << " failed), "
+              << number(values.at("queries_per_second")) << " queries/s\n"
+              << "  latency ms   p50 " << number(latencies.at("p50")) << "  p90 "
+              << number(latencies.at("p90")) << "  p99 " << number(latencies.at("p99"))
+              << "  max " << number(latencies.at("max")) << "\n"
+              << "  per query    " << number(values.at("settled_nodes_per_query"))
+              << " settled nodes, " << number(values.at("allocations_per_query"))
+              << " allocations" << std::endl;
+}
+}
+}
+
+int main(int argc, const char *argv[]) try
+{
+    using namespace osrm;
+    namespace po = boost::program_options;
+
+    util::LogPolicy::GetInstance().Unmute();
+
+    EngineConfig config;
+    boost::filesystem::path base_path, query_log;
+    std::vector<std::string> services;
+    std::string workload, output;
+    unsigned number_of_queries, threads, table_size;
+
+    po::options_description options("Options");
+    options.add_options()("help,h", "Show this help message")(
+        "shared-memory,s", po::value<bool>(&config.use_shared_memory)->implicit_value(true)
+                               ->default_value(false),
+        "Load the dataset from shared memory")(
+        "queries,q", po::value<boost::filesystem::path>(&query_log),
+        "Replay the requests of this log instead of generating a workload")(
+        "workload,w", po::value<std::string>(&workload)->default_value("random"),
+        "Generated workload: random, local or long-haul")(
+        "service", po::value<std::vector<std::string>>(&services)->composing(),
+        "Service of the generated queries, repeat to mix several: viaroute, table or nearest")(
+        "requests,n", po::value<unsigned>(&number_of_queries)->default_value(10000),
+        "Number of generated queries per service")(
+        "threads,t", po::value<unsigned>(&threads)->default_value(1),
+        "Number of threads sending queries")(
+        "table-size", po::value<unsigned>(&table_size)->default_value(10),
+        "Number of locations of generated table queries")(
+        "max-table-size", po::value<int>(&config.max_locations_distance_table)->default_value(-1),
+        "Max. locations supported in distance table query")(
+        "max-viaroute-size", po::value<int>(&config.max_locations_viaroute)->default_value(-1),
+        "Max. locations supported in viaroute query")(
+        "output,o", po::value<std::string>(&output)->default_value("text"),
+        "Format of the report: text or json");
+
+    po::options_description hidden_options("Hidden options");
+    hidden_options.add_options()("base,b", po::value<boost::filesystem::path>(&base_path),
+                                 "base path to .osrm file");
+    po::positional_options_description positional_options;
+    positional_options.add("base", 1);
+
+    po::options_description cmdline_options;
+    cmdline_options.add(options).add(hidden_options);
+
+    po::variables_map option_variables;
+    po::store(po::command_line_parser(argc, argv)
+                  .options(cmdline_options)
+                  .positional(positional_options)
+                  .run(),
+              option_variables);
+    po::notify(option_variables);
+
+    if (option_variables.count("help") ||
+        (base_path.empty() && (!config.use_shared_memory || query_log.empty())))
+    {
+        std::cout << "osrm-bench <base.osrm> [<options>]\n\n"
+                  << "Replays a query log or a generated workload against the routing engine.\n"
+                  << "Generated workloads need the base path even with --shared-memory.\n\n"
+                  << options;
+        return option_variables.count("help") ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (output != "text" && output != "json")
+    {
+        throw util::exception("Unknown output format " + output);
+    }
+    threads = std::max(1u, threads);
+    if (services.empty())
+    {
+        services.push_back("viaroute");
+    }
+
+    std::vector<engine::RouteParameters> queries;
+    if (!query_log.empty())
+    {
+        queries = benchmarks::loadQueryLog(query_log);
+    }
+    else
+    {
+        const auto coordinates =
+            benchmarks::loadCoordinates(base_path.string() + ".nodes");
+        for (const auto &service : services)
+        {
+            auto service_queries = benchmarks::generateQueries(coordinates, workload, service,
+                                                               number_of_queries, table_size);
+            std::move(service_queries.begin(), service_queries.end(),
+                      std::back_inserter(queries));
+        }
+        // mix the services so they compete for the engine like in production
+        std::shuffle(queries.begin(), queries.end(), std::mt19937(benchmarks::RANDOM_SEED));
+    }
+    if (queries.empty())
+    {
+        throw util::exception("No queries to run");
+    }
+
+    if (!config.use_shared_memory)
+    {
+        config.server_paths["base"] = base_path;
+    }
+    OSRM routing_machine(config);
+
+    util::SimpleLogger().Write() << "running " << queries.size() << " queries on " << threads
+                                 << " threads";
+    // the engine would log every failed query
+    util::LogPolicy::GetInstance().Mute();
+    const auto start = std::chrono::steady_clock::now();
+    auto results = benchmarks::replay(routing_machine, queries, threads);
+    const auto end = std::chrono::steady_clock::now();
+    util::LogPolicy::GetInstance().Unmute();
+    const double seconds = std::chrono::duration<double>(end - start).count();
+
+    util::json::Object json_report;
+    json_report.values["threads"] = static_cast<double>(threads);
+    json_report.values["workload"] = query_log.empty() ? workload : query_log.string();
+    json_report.values["seconds"] = seconds;
+    json_report.values["queries_per_second"] = queries.size() / seconds;
+    util::json::Array json_services;
+    for (auto &result : results)
+    {
+        json_services.values.push_back(benchmarks::summarize(result));
+    }
+    json_report.values["services"] = json_services;
+
+    if (output == "json")
+    {
+        util::json::render(std::cout, json_report);
+        std::cout << std::endl;
+    }
+    else
+    {
+        std::cout << queries.size() << " queries in " << seconds << " seconds, "
+                  << queries.size() / seconds << " queries/s\n";
+        for (const auto &json_summary : json_services.values)
+        {
+            benchmarks::printSummary(mapbox::util::get<util::json::Object>(json_summary));
+        }
+    }
+    return EXIT_SUCCESS;
+}
+catch (const std::exception &e)
+{
+    osrm::util::SimpleLogger().Write(logWARNING) << "[exception] " << e.what();
+    return EXIT_FAILURE;
+}
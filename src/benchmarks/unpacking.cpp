@@ -0,0 +1,198 @@
+#include "contractor/query_edge.hpp"
+#include "engine/routing_algorithms/routing_base.hpp"
+#include "util/graph_loader.hpp"
+#include "util/integer_range.hpp"
+#include "util/static_graph.hpp"
+#include "util/timing_util.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace benchmarks
+{
+
+using QueryGraph = util::StaticGraph<contractor::QueryEdge::EdgeData>;
+
+// The longest shortcuts of the hierarchy, each one stands in for a long stretch of a route
+struct BenchShortcut
+{
+    NodeID source;
+    NodeID target;
+    EdgeID edge_id;
+};
+
+// Serves the graph to the engine's unpacking code, with or without the shortcut children
+class GraphFacade
+{
+  public:
+    using EdgeData = contractor::QueryEdge::EdgeData;
+
+    GraphFacade(const QueryGraph &graph,
+                const std::vector<contractor::ShortcutChildren> &shortcut_children)
+        : graph(graph), shortcut_children(shortcut_children)
+    {
+    }
+
+    util::range<EdgeID> GetAdjacentEdgeRange(const NodeID node) const
+    {
+        return graph.GetAdjacentEdgeRange(node);
+    }
+
+    NodeID GetTarget(const EdgeID edge_id) const { return graph.GetTarget(edge_id); }
+
+    const EdgeData &GetEdgeData(const EdgeID edge_id) const { return graph.GetEdgeData(edge_id); }
+
+    contractor::ShortcutChildren GetShortcutChildren(const EdgeID edge_id) const
+    {
+        return shortcut_children.empty() ? contractor::ShortcutChildren()
+                                          : shortcut_children[edge_id];
+    }
+
+  private:
+    const QueryGraph &graph;
+    const std::vector<contractor::ShortcutChildren> &shortcut_children;
+};
+
+class Unpacker;
+using UnpackingInterface = engine::routing_algorithms::BasicRoutingInterface<GraphFacade, Unpacker>;
+
+class Unpacker final : public UnpackingInterface
+{
+  public:
+    explicit Unpacker(GraphFacade *facade) : UnpackingInterface(facade) {}
+};
+
+// Sums the cheapest original edges along an unpacked path
+std::int64_t pathWeight(const QueryGraph &graph, const std::vector<NodeID> &path)
+{
+    std::int64_t weight = 0;
+    for (std::size_t i = 1; i < path.size(); ++i)
+    {
+        EdgeWeight edge_weight = std::numeric_limits<EdgeWeight>::max();
+        for (const auto edge_id : graph.GetAdjacentEdgeRange(path[i - 1]))
+        {
+            const auto &data = graph.GetEdgeData(edge_id);
+            if (graph.GetTarget(edge_id) == path[i] && data.forward && !data.shortcut)
+            {
+                edge_weight = std::min(edge_weight, data.distance);
+            }
+        }
+        for (const auto edge_id : graph.GetAdjacentEdgeRange(path[i]))
+        {
+            const auto &data = graph.GetEdgeData(edge_id);
+            if (graph.GetTarget(edge_id) == path[i - 1] && data.backward && !data.shortcut)
+            {
+                edge_weight = std::min(edge_weight, data.distance);
+            }
+        }
+        weight += edge_weight;
+    }
+    return weight;
+}
+
+std::int64_t benchmarkUnpacking(const QueryGraph &graph,
+                                const std::vector<contractor::ShortcutChildren> &shortcut_children,
+                                const std::vector<BenchShortcut> &shortcuts,
+                                const std::string &name)
+{
+    std::cout << "Unpacking " << shortcuts.size() << " shortcuts " << name << ": " << std::flush;
+
+    GraphFacade facade(graph, shortcut_children);
+    const Unpacker unpacker(&facade);
+    std::vector<std::vector<NodeID>> paths(shortcuts.size());
+    TIMER_START(unpacking);
+    for (std::size_t i = 0; i < shortcuts.size(); ++i)
+    {
+        unpacker.UnpackEdge(shortcuts[i].source, shortcuts[i].target, paths[i]);
+    }
+    TIMER_STOP(unpacking);
+
+    std::cout << "Took " << TIMER_MSEC(unpacking) << "ms  ->  "
+              << TIMER_MSEC(unpacking) / shortcuts.size() << " ms/shortcut" << std::endl;
+
+    // ties between equally heavy edges may unpack to different nodes, so compare the weights
+    std::int64_t unpacked_weight = 0;
+    for (const auto &path : paths)
+    {
+        unpacked_weight += pathWeight(graph, path);
+    }
+    return unpacked_weight;
+}
+
+// Returns false if the two ways of unpacking disagree
+bool benchmark(const QueryGraph &graph,
+               const std::vector<contractor::ShortcutChildren> &shortcut_children,
+               const unsigned num_shortcuts)
+{
+    std::vector<BenchShortcut> shortcuts;
+    for (const auto node : util::irange(0u, graph.GetNumberOfNodes()))
+    {
+        for (const auto edge_id : graph.GetAdjacentEdgeRange(node))
+        {
+            const auto &data = graph.GetEdgeData(edge_id);
+            if (data.shortcut && data.forward)
+            {
+                shortcuts.push_back({node, graph.GetTarget(edge_id), edge_id});
+            }
+        }
+    }
+    const auto longer = [&graph](const BenchShortcut &lhs, const BenchShortcut &rhs)
+    {
+        return graph.GetEdgeData(lhs.edge_id).distance > graph.GetEdgeData(rhs.edge_id).distance;
+    };
+    const auto num_selected = std::min<std::size_t>(num_shortcuts, shortcuts.size());
+    std::partial_sort(shortcuts.begin(), shortcuts.begin() + num_selected, shortcuts.end(),
+                      longer);
+    shortcuts.resize(num_selected);
+    if (shortcuts.empty())
+    {
+        std::cout << "graph has no shortcuts" << std::endl;
+        return true;
+    }
+
+    const auto scanned_weight =
+        benchmarkUnpacking(graph, {}, shortcuts, "by scanning adjacency lists");
+    if (shortcut_children.empty())
+    {
+        std::cout << "graph has no shortcut children, rerun osrm-prepare" << std::endl;
+        return true;
+    }
+    const auto resolved_weight =
+        benchmarkUnpacking(graph, shortcut_children, shortcuts, "by shortcut children");
+    if (scanned_weight != resolved_weight)
+    {
+        std::cout << "unpacked weights differ: " << scanned_weight << " != " << resolved_weight
+                  << std::endl;
+        return false;
+    }
+    return true;
+}
+}
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "./unpacking-bench file.hsgr"
+                  << "\n";
+        return 1;
+    }
+
+    std::vector<osrm::benchmarks::QueryGraph::NodeArrayEntry> node_list;
+    std::vector<osrm::benchmarks::QueryGraph::EdgeArrayEntry> edge_list;
+    std::vector<osrm::contractor::ShortcutChildren> shortcut_children;
+    unsigned check_sum = 0;
+    osrm::util::readHSGRFromStream(argv[1], node_list, edge_list, shortcut_children, &check_sum);
+    osrm::benchmarks::QueryGraph graph(node_list, edge_list);
+
+    return osrm::benchmarks::benchmark(graph, shortcut_children, 1000) ? EXIT_SUCCESS
+                                                                        : EXIT_FAILURE;
+}
@@ -16,42 +16,405 @@
 #include "util/timing_util.hpp"
 #include "util/typedefs.hpp"
 
-#include <fast-cpp-csv-parser/csv.h>
-
 #include <boost/filesystem/fstream.hpp>
 #include <boost/program_options.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 #include <tbb/parallel_sort.h>
 
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <limits>
 #include <bitset>
 #include <chrono>
 #include <memory>
 #include <string>
 #include <thread>
+#include <tuple>
 #include <vector>
 
 #include "util/debug_geometry.hpp"
 
-namespace std
+namespace osrm
+{
+namespace contractor
+{
+
+namespace
 {
 
-template <> struct hash<std::pair<OSMNodeID, OSMNodeID>>
+struct SegmentSpeedSource
 {
-    std::size_t operator()(const std::pair<OSMNodeID, OSMNodeID> &k) const
+    OSMNodeID from;
+    OSMNodeID to;
+    unsigned speed;
+    // row of the entry in the file, later rows override earlier ones
+    std::uint32_t position;
+};
+
+// Sorted by (from, to), at most one entry per segment.
+using SegmentSpeedLookup = std::vector<SegmentSpeedSource>;
+
+inline bool ParseUnsigned(const char *&first, const char *last, std::uint64_t &value)
+{
+    while (first != last && (*first == ' ' || *first == '\t'))
+    {
+        ++first;
+    }
+    if (first == last || *first < '0' || *first > '9')
     {
-        return OSMNodeID_to_uint64_t(k.first) ^ (OSMNodeID_to_uint64_t(k.second) << 12);
+        return false;
+    }
+    value = 0;
+    while (first != last && *first >= '0' && *first <= '9')
+    {
+        value = value * 10 + (*first - '0');
+        ++first;
+    }
+    while (first != last && (*first == ' ' || *first == '\t' || *first == '\r'))
+    {
+        ++first;
+    }
+    return true;
+}
+
+// Parses the lines "from_node,to_node,speed" in [first, last).
+void ParseSegmentSpeeds(const char *first, const char *last, std::vector<SegmentSpeedSource> &out)
+{
+    while (first != last)
+    {
+        const char *line_end = std::find(first, last, '\n');
+        const char *position = first;
+        std::uint64_t from_node_id, to_node_id, speed;
+        const bool valid = ParseUnsigned(position, line_end, from_node_id) &&
+                           position != line_end && *position++ == ',' &&
+                           ParseUnsigned(position, line_end, to_node_id) &&
+                           position != line_end && *position++ == ',' &&
+                           ParseUnsigned(position, line_end, speed) && position == line_end;
+        if (valid)
+        {
+            out.push_back({OSMNodeID(from_node_id), OSMNodeID(to_node_id),
+                           static_cast<unsigned>(speed), 0});
+        }
+        else if (std::find_if(first, line_end, [](const char c)
+                              {
+                                  return c != ' ' && c != '\t' && c != '\r';
+                              }) != line_end)
+        {
+            throw util::exception("Invalid line in segment speed file: " +
+                                  std::string(first, line_end));
+        }
+        first = line_end == last ? last : line_end + 1;
+    }
+}
+
+// Reads the speed file in large chunks, every chunk is split at line boundaries and parsed
+// in parallel.
+SegmentSpeedLookup LoadSegmentSpeeds(const std::string &segment_speed_filename)
+{
+    boost::filesystem::ifstream speed_input_stream(segment_speed_filename, std::ios::binary);
+    if (!speed_input_stream)
+    {
+        throw util::exception("Could not open " + segment_speed_filename);
+    }
+
+    const constexpr std::size_t CHUNK_SIZE = 64 * 1024 * 1024;
+    const constexpr std::size_t MIN_RANGE_SIZE = 1024 * 1024;
+
+    SegmentSpeedLookup lookup;
+    std::vector<char> buffer;
+    std::size_t carry_over = 0;
+    while (speed_input_stream)
+    {
+        buffer.resize(carry_over + CHUNK_SIZE);
+        speed_input_stream.read(buffer.data() + carry_over, CHUNK_SIZE);
+        const std::size_t buffer_size = carry_over + speed_input_stream.gcount();
+
+        // only parse complete lines, the rest is moved to the next chunk
+        std::size_t parse_size = buffer_size;
+        if (speed_input_stream)
+        {
+            const auto last_newline = std::find(buffer.rbegin() + (buffer.size() - buffer_size),
+                                                buffer.rend(), '\n');
+            parse_size = std::distance(last_newline, buffer.rend());
+        }
+
+        std::vector<std::size_t> range_begins{0};
+        for (std::size_t begin = MIN_RANGE_SIZE; begin < parse_size; begin += MIN_RANGE_SIZE)
+        {
+            const auto line_end = std::find(buffer.begin() + begin, buffer.begin() + parse_size, '\n');
+            const std::size_t next_begin = std::distance(buffer.begin(), line_end) + 1;
+            if (next_begin < parse_size && next_begin > range_begins.back())
+            {
+                range_begins.push_back(next_begin);
+            }
+        }
+        range_begins.push_back(parse_size);
+
+        std::vector<std::vector<SegmentSpeedSource>> parsed(range_begins.size() - 1);
+        tbb::parallel_for(std::size_t{0}, parsed.size(), [&](const std::size_t range)
+                          {
+                              ParseSegmentSpeeds(buffer.data() + range_begins[range],
+                                                 buffer.data() + range_begins[range + 1],
+                                                 parsed[range]);
+                          });
+        for (const auto &entries : parsed)
+        {
+            lookup.insert(lookup.end(), entries.begin(), entries.end());
+        }
+
+        carry_over = buffer_size - parse_size;
+        std::copy(buffer.begin() + parse_size, buffer.begin() + buffer_size, buffer.begin());
     }
+
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, lookup.size()),
+                      [&lookup](const tbb::blocked_range<std::size_t> &range)
+                      {
+                          for (auto i = range.begin(); i != range.end(); ++i)
+                          {
+                              lookup[i].position = static_cast<std::uint32_t>(i);
+                          }
+                      });
+    tbb::parallel_sort(lookup.begin(), lookup.end(),
+                       [](const SegmentSpeedSource &lhs, const SegmentSpeedSource &rhs)
+                       {
+                           return std::tie(lhs.from, lhs.to, rhs.position) <
+                                  std::tie(rhs.from, rhs.to, lhs.position);
+                       });
+    // keep the last speed given for every segment
+    lookup.erase(std::unique(lookup.begin(), lookup.end(),
+                             [](const SegmentSpeedSource &lhs, const SegmentSpeedSource &rhs)
+                             {
+                                 return lhs.from == rhs.from && lhs.to == rhs.to;
+                             }),
+                 lookup.end());
+    lookup.shrink_to_fit();
+    return lookup;
+}
+
+inline const SegmentSpeedSource *
+FindSegmentSpeed(const SegmentSpeedLookup &lookup, const OSMNodeID from, const OSMNodeID to)
+{
+    const auto iter =
+        std::lower_bound(lookup.begin(), lookup.end(), std::make_pair(from, to),
+                         [](const SegmentSpeedSource &entry, const std::pair<OSMNodeID, OSMNodeID> &key)
+                         {
+                             return std::tie(entry.from, entry.to) < std::tie(key.first, key.second);
+                         });
+    if (iter != lookup.end() && iter->from == from && iter->to == to)
+    {
+        return &*iter;
+    }
+    return nullptr;
+}
+
+template <typename T> inline T ReadUnaligned(const char *data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+// Packed record per edge in .edge_segment_lookup: the number of OSM nodes, the first OSM node
+// and then (OSM node, segment length, segment weight) for every following node.
+const constexpr std::size_t SEGMENT_HEADER_SIZE = sizeof(unsigned) + sizeof(OSMNodeID);
+const constexpr std::size_t SEGMENT_ENTRY_SIZE = sizeof(OSMNodeID) + sizeof(double) + sizeof(int);
+
+int ComputeEdgeWeight(const char *segment_record, const SegmentSpeedLookup &segment_speed_lookup)
+{
+    const auto num_osm_nodes = ReadUnaligned<unsigned>(segment_record);
+    auto previous_osm_node_id = ReadUnaligned<OSMNodeID>(segment_record + sizeof(unsigned));
+    const char *entry = segment_record + SEGMENT_HEADER_SIZE;
+
+    int new_weight = 0;
+    for (unsigned i = 1; i < num_osm_nodes; ++i, entry += SEGMENT_ENTRY_SIZE)
+    {
+        const auto this_osm_node_id = ReadUnaligned<OSMNodeID>(entry);
+        const auto segment_length = ReadUnaligned<double>(entry + sizeof(OSMNodeID));
+        const auto segment_weight =
+            ReadUnaligned<int>(entry + sizeof(OSMNodeID) + sizeof(double));
+
+        const auto speed_entry =
+            FindSegmentSpeed(segment_speed_lookup, previous_osm_node_id, this_osm_node_id);
+        if (speed_entry != nullptr)
+        {
+            // This sets the segment weight using the same formula as the
+            // EdgeBasedGraphFactory for consistency.  The *why* of this formula
+            // is lost in the annals of time.
+            int new_segment_weight = std::max(
+                1, static_cast<int>(std::floor((segment_length * 10.) / (speed_entry->speed / 3.6) + .5)));
+            new_weight += new_segment_weight;
+
+            util::DEBUG_GEOMETRY_EDGE(new_segment_weight, segment_length, previous_osm_node_id,
+                                      this_osm_node_id);
+        }
+        else
+        {
+            // If no lookup found, use the original weight value for this segment
+            new_weight += segment_weight;
+
+            util::DEBUG_GEOMETRY_EDGE(segment_weight, segment_length, previous_osm_node_id,
+                                      this_osm_node_id);
+        }
+
+        previous_osm_node_id = this_osm_node_id;
+    }
+    return new_weight;
+}
+
+// Buffered reader for the variable sized records of .edge_segment_lookup
+class SegmentRecordReader
+{
+  public:
+    explicit SegmentRecordReader(boost::filesystem::ifstream &input_stream)
+        : input_stream(input_stream), begin(0), end(0)
+    {
+    }
+
+    // Reads the next `number_of_records` records. The offsets point into Data() and stay valid
+    // until the next call.
+    void ReadRecords(const std::size_t number_of_records, std::vector<std::size_t> &offsets)
+    {
+        buffer.erase(buffer.begin(), buffer.begin() + begin);
+        end -= begin;
+        begin = 0;
+
+        offsets.resize(number_of_records);
+        for (auto &offset : offsets)
+        {
+            Fill(SEGMENT_HEADER_SIZE);
+            const auto num_osm_nodes = ReadUnaligned<unsigned>(buffer.data() + begin);
+            BOOST_ASSERT(num_osm_nodes > 0);
+            const std::size_t record_size =
+                SEGMENT_HEADER_SIZE + (num_osm_nodes - 1) * SEGMENT_ENTRY_SIZE;
+            Fill(record_size);
+            offset = begin;
+            begin += record_size;
+        }
+    }
+
+    const char *Data() const { return buffer.data(); }
+
+  private:
+    // makes sure there are at least `size` unread bytes in the buffer
+    void Fill(const std::size_t size)
+    {
+        const constexpr std::size_t READ_SIZE = 4 * 1024 * 1024;
+        while (end - begin < size)
+        {
+            buffer.resize(end + READ_SIZE);
+            input_stream.read(buffer.data() + end, READ_SIZE);
+            if (input_stream.gcount() == 0)
+            {
+                throw util::exception(".edge_segment_lookup is truncated");
+            }
+            end += input_stream.gcount();
+        }
+    }
+
+    boost::filesystem::ifstream &input_stream;
+    std::vector<char> buffer;
+    std::size_t begin;
+    std::size_t end;
 };
+
+// Picks the edge used to unpack (from, to) the same way the query side scans adjacency lists
+template <typename NodeArrayT>
+EdgeID FindUnpackingEdge(const util::DeallocatingVector<QueryEdge> &edges,
+                         const NodeArrayT &node_array,
+                         const NodeID from,
+                         const NodeID to)
+{
+    EdgeID smaller_edge_id = SPECIAL_EDGEID;
+    int edge_weight = std::numeric_limits<int>::max();
+    for (auto edge = node_array[from].first_edge; edge < node_array[from + 1].first_edge; ++edge)
+    {
+        const auto &data = edges[edge].data;
+        if (edges[edge].target == to && data.forward && data.distance < edge_weight)
+        {
+            smaller_edge_id = edge;
+            edge_weight = data.distance;
+        }
+    }
+    if (SPECIAL_EDGEID == smaller_edge_id)
+    {
+        for (auto edge = node_array[to].first_edge; edge < node_array[to + 1].first_edge; ++edge)
+        {
+            const auto &data = edges[edge].data;
+            if (edges[edge].target == from && data.backward && data.distance < edge_weight)
+            {
+                smaller_edge_id = edge;
+                edge_weight = data.distance;
+            }
+        }
+    }
+    return smaller_edge_id;
 }
 
-namespace osrm
+inline bool CanTraverse(const QueryEdge &edge, const NodeID from, const NodeID to)
 {
-namespace contractor
+    return (edge.source == from && edge.target == to && edge.data.forward) ||
+           (edge.source == to && edge.target == from && edge.data.backward);
+}
+
+// Resolves the children of every shortcut once, so queries can unpack them without searching.
+// Children are only kept if they are valid for every direction the shortcut can be used in.
+template <typename NodeArrayT>
+std::vector<ShortcutChildren>
+ComputeShortcutChildren(const util::DeallocatingVector<QueryEdge> &edges,
+                        const NodeArrayT &node_array)
 {
+    std::vector<ShortcutChildren> shortcut_children(edges.size());
+    tbb::parallel_for(
+        tbb::blocked_range<std::size_t>(0, edges.size()),
+        [&](const tbb::blocked_range<std::size_t> &range)
+        {
+            for (auto edge_id = range.begin(); edge_id != range.end(); ++edge_id)
+            {
+                const QueryEdge &shortcut = edges[edge_id];
+                if (!shortcut.data.shortcut)
+                {
+                    continue;
+                }
+                const NodeID middle = shortcut.data.id;
+                const bool forward = shortcut.data.forward;
+                const EdgeID first =
+                    forward ? FindUnpackingEdge(edges, node_array, shortcut.source, middle)
+                            : FindUnpackingEdge(edges, node_array, middle, shortcut.source);
+                const EdgeID second =
+                    forward ? FindUnpackingEdge(edges, node_array, middle, shortcut.target)
+                            : FindUnpackingEdge(edges, node_array, shortcut.target, middle);
+                if (SPECIAL_EDGEID == first || SPECIAL_EDGEID == second)
+                {
+                    continue;
+                }
 
-int Contractor::Run()
+                const QueryEdge &first_edge = edges[first];
+                const QueryEdge &second_edge = edges[second];
+                const bool valid_forward = !forward ||
+                                           (CanTraverse(first_edge, shortcut.source, middle) &&
+                                            CanTraverse(second_edge, middle, shortcut.target));
+                const bool valid_backward =
+                    !shortcut.data.backward ||
+                    (CanTraverse(second_edge, shortcut.target, middle) &&
+                     CanTraverse(first_edge, middle, shortcut.source));
+                if (first_edge.data.distance + second_edge.data.distance ==
+                        shortcut.data.distance &&
+                    valid_forward && valid_backward)
+                {
+                    shortcut_children[edge_id] = ShortcutChildren(first, second);
+                }
+            }
+        });
+    return shortcut_children;
+}
+}
+
+int Contractor::Run(extractor::EdgeExpandedGraph *edge_expanded_graph)
 {
 #ifdef WIN32
 #pragma message("Memory consumption on Windows can be higher due to different bit packing")
@@ -69,15 +432,39 @@ int Contractor::Run()
 
     TIMER_START(preparing);
 
-    // Create a new lua state
+    util::DeallocatingVector<extractor::EdgeBasedEdge> edge_based_edge_list;
+    std::vector<EdgeWeight> node_weights;
+    std::size_t max_edge_id = SPECIAL_EDGEID;
 
-    util::SimpleLogger().Write() << "Loading edge-expanded graph representation";
+    if (edge_expanded_graph != nullptr)
+    {
+        util::SimpleLogger().Write() << "Using the edge-expanded graph of the extractor";
+        edge_based_edge_list.swap(edge_expanded_graph->edges);
+        node_weights = std::move(edge_expanded_graph->node_weights);
+        max_edge_id = edge_expanded_graph->max_edge_id;
+    }
+    else
+    {
+        util::SimpleLogger().Write() << "Loading edge-expanded graph representation";
+        max_edge_id = LoadEdgeExpandedGraph(config.edge_based_graph_path, edge_based_edge_list);
 
-    util::DeallocatingVector<extractor::EdgeBasedEdge> edge_based_edge_list;
+        util::SimpleLogger().Write() << "Reading node weights.";
+        std::string node_file_name = config.osrm_input_path.string() + ".enw";
+        if (util::deserializeVector(node_file_name, node_weights))
+        {
+            util::SimpleLogger().Write() << "Done reading node weights.";
+        }
+        else
+        {
+            throw util::exception("Failed reading node weights.");
+        }
+    }
 
-    std::size_t max_edge_id = LoadEdgeExpandedGraph(
-        config.edge_based_graph_path, edge_based_edge_list, config.edge_segment_lookup_path,
-        config.edge_penalty_path, config.segment_speed_lookup_path);
+    if (!config.segment_speed_lookup_path.empty())
+    {
+        UpdateEdgeWeights(edge_based_edge_list, config.edge_segment_lookup_path,
+                          config.edge_penalty_path, config.segment_speed_lookup_path);
+    }
 
     // Contracting the edge-expanded graph
 
@@ -89,18 +476,6 @@ int Contractor::Run()
         ReadNodeLevels(node_levels);
     }
 
-    util::SimpleLogger().Write() << "Reading node weights.";
-    std::vector<EdgeWeight> node_weights;
-    std::string node_file_name = config.osrm_input_path.string() + ".enw";
-    if (util::deserializeVector(node_file_name, node_weights))
-    {
-        util::SimpleLogger().Write() << "Done reading node weights.";
-    }
-    else
-    {
-        throw util::exception("Failed reading node weights.");
-    }
-
     util::DeallocatingVector<QueryEdge> contracted_edge_list;
     ContractGraph(max_edge_id, edge_based_edge_list, contracted_edge_list, std::move(node_weights),
                   is_core_node, node_levels);
@@ -129,30 +504,11 @@ int Contractor::Run()
 
 std::size_t Contractor::LoadEdgeExpandedGraph(
     std::string const &edge_based_graph_filename,
-    util::DeallocatingVector<extractor::EdgeBasedEdge> &edge_based_edge_list,
-    const std::string &edge_segment_lookup_filename,
-    const std::string &edge_penalty_filename,
-    const std::string &segment_speed_filename)
+    util::DeallocatingVector<extractor::EdgeBasedEdge> &edge_based_edge_list)
 {
     util::SimpleLogger().Write() << "Opening " << edge_based_graph_filename;
     boost::filesystem::ifstream input_stream(edge_based_graph_filename, std::ios::binary);
 
-    const bool update_edge_weights = segment_speed_filename != "";
-
-    boost::filesystem::ifstream edge_segment_input_stream;
-    boost::filesystem::ifstream edge_fixed_penalties_input_stream;
-
-    if (update_edge_weights)
-    {
-        edge_segment_input_stream.open(edge_segment_lookup_filename, std::ios::binary);
-        edge_fixed_penalties_input_stream.open(edge_penalty_filename, std::ios::binary);
-        if (!edge_segment_input_stream || !edge_fixed_penalties_input_stream)
-        {
-            throw util::exception("Could not load .edge_segment_lookup or .edge_penalties, did you "
-                                  "run osrm-extract with '--generate-edge-lookup'?");
-        }
-    }
-
     const util::FingerPrint fingerprint_valid = util::FingerPrint::GetValid();
     util::FingerPrint fingerprint_loaded;
     input_stream.read((char *)&fingerprint_loaded, sizeof(util::FingerPrint));
@@ -165,101 +521,88 @@ std::size_t Contractor::LoadEdgeExpandedGraph(
     input_stream.read((char *)&number_of_edges, sizeof(std::size_t));
     input_stream.read((char *)&max_edge_id, sizeof(std::size_t));
 
-    edge_based_edge_list.resize(number_of_edges);
     util::SimpleLogger().Write() << "Reading " << number_of_edges
                                  << " edges from the edge based graph";
 
-    std::unordered_map<std::pair<OSMNodeID, OSMNodeID>, unsigned> segment_speed_lookup;
+    const constexpr std::size_t EDGE_BLOCK_SIZE = 1024 * 1024;
+    std::vector<extractor::EdgeBasedEdge> edge_block;
+    while (number_of_edges > 0)
+    {
+        const std::size_t block_size = std::min(number_of_edges, EDGE_BLOCK_SIZE);
+        number_of_edges -= block_size;
+
+        edge_block.resize(block_size);
+        input_stream.read(reinterpret_cast<char *>(edge_block.data()),
+                          block_size * sizeof(extractor::EdgeBasedEdge));
+        edge_based_edge_list.append(edge_block.begin(), edge_block.end());
+    }
 
-    if (update_edge_weights)
+    util::SimpleLogger().Write() << "Done reading edges";
+    return max_edge_id;
+}
+
+void Contractor::UpdateEdgeWeights(
+    util::DeallocatingVector<extractor::EdgeBasedEdge> &edge_based_edge_list,
+    const std::string &edge_segment_lookup_filename,
+    const std::string &edge_penalty_filename,
+    const std::string &segment_speed_filename) const
+{
+    boost::filesystem::ifstream edge_segment_input_stream(edge_segment_lookup_filename,
+                                                          std::ios::binary);
+    boost::filesystem::ifstream edge_fixed_penalties_input_stream(edge_penalty_filename,
+                                                                  std::ios::binary);
+    if (!edge_segment_input_stream || !edge_fixed_penalties_input_stream)
     {
-        util::SimpleLogger().Write()
-            << "Segment speed data supplied, will update edge weights from "
-            << segment_speed_filename;
-        io::CSVReader<3> csv_in(segment_speed_filename);
-        csv_in.set_header("from_node", "to_node", "speed");
-        uint64_t from_node_id{};
-        uint64_t to_node_id{};
-        unsigned speed{};
-        while (csv_in.read_row(from_node_id, to_node_id, speed))
-        {
-            segment_speed_lookup[std::make_pair(OSMNodeID(from_node_id), OSMNodeID(to_node_id))] =
-                speed;
-        }
+        throw util::exception("Could not load .edge_segment_lookup or .edge_penalties, did you "
+                              "run osrm-extract with '--generate-edge-lookup'?");
     }
 
+    util::SimpleLogger().Write() << "Segment speed data supplied, will update edge weights from "
+                                 << segment_speed_filename;
+    TIMER_START(load_speeds);
+    const auto segment_speed_lookup = LoadSegmentSpeeds(segment_speed_filename);
+    TIMER_STOP(load_speeds);
+    util::SimpleLogger().Write() << "Loaded " << segment_speed_lookup.size()
+                                 << " segment speeds in " << TIMER_SEC(load_speeds) << "s";
+
     util::DEBUG_GEOMETRY_START(config);
 
-    // TODO: can we read this in bulk?  util::DeallocatingVector isn't necessarily
-    // all stored contiguously
-    for (; number_of_edges > 0; --number_of_edges)
+    // Edges are updated in blocks. The weights of a block are recomputed in parallel.
+    const constexpr std::size_t EDGE_BLOCK_SIZE = 1024 * 1024;
+    std::vector<unsigned> fixed_penalties;
+    std::vector<std::size_t> segment_offsets;
+    SegmentRecordReader segment_reader(edge_segment_input_stream);
+    for (std::size_t block_begin = 0; block_begin < edge_based_edge_list.size();
+         block_begin += EDGE_BLOCK_SIZE)
     {
-        extractor::EdgeBasedEdge inbuffer;
-        input_stream.read((char *)&inbuffer, sizeof(extractor::EdgeBasedEdge));
-        if (update_edge_weights)
-        {
-            // Processing-time edge updates
-            unsigned fixed_penalty;
-            edge_fixed_penalties_input_stream.read(reinterpret_cast<char *>(&fixed_penalty),
-                                                   sizeof(fixed_penalty));
-
-            int new_weight = 0;
-
-            unsigned num_osm_nodes = 0;
-            edge_segment_input_stream.read(reinterpret_cast<char *>(&num_osm_nodes),
-                                           sizeof(num_osm_nodes));
-            OSMNodeID previous_osm_node_id;
-            edge_segment_input_stream.read(reinterpret_cast<char *>(&previous_osm_node_id),
-                                           sizeof(previous_osm_node_id));
-            OSMNodeID this_osm_node_id;
-            double segment_length;
-            int segment_weight;
-            --num_osm_nodes;
-            for (; num_osm_nodes != 0; --num_osm_nodes)
-            {
-                edge_segment_input_stream.read(reinterpret_cast<char *>(&this_osm_node_id),
-                                               sizeof(this_osm_node_id));
-                edge_segment_input_stream.read(reinterpret_cast<char *>(&segment_length),
-                                               sizeof(segment_length));
-                edge_segment_input_stream.read(reinterpret_cast<char *>(&segment_weight),
-                                               sizeof(segment_weight));
-
-                auto speed_iter = segment_speed_lookup.find(
-                    std::make_pair(previous_osm_node_id, this_osm_node_id));
-                if (speed_iter != segment_speed_lookup.end())
-                {
-                    // This sets the segment weight using the same formula as the
-                    // EdgeBasedGraphFactory for consistency.  The *why* of this formula
-                    // is lost in the annals of time.
-                    int new_segment_weight =
-                        std::max(1, static_cast<int>(std::floor(
-                                        (segment_length * 10.) / (speed_iter->second / 3.6) + .5)));
-                    new_weight += new_segment_weight;
-
-                    util::DEBUG_GEOMETRY_EDGE(new_segment_weight, segment_length,
-                                              previous_osm_node_id, this_osm_node_id);
-                }
-                else
-                {
-                    // If no lookup found, use the original weight value for this segment
-                    new_weight += segment_weight;
+        const std::size_t block_size =
+            std::min(edge_based_edge_list.size() - block_begin, EDGE_BLOCK_SIZE);
 
-                    util::DEBUG_GEOMETRY_EDGE(segment_weight, segment_length, previous_osm_node_id,
-                                              this_osm_node_id);
-                }
+        // Processing-time edge updates
+        fixed_penalties.resize(block_size);
+        edge_fixed_penalties_input_stream.read(reinterpret_cast<char *>(fixed_penalties.data()),
+                                               block_size * sizeof(unsigned));
+        segment_reader.ReadRecords(block_size, segment_offsets);
 
-                previous_osm_node_id = this_osm_node_id;
+        const auto update_weights = [&](const tbb::blocked_range<std::size_t> &range)
+        {
+            for (auto i = range.begin(); i != range.end(); ++i)
+            {
+                const int new_weight = ComputeEdgeWeight(
+                    segment_reader.Data() + segment_offsets[i], segment_speed_lookup);
+                edge_based_edge_list[block_begin + i].weight = fixed_penalties[i] + new_weight;
             }
-
-            inbuffer.weight = fixed_penalty + new_weight;
-        }
-
-        edge_based_edge_list.emplace_back(std::move(inbuffer));
+        };
+#ifdef DEBUG_GEOMETRY
+        // the debug geometry is written in edge order
+        update_weights(tbb::blocked_range<std::size_t>(0, block_size));
+#else
+        tbb::parallel_for(tbb::blocked_range<std::size_t>(0, block_size), update_weights);
+#endif
     }
 
     util::DEBUG_GEOMETRY_STOP();
-    util::SimpleLogger().Write() << "Done reading edges";
-    return max_edge_id;
+    util::SimpleLogger().Write() << "Done updating edge weights";
 }
 
 void Contractor::ReadNodeLevels(std::vector<float> &node_levels) const
@@ -416,6 +759,14 @@ Contractor::WriteContractedGraph(unsigned max_node_id,
         ++number_of_used_edges;
     }
 
+    // optional trailing section, readers that do not know it ignore it
+    util::SimpleLogger().Write() << "Resolving shortcut children";
+    const auto shortcut_children = ComputeShortcutChildren(contracted_edge_list, node_array);
+    const unsigned shortcut_children_size = shortcut_children.size();
+    hsgr_output_stream.write((char *)&shortcut_children_size, sizeof(unsigned));
+    hsgr_output_stream.write((char *)shortcut_children.data(),
+                             sizeof(ShortcutChildren) * shortcut_children.size());
+
     return number_of_used_edges;
 }
 
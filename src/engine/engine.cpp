@@ -1,9 +1,13 @@
 #include "engine/engine.hpp"
+#include "engine/binary_response.hpp"
 #include "engine/engine_config.hpp"
+#include "engine/query_budget.hpp"
+#include "engine/query_statistics.hpp"
 #include "engine/route_parameters.hpp"
 
 #include "engine/plugins/distance_table.hpp"
 #include "engine/plugins/hello_world.hpp"
+#include "engine/plugins/isochrone.hpp"
 #include "engine/plugins/nearest.hpp"
 #include "engine/plugins/timestamp.hpp"
 #include "engine/plugins/trip.hpp"
@@ -25,6 +29,7 @@
 
 #include <algorithm>
 #include <fstream>
+#include <functional>
 #include <utility>
 #include <vector>
 
@@ -34,6 +39,8 @@ namespace engine
 {
 
 Engine::Engine(EngineConfig &config)
+    : max_query_duration(std::max(0, config.max_query_duration)),
+      max_settled_nodes(static_cast<std::uint64_t>(std::max(0, config.max_settled_nodes)))
 {
     if (config.use_shared_memory)
     {
@@ -45,21 +52,27 @@ Engine::Engine(EngineConfig &config)
         // populate base path
         util::populate_base_path(config.server_paths);
         query_data_facade = new datafacade::InternalDataFacade<contractor::QueryEdge::EdgeData>(
-            config.server_paths);
+            config.server_paths, config.use_search_graph);
     }
 
     using DataFacade = datafacade::BaseDataFacade<contractor::QueryEdge::EdgeData>;
 
+    // routes and table rows share the result cache memory evenly
+    const std::size_t result_cache_size =
+        static_cast<std::size_t>(std::max(0, config.max_result_cache_size)) * 1024 * 1024;
+
     // The following plugins handle all requests.
     RegisterPlugin(new plugins::DistanceTablePlugin<DataFacade>(
-        query_data_facade, config.max_locations_distance_table));
+        query_data_facade, config.max_locations_distance_table, config.min_rphast_table_size,
+        result_cache_size / 2));
     RegisterPlugin(new plugins::HelloWorldPlugin());
+    RegisterPlugin(new plugins::IsochronePlugin<DataFacade>(query_data_facade));
     RegisterPlugin(new plugins::NearestPlugin<DataFacade>(query_data_facade));
     RegisterPlugin(new plugins::MapMatchingPlugin<DataFacade>(
         query_data_facade, config.max_locations_map_matching));
     RegisterPlugin(new plugins::TimestampPlugin<DataFacade>(query_data_facade));
-    RegisterPlugin(new plugins::ViaRoutePlugin<DataFacade>(query_data_facade,
-                                                           config.max_locations_viaroute));
+    RegisterPlugin(new plugins::ViaRoutePlugin<DataFacade>(
+        query_data_facade, config.max_locations_viaroute, result_cache_size / 2));
     RegisterPlugin(
         new plugins::RoundTripPlugin<DataFacade>(query_data_facade, config.max_locations_trip));
 }
@@ -82,20 +95,74 @@ int Engine::RunQuery(const RouteParameters &route_parameters,
         return 400;
     }
 
-    osrm::engine::plugins::BasePlugin::Status return_code;
+    return RunPlugin(
+        [&]()
+        {
+            return static_cast<int>(
+                plugin_iterator->second->HandleRequest(route_parameters, json_result));
+        },
+        [&](const char *message)
+        {
+            // partial results of the plugin are dropped
+            json_result.values.clear();
+            json_result.values["status_message"] = message;
+        });
+}
+
+int Engine::RunQuery(const RouteParameters &route_parameters, BinaryResponse &binary_result)
+{
+    const auto &plugin_iterator = plugin_map.find(route_parameters.service);
+
+    int return_code = 400;
+    if (plugin_map.end() == plugin_iterator)
+    {
+        binary_result.WriteStatusMessage("Service not found");
+    }
+    else
+    {
+        return_code = RunPlugin(
+            [&]()
+            {
+                return static_cast<int>(
+                    plugin_iterator->second->HandleBinaryRequest(route_parameters, binary_result));
+            },
+            [&](const char *message)
+            {
+                binary_result.Clear();
+                binary_result.WriteStatusMessage(message);
+            });
+    }
+    binary_result.SetStatus(return_code);
+    return return_code;
+}
+
+int Engine::RunPlugin(const std::function<int()> &handle_request,
+                      const std::function<void(const char *)> &report_abort)
+{
+    int return_code;
+    QueryStatistics::Get().MarkQuery();
     increase_concurrent_query_count();
-    if (barrier) {
-        // Get a shared data lock so that other threads won't update
-        // things while the query is running
-        boost::shared_lock<boost::shared_mutex> data_lock{
-                    (static_cast<datafacade::SharedDataFacade<contractor::QueryEdge::EdgeData> *>(
-                            query_data_facade))->data_mutex};
-        return_code = plugin_iterator->second->HandleRequest(route_parameters, json_result);
-    } else {
-        return_code = plugin_iterator->second->HandleRequest(route_parameters, json_result);
+    try
+    {
+        ScopedQueryBudget budget(max_query_duration, max_settled_nodes);
+        if (barrier) {
+            // Get a shared data lock so that other threads won't update
+            // things while the query is running
+            boost::shared_lock<boost::shared_mutex> data_lock{
+                (static_cast<datafacade::SharedDataFacade<contractor::QueryEdge::EdgeData> *>(
+                     query_data_facade))->data_mutex};
+            return_code = handle_request();
+        } else {
+            return_code = handle_request();
+        }
+    }
+    catch (const QueryAborted &aborted)
+    {
+        report_abort(aborted.what());
+        return_code = static_cast<int>(plugins::BasePlugin::Status::Aborted);
     }
     decrease_concurrent_query_count();
-    return static_cast<int>(return_code);
+    return return_code;
 }
 
 // decrease number of concurrent queries
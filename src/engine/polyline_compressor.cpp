@@ -1,7 +1,9 @@
 #include "engine/polyline_compressor.hpp"
 
+#include <boost/assert.hpp>
+
 #include <cstddef>
-#include <cstdlib>
+#include <cstdint>
 #include <cmath>
 
 namespace osrm
@@ -11,107 +13,116 @@ namespace engine
 namespace /*detail*/ // anonymous to keep TU local
 {
 
-std::string encode(int number_to_encode)
+// every encoded number takes at most seven characters, a coordinate two numbers
+constexpr std::size_t MAX_ENCODED_COORDINATE_LENGTH = 2 * 7;
+
+// coordinates are stored with six decimal places, precision five drops the last one
+int toPrecision(const int value, const unsigned precision)
 {
-    std::string output;
-    while (number_to_encode >= 0x20)
+    if (precision == POLYLINE_PRECISION_6)
     {
-        const int next_value = (0x20 | (number_to_encode & 0x1f)) + 63;
-        output += static_cast<char>(next_value);
-        number_to_encode >>= 5;
+        return value;
     }
+    return static_cast<int>(std::lround(value / 10.));
+}
 
-    number_to_encode += 63;
-    output += static_cast<char>(number_to_encode);
-    return output;
+int fromPrecision(const int value, const unsigned precision)
+{
+    return precision == POLYLINE_PRECISION_6 ? value : value * 10;
 }
 
-std::string encode(std::vector<int> &numbers)
+void encode(const int number_to_encode, std::string &output)
 {
-    std::string output;
-    for (auto &number : numbers)
+    // zigzag, the sign ends up in the lowest bit
+    auto number = static_cast<std::uint32_t>(number_to_encode) << 1;
+    if (number_to_encode < 0)
     {
-        bool isNegative = number < 0;
-
-        if (isNegative)
-        {
-            const unsigned binary = std::llabs(number);
-            const unsigned twos = (~binary) + 1u;
-            number = twos;
-        }
+        number = ~number;
+    }
 
-        number <<= 1u;
+    while (number >= 0x20)
+    {
+        output.push_back(static_cast<char>((0x20 | (number & 0x1f)) + 63));
+        number >>= 5;
+    }
+    output.push_back(static_cast<char>(number + 63));
+}
 
-        if (isNegative)
+// returns false if the input ends within the number
+bool decode(const char *&position, const char *last, int &number)
+{
+    std::uint32_t result = 0;
+    unsigned shift = 0;
+    while (position != last && shift < 32)
+    {
+        const std::uint32_t chunk = static_cast<unsigned char>(*position++) - 63;
+        result |= (chunk & 0x1f) << shift;
+        shift += 5;
+        if (chunk < 0x20)
         {
-            number = ~number;
+            number = static_cast<int>((result >> 1) ^ (0u - (result & 1)));
+            return true;
         }
     }
-    for (const int number : numbers)
-    {
-        output += encode(number);
-    }
-    return output;
+    return false;
 }
 } // anonymous ns
 
-std::string polylineEncode(const std::vector<SegmentInformation> &polyline)
+void polylineEncode(const std::vector<SegmentInformation> &polyline,
+                    const unsigned precision,
+                    std::string &output)
 {
-    if (polyline.empty())
-    {
-        return {};
-    }
+    BOOST_ASSERT(precision == POLYLINE_PRECISION_5 || precision == POLYLINE_PRECISION_6);
+    output.reserve(output.size() + polyline.size() * MAX_ENCODED_COORDINATE_LENGTH / 2);
 
-    std::vector<int> delta_numbers;
-    delta_numbers.reserve((polyline.size() - 1) * 2);
-    util::FixedPointCoordinate previous_coordinate = {0, 0};
+    // deltas are taken after rounding so that rounding errors do not add up along the line
+    int previous_lat = 0;
+    int previous_lon = 0;
     for (const auto &segment : polyline)
     {
         if (segment.necessary)
         {
-            const int lat_diff = segment.location.lat - previous_coordinate.lat;
-            const int lon_diff = segment.location.lon - previous_coordinate.lon;
-            delta_numbers.emplace_back(lat_diff);
-            delta_numbers.emplace_back(lon_diff);
-            previous_coordinate = segment.location;
+            const int lat = toPrecision(segment.location.lat, precision);
+            const int lon = toPrecision(segment.location.lon, precision);
+            encode(lat - previous_lat, output);
+            encode(lon - previous_lon, output);
+            previous_lat = lat;
+            previous_lon = lon;
         }
     }
-    return encode(delta_numbers);
 }
 
-std::vector<util::FixedPointCoordinate> polylineDecode(const std::string &geometry_string)
+std::string polylineEncode(const std::vector<SegmentInformation> &polyline,
+                           const unsigned precision)
 {
+    std::string output;
+    polylineEncode(polyline, precision, output);
+    return output;
+}
+
+std::vector<util::FixedPointCoordinate> polylineDecode(const std::string &geometry_string,
+                                                       const unsigned precision)
+{
+    BOOST_ASSERT(precision == POLYLINE_PRECISION_5 || precision == POLYLINE_PRECISION_6);
     std::vector<util::FixedPointCoordinate> new_coordinates;
-    int index = 0, len = geometry_string.size();
-    int lat = 0, lng = 0;
+    // the shortest coordinate takes two characters
+    new_coordinates.reserve(geometry_string.size() / 2);
 
-    while (index < len)
+    const char *position = geometry_string.data();
+    const char *const last = position + geometry_string.size();
+    int lat = 0;
+    int lon = 0;
+    while (position != last)
     {
-        int b, shift = 0, result = 0;
-        do
+        int lat_diff, lon_diff;
+        if (!decode(position, last, lat_diff) || !decode(position, last, lon_diff))
         {
-            b = geometry_string.at(index++) - 63;
-            result |= (b & 0x1f) << shift;
-            shift += 5;
-        } while (b >= 0x20);
-        int dlat = ((result & 1) != 0 ? ~(result >> 1) : (result >> 1));
-        lat += dlat;
-
-        shift = 0;
-        result = 0;
-        do
-        {
-            b = geometry_string.at(index++) - 63;
-            result |= (b & 0x1f) << shift;
-            shift += 5;
-        } while (b >= 0x20);
-        int dlng = ((result & 1) != 0 ? ~(result >> 1) : (result >> 1));
-        lng += dlng;
-
-        util::FixedPointCoordinate p;
-        p.lat = COORDINATE_PRECISION * (((double)lat / 1E6));
-        p.lon = COORDINATE_PRECISION * (((double)lng / 1E6));
-        new_coordinates.push_back(p);
+            // truncated input, keep the coordinates decoded so far
+            break;
+        }
+        lat += lat_diff;
+        lon += lon_diff;
+        new_coordinates.emplace_back(fromPrecision(lat, precision), fromPrecision(lon, precision));
     }
 
     return new_coordinates;
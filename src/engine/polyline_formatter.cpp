@@ -7,9 +7,12 @@ namespace osrm
 namespace engine
 {
 
-util::json::String polylineEncodeAsJSON(const std::vector<SegmentInformation> &polyline)
+util::json::String polylineEncodeAsJSON(const std::vector<SegmentInformation> &polyline,
+                                        const unsigned precision)
 {
-    return util::json::String(polylineEncode(polyline));
+    util::json::String json_geometry;
+    polylineEncode(polyline, precision, json_geometry.value);
+    return json_geometry;
 }
 
 util::json::Array polylineUnencodedAsJSON(const std::vector<SegmentInformation> &polyline)
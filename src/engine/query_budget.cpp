@@ -0,0 +1,107 @@
+#include "engine/query_budget.hpp"
+
+#include <algorithm>
+#include <limits>
+
+// Visual Studio 2013 does not implement thread_local, but supports POD thread locals
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#define OSRM_THREAD_LOCAL __declspec(thread)
+#else
+#define OSRM_THREAD_LOCAL thread_local
+#endif
+
+namespace osrm
+{
+namespace engine
+{
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+// zero initialized, which is the state outside of a request
+OSRM_THREAD_LOCAL QueryBudget local_budget;
+
+std::int64_t Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               Clock::now().time_since_epoch())
+        .count();
+}
+}
+
+const char *QueryAborted::what() const noexcept
+{
+    switch (reason)
+    {
+    case Reason::TimeLimit:
+        return "Query exceeded the time limit";
+    case Reason::NodeLimit:
+        return "Query exceeded the search space limit";
+    case Reason::Cancelled:
+    default:
+        return "Query was cancelled";
+    }
+}
+
+QueryBudget &QueryBudget::Get() { return local_budget; }
+
+void QueryBudget::SetCancellationFlag(const std::atomic<bool> *flag) { cancelled = flag; }
+
+void QueryBudget::Start(const std::chrono::milliseconds max_duration,
+                        const std::uint64_t max_settled_nodes_)
+{
+    running = true;
+    settled_nodes = 0;
+    max_settled_nodes = max_settled_nodes_;
+    deadline = max_duration.count() > 0
+                   ? Now() + std::chrono::duration_cast<std::chrono::nanoseconds>(max_duration)
+                                 .count()
+                   : 0;
+    next_check = max_settled_nodes > 0 ? std::min(CHECK_INTERVAL, max_settled_nodes)
+                                       : CHECK_INTERVAL;
+}
+
+void QueryBudget::Stop()
+{
+    running = false;
+    next_check = std::numeric_limits<std::uint64_t>::max();
+}
+
+void QueryBudget::Poll()
+{
+    if (running)
+    {
+        Check();
+    }
+}
+
+void QueryBudget::Check()
+{
+    if (!running)
+    {
+        next_check = std::numeric_limits<std::uint64_t>::max();
+        return;
+    }
+
+    if (cancelled != nullptr && cancelled->load(std::memory_order_relaxed))
+    {
+        throw QueryAborted(QueryAborted::Reason::Cancelled);
+    }
+    if (max_settled_nodes > 0 && settled_nodes >= max_settled_nodes)
+    {
+        throw QueryAborted(QueryAborted::Reason::NodeLimit);
+    }
+    if (deadline > 0 && Now() >= deadline)
+    {
+        throw QueryAborted(QueryAborted::Reason::TimeLimit);
+    }
+
+    next_check = settled_nodes + CHECK_INTERVAL;
+    if (max_settled_nodes > 0)
+    {
+        next_check = std::min(next_check, max_settled_nodes);
+    }
+}
+}
+}
@@ -0,0 +1,285 @@
+#include "engine/query_statistics.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+// Visual Studio 2013 does not implement thread_local, but supports POD thread locals
+#if defined(_MSC_VER) && _MSC_VER < 1900
+#define OSRM_THREAD_LOCAL __declspec(thread)
+#else
+#define OSRM_THREAD_LOCAL thread_local
+#endif
+
+namespace osrm
+{
+namespace engine
+{
+
+namespace
+{
+const char *const COUNTER_NAMES[QueryStatistics::NUMBER_OF_COUNTERS] = {
+    "settled_nodes",       "relaxed_edges", "heap_inserts", "stalled_nodes", "unpacked_shortcuts",
+    "snapping_candidates", "cache_hits",    "cache_misses"};
+
+const char *const PHASE_NAMES[QueryStatistics::NUMBER_OF_PHASES] = {
+    "parse", "snap", "search", "unpack", "annotate", "render", "compress"};
+
+// upper bounds of the finite phase buckets
+const std::uint64_t PHASE_BUCKET_NANOSECONDS[QueryStatistics::NUMBER_OF_PHASE_BUCKETS - 1] = {
+    100000,    250000,    500000,     1000000,    2500000,    5000000,    10000000,  25000000,
+    50000000,  100000000, 250000000,  500000000,  1000000000, 2500000000, 5000000000};
+
+std::size_t CounterBucket(const std::uint64_t value)
+{
+    std::size_t bucket = 0;
+    std::uint64_t upper_bound = 1;
+    while (bucket + 1 < QueryStatistics::NUMBER_OF_COUNTER_BUCKETS && value > upper_bound)
+    {
+        upper_bound *= 4;
+        ++bucket;
+    }
+    return bucket;
+}
+
+std::size_t PhaseBucket(const std::uint64_t nanoseconds)
+{
+    return std::lower_bound(std::begin(PHASE_BUCKET_NANOSECONDS),
+                            std::end(PHASE_BUCKET_NANOSECONDS), nanoseconds) -
+           std::begin(PHASE_BUCKET_NANOSECONDS);
+}
+
+// Accumulators are never freed, so their totals outlive the threads that filled them
+struct StatisticsRegistry
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<QueryStatistics>> statistics;
+};
+
+StatisticsRegistry &GetRegistry()
+{
+    static StatisticsRegistry registry;
+    return registry;
+}
+
+OSRM_THREAD_LOCAL QueryStatistics *local_statistics = nullptr;
+
+template <typename HistogramT, typename LabelT>
+void RenderBuckets(std::ostream &output,
+                   const std::string &name,
+                   const std::string &labels,
+                   const std::vector<const HistogramT *> &histograms,
+                   const std::size_t number_of_buckets,
+                   LabelT bucket_label,
+                   const double sum_scale)
+{
+    std::uint64_t cumulative_count = 0;
+    std::uint64_t sum = 0;
+    for (std::size_t bucket = 0; bucket < number_of_buckets; ++bucket)
+    {
+        for (const auto histogram : histograms)
+        {
+            cumulative_count += histogram->buckets[bucket].load(std::memory_order_relaxed);
+        }
+        output << name << "_bucket{" << labels << "le=\"" << bucket_label(bucket) << "\"} "
+               << cumulative_count << "\n";
+    }
+    for (const auto histogram : histograms)
+    {
+        sum += histogram->sum.load(std::memory_order_relaxed);
+    }
+    output << name << "_sum";
+    if (!labels.empty())
+    {
+        output << "{" << labels.substr(0, labels.size() - 1) << "}";
+    }
+    output << " " << sum * sum_scale << "\n";
+    output << name << "_count";
+    if (!labels.empty())
+    {
+        output << "{" << labels.substr(0, labels.size() - 1) << "}";
+    }
+    output << " " << cumulative_count << "\n";
+}
+}
+
+QueryStatistics::QueryStatistics() { BeginRequest(); }
+
+QueryStatistics &QueryStatistics::Get()
+{
+    if (local_statistics == nullptr)
+    {
+        auto &registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.statistics.emplace_back(new QueryStatistics());
+        local_statistics = registry.statistics.back().get();
+    }
+    return *local_statistics;
+}
+
+void QueryStatistics::BeginRequest()
+{
+    request_counters.fill(0);
+    request_phase_nanoseconds.fill(0);
+    request_phases_entered = 0;
+    request_is_query = false;
+    current_phase = QueryPhase::NumberOfPhases;
+    phase_start = Clock::now();
+}
+
+void QueryStatistics::EndRequest()
+{
+    ChargeCurrentPhase(Clock::now());
+    current_phase = QueryPhase::NumberOfPhases;
+    if (!request_is_query)
+    {
+        return;
+    }
+
+    for (std::size_t counter = 0; counter < NUMBER_OF_COUNTERS; ++counter)
+    {
+        const auto value = request_counters[counter];
+        counter_histograms[counter].Observe(CounterBucket(value), value);
+    }
+    for (std::size_t phase = 0; phase < NUMBER_OF_PHASES; ++phase)
+    {
+        if (request_phases_entered & (1u << phase))
+        {
+            const auto nanoseconds = request_phase_nanoseconds[phase];
+            phase_histograms[phase].Observe(PhaseBucket(nanoseconds), nanoseconds);
+        }
+    }
+}
+
+util::json::Object QueryStatistics::RequestStatistics() const
+{
+    util::json::Object json_statistics;
+    for (std::size_t counter = 0; counter < NUMBER_OF_COUNTERS; ++counter)
+    {
+        json_statistics.values[COUNTER_NAMES[counter]] =
+            static_cast<double>(request_counters[counter]);
+    }
+
+    // phases still running (e.g. render and compress) are not included yet
+    util::json::Object json_phases;
+    for (std::size_t phase = 0; phase < NUMBER_OF_PHASES; ++phase)
+    {
+        if (request_phases_entered & (1u << phase))
+        {
+            json_phases.values[PHASE_NAMES[phase]] = request_phase_nanoseconds[phase] / 1e6;
+        }
+    }
+    json_statistics.values["phase_milliseconds"] = json_phases;
+    return json_statistics;
+}
+
+std::string QueryStatistics::RenderMetrics()
+{
+    std::vector<const QueryStatistics *> all_statistics;
+    {
+        auto &registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (const auto &statistics : registry.statistics)
+        {
+            all_statistics.push_back(statistics.get());
+        }
+    }
+
+    std::ostringstream output;
+    output.precision(9);
+
+    using CounterHistogram = Histogram<NUMBER_OF_COUNTER_BUCKETS>;
+    using PhaseHistogram = Histogram<NUMBER_OF_PHASE_BUCKETS>;
+
+    std::uint64_t number_of_requests = 0;
+    for (const auto statistics : all_statistics)
+    {
+        for (const auto &bucket : statistics->counter_histograms.front().buckets)
+        {
+            number_of_requests += bucket.load(std::memory_order_relaxed);
+        }
+    }
+    output << "# HELP osrm_requests_total Queries handed to a plugin.\n"
+           << "# TYPE osrm_requests_total counter\n"
+           << "osrm_requests_total " << number_of_requests << "\n";
+
+    const auto counter_label = [](const std::size_t bucket)
+    {
+        if (bucket + 1 == NUMBER_OF_COUNTER_BUCKETS)
+        {
+            return std::string("+Inf");
+        }
+        return std::to_string(std::uint64_t{1} << (2 * bucket));
+    };
+    for (std::size_t counter = 0; counter < NUMBER_OF_COUNTERS; ++counter)
+    {
+        const std::string name = std::string("osrm_query_") + COUNTER_NAMES[counter];
+        std::vector<const CounterHistogram *> histograms;
+        for (const auto statistics : all_statistics)
+        {
+            histograms.push_back(&statistics->counter_histograms[counter]);
+        }
+        output << "# HELP " << name << " Per request count of " << COUNTER_NAMES[counter]
+               << ".\n";
+        output << "# TYPE " << name << " histogram\n";
+        RenderBuckets(output, name, "", histograms, NUMBER_OF_COUNTER_BUCKETS, counter_label, 1.);
+    }
+
+    const auto phase_label = [](const std::size_t bucket)
+    {
+        if (bucket + 1 == NUMBER_OF_PHASE_BUCKETS)
+        {
+            return std::string("+Inf");
+        }
+        std::ostringstream label;
+        label << PHASE_BUCKET_NANOSECONDS[bucket] / 1e9;
+        return label.str();
+    };
+    output << "# HELP osrm_query_phase_seconds Per request time spent in each phase.\n"
+           << "# TYPE osrm_query_phase_seconds histogram\n";
+    for (std::size_t phase = 0; phase < NUMBER_OF_PHASES; ++phase)
+    {
+        std::vector<const PhaseHistogram *> histograms;
+        for (const auto statistics : all_statistics)
+        {
+            histograms.push_back(&statistics->phase_histograms[phase]);
+        }
+        RenderBuckets(output, "osrm_query_phase_seconds",
+                      std::string("phase=\"") + PHASE_NAMES[phase] + "\",", histograms,
+                      NUMBER_OF_PHASE_BUCKETS, phase_label, 1e-9);
+    }
+
+    return output.str();
+}
+
+QueryPhase QueryStatistics::EnterPhase(const QueryPhase phase)
+{
+    const auto now = Clock::now();
+    ChargeCurrentPhase(now);
+    const auto previous_phase = current_phase;
+    current_phase = phase;
+    request_phases_entered |= 1u << static_cast<std::size_t>(phase);
+    phase_start = now;
+    return previous_phase;
+}
+
+void QueryStatistics::LeavePhase(const QueryPhase previous_phase)
+{
+    const auto now = Clock::now();
+    ChargeCurrentPhase(now);
+    current_phase = previous_phase;
+    phase_start = now;
+}
+
+void QueryStatistics::ChargeCurrentPhase(const Clock::time_point now)
+{
+    if (current_phase != QueryPhase::NumberOfPhases)
+    {
+        request_phase_nanoseconds[static_cast<std::size_t>(current_phase)] +=
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - phase_start).count();
+    }
+}
+}
+}
@@ -13,8 +13,9 @@ namespace engine
 
 RouteParameters::RouteParameters()
     : zoom_level(18), print_instructions(false), alternate_route(true), geometry(true),
-      compression(true), deprecatedAPI(false), uturn_default(false), classify(false),
-      matching_beta(5), gps_precision(5), check_sum(-1), num_results(1)
+      compression(true), polyline_precision(POLYLINE_PRECISION_6), debug_stats(false),
+      deprecatedAPI(false), uturn_default(false), classify(false), matching_beta(5),
+      gps_precision(5), max_duration(0), check_sum(-1), num_results(1)
 {
 }
 
@@ -68,6 +69,8 @@ void RouteParameters::SetMatchingBeta(const double beta) { matching_beta = beta;
 
 void RouteParameters::SetGPSPrecision(const double precision) { gps_precision = precision; }
 
+void RouteParameters::SetMaxDuration(const unsigned duration) { max_duration = duration; }
+
 void RouteParameters::SetOutputFormat(const std::string &format) { output_format = format; }
 
 void RouteParameters::SetJSONpParameter(const std::string &parameter)
@@ -112,6 +115,18 @@ void RouteParameters::SetGeometryFlag(const bool flag) { geometry = flag; }
 
 void RouteParameters::SetCompressionFlag(const bool flag) { compression = flag; }
 
+bool RouteParameters::SetPolylinePrecision(const unsigned precision)
+{
+    if (POLYLINE_PRECISION_5 != precision && POLYLINE_PRECISION_6 != precision)
+    {
+        return false;
+    }
+    polyline_precision = precision;
+    return true;
+}
+
+void RouteParameters::SetDebugStatsFlag(const bool flag) { debug_stats = flag; }
+
 void RouteParameters::AddCoordinate(const double latitude, const double longitude)
 {
     coordinates.emplace_back(
@@ -142,9 +157,17 @@ void RouteParameters::AddSource(const double latitude, const double longitude)
     uturns.push_back(uturn_default);
 }
 
-void RouteParameters::SetCoordinatesFromGeometry(const std::string &geometry_string)
+void RouteParameters::SetCoordinatesFromGeometry(const std::string &geometry)
 {
-    coordinates = polylineDecode(geometry_string);
+    geometry_string = geometry;
+}
+
+void RouteParameters::DecodeGeometry()
+{
+    if (!geometry_string.empty())
+    {
+        coordinates = polylineDecode(geometry_string, polyline_precision);
+    }
 }
 }
 }
@@ -1,189 +1,119 @@
 #include "extractor/compressed_edge_container.hpp"
+#include "util/integer_range.hpp"
+#include "util/osrm_exception.hpp"
+#include "util/packed_geometry.hpp"
 #include "util/simple_logger.hpp"
 
 #include <boost/assert.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
 
+#include <algorithm>
 #include <limits>
 #include <string>
-
-#include <iostream>
+#include <utility>
 
 namespace osrm
 {
 namespace extractor
 {
 
-CompressedEdgeContainer::CompressedEdgeContainer()
-{
-    m_free_list.reserve(100);
-    IncreaseFreeList();
-}
+CompressedEdgeContainer::CompressedEdgeContainer() : m_geometry_offsets(1, 0) {}
 
-void CompressedEdgeContainer::IncreaseFreeList()
+void CompressedEdgeContainer::SetGeometries(std::vector<EdgeID> edge_ids,
+                                            std::vector<std::size_t> offsets,
+                                            std::vector<CompressedNode> nodes)
 {
-    m_compressed_geometries.resize(m_compressed_geometries.size() + 100);
-    for (unsigned i = 100; i > 0; --i)
+    BOOST_ASSERT(offsets.size() == edge_ids.size() + 1);
+    BOOST_ASSERT(offsets.front() == 0 && offsets.back() == nodes.size());
+    if (edge_ids.size() >= std::numeric_limits<unsigned>::max())
+    {
+        throw util::exception("Too many compressed edges");
+    }
+
+    m_compressed_nodes = std::move(nodes);
+    m_geometry_offsets = std::move(offsets);
+
+    const auto max_edge_id = std::max_element(edge_ids.begin(), edge_ids.end());
+    m_edge_id_to_position.clear();
+    m_edge_id_to_position.resize(edge_ids.empty() ? 0 : *max_edge_id + 1, SPECIAL_EDGEID);
+    for (const auto position : util::irange<std::size_t>(0, edge_ids.size()))
     {
-        m_free_list.emplace_back(free_list_maximum);
-        ++free_list_maximum;
+        BOOST_ASSERT(SPECIAL_EDGEID == m_edge_id_to_position[edge_ids[position]]);
+        BOOST_ASSERT(m_geometry_offsets[position] < m_geometry_offsets[position + 1]);
+        m_edge_id_to_position[edge_ids[position]] = static_cast<unsigned>(position);
     }
 }
 
 bool CompressedEdgeContainer::HasEntryForID(const EdgeID edge_id) const
 {
-    auto iter = m_edge_id_to_list_index_map.find(edge_id);
-    return iter != m_edge_id_to_list_index_map.end();
+    return edge_id < m_edge_id_to_position.size() &&
+           SPECIAL_EDGEID != m_edge_id_to_position[edge_id];
 }
 
 unsigned CompressedEdgeContainer::GetPositionForID(const EdgeID edge_id) const
 {
-    auto map_iterator = m_edge_id_to_list_index_map.find(edge_id);
-    BOOST_ASSERT(map_iterator != m_edge_id_to_list_index_map.end());
-    BOOST_ASSERT(map_iterator->second < m_compressed_geometries.size());
-    return map_iterator->second;
+    BOOST_ASSERT(HasEntryForID(edge_id));
+    return m_edge_id_to_position[edge_id];
 }
 
 void CompressedEdgeContainer::SerializeInternalVector(const std::string &path) const
 {
-
-    boost::filesystem::fstream geometry_out_stream(path, std::ios::binary | std::ios::out);
-    const unsigned compressed_geometries = m_compressed_geometries.size() + 1;
-    BOOST_ASSERT(std::numeric_limits<unsigned>::max() != compressed_geometries);
-    geometry_out_stream.write((char *)&compressed_geometries, sizeof(unsigned));
-
-    // write indices array
-    unsigned prefix_sum_of_list_indices = 0;
-    for (const auto &elem : m_compressed_geometries)
-    {
-        geometry_out_stream.write((char *)&prefix_sum_of_list_indices, sizeof(unsigned));
-
-        const std::vector<CompressedNode> &current_vector = elem;
-        const unsigned unpacked_size = current_vector.size();
-        BOOST_ASSERT(std::numeric_limits<unsigned>::max() != unpacked_size);
-        prefix_sum_of_list_indices += unpacked_size;
-    }
-    // sentinel element
-    geometry_out_stream.write((char *)&prefix_sum_of_list_indices, sizeof(unsigned));
-
-    // number of geometry entries to follow, it is the (inclusive) prefix sum
-    geometry_out_stream.write((char *)&prefix_sum_of_list_indices, sizeof(unsigned));
-
-    unsigned control_sum = 0;
-    // write compressed geometries
-    for (auto &elem : m_compressed_geometries)
+    // geometries are packed with util::AppendPackedGeometryNode, indices are byte offsets
+    const auto number_of_geometries = m_geometry_offsets.size() - 1;
+    std::vector<unsigned> geometry_indices;
+    geometry_indices.reserve(number_of_geometries + 1);
+    std::vector<unsigned char> packed_geometries;
+    packed_geometries.reserve(m_compressed_nodes.size() * 2);
+    for (const auto position : util::irange<std::size_t>(0, number_of_geometries))
     {
-        const std::vector<CompressedNode> &current_vector = elem;
-        const unsigned unpacked_size = current_vector.size();
-        control_sum += unpacked_size;
-        BOOST_ASSERT(std::numeric_limits<unsigned>::max() != unpacked_size);
-        for (const CompressedNode current_node : current_vector)
+        geometry_indices.push_back(packed_geometries.size());
+        NodeID previous_node = 0;
+        for (const auto index :
+             util::irange(m_geometry_offsets[position], m_geometry_offsets[position + 1]))
         {
-            geometry_out_stream.write((char *)&(current_node.first), sizeof(NodeID));
+            const NodeID node = m_compressed_nodes[index].first;
+            util::AppendPackedGeometryNode(previous_node, node, packed_geometries);
+            previous_node = node;
         }
-    }
-    BOOST_ASSERT(control_sum == prefix_sum_of_list_indices);
-    // all done, let's close the resource
-    geometry_out_stream.close();
-}
-
-void CompressedEdgeContainer::CompressEdge(const EdgeID edge_id_1,
-                                           const EdgeID edge_id_2,
-                                           const NodeID via_node_id,
-                                           const NodeID target_node_id,
-                                           const EdgeWeight weight1,
-                                           const EdgeWeight weight2)
-{
-    // remove super-trivial geometries
-    BOOST_ASSERT(SPECIAL_EDGEID != edge_id_1);
-    BOOST_ASSERT(SPECIAL_EDGEID != edge_id_2);
-    BOOST_ASSERT(SPECIAL_NODEID != via_node_id);
-    BOOST_ASSERT(SPECIAL_NODEID != target_node_id);
-    BOOST_ASSERT(INVALID_EDGE_WEIGHT != weight1);
-    BOOST_ASSERT(INVALID_EDGE_WEIGHT != weight2);
-
-    // append list of removed edge_id plus via node to surviving edge id:
-    // <surv_1, .. , surv_n, via_node_id, rem_1, .. rem_n
-    //
-    // General scheme:
-    // 1. append via node id to list of edge_id_1
-    // 2. find list for edge_id_2, if yes add all elements and delete it
-
-    // Add via node id. List is created if it does not exist
-    if (!HasEntryForID(edge_id_1))
-    {
-        // create a new entry in the map
-        if (0 == m_free_list.size())
+        if (packed_geometries.size() > std::numeric_limits<unsigned>::max())
         {
-            // make sure there is a place to put the entries
-            IncreaseFreeList();
+            throw util::exception("Packed geometries exceed the 4GiB offset range");
         }
-        BOOST_ASSERT(!m_free_list.empty());
-        m_edge_id_to_list_index_map[edge_id_1] = m_free_list.back();
-        m_free_list.pop_back();
     }
+    // sentinel element
+    geometry_indices.push_back(packed_geometries.size());
 
-    // find bucket index
-    const auto iter = m_edge_id_to_list_index_map.find(edge_id_1);
-    BOOST_ASSERT(iter != m_edge_id_to_list_index_map.end());
-    const unsigned edge_bucket_id1 = iter->second;
-    BOOST_ASSERT(edge_bucket_id1 == GetPositionForID(edge_id_1));
-    BOOST_ASSERT(edge_bucket_id1 < m_compressed_geometries.size());
-
-    std::vector<CompressedNode> &edge_bucket_list1 = m_compressed_geometries[edge_bucket_id1];
+    boost::filesystem::fstream geometry_out_stream(path, std::ios::binary | std::ios::out);
+    const unsigned compressed_geometries = geometry_indices.size();
+    BOOST_ASSERT(std::numeric_limits<unsigned>::max() != compressed_geometries);
+    geometry_out_stream.write((char *)&compressed_geometries, sizeof(unsigned));
 
-    // note we don't save the start coordinate: it is implicitly given by edge 1
-    // weight1 is the distance to the (currently) last coordinate in the bucket
-    if (edge_bucket_list1.empty())
-    {
-        edge_bucket_list1.emplace_back(via_node_id, weight1);
-    }
+    // write indices array
+    geometry_out_stream.write((char *)geometry_indices.data(),
+                              geometry_indices.size() * sizeof(unsigned));
 
-    BOOST_ASSERT(0 < edge_bucket_list1.size());
-    BOOST_ASSERT(!edge_bucket_list1.empty());
+    // number of bytes to follow, it is the sentinel offset
+    const unsigned packed_size = packed_geometries.size();
+    geometry_out_stream.write((char *)&packed_size, sizeof(unsigned));
 
-    if (HasEntryForID(edge_id_2))
-    {
-        // second edge is not atomic anymore
-        const unsigned list_to_remove_index = GetPositionForID(edge_id_2);
-        BOOST_ASSERT(list_to_remove_index < m_compressed_geometries.size());
-
-        std::vector<CompressedNode> &edge_bucket_list2 =
-            m_compressed_geometries[list_to_remove_index];
-
-        // found an existing list, append it to the list of edge_id_1
-        edge_bucket_list1.insert(edge_bucket_list1.end(), edge_bucket_list2.begin(),
-                                 edge_bucket_list2.end());
-
-        // remove the list of edge_id_2
-        m_edge_id_to_list_index_map.erase(edge_id_2);
-        BOOST_ASSERT(m_edge_id_to_list_index_map.end() ==
-                     m_edge_id_to_list_index_map.find(edge_id_2));
-        edge_bucket_list2.clear();
-        BOOST_ASSERT(0 == edge_bucket_list2.size());
-        m_free_list.emplace_back(list_to_remove_index);
-        BOOST_ASSERT(list_to_remove_index == m_free_list.back());
-    }
-    else
-    {
-        // we are certain that the second edge is atomic.
-        edge_bucket_list1.emplace_back(target_node_id, weight2);
-    }
+    // write packed geometries
+    geometry_out_stream.write((char *)packed_geometries.data(), packed_geometries.size());
+    // all done, let's close the resource
+    geometry_out_stream.close();
 }
 
 void CompressedEdgeContainer::PrintStatistics() const
 {
-    const uint64_t compressed_edges = m_compressed_geometries.size();
+    const uint64_t compressed_edges = m_geometry_offsets.size() - 1;
     BOOST_ASSERT(0 == compressed_edges % 2);
-    BOOST_ASSERT(m_compressed_geometries.size() + m_free_list.size() > 0);
 
-    uint64_t compressed_geometries = 0;
+    const uint64_t compressed_geometries = m_compressed_nodes.size();
     uint64_t longest_chain_length = 0;
-    for (const std::vector<CompressedNode> &current_vector : m_compressed_geometries)
+    for (const auto position : util::irange<std::size_t>(0, compressed_edges))
     {
-        compressed_geometries += current_vector.size();
-        longest_chain_length = std::max(longest_chain_length, (uint64_t)current_vector.size());
+        longest_chain_length = std::max<uint64_t>(
+            longest_chain_length, m_geometry_offsets[position + 1] - m_geometry_offsets[position]);
     }
 
     util::SimpleLogger().Write()
@@ -196,11 +126,13 @@ void CompressedEdgeContainer::PrintStatistics() const
         << (float)compressed_geometries / std::max((uint64_t)1, compressed_edges);
 }
 
-const CompressedEdgeContainer::EdgeBucket &
+CompressedEdgeContainer::EdgeBucket
 CompressedEdgeContainer::GetBucketReference(const EdgeID edge_id) const
 {
-    const unsigned index = m_edge_id_to_list_index_map.at(edge_id);
-    return m_compressed_geometries.at(index);
+    const auto position = GetPositionForID(edge_id);
+    return boost::make_iterator_range(
+        m_compressed_nodes.begin() + m_geometry_offsets[position],
+        m_compressed_nodes.begin() + m_geometry_offsets[position + 1]);
 }
 
 NodeID CompressedEdgeContainer::GetFirstEdgeTargetID(const EdgeID edge_id) const
@@ -7,6 +7,7 @@
 #include "extractor/extractor_callbacks.hpp"
 #include "extractor/restriction_parser.hpp"
 #include "extractor/scripting_environment.hpp"
+#include "extractor/way_result_cache.hpp"
 
 #include "extractor/raster_source.hpp"
 #include "util/io.hpp"
@@ -23,7 +24,7 @@
 #include "extractor/compressed_edge_container.hpp"
 #include "extractor/restriction_map.hpp"
 
-#include "extractor/tarjan_scc.hpp"
+#include "extractor/parallel_scc.hpp"
 
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
@@ -65,6 +66,9 @@ namespace extractor
  *  - discarding all tag information: All relevant type information for nodes/ways
  *    is extracted at this point.
  *
+ * If edge_expanded_graph is given, the edge-expanded graph and its node weights are moved into it
+ * for the contractor instead of being read back from disk.
+ *
  * The result of this process are the following files:
  *  .names : Names of all streets, stored as long consecutive string with prefix sum based index
  *  .osrm  : Nodes and edges in a intermediate format that easy to digest for osrm-prepare
@@ -72,7 +76,7 @@ namespace extractor
  * graph
  *
  */
-int Extractor::run()
+int Extractor::run(EdgeExpandedGraph *edge_expanded_graph)
 {
     try
     {
@@ -144,6 +148,14 @@ int Extractor::run()
         // setup restriction parser
         const RestrictionParser restriction_parser(scripting_environment.GetLuaState());
 
+        // profiles declaring the tags their way_function reads get its results memoized
+        WayResultCache way_result_cache(util::lua_string_list(segment_state, "way_cache_keys"));
+        if (way_result_cache.Enabled())
+        {
+            util::SimpleLogger().Write() << "Caching way_function results by the profile's "
+                                            "way_cache_keys";
+        }
+
         while (const osmium::memory::Buffer buffer = reader.read())
         {
             // create a vector of iterators into the buffer
@@ -183,14 +195,19 @@ int Extractor::run()
                             resulting_nodes.push_back(std::make_pair(x, result_node));
                             break;
                         case osmium::item_type::way:
-                            result_way.clear();
+                        {
                             ++number_of_ways;
-                            luabind::call_function<void>(
-                                local_state, "way_function",
-                                boost::cref(static_cast<const osmium::Way &>(*entity)),
-                                boost::ref(result_way));
+                            const auto &way = static_cast<const osmium::Way &>(*entity);
+                            way_result_cache.Get(way, result_way, [&](ExtractionWay &result)
+                                                 {
+                                                     result.clear();
+                                                     luabind::call_function<void>(
+                                                         local_state, "way_function",
+                                                         boost::cref(way), boost::ref(result));
+                                                 });
                             resulting_ways.push_back(std::make_pair(x, result_way));
                             break;
+                        }
                         case osmium::item_type::relation:
                             ++number_of_relations;
                             resulting_restrictions.push_back(restriction_parser.TryParse(
@@ -228,6 +245,12 @@ int Extractor::run()
                                      << " nodes, " << number_of_ways.load() << " ways, and "
                                      << number_of_relations.load() << " relations, and "
                                      << number_of_others.load() << " unknown entities";
+        if (way_result_cache.Enabled())
+        {
+            util::SimpleLogger().Write() << "way_function was called for "
+                                         << way_result_cache.Misses() << " ways, "
+                                         << way_result_cache.Hits() << " were cached";
+        }
 
         extractor_callbacks.reset();
 
@@ -277,13 +300,16 @@ int Extractor::run()
 
         TIMER_STOP(expansion);
 
-        util::SimpleLogger().Write() << "Saving edge-based node weights to file.";
-        TIMER_START(timer_write_node_weights);
-        util::serializeVector(config.edge_based_node_weights_output_path,
+        if (config.write_edge_expanded_graph)
+        {
+            util::SimpleLogger().Write() << "Saving edge-based node weights to file.";
+            TIMER_START(timer_write_node_weights);
+            util::serializeVector(config.edge_based_node_weights_output_path,
                                   edge_based_node_weights);
-        TIMER_STOP(timer_write_node_weights);
-        util::SimpleLogger().Write() << "Done writing. (" << TIMER_SEC(timer_write_node_weights)
-                                     << ")";
+            TIMER_STOP(timer_write_node_weights);
+            util::SimpleLogger().Write() << "Done writing. ("
+                                         << TIMER_SEC(timer_write_node_weights) << ")";
+        }
 
         util::SimpleLogger().Write() << "building r-tree ...";
         TIMER_START(rtree);
@@ -298,13 +324,28 @@ int Extractor::run()
         util::SimpleLogger().Write() << "writing node map ...";
         WriteNodeMapping(internal_to_external_node_map);
 
-        WriteEdgeBasedGraph(config.edge_graph_output_path, max_edge_id, edge_based_edge_list);
+        if (config.write_edge_expanded_graph)
+        {
+            WriteEdgeBasedGraph(config.edge_graph_output_path, max_edge_id,
+                                edge_based_edge_list);
+        }
 
         util::SimpleLogger().Write()
             << "Expansion  : " << (number_of_node_based_nodes / TIMER_SEC(expansion))
             << " nodes/sec and " << ((max_edge_id + 1) / TIMER_SEC(expansion)) << " edges/sec";
-        util::SimpleLogger().Write() << "To prepare the data for routing, run: "
-                                     << "./osrm-prepare " << config.output_file_name << std::endl;
+
+        if (edge_expanded_graph != nullptr)
+        {
+            edge_expanded_graph->max_edge_id = max_edge_id;
+            edge_expanded_graph->edges.swap(edge_based_edge_list);
+            edge_expanded_graph->node_weights = std::move(edge_based_node_weights);
+        }
+        else
+        {
+            util::SimpleLogger().Write() << "To prepare the data for routing, run: "
+                                         << "./osrm-prepare " << config.output_file_name
+                                         << std::endl;
+        }
     }
     catch (const std::exception &e)
     {
@@ -415,7 +456,7 @@ void Extractor::FindComponents(unsigned max_edge_id,
 
     auto uncontractor_graph = std::make_shared<UncontractedGraph>(max_edge_id + 1, edges);
 
-    TarjanSCC<UncontractedGraph> component_search(
+    ParallelSCC<UncontractedGraph> component_search(
         std::const_pointer_cast<const UncontractedGraph>(uncontractor_graph));
     component_search.run();
 
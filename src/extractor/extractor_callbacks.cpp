@@ -128,16 +128,22 @@ void ExtractorCallbacks::ProcessWay(const osmium::Way &input_way, const Extracti
         return;
     }
 
-    // Get the unique identifier for the street name
-    const auto &string_map_iterator = string_map.find(parsed_way.name);
+    // Get the unique identifier for the street name. Names are stored with at most 255 bytes,
+    // names that only differ after that share the stored one.
+    std::string truncated_name;
+    if (parsed_way.name.size() > 255u)
+    {
+        truncated_name = parsed_way.name.substr(0, 255u);
+    }
+    const std::string &name = truncated_name.empty() ? parsed_way.name : truncated_name;
+    const auto &string_map_iterator = string_map.find(name);
     unsigned name_id = external_memory.name_lengths.size();
     if (string_map.end() == string_map_iterator)
     {
-        auto name_length = std::min<unsigned>(255u, parsed_way.name.size());
-        std::copy(parsed_way.name.c_str(), parsed_way.name.c_str() + name_length,
+        std::copy(name.c_str(), name.c_str() + name.size(),
                   std::back_inserter(external_memory.name_char_data));
-        external_memory.name_lengths.push_back(name_length);
-        string_map.insert(std::make_pair(parsed_way.name, name_id));
+        external_memory.name_lengths.push_back(name.size());
+        string_map.insert(std::make_pair(name, name_id));
     }
     else
     {
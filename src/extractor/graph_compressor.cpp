@@ -3,165 +3,485 @@
 #include "extractor/compressed_edge_container.hpp"
 #include "extractor/restriction_map.hpp"
 #include "util/dynamic_graph.hpp"
+#include "util/integer_range.hpp"
 #include "util/node_based_graph.hpp"
-#include "util/percent.hpp"
 
 #include "util/simple_logger.hpp"
 
+#include <boost/assert.hpp>
+
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
 namespace osrm
 {
 namespace extractor
 {
 
-GraphCompressor::GraphCompressor(SpeedProfileProperties speed_profile)
-    : speed_profile(std::move(speed_profile))
+namespace
 {
+
+using Graph = util::NodeBasedDynamicGraph;
+using CompressedNode = CompressedEdgeContainer::CompressedNode;
+
+// A maximal path source, first_node, .., last_node, target whose inner nodes can be removed
+//
+//    first_edge                                    reverse_edge
+// source ----------> first_node ... last_node <---------- target
+//
+// Both edges survive the compression and get the whole path as their geometry.
+struct CompressibleChain
+{
+    NodeID source;
+    NodeID target;
+    EdgeID first_edge;
+    EdgeID reverse_edge;
+    NodeID first_node;
+    NodeID last_node;
+    // number of inner nodes
+    unsigned length;
+    // the inner nodes with the largest ids, they are kept if the chain cannot be compressed fully
+    NodeID largest_node;
+    NodeID second_largest_node;
+    EdgeWeight forward_weight;
+    EdgeWeight reverse_weight;
+
+    bool operator<(const CompressibleChain &other) const
+    {
+        return std::tie(source, target, first_edge) <
+               std::tie(other.source, other.target, other.first_edge);
+    }
+};
+
+// The neighbour of a node of degree two that is not the given one
+EdgeID OtherEdge(const Graph &graph, const NodeID node, const NodeID neighbour)
+{
+    BOOST_ASSERT(2 == graph.GetOutDegree(node));
+    const EdgeID first_edge = graph.BeginEdges(node);
+    return graph.GetTarget(first_edge) == neighbour ? first_edge + 1 : first_edge;
 }
 
-void GraphCompressor::Compress(const std::unordered_set<NodeID> &barrier_nodes,
-                               const std::unordered_set<NodeID> &traffic_lights,
-                               RestrictionMap &restriction_map,
-                               util::NodeBasedDynamicGraph &graph,
-                               CompressedEdgeContainer &geometry_compressor)
+//    reverse_e2   forward_e2
+// u <---------- v -----------> w
+//    ----------> <-----------
+//    forward_e1   reverse_e1
+//
+// Will be compressed to:
+//
+//    reverse_e1
+// u <---------- w
+//    ---------->
+//    forward_e1
+//
+// If the edges are compatible. The check is symmetric in u and w and only looks at the
+// neighbourhood of v, whether u and w are connected already is checked for whole chains.
+bool IsCompressible(const Graph &graph,
+                    const std::unordered_set<NodeID> &barrier_nodes,
+                    const RestrictionMap &restriction_map,
+                    const NodeID node_v)
 {
-    const unsigned original_number_of_nodes = graph.GetNumberOfNodes();
-    const unsigned original_number_of_edges = graph.GetNumberOfEdges();
+    // only contract degree 2 vertices
+    if (2 != graph.GetOutDegree(node_v))
+    {
+        return false;
+    }
 
-    util::Percent progress(original_number_of_nodes);
+    // don't contract barrier node
+    if (barrier_nodes.end() != barrier_nodes.find(node_v))
+    {
+        return false;
+    }
 
-    for (const NodeID node_v : util::irange(0u, original_number_of_nodes))
+    // check if v is a via node for a turn restriction, i.e. a 'directed' barrier node
+    if (restriction_map.IsViaNode(node_v))
     {
-        progress.printStatus(node_v);
+        return false;
+    }
 
-        // only contract degree 2 vertices
-        if (2 != graph.GetOutDegree(node_v))
-        {
-            continue;
-        }
+    const bool reverse_edge_order = graph.GetEdgeData(graph.BeginEdges(node_v)).reversed;
+    const EdgeID forward_e2 = graph.BeginEdges(node_v) + reverse_edge_order;
+    const EdgeID reverse_e2 = graph.BeginEdges(node_v) + 1 - reverse_edge_order;
 
-        // don't contract barrier node
-        if (barrier_nodes.end() != barrier_nodes.find(node_v))
-        {
-            continue;
-        }
+    const NodeID node_w = graph.GetTarget(forward_e2);
+    const NodeID node_u = graph.GetTarget(reverse_e2);
+    BOOST_ASSERT(node_u != node_v && node_w != node_v);
+    // both edges lead to the same node, compressing would create a loop
+    if (node_u == node_w)
+    {
+        return false;
+    }
+
+    const EdgeID forward_e1 = graph.FindEdge(node_u, node_v);
+    const EdgeID reverse_e1 = graph.FindEdge(node_w, node_v);
+    if (SPECIAL_EDGEID == forward_e1 || SPECIAL_EDGEID == reverse_e1)
+    {
+        return false;
+    }
+
+    const auto &fwd_edge_data1 = graph.GetEdgeData(forward_e1);
+    const auto &rev_edge_data1 = graph.GetEdgeData(reverse_e1);
+    const auto &fwd_edge_data2 = graph.GetEdgeData(forward_e2);
+    const auto &rev_edge_data2 = graph.GetEdgeData(reverse_e2);
+
+    // this case can happen if two ways with different names overlap
+    if (fwd_edge_data1.name_id != rev_edge_data1.name_id ||
+        fwd_edge_data2.name_id != rev_edge_data2.name_id)
+    {
+        return false;
+    }
+
+    return fwd_edge_data1.IsCompatibleTo(fwd_edge_data2) &&
+           rev_edge_data1.IsCompatibleTo(rev_edge_data2);
+}
 
-        // check if v is a via node for a turn restriction, i.e. a 'directed' barrier node
-        if (restriction_map.IsViaNode(node_v))
+// Follows the compressible nodes from source over first_edge. Every chain is found from both of
+// its ends, only the walk from the smaller end is kept.
+bool WalkChain(const Graph &graph,
+               const std::vector<std::uint8_t> &is_compressible,
+               const NodeID source,
+               const EdgeID first_edge,
+               CompressibleChain &chain)
+{
+    chain.source = source;
+    chain.first_edge = first_edge;
+    chain.first_node = graph.GetTarget(first_edge);
+    chain.length = 0;
+    chain.largest_node = SPECIAL_NODEID;
+    chain.second_largest_node = SPECIAL_NODEID;
+
+    NodeID previous = source;
+    NodeID current = chain.first_node;
+    while (is_compressible[current])
+    {
+        ++chain.length;
+        if (SPECIAL_NODEID == chain.largest_node || current > chain.largest_node)
         {
-            continue;
+            chain.second_largest_node = chain.largest_node;
+            chain.largest_node = current;
         }
-
-        //    reverse_e2   forward_e2
-        // u <---------- v -----------> w
-        //    ----------> <-----------
-        //    forward_e1   reverse_e1
-        //
-        // Will be compressed to:
-        //
-        //    reverse_e1
-        // u <---------- w
-        //    ---------->
-        //    forward_e1
-        //
-        // If the edges are compatible.
-
-        const bool reverse_edge_order = graph.GetEdgeData(graph.BeginEdges(node_v)).reversed;
-        const EdgeID forward_e2 = graph.BeginEdges(node_v) + reverse_edge_order;
-        BOOST_ASSERT(SPECIAL_EDGEID != forward_e2);
-        BOOST_ASSERT(forward_e2 >= graph.BeginEdges(node_v) && forward_e2 < graph.EndEdges(node_v));
-        const EdgeID reverse_e2 = graph.BeginEdges(node_v) + 1 - reverse_edge_order;
-        BOOST_ASSERT(SPECIAL_EDGEID != reverse_e2);
-        BOOST_ASSERT(reverse_e2 >= graph.BeginEdges(node_v) && reverse_e2 < graph.EndEdges(node_v));
-
-        const EdgeData &fwd_edge_data2 = graph.GetEdgeData(forward_e2);
-        const EdgeData &rev_edge_data2 = graph.GetEdgeData(reverse_e2);
-
-        const NodeID node_w = graph.GetTarget(forward_e2);
-        BOOST_ASSERT(SPECIAL_NODEID != node_w);
-        BOOST_ASSERT(node_v != node_w);
-        const NodeID node_u = graph.GetTarget(reverse_e2);
-        BOOST_ASSERT(SPECIAL_NODEID != node_u);
-        BOOST_ASSERT(node_u != node_v);
-
-        const EdgeID forward_e1 = graph.FindEdge(node_u, node_v);
-        BOOST_ASSERT(SPECIAL_EDGEID != forward_e1);
-        BOOST_ASSERT(node_v == graph.GetTarget(forward_e1));
-        const EdgeID reverse_e1 = graph.FindEdge(node_w, node_v);
-        BOOST_ASSERT(SPECIAL_EDGEID != reverse_e1);
-        BOOST_ASSERT(node_v == graph.GetTarget(reverse_e1));
-
-        const EdgeData &fwd_edge_data1 = graph.GetEdgeData(forward_e1);
-        const EdgeData &rev_edge_data1 = graph.GetEdgeData(reverse_e1);
-
-        if (graph.FindEdgeInEitherDirection(node_u, node_w) != SPECIAL_EDGEID)
+        else if (SPECIAL_NODEID == chain.second_largest_node || current > chain.second_largest_node)
         {
-            continue;
+            chain.second_largest_node = current;
         }
 
-        // this case can happen if two ways with different names overlap
-        if (fwd_edge_data1.name_id != rev_edge_data1.name_id ||
-            fwd_edge_data2.name_id != rev_edge_data2.name_id)
+        const NodeID next = graph.GetTarget(OtherEdge(graph, current, previous));
+        previous = current;
+        current = next;
+    }
+    chain.last_node = previous;
+    chain.target = current;
+
+    if (0 == chain.length)
+    {
+        return false;
+    }
+    return chain.source < chain.target ||
+           (chain.source == chain.target && chain.first_node < chain.last_node);
+}
+
+std::vector<CompressibleChain> FindChains(const Graph &graph,
+                                          const std::vector<std::uint8_t> &is_compressible)
+{
+    tbb::enumerable_thread_specific<std::vector<CompressibleChain>> local_chains;
+    tbb::parallel_for(tbb::blocked_range<NodeID>(0, graph.GetNumberOfNodes()),
+                      [&](const tbb::blocked_range<NodeID> &range)
+                      {
+                          auto &chains = local_chains.local();
+                          CompressibleChain chain;
+                          for (const auto node : util::irange(range.begin(), range.end()))
+                          {
+                              if (is_compressible[node])
+                              {
+                                  continue;
+                              }
+                              for (const auto edge : graph.GetAdjacentEdgeRange(node))
+                              {
+                                  if (WalkChain(graph, is_compressible, node, edge, chain))
+                                  {
+                                      chains.push_back(chain);
+                                  }
+                              }
+                          }
+                      });
+
+    std::vector<CompressibleChain> chains;
+    for (const auto &chains_of_thread : local_chains)
+    {
+        chains.insert(chains.end(), chains_of_thread.begin(), chains_of_thread.end());
+    }
+    tbb::parallel_sort(chains.begin(), chains.end());
+    return chains;
+}
+
+// Compressible nodes on cycles without any other node are not reached from a chain end. Keeping
+// the node with the largest id turns each cycle into a chain that starts and ends there.
+bool BreakIsolatedCycles(const Graph &graph,
+                         const std::vector<CompressibleChain> &chains,
+                         std::vector<std::uint8_t> &is_compressible)
+{
+    std::atomic<std::size_t> number_of_compressible(0);
+    tbb::parallel_for(tbb::blocked_range<NodeID>(0, graph.GetNumberOfNodes()),
+                      [&](const tbb::blocked_range<NodeID> &range)
+                      {
+                          number_of_compressible +=
+                              std::count(is_compressible.begin() + range.begin(),
+                                         is_compressible.begin() + range.end(), 1);
+                      });
+    std::size_t number_of_chain_nodes = 0;
+    for (const auto &chain : chains)
+    {
+        number_of_chain_nodes += chain.length;
+    }
+    if (number_of_chain_nodes == number_of_compressible)
+    {
+        return false;
+    }
+
+    std::vector<std::uint8_t> is_on_chain(graph.GetNumberOfNodes(), 0);
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, chains.size()),
+                      [&](const tbb::blocked_range<std::size_t> &range)
+                      {
+                          for (auto index = range.begin(); index != range.end(); ++index)
+                          {
+                              NodeID previous = chains[index].source;
+                              NodeID current = chains[index].first_node;
+                              while (is_compressible[current])
+                              {
+                                  is_on_chain[current] = 1;
+                                  const auto next_edge = OtherEdge(graph, current, previous);
+                                  previous = current;
+                                  current = graph.GetTarget(next_edge);
+                              }
+                          }
+                      });
+
+    for (const auto node : util::irange(0u, graph.GetNumberOfNodes()))
+    {
+        if (!is_compressible[node] || is_on_chain[node])
         {
             continue;
         }
-
-        if (fwd_edge_data1.IsCompatibleTo(fwd_edge_data2) &&
-            rev_edge_data1.IsCompatibleTo(rev_edge_data2))
+        NodeID largest_node = node;
+        NodeID previous = graph.GetTarget(graph.BeginEdges(node));
+        NodeID current = node;
+        do
         {
-            BOOST_ASSERT(graph.GetEdgeData(forward_e1).name_id ==
-                         graph.GetEdgeData(reverse_e1).name_id);
-            BOOST_ASSERT(graph.GetEdgeData(forward_e2).name_id ==
-                         graph.GetEdgeData(reverse_e2).name_id);
+            is_on_chain[current] = 1;
+            largest_node = std::max(largest_node, current);
+            const NodeID next = graph.GetTarget(OtherEdge(graph, current, previous));
+            previous = current;
+            current = next;
+        } while (current != node);
+        is_compressible[largest_node] = 0;
+    }
+    return true;
+}
 
-            // Get distances before graph is modified
-            const int forward_weight1 = graph.GetEdgeData(forward_e1).distance;
-            const int forward_weight2 = graph.GetEdgeData(forward_e2).distance;
+// A compressed chain must not end up parallel to an edge or another chain and must not be a
+// loop. Nodes are compressed in the order of their ids in a sequential run, so the nodes that it
+// had to keep are the ones with the largest ids. Keep those here, too.
+bool KeepConflictingNodes(const Graph &graph,
+                          const std::vector<CompressibleChain> &chains,
+                          std::vector<std::uint8_t> &is_compressible)
+{
+    std::atomic<bool> found_conflict(false);
+    tbb::parallel_for(
+        tbb::blocked_range<std::size_t>(0, chains.size()),
+        [&](const tbb::blocked_range<std::size_t> &range)
+        {
+            for (auto index = range.begin(); index != range.end(); ++index)
+            {
+                const auto &chain = chains[index];
+                if (chain.source == chain.target)
+                {
+                    BOOST_ASSERT(chain.length >= 2);
+                    is_compressible[chain.largest_node] = 0;
+                    is_compressible[chain.second_largest_node] = 0;
+                    found_conflict = true;
+                }
+                else if ((index > 0 && chains[index - 1].source == chain.source &&
+                          chains[index - 1].target == chain.target) ||
+                         SPECIAL_EDGEID != graph.FindEdgeInEitherDirection(chain.source,
+                                                                           chain.target))
+                {
+                    is_compressible[chain.largest_node] = 0;
+                    found_conflict = true;
+                }
+            }
+        });
+    return found_conflict;
+}
+} // namespace
 
-            BOOST_ASSERT(0 != forward_weight1);
-            BOOST_ASSERT(0 != forward_weight2);
+GraphCompressor::GraphCompressor(SpeedProfileProperties speed_profile)
+    : speed_profile(std::move(speed_profile))
+{
+}
 
-            const int reverse_weight1 = graph.GetEdgeData(reverse_e1).distance;
-            const int reverse_weight2 = graph.GetEdgeData(reverse_e2).distance;
+void GraphCompressor::Compress(const std::unordered_set<NodeID> &barrier_nodes,
+                               const std::unordered_set<NodeID> &traffic_lights,
+                               RestrictionMap &restriction_map,
+                               util::NodeBasedDynamicGraph &graph,
+                               CompressedEdgeContainer &geometry_compressor)
+{
+    const unsigned original_number_of_nodes = graph.GetNumberOfNodes();
+    const unsigned original_number_of_edges = graph.GetNumberOfEdges();
 
-            BOOST_ASSERT(0 != reverse_weight1);
-            BOOST_ASSERT(0 != reverse_weight2);
+    // Find the chains to compress without touching the graph
+    std::vector<std::uint8_t> is_compressible(original_number_of_nodes);
+    tbb::parallel_for(tbb::blocked_range<NodeID>(0, original_number_of_nodes),
+                      [&](const tbb::blocked_range<NodeID> &range)
+                      {
+                          for (const auto node : util::irange(range.begin(), range.end()))
+                          {
+                              is_compressible[node] =
+                                  IsCompressible(graph, barrier_nodes, restriction_map, node);
+                          }
+                      });
+
+    auto chains = FindChains(graph, is_compressible);
+    if (BreakIsolatedCycles(graph, chains, is_compressible))
+    {
+        chains = FindChains(graph, is_compressible);
+    }
+    // one round is enough: the parts of a split chain end at a node that was inside of it, so
+    // they cannot run parallel to an edge, another chain or each other
+    if (KeepConflictingNodes(graph, chains, is_compressible))
+    {
+        chains = FindChains(graph, is_compressible);
+    }
 
-            const bool has_node_penalty = traffic_lights.find(node_v) != traffic_lights.end();
+    // every chain gets a forward and a reverse geometry with one entry per segment
+    std::vector<std::size_t> geometry_offsets(2 * chains.size() + 1, 0);
+    for (const auto index : util::irange<std::size_t>(0, chains.size()))
+    {
+        const auto number_of_segments = chains[index].length + 1;
+        geometry_offsets[2 * index + 1] = geometry_offsets[2 * index] + number_of_segments;
+        geometry_offsets[2 * index + 2] = geometry_offsets[2 * index + 1] + number_of_segments;
+    }
+    std::vector<CompressedNode> geometry_nodes(geometry_offsets.back());
+    std::vector<EdgeID> geometry_edge_ids(2 * chains.size());
 
-            // add weight of e2's to e1
-            graph.GetEdgeData(forward_e1).distance += fwd_edge_data2.distance;
-            graph.GetEdgeData(reverse_e1).distance += rev_edge_data2.distance;
-            if (has_node_penalty)
+    const auto node_penalty = [&](const NodeID node)
+    {
+        return traffic_lights.end() != traffic_lights.find(node)
+                   ? speed_profile.traffic_signal_penalty
+                   : 0;
+    };
+
+    // Collect the geometries. This still only reads the graph, the adjacency of chain ends is
+    // searched here, while the next step rewrites it.
+    tbb::parallel_for(
+        tbb::blocked_range<std::size_t>(0, chains.size()),
+        [&](const tbb::blocked_range<std::size_t> &range)
+        {
+            for (auto index = range.begin(); index != range.end(); ++index)
             {
-                graph.GetEdgeData(forward_e1).distance += speed_profile.traffic_signal_penalty;
-                graph.GetEdgeData(reverse_e1).distance += speed_profile.traffic_signal_penalty;
+                auto &chain = chains[index];
+                auto forward_geometry = geometry_nodes.begin() + geometry_offsets[2 * index];
+                auto reverse_geometry = geometry_nodes.begin() + geometry_offsets[2 * index + 1];
+
+                // the segment between nodes i and i + 1 of the path is at position i of the
+                // forward and at position length - i of the reverse geometry. Signal penalties
+                // are added to the segment arriving at the signal.
+                NodeID previous = chain.source;
+                EdgeID forward_edge = chain.first_edge;
+                for (const auto segment : util::irange(0u, chain.length))
+                {
+                    const NodeID current = graph.GetTarget(forward_edge);
+                    const EdgeID next_edge = OtherEdge(graph, current, previous);
+                    const EdgeID backward_edge =
+                        graph.BeginEdges(current) + (next_edge == graph.BeginEdges(current));
+                    BOOST_ASSERT(graph.GetTarget(backward_edge) == previous);
+
+                    forward_geometry[segment] = {current,
+                                                 graph.GetEdgeData(forward_edge).distance +
+                                                     node_penalty(current)};
+                    reverse_geometry[chain.length - segment] = {
+                        previous, graph.GetEdgeData(backward_edge).distance +
+                                      (segment > 0 ? node_penalty(previous) : 0)};
+
+                    forward_edge = next_edge;
+                    previous = current;
+                }
+                BOOST_ASSERT(previous == chain.last_node);
+                BOOST_ASSERT(graph.GetTarget(forward_edge) == chain.target);
+
+                chain.reverse_edge = graph.FindEdge(chain.target, chain.last_node);
+                BOOST_ASSERT(SPECIAL_EDGEID != chain.reverse_edge);
+                forward_geometry[chain.length] = {chain.target,
+                                                  graph.GetEdgeData(forward_edge).distance};
+                reverse_geometry[0] = {chain.last_node,
+                                       graph.GetEdgeData(chain.reverse_edge).distance +
+                                           node_penalty(chain.last_node)};
+
+                chain.forward_weight = 0;
+                chain.reverse_weight = 0;
+                for (const auto segment : util::irange(0u, chain.length + 1))
+                {
+                    chain.forward_weight += forward_geometry[segment].second;
+                    chain.reverse_weight += reverse_geometry[segment].second;
+                }
+                geometry_edge_ids[2 * index] = chain.first_edge;
+                geometry_edge_ids[2 * index + 1] = chain.reverse_edge;
             }
-
-            // extend e1's to targets of e2's
-            graph.SetTarget(forward_e1, node_w);
-            graph.SetTarget(reverse_e1, node_u);
-
-            // remove e2's (if bidir, otherwise only one)
-            graph.DeleteEdge(node_v, forward_e2);
-            graph.DeleteEdge(node_v, reverse_e2);
-
-            // update any involved turn restrictions
-            restriction_map.FixupStartingTurnRestriction(node_u, node_v, node_w);
-            restriction_map.FixupArrivingTurnRestriction(node_u, node_v, node_w, graph);
-
-            restriction_map.FixupStartingTurnRestriction(node_w, node_v, node_u);
-            restriction_map.FixupArrivingTurnRestriction(node_w, node_v, node_u, graph);
-
-            // store compressed geometry in container
-            geometry_compressor.CompressEdge(
-                forward_e1, forward_e2, node_v, node_w,
-                forward_weight1 + (has_node_penalty ? speed_profile.traffic_signal_penalty : 0),
-                forward_weight2);
-            geometry_compressor.CompressEdge(
-                reverse_e1, reverse_e2, node_v, node_u, reverse_weight1,
-                reverse_weight2 + (has_node_penalty ? speed_profile.traffic_signal_penalty : 0));
-        }
+        });
+
+    // Rewrite the graph. The inner nodes of chains are disjoint and only the two surviving edges
+    // of each chain are modified at its ends, so chains can be handled independently.
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, chains.size()),
+                      [&](const tbb::blocked_range<std::size_t> &range)
+                      {
+                          for (auto index = range.begin(); index != range.end(); ++index)
+                          {
+                              const auto &chain = chains[index];
+                              graph.SetTarget(chain.first_edge, chain.target);
+                              graph.GetEdgeData(chain.first_edge).distance = chain.forward_weight;
+                              graph.SetTarget(chain.reverse_edge, chain.source);
+                              graph.GetEdgeData(chain.reverse_edge).distance =
+                                  chain.reverse_weight;
+
+                              NodeID previous = chain.source;
+                              NodeID current = chain.first_node;
+                              for (const auto segment : util::irange(0u, chain.length))
+                              {
+                                  (void)segment;
+                                  const NodeID next =
+                                      graph.GetTarget(OtherEdge(graph, current, previous));
+                                  graph.DeleteEdge(current, graph.BeginEdges(current) + 1);
+                                  graph.DeleteEdge(current, graph.BeginEdges(current));
+                                  previous = current;
+                                  current = next;
+                              }
+                          }
+                      });
+
+    // update any involved turn restrictions, restrictions that start at an inner node are moved
+    // first, so that restrictions arriving at a chain end are found from their new start
+    for (const auto &chain : chains)
+    {
+        restriction_map.FixupStartingTurnRestriction(chain.source, chain.last_node, chain.target);
+        restriction_map.FixupStartingTurnRestriction(chain.target, chain.first_node, chain.source);
     }
+    for (const auto &chain : chains)
+    {
+        restriction_map.FixupArrivingTurnRestriction(chain.source, chain.first_node, chain.target,
+                                                     graph);
+        restriction_map.FixupArrivingTurnRestriction(chain.target, chain.last_node, chain.source,
+                                                     graph);
+    }
+
+    geometry_compressor.SetGeometries(std::move(geometry_edge_ids), std::move(geometry_offsets),
+                                      std::move(geometry_nodes));
 
     PrintStatistics(original_number_of_nodes, original_number_of_edges, graph);
 }
@@ -0,0 +1,55 @@
+#include "extractor/way_result_cache.hpp"
+
+#include <osmium/osm/way.hpp>
+
+#include <utility>
+
+namespace osrm
+{
+namespace extractor
+{
+
+WayResultCache::WayResultCache(std::vector<std::string> keys_) : keys(std::move(keys_)) {}
+
+void WayResultCache::BuildKey(const osmium::Way &way, std::string &key) const
+{
+    key.clear();
+    const auto &tags = way.tags();
+    for (const auto &tag_key : keys)
+    {
+        // OSM values contain no '\0', so the encoding is unambiguous
+        const char *value = tags.get_value_by_key(tag_key.c_str());
+        if (value == nullptr)
+        {
+            key.push_back('\0');
+        }
+        else
+        {
+            key.push_back('\1');
+            key.append(value);
+            key.push_back('\0');
+        }
+    }
+}
+
+std::uint64_t WayResultCache::Hits() const
+{
+    std::uint64_t hits = 0;
+    for (const auto &cache : thread_caches)
+    {
+        hits += cache.hits;
+    }
+    return hits;
+}
+
+std::uint64_t WayResultCache::Misses() const
+{
+    std::uint64_t misses = 0;
+    for (const auto &cache : thread_caches)
+    {
+        misses += cache.misses;
+    }
+    return misses;
+}
+}
+}
@@ -19,4 +19,10 @@ int OSRM::RunQuery(const RouteParameters &route_parameters, util::json::Object &
     return engine_->RunQuery(route_parameters, json_result);
 }
 
+int OSRM::RunQuery(const RouteParameters &route_parameters,
+                   engine::BinaryResponse &binary_result)
+{
+    return engine_->RunQuery(route_parameters, binary_result);
+}
+
 }
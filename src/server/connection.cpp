@@ -2,11 +2,25 @@
 #include "server/request_handler.hpp"
 #include "server/request_parser.hpp"
 
+#include "engine/query_budget.hpp"
+#include "engine/query_statistics.hpp"
+
 #include <boost/assert.hpp>
 #include <boost/bind.hpp>
-#include <boost/iostreams/filtering_stream.hpp>
-#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/thread/tss.hpp>
+
+#include <zlib.h>
+
+#ifdef ENABLE_BROTLI
+#include <brotli/encode.h>
+#endif
+#ifdef ENABLE_ZSTD
+#include <zstd.h>
+#endif
 
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -15,8 +29,119 @@ namespace osrm
 namespace server
 {
 
-Connection::Connection(boost::asio::io_service &io_service, RequestHandler &handler)
-    : strand(io_service), TCP_socket(io_service), request_handler(handler)
+namespace
+{
+// replies below this size fit into a single TCP segment anyway, compressing them only costs time
+const constexpr std::size_t MINIMUM_COMPRESSED_REPLY_SIZE = 1400;
+
+// there's a trade-off between speed and size. speed wins
+const constexpr int ZLIB_LEVEL = Z_BEST_SPEED;
+#ifdef ENABLE_BROTLI
+const constexpr int BROTLI_FAST_QUALITY = 1;
+#endif
+#ifdef ENABLE_ZSTD
+const constexpr int ZSTD_FAST_LEVEL = 1;
+#endif
+
+// A zlib deflate stream that is reset instead of reallocated between replies
+class DeflateStream
+{
+  public:
+    explicit DeflateStream(const int window_bits)
+    {
+        std::memset(&stream, 0, sizeof(stream));
+        initialized = Z_OK == deflateInit2(&stream, ZLIB_LEVEL, Z_DEFLATED, window_bits,
+                                           MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY);
+    }
+
+    ~DeflateStream()
+    {
+        if (initialized)
+        {
+            deflateEnd(&stream);
+        }
+    }
+
+    DeflateStream(const DeflateStream &) = delete;
+    DeflateStream &operator=(const DeflateStream &) = delete;
+
+    bool Compress(const std::vector<char> &input, std::vector<char> &output)
+    {
+        if (!initialized || Z_OK != deflateReset(&stream))
+        {
+            return false;
+        }
+
+        // sized for the worst case, so a single call always finishes the stream
+        output.resize(deflateBound(&stream, static_cast<uLong>(input.size())));
+        stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input.data()));
+        stream.avail_in = static_cast<uInt>(input.size());
+        stream.next_out = reinterpret_cast<Bytef *>(output.data());
+        stream.avail_out = static_cast<uInt>(output.size());
+        if (Z_STREAM_END != deflate(&stream, Z_FINISH))
+        {
+            return false;
+        }
+        output.resize(stream.total_out);
+        return true;
+    }
+
+  private:
+    z_stream stream;
+    bool initialized;
+};
+
+// Compression state of one worker thread
+struct CompressionContexts
+{
+    CompressionContexts()
+        : gzip(MAX_WBITS + 16), deflate(-MAX_WBITS)
+#ifdef ENABLE_ZSTD
+          ,
+          zstd(ZSTD_createCCtx())
+#endif
+    {
+    }
+
+#ifdef ENABLE_ZSTD
+    ~CompressionContexts() { ZSTD_freeCCtx(zstd); }
+#endif
+
+    DeflateStream gzip;
+    DeflateStream deflate;
+#ifdef ENABLE_ZSTD
+    ZSTD_CCtx *zstd;
+#endif
+};
+
+boost::thread_specific_ptr<CompressionContexts> compression_contexts;
+
+const char *content_encoding(const http::compression_type compression_type)
+{
+    switch (compression_type)
+    {
+    case http::gzip_rfc1952:
+        return "gzip";
+    case http::deflate_rfc1951:
+        return "deflate";
+    case http::brotli_rfc7932:
+        return "br";
+    case http::zstd_rfc8478:
+        return "zstd";
+    default:
+        return "identity";
+    }
+}
+
+const constexpr char METRICS_SERVICE[] = "metrics";
+}
+
+
+Connection::Connection(boost::asio::io_service &io_service,
+                       RequestHandler &handler,
+                       WorkerPool &worker_pool)
+    : strand(io_service), TCP_socket(io_service), request_handler(handler),
+      worker_pool(worker_pool), cancelled(false)
 {
 }
 
@@ -50,40 +175,30 @@ void Connection::handle_read(const boost::system::error_code &error, std::size_t
     if (result == util::tribool::yes)
     {
         current_request.endpoint = TCP_socket.remote_endpoint().address();
-        request_handler.handle_request(current_request, current_reply);
+        const auto service = request_handler.GetService(current_request.uri);
+
+        // the metrics only read counters, they are answered right away even when the workers
+        // are saturated and the queues reject queries
+        if (METRICS_SERVICE == service)
+        {
+            handle_request(compression_type);
+            return;
+        }
 
-        // compress the result w/ gzip/deflate if requested
-        switch (compression_type)
+        // the query runs on the worker pool, the io thread goes on serving other sockets
+        const bool accepted = worker_pool.Submit(
+            service,
+            std::bind(&Connection::handle_request, this->shared_from_this(), compression_type));
+        if (accepted)
+        {
+            watch_client();
+        }
+        else
         {
-        case http::deflate_rfc1951:
-            // use deflate for compression
-            current_reply.headers.insert(current_reply.headers.begin(),
-                                         {"Content-Encoding", "deflate"});
-            compressed_output = compress_buffers(current_reply.content, compression_type);
-            current_reply.set_size(static_cast<unsigned>(compressed_output.size()));
-            output_buffer = current_reply.headers_to_buffers();
-            output_buffer.push_back(boost::asio::buffer(compressed_output));
-            break;
-        case http::gzip_rfc1952:
-            // use gzip for compression
-            current_reply.headers.insert(current_reply.headers.begin(),
-                                         {"Content-Encoding", "gzip"});
-            compressed_output = compress_buffers(current_reply.content, compression_type);
-            current_reply.set_size(static_cast<unsigned>(compressed_output.size()));
-            output_buffer = current_reply.headers_to_buffers();
-            output_buffer.push_back(boost::asio::buffer(compressed_output));
-            break;
-        case http::no_compression:
-            // don't use any compression
-            current_reply.set_uncompressed_size();
+            current_reply = http::reply::stock_reply(http::reply::service_unavailable);
             output_buffer = current_reply.to_buffers();
-            break;
+            write_reply();
         }
-        // write result to stream
-        boost::asio::async_write(
-            TCP_socket, output_buffer,
-            strand.wrap(boost::bind(&Connection::handle_write, this->shared_from_this(),
-                                    boost::asio::placeholders::error)));
     }
     else if (result == util::tribool::no)
     { // request is not parseable
@@ -105,6 +220,77 @@ void Connection::handle_read(const boost::system::error_code &error, std::size_t
     }
 }
 
+void Connection::handle_request(http::compression_type compression_type)
+{
+    // nobody waits for the answer anymore, dropping the last reference closes the socket
+    if (cancelled.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    auto &statistics = engine::QueryStatistics::Get();
+    statistics.BeginRequest();
+
+    auto &budget = engine::QueryBudget::Get();
+    budget.SetCancellationFlag(&cancelled);
+    request_handler.handle_request(current_request, current_reply);
+    budget.SetCancellationFlag(nullptr);
+
+    // compress the result if requested, falling back to plain output for small replies
+    if (http::no_compression != compression_type &&
+        (current_reply.content.size() < MINIMUM_COMPRESSED_REPLY_SIZE ||
+         !compress_buffers(current_reply.content, compression_type, compressed_output)))
+    {
+        compression_type = http::no_compression;
+    }
+
+    if (http::no_compression == compression_type)
+    {
+        current_reply.set_uncompressed_size();
+        output_buffer = current_reply.to_buffers();
+    }
+    else
+    {
+        current_reply.headers.insert(current_reply.headers.begin(),
+                                     {"Content-Encoding", content_encoding(compression_type)});
+        current_reply.set_size(static_cast<unsigned>(compressed_output.size()));
+        output_buffer = current_reply.headers_to_buffers();
+        output_buffer.push_back(boost::asio::buffer(compressed_output));
+    }
+    statistics.EndRequest();
+
+    strand.post(boost::bind(&Connection::write_reply, this->shared_from_this()));
+}
+
+void Connection::write_reply()
+{
+    // write result to stream
+    boost::asio::async_write(
+        TCP_socket, output_buffer,
+        strand.wrap(boost::bind(&Connection::handle_write, this->shared_from_this(),
+                                boost::asio::placeholders::error)));
+}
+
+void Connection::watch_client()
+{
+    // anything sent after the request is ignored, there is no keep-alive
+    TCP_socket.async_read_some(
+        boost::asio::buffer(incoming_data_buffer),
+        strand.wrap(boost::bind(&Connection::handle_watch, this->shared_from_this(),
+                                boost::asio::placeholders::error)));
+}
+
+void Connection::handle_watch(const boost::system::error_code &error)
+{
+    if (error)
+    {
+        // a client closing its sending side looks the same, but no client we know does that
+        cancelled.store(true, std::memory_order_relaxed);
+        return;
+    }
+    watch_client();
+}
+
 /// Handle completion of a write operation.
 void Connection::handle_write(const boost::system::error_code &error)
 {
@@ -116,28 +302,66 @@ void Connection::handle_write(const boost::system::error_code &error)
     }
 }
 
-std::vector<char> Connection::compress_buffers(const std::vector<char> &uncompressed_data,
-                                               const http::compression_type compression_type)
+bool Connection::compress_buffers(const std::vector<char> &uncompressed_data,
+                                  const http::compression_type compression_type,
+                                  std::vector<char> &compressed_data)
 {
-    boost::iostreams::gzip_params compression_parameters;
+    engine::ScopedQueryPhase compress_phase(engine::QueryPhase::Compress);
 
-    // there's a trade-off between speed and size. speed wins
-    compression_parameters.level = boost::iostreams::zlib::best_speed;
-    // check which compression flavor is used
-    if (http::deflate_rfc1951 == compression_type)
+    if (!compression_contexts.get())
     {
-        compression_parameters.noheader = true;
+        compression_contexts.reset(new CompressionContexts());
     }
 
-    std::vector<char> compressed_data;
-    // plug data into boost's compression stream
-    boost::iostreams::filtering_ostream gzip_stream;
-    gzip_stream.push(boost::iostreams::gzip_compressor(compression_parameters));
-    gzip_stream.push(boost::iostreams::back_inserter(compressed_data));
-    gzip_stream.write(&uncompressed_data[0], uncompressed_data.size());
-    boost::iostreams::close(gzip_stream);
-
-    return compressed_data;
+    switch (compression_type)
+    {
+    case http::gzip_rfc1952:
+        return compression_contexts->gzip.Compress(uncompressed_data, compressed_data);
+    case http::deflate_rfc1951:
+        return compression_contexts->deflate.Compress(uncompressed_data, compressed_data);
+#ifdef ENABLE_BROTLI
+    case http::brotli_rfc7932:
+    {
+        std::size_t compressed_size = BrotliEncoderMaxCompressedSize(uncompressed_data.size());
+        if (0 == compressed_size)
+        {
+            return false;
+        }
+        compressed_data.resize(compressed_size);
+        if (!BrotliEncoderCompress(
+                BROTLI_FAST_QUALITY, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+                uncompressed_data.size(),
+                reinterpret_cast<const std::uint8_t *>(uncompressed_data.data()), &compressed_size,
+                reinterpret_cast<std::uint8_t *>(compressed_data.data())))
+        {
+            return false;
+        }
+        compressed_data.resize(compressed_size);
+        return true;
+    }
+#endif
+#ifdef ENABLE_ZSTD
+    case http::zstd_rfc8478:
+    {
+        if (compression_contexts->zstd == nullptr)
+        {
+            return false;
+        }
+        compressed_data.resize(ZSTD_compressBound(uncompressed_data.size()));
+        const std::size_t compressed_size = ZSTD_compressCCtx(
+            compression_contexts->zstd, compressed_data.data(), compressed_data.size(),
+            uncompressed_data.data(), uncompressed_data.size(), ZSTD_FAST_LEVEL);
+        if (ZSTD_isError(compressed_size))
+        {
+            return false;
+        }
+        compressed_data.resize(compressed_size);
+        return true;
+    }
+#endif
+    default:
+        return false;
+    }
 }
 }
 }
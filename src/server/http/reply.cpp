@@ -13,11 +13,16 @@ const char ok_html[] = "";
 const char bad_request_html[] = "{\"status\": 400,\"status_message\":\"Bad Request\"}";
 const char internal_server_error_html[] =
     "{\"status\": 500,\"status_message\":\"Internal Server Error\"}";
+const char service_unavailable_html[] =
+    "{\"status\": 503,\"status_message\":\"Service Unavailable\"}";
+const char gateway_timeout_html[] = "{\"status\": 504,\"status_message\":\"Gateway Timeout\"}";
 const char seperators[] = {':', ' '};
 const char crlf[] = {'\r', '\n'};
 const std::string http_ok_string = "HTTP/1.0 200 OK\r\n";
 const std::string http_bad_request_string = "HTTP/1.0 400 Bad Request\r\n";
 const std::string http_internal_server_error_string = "HTTP/1.0 500 Internal Server Error\r\n";
+const std::string http_service_unavailable_string = "HTTP/1.0 503 Service Unavailable\r\n";
+const std::string http_gateway_timeout_string = "HTTP/1.0 504 Gateway Timeout\r\n";
 
 void reply::set_size(const std::size_t size)
 {
@@ -87,6 +92,14 @@ std::string reply::status_to_string(const reply::status_type status)
     {
         return bad_request_html;
     }
+    if (reply::service_unavailable == status)
+    {
+        return service_unavailable_html;
+    }
+    if (reply::gateway_timeout == status)
+    {
+        return gateway_timeout_html;
+    }
     return internal_server_error_html;
 }
 
@@ -100,6 +113,14 @@ boost::asio::const_buffer reply::status_to_buffer(const reply::status_type statu
     {
         return boost::asio::buffer(http_internal_server_error_string);
     }
+    if (reply::service_unavailable == status)
+    {
+        return boost::asio::buffer(http_service_unavailable_string);
+    }
+    if (reply::gateway_timeout == status)
+    {
+        return boost::asio::buffer(http_gateway_timeout_string);
+    }
     return boost::asio::buffer(http_bad_request_string);
 }
 
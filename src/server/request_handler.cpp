@@ -10,22 +10,29 @@
 #include "util/xml_renderer.hpp"
 #include "util/typedefs.hpp"
 
+#include "engine/binary_response.hpp"
+#include "engine/query_statistics.hpp"
 #include "engine/route_parameters.hpp"
 #include "util/json_container.hpp"
 #include "osrm/osrm.hpp"
 
+#include <boost/assert.hpp>
+
 #include <ctime>
 
 #include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <vector>
 
 namespace osrm
 {
 namespace server
 {
 
-RequestHandler::RequestHandler() : routing_machine(nullptr) {}
+RequestHandler::RequestHandler() {}
 
 void RequestHandler::handle_request(const http::request &current_request,
                                     http::reply &current_reply)
@@ -36,7 +43,10 @@ void RequestHandler::handle_request(const http::request &current_request,
     try
     {
         std::string request_string;
-        util::URIDecode(current_request.uri, request_string);
+        {
+            engine::ScopedQueryPhase parse_phase(engine::QueryPhase::Parse);
+            util::URIDecode(current_request.uri, request_string);
+        }
 
         // deactivated as GCC apparently does not implement that, not even in 4.9
         // std::time_t t = std::time(nullptr);
@@ -64,18 +74,71 @@ void RequestHandler::handle_request(const http::request &current_request,
             << current_request.agent << (0 == current_request.agent.length() ? "- " : " ")
             << request_string;
 
+        Dataset *dataset = nullptr;
+        {
+            engine::ScopedQueryPhase parse_phase(engine::QueryPhase::Parse);
+            dataset = SelectDataset(request_string);
+        }
+
         engine::RouteParameters route_parameters;
         APIGrammarParser api_parser(&route_parameters);
 
         auto api_iterator = request_string.begin();
-        const bool result =
-            boost::spirit::qi::parse(api_iterator, request_string.end(), api_parser);
+        bool result = false;
+        {
+            engine::ScopedQueryPhase parse_phase(engine::QueryPhase::Parse);
+            result = boost::spirit::qi::parse(api_iterator, request_string.end(), api_parser);
+        }
 
         // check if the was an error with the request
-        if (result && api_iterator == request_string.end())
+        if (result && api_iterator == request_string.end() && "metrics" == route_parameters.service)
+        {
+            // served by the server itself in the Prometheus text format
+            const std::string metrics =
+                engine::QueryStatistics::RenderMetrics() + RenderDatasetMetrics();
+            current_reply.content.assign(metrics.begin(), metrics.end());
+            current_reply.headers.emplace_back("Content-Length",
+                                               std::to_string(current_reply.content.size()));
+            current_reply.headers.emplace_back("Content-Type", "text/plain; version=0.0.4");
+            return;
+        }
+        else if (result && api_iterator == request_string.end() && nullptr == dataset)
+        {
+            // no default dataset and no known dataset prefix
+            current_reply.status = http::reply::bad_request;
+            json_result.values["status"] = http::reply::bad_request;
+            json_result.values["status_message"] = "Dataset not found";
+            route_parameters.output_format.clear();
+            route_parameters.jsonp_parameter.clear();
+        }
+        else if (result && api_iterator == request_string.end() &&
+                 "binary" == route_parameters.output_format &&
+                 route_parameters.jsonp_parameter.empty())
+        {
+            // the plugin writes the response body directly, no JSON document in between
+            engine::BinaryResponse binary_result;
+            const int return_code = RunQuery(*dataset, route_parameters, binary_result);
+            if (return_code / 100 == 4)
+            {
+                current_reply.status = http::reply::bad_request;
+            }
+            else if (return_code == http::reply::gateway_timeout)
+            {
+                current_reply.status = http::reply::gateway_timeout;
+            }
+            current_reply.content = std::move(binary_result.Buffer());
+            current_reply.headers.emplace_back("Access-Control-Allow-Origin", "*");
+            current_reply.headers.emplace_back("Access-Control-Allow-Methods", "GET");
+            current_reply.headers.emplace_back("Access-Control-Allow-Headers",
+                                               "X-Requested-With, Content-Type");
+            current_reply.headers.emplace_back("Content-Length",
+                                               std::to_string(current_reply.content.size()));
+            current_reply.headers.emplace_back("Content-Type", "application/x-osrm-binary");
+            return;
+        }
+        else if (result && api_iterator == request_string.end())
         {
             // parsing done, lets call the right plugin to handle the request
-            BOOST_ASSERT_MSG(routing_machine != nullptr, "pointer not init'ed");
 
             if (!route_parameters.jsonp_parameter.empty())
             { // prepend response with jsonp parameter
@@ -84,8 +147,13 @@ void RequestHandler::handle_request(const http::request &current_request,
                                              json_p.end());
             }
 
-            const int return_code = routing_machine->RunQuery(route_parameters, json_result);
+            const int return_code = RunQuery(*dataset, route_parameters, json_result);
             json_result.values["status"] = return_code;
+            if (route_parameters.debug_stats)
+            {
+                json_result.values["debug_stats"] =
+                    engine::QueryStatistics::Get().RequestStatistics();
+            }
             // 4xx bad request return code
             if (return_code / 100 == 4)
             {
@@ -93,6 +161,13 @@ void RequestHandler::handle_request(const http::request &current_request,
                 current_reply.content.clear();
                 route_parameters.output_format.clear();
             }
+            // the query ran out of its budget
+            else if (return_code == http::reply::gateway_timeout)
+            {
+                current_reply.status = http::reply::gateway_timeout;
+                current_reply.content.clear();
+                route_parameters.output_format.clear();
+            }
             else
             {
                 // 2xx valid request
@@ -117,6 +192,7 @@ void RequestHandler::handle_request(const http::request &current_request,
         // set headers
         current_reply.headers.emplace_back("Content-Length",
                                            std::to_string(current_reply.content.size()));
+        engine::ScopedQueryPhase render_phase(engine::QueryPhase::Render);
         if ("gpx" == route_parameters.output_format)
         { // gpx file
             util::json::gpx_render(current_reply.content, json_result.values["route"]);
@@ -152,6 +228,116 @@ void RequestHandler::handle_request(const http::request &current_request,
     }
 }
 
-void RequestHandler::RegisterRoutingMachine(OSRM *osrm) { routing_machine = osrm; }
+void RequestHandler::RegisterRoutingMachine(OSRM *osrm,
+                                            const std::string &dataset,
+                                            const std::uint64_t resident_bytes)
+{
+    BOOST_ASSERT_MSG(osrm != nullptr, "pointer not init'ed");
+    datasets[dataset].reset(new Dataset(osrm, resident_bytes));
+}
+
+std::string RequestHandler::GetService(const std::string &uri) const
+{
+    std::string request_string;
+    util::URIDecode(uri, request_string);
+    SelectDataset(request_string);
+
+    const auto begin = request_string.find_first_not_of('/');
+    if (std::string::npos == begin)
+    {
+        return {};
+    }
+    const auto end = request_string.find_first_of("/?", begin);
+    return request_string.substr(begin, std::string::npos == end ? std::string::npos : end - begin);
+}
+
+RequestHandler::Dataset *RequestHandler::SelectDataset(std::string &request_string) const
+{
+    // "/car/viaroute?loc=..." is asked to the dataset car as "/viaroute?loc=..."
+    const auto end = request_string.find_first_of("/?", 1);
+    if (!request_string.empty() && '/' == request_string.front() && std::string::npos != end &&
+        '/' == request_string[end])
+    {
+        const auto dataset_iterator = datasets.find(request_string.substr(1, end - 1));
+        if (datasets.end() != dataset_iterator && !dataset_iterator->first.empty())
+        {
+            request_string.erase(0, end);
+            return dataset_iterator->second.get();
+        }
+    }
+
+    const auto default_iterator = datasets.find("");
+    return datasets.end() == default_iterator ? nullptr : default_iterator->second.get();
+}
+
+template <typename ResultT>
+int RequestHandler::RunQuery(Dataset &dataset,
+                             const engine::RouteParameters &route_parameters,
+                             ResultT &result) const
+{
+    const auto start = std::chrono::steady_clock::now();
+    const int return_code = dataset.routing_machine->RunQuery(route_parameters, result);
+    const auto duration = std::chrono::steady_clock::now() - start;
+
+    dataset.requests.fetch_add(1, std::memory_order_relaxed);
+    dataset.query_nanoseconds.fetch_add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(),
+        std::memory_order_relaxed);
+    return return_code;
+}
+
+std::string RequestHandler::RenderDatasetMetrics() const
+{
+    // sorted, so the series keep their order between scrapes
+    std::vector<std::pair<std::string, const Dataset *>> sorted_datasets;
+    for (const auto &dataset : datasets)
+    {
+        sorted_datasets.emplace_back(dataset.first.empty() ? "default" : dataset.first,
+                                     dataset.second.get());
+    }
+    std::sort(sorted_datasets.begin(), sorted_datasets.end());
+
+    std::ostringstream output;
+    output.precision(9);
+    output << "# HELP osrm_dataset_requests_total Requests answered per dataset.\n"
+           << "# TYPE osrm_dataset_requests_total counter\n";
+    for (const auto &dataset : sorted_datasets)
+    {
+        output << "osrm_dataset_requests_total{dataset=\"" << dataset.first << "\"} "
+               << dataset.second->requests.load(std::memory_order_relaxed) << "\n";
+    }
+    output << "# HELP osrm_dataset_query_seconds_total Time spent answering queries per dataset.\n"
+           << "# TYPE osrm_dataset_query_seconds_total counter\n";
+    for (const auto &dataset : sorted_datasets)
+    {
+        output << "osrm_dataset_query_seconds_total{dataset=\"" << dataset.first << "\"} "
+               << dataset.second->query_nanoseconds.load(std::memory_order_relaxed) / 1e9
+               << "\n";
+    }
+    output << "# HELP osrm_dataset_resident_bytes Resident memory added by loading the dataset.\n"
+           << "# TYPE osrm_dataset_resident_bytes gauge\n";
+    for (const auto &dataset : sorted_datasets)
+    {
+        output << "osrm_dataset_resident_bytes{dataset=\"" << dataset.first << "\"} "
+               << dataset.second->resident_bytes << "\n";
+    }
+    return output.str();
+}
+
+bool ParseDataset(const std::string &input, std::string &name, std::string &base_path)
+{
+    const auto equal_sign = input.find('=');
+    if (std::string::npos == equal_sign || 0 == equal_sign || input.size() == equal_sign + 1)
+    {
+        return false;
+    }
+    name = input.substr(0, equal_sign);
+    if (std::string::npos != name.find_first_of("/?&"))
+    {
+        return false;
+    }
+    base_path = input.substr(equal_sign + 1);
+    return true;
+}
 }
 }
@@ -7,8 +7,12 @@
 #include "util/tribool.hpp"
 
 #include <boost/algorithm/string/predicate.hpp>
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/trim.hpp>
 
+#include <cstdlib>
 #include <string>
+#include <vector>
 
 namespace osrm
 {
@@ -195,15 +199,7 @@ util::tribool RequestParser::consume(http::request &current_request, const char
     case internal_state::header_line_start:
         if (boost::iequals(current_header.name, "Accept-Encoding"))
         {
-            /* giving gzip precedence over deflate */
-            if (boost::icontains(current_header.value, "deflate"))
-            {
-                selected_compression = http::deflate_rfc1951;
-            }
-            if (boost::icontains(current_header.value, "gzip"))
-            {
-                selected_compression = http::gzip_rfc1952;
-            }
+            selected_compression = select_compression(current_header.value);
         }
 
         if (boost::iequals(current_header.name, "Referer"))
@@ -364,5 +360,76 @@ bool RequestParser::is_digit(const int character) const
 {
     return character >= '0' && character <= '9';
 }
+
+// Prefers zstd, then brotli (if built with them), then gzip, then deflate among the codings the
+// client accepts. A coding with a quality value of zero is refused by the client.
+http::compression_type RequestParser::select_compression(const std::string &accept_encoding) const
+{
+    std::vector<std::string> codings;
+    boost::split(codings, accept_encoding, [](const char c)
+                 {
+                     return c == ',';
+                 });
+
+    const auto preference = [](const http::compression_type type)
+    {
+        switch (type)
+        {
+        case http::zstd_rfc8478:
+            return 4;
+        case http::brotli_rfc7932:
+            return 3;
+        case http::gzip_rfc1952:
+            return 2;
+        case http::deflate_rfc1951:
+            return 1;
+        default:
+            return 0;
+        }
+    };
+
+    http::compression_type selected = http::no_compression;
+    for (const auto &coding : codings)
+    {
+        const auto parameters_begin = coding.find(';');
+        const std::string name = boost::trim_copy(coding.substr(0, parameters_begin));
+        if (parameters_begin != std::string::npos)
+        {
+            const auto quality_begin = coding.find("q=", parameters_begin);
+            if (quality_begin != std::string::npos &&
+                std::atof(coding.c_str() + quality_begin + 2) <= 0.)
+            {
+                continue;
+            }
+        }
+
+        http::compression_type type = http::no_compression;
+        if (boost::iequals(name, "gzip"))
+        {
+            type = http::gzip_rfc1952;
+        }
+        else if (boost::iequals(name, "deflate"))
+        {
+            type = http::deflate_rfc1951;
+        }
+#ifdef ENABLE_BROTLI
+        else if (boost::iequals(name, "br"))
+        {
+            type = http::brotli_rfc7932;
+        }
+#endif
+#ifdef ENABLE_ZSTD
+        else if (boost::iequals(name, "zstd"))
+        {
+            type = http::zstd_rfc8478;
+        }
+#endif
+        if (preference(type) > preference(selected))
+        {
+            selected = type;
+        }
+    }
+    return selected;
+}
 }
 }
@@ -0,0 +1,191 @@
+#include "server/worker_pool.hpp"
+#include "server/thread_affinity.hpp"
+
+#include "util/simple_logger.hpp"
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <string>
+#include <utility>
+
+namespace osrm
+{
+namespace server
+{
+
+namespace
+{
+// std::stoul accepts signs and leading blanks, a limit has to be plain digits
+bool ParseUnsigned(const std::string &input, unsigned &value)
+{
+    const auto is_digit = [](const char c)
+    {
+        return 0 != std::isdigit(static_cast<unsigned char>(c));
+    };
+    if (input.empty() || !std::all_of(input.begin(), input.end(), is_digit))
+    {
+        return false;
+    }
+    try
+    {
+        value = static_cast<unsigned>(std::stoul(input));
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+    return true;
+}
+}
+
+bool ParseServiceLimit(const std::string &input, std::string &service, ServiceLimit &limit)
+{
+    const auto equal_sign = input.find('=');
+    if (std::string::npos == equal_sign || 0 == equal_sign)
+    {
+        return false;
+    }
+
+    const auto colon = input.find(':', equal_sign);
+    unsigned max_concurrency = 0;
+    if (!ParseUnsigned(input.substr(equal_sign + 1, colon - equal_sign - 1), max_concurrency) ||
+        0 == max_concurrency)
+    {
+        return false;
+    }
+    unsigned max_queue_depth = limit.max_queue_depth;
+    if (std::string::npos != colon && !ParseUnsigned(input.substr(colon + 1), max_queue_depth))
+    {
+        return false;
+    }
+
+    limit.max_concurrency = max_concurrency;
+    limit.max_queue_depth = max_queue_depth;
+    service = input.substr(0, equal_sign);
+    return true;
+}
+
+WorkerPool::WorkerPool(const unsigned number_of_threads,
+                       const ServiceLimit &default_limit,
+                       const std::unordered_map<std::string, ServiceLimit> &service_limits,
+                       const bool pin_threads,
+                       const unsigned first_core)
+    : stopping(false), next_queue(0)
+{
+    BOOST_ASSERT(number_of_threads > 0);
+    for (const auto &service_limit : service_limits)
+    {
+        queue_of_service.emplace(service_limit.first, queues.size());
+        queues.push_back({service_limit.second, 0, {}});
+    }
+    queues.push_back({default_limit, 0, {}});
+
+    threads.reserve(number_of_threads);
+    for (unsigned i = 0; i < number_of_threads; ++i)
+    {
+        threads.emplace_back(&WorkerPool::WorkerLoop, this, pin_threads, first_core + i);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    Stop();
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+bool WorkerPool::Submit(const std::string &service, Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto service_iterator = queue_of_service.find(service);
+        auto &queue = queues[service_iterator == queue_of_service.end()
+                                 ? queues.size() - 1
+                                 : service_iterator->second];
+        if (stopping || queue.tasks.size() >= queue.limit.max_queue_depth)
+        {
+            return false;
+        }
+        queue.tasks.push_back(std::move(task));
+    }
+    task_available.notify_one();
+    return true;
+}
+
+void WorkerPool::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        for (auto &queue : queues)
+        {
+            queue.tasks.clear();
+        }
+    }
+    task_available.notify_all();
+}
+
+WorkerPool::ServiceQueue *WorkerPool::NextRunnableQueue()
+{
+    // round robin over the services, none of them can starve the others
+    for (std::size_t offset = 0; offset < queues.size(); ++offset)
+    {
+        auto &queue = queues[(next_queue + offset) % queues.size()];
+        if (!queue.tasks.empty() && queue.running < queue.limit.max_concurrency)
+        {
+            next_queue = (next_queue + offset + 1) % queues.size();
+            return &queue;
+        }
+    }
+    return nullptr;
+}
+
+void WorkerPool::WorkerLoop(const bool pin_thread, const unsigned core)
+{
+    // keeps the thread local search heaps in the caches of one core
+    if (pin_thread)
+    {
+        PinCurrentThread(core);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        ServiceQueue *queue = nullptr;
+        task_available.wait(lock, [this, &queue]
+                            {
+                                queue = NextRunnableQueue();
+                                return stopping || queue != nullptr;
+                            });
+        if (stopping)
+        {
+            return;
+        }
+
+        Task task = std::move(queue->tasks.front());
+        queue->tasks.pop_front();
+        ++queue->running;
+        lock.unlock();
+
+        try
+        {
+            task();
+        }
+        catch (const std::exception &e)
+        {
+            util::SimpleLogger().Write(logWARNING) << "[worker] " << e.what();
+        }
+
+        lock.lock();
+        --queue->running;
+        // the finished task may have been the one holding back its queue
+        task_available.notify_all();
+    }
+}
+}
+}
@@ -3,8 +3,10 @@
 #include "contractor/query_edge.hpp"
 #include "extractor/query_node.hpp"
 #include "util/shared_memory_vector_wrapper.hpp"
+#include "util/search_graph.hpp"
 #include "util/static_graph.hpp"
 #include "util/static_rtree.hpp"
+#include "util/sweep_order.hpp"
 #include "engine/datafacade/datafacade_base.hpp"
 #include "extractor/travel_mode.hpp"
 #include "extractor/turn_instructions.hpp"
@@ -13,6 +15,7 @@
 #include "storage/shared_barriers.hpp"
 #include "storage/shared_memory.hpp"
 #include "util/fingerprint.hpp"
+#include "util/integer_range.hpp"
 #include "util/osrm_exception.hpp"
 #include "util/simple_logger.hpp"
 #include "util/typedefs.hpp"
@@ -26,11 +29,14 @@
 #include <boost/filesystem/fstream.hpp>
 #include <boost/iostreams/seek.hpp>
 
+#include <algorithm>
 #include <cstdint>
 
 #include <fstream>
+#include <memory>
 #include <new>
 #include <string>
+#include <vector>
 
 namespace osrm
 {
@@ -44,6 +50,43 @@ using RTreeNode = util::StaticRTree<RTreeLeaf,
                                     true>::TreeNode;
 using QueryGraph = util::StaticGraph<contractor::QueryEdge::EdgeData>;
 
+// number of edges read at once while counting the edges of the search graph
+const constexpr unsigned EDGE_BUFFER_SIZE = 1 << 20;
+// the identity of a data file hashes its size and this many evenly spaced samples of it
+const constexpr unsigned IDENTITY_SAMPLES = 64;
+const constexpr std::size_t IDENTITY_SAMPLE_SIZE = 4096;
+
+// FNV-1a, stays the same across builds and platforms unlike std::hash
+std::uint64_t hashBytes(std::uint64_t hash, const char *bytes, const std::size_t length)
+{
+    for (const auto byte : util::irange<std::size_t>(0, length))
+    {
+        hash ^= static_cast<unsigned char>(bytes[byte]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Identifies the contents of a data file without reading all of it. Files of another extract
+// differ in their samples even if they hold as many entries.
+std::uint64_t hashFile(const std::uint64_t hash, const boost::filesystem::path &path)
+{
+    const std::uint64_t file_size = boost::filesystem::file_size(path);
+    auto result = hashBytes(hash, (const char *)&file_size, sizeof(file_size));
+
+    boost::filesystem::ifstream file(path, std::ios::binary);
+    std::vector<char> sample(IDENTITY_SAMPLE_SIZE);
+    const auto stride = std::max<std::uint64_t>(file_size / IDENTITY_SAMPLES, sample.size());
+    for (std::uint64_t position = 0; position < file_size; position += stride)
+    {
+        file.seekg(position);
+        file.read(sample.data(), sample.size());
+        result = hashBytes(result, sample.data(), file.gcount());
+        file.clear();
+    }
+    return result;
+}
+
 // delete a shared memory region. report warning if it could not be deleted
 void deleteRegion(const SharedDataType region)
 {
@@ -65,8 +108,14 @@ void deleteRegion(const SharedDataType region)
                 return "DATA_2";
             case LAYOUT_NONE:
                 return "LAYOUT_NONE";
-            default: // DATA_NONE:
+            case DATA_NONE:
                 return "DATA_NONE";
+            case GRAPH_1:
+                return "GRAPH_1";
+            case GRAPH_2:
+                return "GRAPH_2";
+            default: // GRAPH_NONE:
+                return "GRAPH_NONE";
             }
         }();
 
@@ -74,7 +123,14 @@ void deleteRegion(const SharedDataType region)
     }
 }
 
-Storage::Storage(const DataPaths &paths_) : paths(paths_) {}
+Storage::Storage(const DataPaths &paths_,
+                 const SharedMemoryOptions &memory_options_,
+                 const bool graph_only_,
+                 const bool search_graph_)
+    : paths(paths_), memory_options(memory_options_), graph_only(graph_only_),
+      search_graph(search_graph_)
+{
+}
 
 int Storage::Run()
 {
@@ -173,24 +229,44 @@ int Storage::Run()
     BOOST_ASSERT(!paths_iterator->second.empty());
     const boost::filesystem::path &core_marker_path = paths_iterator->second;
 
-    // determine segment to use
-    bool segment2_in_use = SharedMemory::RegionExists(LAYOUT_2);
-    const storage::SharedDataType layout_region = [&]
+    // find the dataset that is currently loaded, if any
+    SharedDataTimestamp current_regions{LAYOUT_NONE, DATA_NONE, GRAPH_NONE, 0};
+    if (SharedMemory::RegionExists(CURRENT_REGIONS))
     {
-        return segment2_in_use ? LAYOUT_1 : LAYOUT_2;
-    }();
-    const storage::SharedDataType data_region = [&]
+        const std::unique_ptr<SharedMemory> current_regions_memory(
+            makeSharedMemory(CURRENT_REGIONS));
+        current_regions = *static_cast<SharedDataTimestamp *>(current_regions_memory->Ptr());
+    }
+    if (graph_only && (!SharedMemory::RegionExists(current_regions.layout) ||
+                       !SharedMemory::RegionExists(current_regions.data)))
     {
-        return segment2_in_use ? DATA_1 : DATA_2;
-    }();
-    const storage::SharedDataType previous_layout_region = [&]
+        throw util::exception("no dataset loaded whose graph could be replaced");
+    }
+
+    // determine segments to use, the layout and graph are always replaced
+    const bool layout2_in_use = SharedMemory::RegionExists(LAYOUT_2);
+    const bool data2_in_use = SharedMemory::RegionExists(DATA_2);
+    const bool graph2_in_use = SharedMemory::RegionExists(GRAPH_2);
+    const storage::SharedDataType layout_region = layout2_in_use ? LAYOUT_1 : LAYOUT_2;
+    const storage::SharedDataType data_region = [&]
     {
-        return segment2_in_use ? LAYOUT_2 : LAYOUT_1;
+        if (graph_only)
+        {
+            return current_regions.data;
+        }
+        return data2_in_use ? DATA_1 : DATA_2;
     }();
+    const storage::SharedDataType graph_region = graph2_in_use ? GRAPH_1 : GRAPH_2;
+    const storage::SharedDataType previous_layout_region = layout2_in_use ? LAYOUT_2 : LAYOUT_1;
     const storage::SharedDataType previous_data_region = [&]
     {
-        return segment2_in_use ? DATA_2 : DATA_1;
+        if (graph_only)
+        {
+            return DATA_NONE;
+        }
+        return data2_in_use ? DATA_2 : DATA_1;
     }();
+    const storage::SharedDataType previous_graph_region = graph2_in_use ? GRAPH_2 : GRAPH_1;
 
     // Allocate a memory layout in shared memory, deallocate previous
     auto *layout_memory = makeSharedMemory(layout_region, sizeof(SharedDataLayout));
@@ -267,6 +343,55 @@ int Storage::Run()
     shared_layout_ptr->SetBlockSize<QueryGraph::EdgeArrayEntry>(SharedDataLayout::GRAPH_EDGE_LIST,
                                                                 number_of_graph_edges);
 
+    // the shortcut children follow the edges, older graphs do not have them
+    const auto graph_data_position = hsgr_input_stream.tellg();
+    hsgr_input_stream.seekg(number_of_graph_nodes * sizeof(QueryGraph::NodeArrayEntry) +
+                                number_of_graph_edges * sizeof(QueryGraph::EdgeArrayEntry),
+                            std::ios::cur);
+    unsigned number_of_shortcut_children = 0;
+    if (!hsgr_input_stream.read((char *)&number_of_shortcut_children, sizeof(unsigned)))
+    {
+        number_of_shortcut_children = 0;
+        hsgr_input_stream.clear();
+    }
+    shared_layout_ptr->SetBlockSize<contractor::ShortcutChildren>(
+        SharedDataLayout::SHORTCUT_CHILDREN, number_of_shortcut_children);
+
+    // the search graph keeps the edges of each direction apart, count them. Without it the
+    // blocks stay empty and the searches read the graph edges.
+    std::size_t number_of_forward_edges = 0;
+    std::size_t number_of_backward_edges = 0;
+    if (search_graph)
+    {
+        hsgr_input_stream.seekg(graph_data_position);
+        hsgr_input_stream.seekg(number_of_graph_nodes * sizeof(QueryGraph::NodeArrayEntry),
+                                std::ios::cur);
+        std::vector<QueryGraph::EdgeArrayEntry> edge_buffer(
+            std::min<unsigned>(number_of_graph_edges, EDGE_BUFFER_SIZE));
+        unsigned number_of_unread_edges = number_of_graph_edges;
+        while (number_of_unread_edges > 0)
+        {
+            const auto number_of_read_edges =
+                std::min<unsigned>(number_of_unread_edges, edge_buffer.size());
+            hsgr_input_stream.read((char *)edge_buffer.data(),
+                                   number_of_read_edges * sizeof(QueryGraph::EdgeArrayEntry));
+            util::SearchGraph<true>::CountEdges(edge_buffer.data(), number_of_read_edges,
+                                                number_of_forward_edges,
+                                                number_of_backward_edges);
+            number_of_unread_edges -= number_of_read_edges;
+        }
+        hsgr_input_stream.seekg(graph_data_position);
+    }
+    const std::size_t number_of_search_offsets = search_graph ? number_of_graph_nodes : 0;
+    shared_layout_ptr->SetBlockSize<unsigned>(SharedDataLayout::SEARCH_FORWARD_OFFSETS,
+                                              number_of_search_offsets);
+    shared_layout_ptr->SetBlockSize<util::SearchEdge>(SharedDataLayout::SEARCH_FORWARD_EDGES,
+                                                      number_of_forward_edges);
+    shared_layout_ptr->SetBlockSize<unsigned>(SharedDataLayout::SEARCH_BACKWARD_OFFSETS,
+                                              number_of_search_offsets);
+    shared_layout_ptr->SetBlockSize<util::SearchEdge>(SharedDataLayout::SEARCH_BACKWARD_EDGES,
+                                                      number_of_backward_edges);
+
     // load rsearch tree size
     boost::filesystem::ifstream tree_node_file(ram_index_path, std::ios::binary);
 
@@ -308,6 +433,23 @@ int Storage::Run()
     shared_layout_ptr->SetBlockSize<unsigned>(SharedDataLayout::CORE_MARKER,
                                               number_of_core_markers);
 
+    // load contraction level size, the levels are optional
+    boost::filesystem::ifstream level_file;
+    unsigned number_of_levels = 0;
+    paths_iterator = paths.find("levels");
+    if (paths.end() != paths_iterator && boost::filesystem::is_regular_file(paths_iterator->second))
+    {
+        level_file.open(paths_iterator->second, std::ios::binary);
+        level_file.read((char *)&number_of_levels, sizeof(unsigned));
+        if (!level_file || number_of_levels + 1 != number_of_graph_nodes)
+        {
+            util::SimpleLogger().Write(logWARNING) << paths_iterator->second
+                                                   << " does not match the graph, PHAST disabled";
+            number_of_levels = 0;
+        }
+    }
+    shared_layout_ptr->SetBlockSize<NodeID>(SharedDataLayout::SWEEP_ORDER, number_of_levels);
+
     // load coordinate size
     boost::filesystem::ifstream nodes_input_stream(nodes_data_path, std::ios::binary);
     unsigned coordinate_list_size = 0;
@@ -318,174 +460,232 @@ int Storage::Run()
     // load geometries sizes
     std::ifstream geometry_input_stream(geometries_data_path.string().c_str(), std::ios::binary);
     unsigned number_of_geometries_indices = 0;
-    unsigned number_of_compressed_geometries = 0;
+    unsigned number_of_packed_geometry_bytes = 0;
 
     geometry_input_stream.read((char *)&number_of_geometries_indices, sizeof(unsigned));
     shared_layout_ptr->SetBlockSize<unsigned>(SharedDataLayout::GEOMETRIES_INDEX,
                                               number_of_geometries_indices);
     boost::iostreams::seek(geometry_input_stream, number_of_geometries_indices * sizeof(unsigned),
                            BOOST_IOS::cur);
-    geometry_input_stream.read((char *)&number_of_compressed_geometries, sizeof(unsigned));
-    shared_layout_ptr->SetBlockSize<unsigned>(SharedDataLayout::GEOMETRIES_LIST,
-                                              number_of_compressed_geometries);
-    // allocate shared memory block
-    util::SimpleLogger().Write() << "allocating shared memory of "
-                                 << shared_layout_ptr->GetSizeOfLayout() << " bytes";
-    auto *shared_memory = makeSharedMemory(data_region, shared_layout_ptr->GetSizeOfLayout());
-    char *shared_memory_ptr = static_cast<char *>(shared_memory->Ptr());
+    geometry_input_stream.read((char *)&number_of_packed_geometry_bytes, sizeof(unsigned));
+    shared_layout_ptr->SetBlockSize<unsigned char>(SharedDataLayout::GEOMETRIES_LIST,
+                                                   number_of_packed_geometry_bytes);
 
-    // read actual data into shared memory object //
-
-    // hsgr checksum
-    unsigned *checksum_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
-        shared_memory_ptr, SharedDataLayout::HSGR_CHECKSUM);
-    *checksum_ptr = checksum;
-
-    // ram index file name
-    char *file_index_path_ptr = shared_layout_ptr->GetBlockPtr<char, true>(
-        shared_memory_ptr, SharedDataLayout::FILE_INDEX_PATH);
-    // make sure we have 0 ending
-    std::fill(file_index_path_ptr,
-              file_index_path_ptr +
-                  shared_layout_ptr->GetBlockSize(SharedDataLayout::FILE_INDEX_PATH),
-              0);
-    std::copy(file_index_path.begin(), file_index_path.end(), file_index_path_ptr);
+    // identity of the data files and the timestamp, everything kept in the data region
+    std::uint64_t data_identity = 14695981039346656037ull;
+    for (const auto &data_path : {names_data_path, edges_data_path, ram_index_path,
+                                  index_file_path_absolute, nodes_data_path, geometries_data_path})
+    {
+        data_identity = hashFile(data_identity, data_path);
+    }
+    data_identity = hashBytes(data_identity, m_timestamp.c_str(), m_timestamp.length());
+    shared_layout_ptr->SetBlockSize<std::uint64_t>(SharedDataLayout::DATA_IDENTITY, 1);
 
-    // Loading street names
-    unsigned *name_offsets_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
-        shared_memory_ptr, SharedDataLayout::NAME_OFFSETS);
-    if (shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_OFFSETS) > 0)
+    if (graph_only)
     {
-        name_stream.read((char *)name_offsets_ptr,
-                         shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_OFFSETS));
+        // the data region is kept as it is, so the files have to be the ones it was loaded from
+        const std::unique_ptr<SharedMemory> previous_layout_memory(
+            makeSharedMemory(current_regions.layout));
+        auto &previous_layout = *static_cast<SharedDataLayout *>(previous_layout_memory->Ptr());
+        for (auto i = 0; i < SharedDataLayout::NUM_BLOCKS; ++i)
+        {
+            const auto bid = static_cast<SharedDataLayout::BlockID>(i);
+            if (!SharedDataLayout::IsGraphBlock(bid) &&
+                (previous_layout.num_entries[bid] != shared_layout_ptr->num_entries[bid] ||
+                 previous_layout.entry_size[bid] != shared_layout_ptr->entry_size[bid]))
+            {
+                throw util::exception("data files differ from the loaded dataset, "
+                                      "the graph cannot be replaced on its own");
+            }
+        }
+        const std::unique_ptr<SharedMemory> previous_data_memory(
+            makeSharedMemory(current_regions.data));
+        const auto *loaded_identity = previous_layout.GetBlockPtr<std::uint64_t>(
+            static_cast<char *>(previous_data_memory->Ptr()), SharedDataLayout::DATA_IDENTITY);
+        if (*loaded_identity != data_identity)
+        {
+            throw util::exception("data files are not the ones of the loaded dataset, "
+                                  "the graph cannot be replaced on its own");
+        }
     }
 
-    unsigned *name_blocks_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
-        shared_memory_ptr, SharedDataLayout::NAME_BLOCKS);
-    if (shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_BLOCKS) > 0)
+    // allocate shared memory blocks
+    char *shared_memory_ptr = nullptr;
+    if (!graph_only)
     {
-        name_stream.read((char *)name_blocks_ptr,
-                         shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_BLOCKS));
+        util::SimpleLogger().Write() << "allocating shared memory of "
+                                     << shared_layout_ptr->GetSizeOfLayout() << " bytes";
+        auto *shared_memory = makeSharedMemory(data_region, shared_layout_ptr->GetSizeOfLayout(),
+                                               false, true, memory_options);
+        shared_memory_ptr = static_cast<char *>(shared_memory->Ptr());
     }
+    util::SimpleLogger().Write() << "allocating shared memory of "
+                                 << shared_layout_ptr->GetSizeOfGraph() << " bytes for the graph";
+    auto *graph_memory = makeSharedMemory(graph_region, shared_layout_ptr->GetSizeOfGraph(), false,
+                                          true, memory_options);
+    char *graph_memory_ptr = static_cast<char *>(graph_memory->Ptr());
 
-    char *name_char_ptr = shared_layout_ptr->GetBlockPtr<char, true>(
-        shared_memory_ptr, SharedDataLayout::NAME_CHAR_LIST);
-    unsigned temp_length;
-    name_stream.read((char *)&temp_length, sizeof(unsigned));
+    // read actual data into shared memory object //
 
-    BOOST_ASSERT_MSG(temp_length ==
-                         shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_CHAR_LIST),
-                     "Name file corrupted!");
+    if (!graph_only)
+    {
+        // ram index file name
+        char *file_index_path_ptr = shared_layout_ptr->GetBlockPtr<char, true>(
+            shared_memory_ptr, SharedDataLayout::FILE_INDEX_PATH);
+        // make sure we have 0 ending
+        std::fill(file_index_path_ptr,
+                  file_index_path_ptr +
+                      shared_layout_ptr->GetBlockSize(SharedDataLayout::FILE_INDEX_PATH),
+                  0);
+        std::copy(file_index_path.begin(), file_index_path.end(), file_index_path_ptr);
+
+        // Loading street names
+        unsigned *name_offsets_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
+            shared_memory_ptr, SharedDataLayout::NAME_OFFSETS);
+        if (shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_OFFSETS) > 0)
+        {
+            name_stream.read((char *)name_offsets_ptr,
+                             shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_OFFSETS));
+        }
 
-    if (shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_CHAR_LIST) > 0)
-    {
-        name_stream.read(name_char_ptr,
-                         shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_CHAR_LIST));
-    }
+        unsigned *name_blocks_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
+            shared_memory_ptr, SharedDataLayout::NAME_BLOCKS);
+        if (shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_BLOCKS) > 0)
+        {
+            name_stream.read((char *)name_blocks_ptr,
+                             shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_BLOCKS));
+        }
 
-    name_stream.close();
+        char *name_char_ptr = shared_layout_ptr->GetBlockPtr<char, true>(
+            shared_memory_ptr, SharedDataLayout::NAME_CHAR_LIST);
+        unsigned temp_length;
+        name_stream.read((char *)&temp_length, sizeof(unsigned));
 
-    // load original edge information
-    NodeID *via_node_ptr = shared_layout_ptr->GetBlockPtr<NodeID, true>(
-        shared_memory_ptr, SharedDataLayout::VIA_NODE_LIST);
+        BOOST_ASSERT_MSG(temp_length ==
+                             shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_CHAR_LIST),
+                         "Name file corrupted!");
 
-    unsigned *name_id_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
-        shared_memory_ptr, SharedDataLayout::NAME_ID_LIST);
+        if (shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_CHAR_LIST) > 0)
+        {
+            name_stream.read(name_char_ptr,
+                             shared_layout_ptr->GetBlockSize(SharedDataLayout::NAME_CHAR_LIST));
+        }
 
-    extractor::TravelMode *travel_mode_ptr =
-        shared_layout_ptr->GetBlockPtr<extractor::TravelMode, true>(shared_memory_ptr,
-                                                                    SharedDataLayout::TRAVEL_MODE);
+        name_stream.close();
 
-    extractor::TurnInstruction *turn_instructions_ptr =
-        shared_layout_ptr->GetBlockPtr<extractor::TurnInstruction, true>(
-            shared_memory_ptr, SharedDataLayout::TURN_INSTRUCTION);
+        // load original edge information
+        NodeID *via_node_ptr = shared_layout_ptr->GetBlockPtr<NodeID, true>(
+            shared_memory_ptr, SharedDataLayout::VIA_NODE_LIST);
 
-    unsigned *geometries_indicator_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
-        shared_memory_ptr, SharedDataLayout::GEOMETRIES_INDICATORS);
+        unsigned *name_id_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
+            shared_memory_ptr, SharedDataLayout::NAME_ID_LIST);
 
-    extractor::OriginalEdgeData current_edge_data;
-    for (unsigned i = 0; i < number_of_original_edges; ++i)
-    {
-        edges_input_stream.read((char *)&(current_edge_data), sizeof(extractor::OriginalEdgeData));
-        via_node_ptr[i] = current_edge_data.via_node;
-        name_id_ptr[i] = current_edge_data.name_id;
-        travel_mode_ptr[i] = current_edge_data.travel_mode;
-        turn_instructions_ptr[i] = current_edge_data.turn_instruction;
+        extractor::TravelMode *travel_mode_ptr =
+            shared_layout_ptr->GetBlockPtr<extractor::TravelMode, true>(
+                shared_memory_ptr, SharedDataLayout::TRAVEL_MODE);
 
-        const unsigned bucket = i / 32;
-        const unsigned offset = i % 32;
-        const unsigned value = [&]
+        extractor::TurnInstruction *turn_instructions_ptr =
+            shared_layout_ptr->GetBlockPtr<extractor::TurnInstruction, true>(
+                shared_memory_ptr, SharedDataLayout::TURN_INSTRUCTION);
+
+        unsigned *geometries_indicator_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
+            shared_memory_ptr, SharedDataLayout::GEOMETRIES_INDICATORS);
+
+        extractor::OriginalEdgeData current_edge_data;
+        for (unsigned i = 0; i < number_of_original_edges; ++i)
         {
-            unsigned return_value = 0;
-            if (0 != offset)
+            edges_input_stream.read((char *)&(current_edge_data),
+                                    sizeof(extractor::OriginalEdgeData));
+            via_node_ptr[i] = current_edge_data.via_node;
+            name_id_ptr[i] = current_edge_data.name_id;
+            travel_mode_ptr[i] = current_edge_data.travel_mode;
+            turn_instructions_ptr[i] = current_edge_data.turn_instruction;
+
+            const unsigned bucket = i / 32;
+            const unsigned offset = i % 32;
+            const unsigned value = [&]
+            {
+                unsigned return_value = 0;
+                if (0 != offset)
+                {
+                    return_value = geometries_indicator_ptr[bucket];
+                }
+                return return_value;
+            }();
+            if (current_edge_data.compressed_geometry)
             {
-                return_value = geometries_indicator_ptr[bucket];
+                geometries_indicator_ptr[bucket] = (value | (1 << offset));
             }
-            return return_value;
-        }();
-        if (current_edge_data.compressed_geometry)
+        }
+        edges_input_stream.close();
+
+        // load compressed geometry
+        unsigned temporary_value;
+        unsigned *geometries_index_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
+            shared_memory_ptr, SharedDataLayout::GEOMETRIES_INDEX);
+        geometry_input_stream.seekg(0, geometry_input_stream.beg);
+        geometry_input_stream.read((char *)&temporary_value, sizeof(unsigned));
+        BOOST_ASSERT(temporary_value ==
+                     shared_layout_ptr->num_entries[SharedDataLayout::GEOMETRIES_INDEX]);
+
+        if (shared_layout_ptr->GetBlockSize(SharedDataLayout::GEOMETRIES_INDEX) > 0)
         {
-            geometries_indicator_ptr[bucket] = (value | (1 << offset));
+            geometry_input_stream.read(
+                (char *)geometries_index_ptr,
+                shared_layout_ptr->GetBlockSize(SharedDataLayout::GEOMETRIES_INDEX));
         }
-    }
-    edges_input_stream.close();
+        unsigned char *geometries_list_ptr = shared_layout_ptr->GetBlockPtr<unsigned char, true>(
+            shared_memory_ptr, SharedDataLayout::GEOMETRIES_LIST);
 
-    // load compressed geometry
-    unsigned temporary_value;
-    unsigned *geometries_index_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
-        shared_memory_ptr, SharedDataLayout::GEOMETRIES_INDEX);
-    geometry_input_stream.seekg(0, geometry_input_stream.beg);
-    geometry_input_stream.read((char *)&temporary_value, sizeof(unsigned));
-    BOOST_ASSERT(temporary_value ==
-                 shared_layout_ptr->num_entries[SharedDataLayout::GEOMETRIES_INDEX]);
+        geometry_input_stream.read((char *)&temporary_value, sizeof(unsigned));
+        BOOST_ASSERT(temporary_value ==
+                     shared_layout_ptr->num_entries[SharedDataLayout::GEOMETRIES_LIST]);
 
-    if (shared_layout_ptr->GetBlockSize(SharedDataLayout::GEOMETRIES_INDEX) > 0)
-    {
-        geometry_input_stream.read(
-            (char *)geometries_index_ptr,
-            shared_layout_ptr->GetBlockSize(SharedDataLayout::GEOMETRIES_INDEX));
-    }
-    unsigned *geometries_list_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
-        shared_memory_ptr, SharedDataLayout::GEOMETRIES_LIST);
+        if (shared_layout_ptr->GetBlockSize(SharedDataLayout::GEOMETRIES_LIST) > 0)
+        {
+            geometry_input_stream.read(
+                (char *)geometries_list_ptr,
+                shared_layout_ptr->GetBlockSize(SharedDataLayout::GEOMETRIES_LIST));
+        }
 
-    geometry_input_stream.read((char *)&temporary_value, sizeof(unsigned));
-    BOOST_ASSERT(temporary_value ==
-                 shared_layout_ptr->num_entries[SharedDataLayout::GEOMETRIES_LIST]);
+        // Loading list of coordinates
+        util::FixedPointCoordinate *coordinates_ptr =
+            shared_layout_ptr->GetBlockPtr<util::FixedPointCoordinate, true>(
+                shared_memory_ptr, SharedDataLayout::COORDINATE_LIST);
 
-    if (shared_layout_ptr->GetBlockSize(SharedDataLayout::GEOMETRIES_LIST) > 0)
-    {
-        geometry_input_stream.read(
-            (char *)geometries_list_ptr,
-            shared_layout_ptr->GetBlockSize(SharedDataLayout::GEOMETRIES_LIST));
-    }
-
-    // Loading list of coordinates
-    util::FixedPointCoordinate *coordinates_ptr =
-        shared_layout_ptr->GetBlockPtr<util::FixedPointCoordinate, true>(
-            shared_memory_ptr, SharedDataLayout::COORDINATE_LIST);
+        extractor::QueryNode current_node;
+        for (unsigned i = 0; i < coordinate_list_size; ++i)
+        {
+            nodes_input_stream.read((char *)&current_node, sizeof(extractor::QueryNode));
+            coordinates_ptr[i] = util::FixedPointCoordinate(current_node.lat, current_node.lon);
+        }
+        nodes_input_stream.close();
 
-    extractor::QueryNode current_node;
-    for (unsigned i = 0; i < coordinate_list_size; ++i)
-    {
-        nodes_input_stream.read((char *)&current_node, sizeof(extractor::QueryNode));
-        coordinates_ptr[i] = util::FixedPointCoordinate(current_node.lat, current_node.lon);
-    }
-    nodes_input_stream.close();
+        // store timestamp
+        char *timestamp_ptr = shared_layout_ptr->GetBlockPtr<char, true>(
+            shared_memory_ptr, SharedDataLayout::TIMESTAMP);
+        std::copy(m_timestamp.c_str(), m_timestamp.c_str() + m_timestamp.length(), timestamp_ptr);
 
-    // store timestamp
-    char *timestamp_ptr =
-        shared_layout_ptr->GetBlockPtr<char, true>(shared_memory_ptr, SharedDataLayout::TIMESTAMP);
-    std::copy(m_timestamp.c_str(), m_timestamp.c_str() + m_timestamp.length(), timestamp_ptr);
+        // store the identity checked by later --graph-only updates
+        std::uint64_t *data_identity_ptr = shared_layout_ptr->GetBlockPtr<std::uint64_t, true>(
+            shared_memory_ptr, SharedDataLayout::DATA_IDENTITY);
+        *data_identity_ptr = data_identity;
 
-    // store search tree portion of rtree
-    char *rtree_ptr = shared_layout_ptr->GetBlockPtr<char, true>(shared_memory_ptr,
-                                                                 SharedDataLayout::R_SEARCH_TREE);
+        // store search tree portion of rtree
+        char *rtree_ptr = shared_layout_ptr->GetBlockPtr<char, true>(
+            shared_memory_ptr, SharedDataLayout::R_SEARCH_TREE);
 
-    if (tree_size > 0)
-    {
-        tree_node_file.read(rtree_ptr, sizeof(RTreeNode) * tree_size);
+        if (tree_size > 0)
+        {
+            tree_node_file.read(rtree_ptr, sizeof(RTreeNode) * tree_size);
+        }
+        tree_node_file.close();
     }
-    tree_node_file.close();
+
+    // hsgr checksum
+    unsigned *checksum_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
+        graph_memory_ptr, SharedDataLayout::HSGR_CHECKSUM);
+    *checksum_ptr = checksum;
 
     // load core markers
     std::vector<char> unpacked_core_markers(number_of_core_markers);
@@ -493,7 +693,7 @@ int Storage::Run()
                           sizeof(char) * number_of_core_markers);
 
     unsigned *core_marker_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
-        shared_memory_ptr, SharedDataLayout::CORE_MARKER);
+        graph_memory_ptr, SharedDataLayout::CORE_MARKER);
 
     for (auto i = 0u; i < number_of_core_markers; ++i)
     {
@@ -517,10 +717,25 @@ int Storage::Run()
         }
     }
 
+    // order the nodes for the downward sweep
+    if (number_of_levels > 0)
+    {
+        std::vector<float> node_levels(number_of_levels);
+        level_file.read((char *)node_levels.data(), sizeof(float) * number_of_levels);
+        util::BuildSweepOrder(node_levels,
+                              [&unpacked_core_markers](const NodeID node)
+                              {
+                                  return !unpacked_core_markers.empty() &&
+                                         unpacked_core_markers[node] == 1;
+                              },
+                              shared_layout_ptr->GetBlockPtr<NodeID, true>(
+                                  graph_memory_ptr, SharedDataLayout::SWEEP_ORDER));
+    }
+
     // load the nodes of the search graph
     QueryGraph::NodeArrayEntry *graph_node_list_ptr =
         shared_layout_ptr->GetBlockPtr<QueryGraph::NodeArrayEntry, true>(
-            shared_memory_ptr, SharedDataLayout::GRAPH_NODE_LIST);
+            graph_memory_ptr, SharedDataLayout::GRAPH_NODE_LIST);
     if (shared_layout_ptr->GetBlockSize(SharedDataLayout::GRAPH_NODE_LIST) > 0)
     {
         hsgr_input_stream.read((char *)graph_node_list_ptr,
@@ -530,14 +745,46 @@ int Storage::Run()
     // load the edges of the search graph
     QueryGraph::EdgeArrayEntry *graph_edge_list_ptr =
         shared_layout_ptr->GetBlockPtr<QueryGraph::EdgeArrayEntry, true>(
-            shared_memory_ptr, SharedDataLayout::GRAPH_EDGE_LIST);
+            graph_memory_ptr, SharedDataLayout::GRAPH_EDGE_LIST);
     if (shared_layout_ptr->GetBlockSize(SharedDataLayout::GRAPH_EDGE_LIST) > 0)
     {
         hsgr_input_stream.read((char *)graph_edge_list_ptr,
                                shared_layout_ptr->GetBlockSize(SharedDataLayout::GRAPH_EDGE_LIST));
     }
+
+    // load the children of the shortcuts
+    contractor::ShortcutChildren *shortcut_children_ptr =
+        shared_layout_ptr->GetBlockPtr<contractor::ShortcutChildren, true>(
+            graph_memory_ptr, SharedDataLayout::SHORTCUT_CHILDREN);
+    if (shared_layout_ptr->GetBlockSize(SharedDataLayout::SHORTCUT_CHILDREN) > 0)
+    {
+        unsigned number_of_shortcut_children = 0;
+        hsgr_input_stream.read((char *)&number_of_shortcut_children, sizeof(unsigned));
+        BOOST_ASSERT(number_of_shortcut_children ==
+                     shared_layout_ptr->num_entries[SharedDataLayout::SHORTCUT_CHILDREN]);
+        hsgr_input_stream.read(
+            (char *)shortcut_children_ptr,
+            shared_layout_ptr->GetBlockSize(SharedDataLayout::SHORTCUT_CHILDREN));
+    }
     hsgr_input_stream.close();
 
+    // split the search graph by direction
+    auto search_forward_offsets_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
+        graph_memory_ptr, SharedDataLayout::SEARCH_FORWARD_OFFSETS);
+    auto search_forward_edges_ptr = shared_layout_ptr->GetBlockPtr<util::SearchEdge, true>(
+        graph_memory_ptr, SharedDataLayout::SEARCH_FORWARD_EDGES);
+    auto search_backward_offsets_ptr = shared_layout_ptr->GetBlockPtr<unsigned, true>(
+        graph_memory_ptr, SharedDataLayout::SEARCH_BACKWARD_OFFSETS);
+    auto search_backward_edges_ptr = shared_layout_ptr->GetBlockPtr<util::SearchEdge, true>(
+        graph_memory_ptr, SharedDataLayout::SEARCH_BACKWARD_EDGES);
+    if (search_graph)
+    {
+        util::SearchGraph<true>::Build(
+            graph_node_list_ptr, shared_layout_ptr->num_entries[SharedDataLayout::GRAPH_NODE_LIST],
+            graph_edge_list_ptr, search_forward_offsets_ptr, search_forward_edges_ptr,
+            search_backward_offsets_ptr, search_backward_edges_ptr);
+    }
+
     // acquire lock
     SharedMemory *data_type_memory =
         makeSharedMemory(CURRENT_REGIONS, sizeof(SharedDataTimestamp), true, false);
@@ -555,8 +802,10 @@ int Storage::Run()
 
     data_timestamp_ptr->layout = layout_region;
     data_timestamp_ptr->data = data_region;
+    data_timestamp_ptr->graph = graph_region;
     data_timestamp_ptr->timestamp += 1;
     deleteRegion(previous_data_region);
+    deleteRegion(previous_graph_region);
     deleteRegion(previous_layout_region);
     util::SimpleLogger().Write() << "all data loaded";
 
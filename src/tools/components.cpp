@@ -1,5 +1,5 @@
 #include "util/typedefs.hpp"
-#include "extractor/tarjan_scc.hpp"
+#include "extractor/parallel_scc.hpp"
 #include "util/coordinate_calculation.hpp"
 #include "util/dynamic_graph.hpp"
 #include "util/static_graph.hpp"
@@ -122,7 +122,7 @@ int main(int argc, char *argv[]) try
     osrm::util::SimpleLogger().Write() << "Starting SCC graph traversal";
 
     auto tarjan =
-        osrm::util::make_unique<osrm::extractor::TarjanSCC<osrm::tools::TarjanGraph>>(graph);
+        osrm::util::make_unique<osrm::extractor::ParallelSCC<osrm::tools::TarjanGraph>>(graph);
     tarjan->run();
     osrm::util::SimpleLogger().Write() << "identified: " << tarjan->get_number_of_components()
                                        << " many components";
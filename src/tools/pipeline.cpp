@@ -0,0 +1,197 @@
+#include "contractor/contractor.hpp"
+#include "contractor/contractor_config.hpp"
+#include "extractor/edge_expanded_graph.hpp"
+#include "extractor/extractor.hpp"
+#include "extractor/extractor_config.hpp"
+#include "util/simple_logger.hpp"
+#include "util/version.hpp"
+
+#include <tbb/task_scheduler_init.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+#include <exception>
+#include <new>
+
+using namespace osrm;
+
+enum class return_code : unsigned
+{
+    ok,
+    fail,
+    exit
+};
+
+return_code parseArguments(int argc,
+                           char *argv[],
+                           extractor::ExtractorConfig &extractor_config,
+                           contractor::ContractorConfig &contractor_config)
+{
+    // declare a group of options that will be allowed only on command line
+    boost::program_options::options_description generic_options("Options");
+    generic_options.add_options()("version,v", "Show version")("help,h", "Show this help message");
+
+    bool keep_intermediate_files = false;
+    unsigned requested_num_threads = 0;
+
+    boost::program_options::options_description config_options("Configuration");
+    config_options.add_options()(
+        "profile,p",
+        boost::program_options::value<boost::filesystem::path>(&extractor_config.profile_path)
+            ->default_value("profile.lua"),
+        "Path to LUA routing profile")(
+        "threads,t",
+        boost::program_options::value<unsigned int>(&requested_num_threads)
+            ->default_value(tbb::task_scheduler_init::default_num_threads()),
+        "Number of threads to use")(
+        "small-component-size",
+        boost::program_options::value<unsigned int>(&extractor_config.small_component_size)
+            ->default_value(1000),
+        "Number of nodes required before a strongly-connected-componennt is considered big "
+        "(affects nearest neighbor snapping)")(
+        "core,k",
+        boost::program_options::value<double>(&contractor_config.core_factor)->default_value(1.0),
+        "Percentage of the graph (in vertices) to contract [0..1]")(
+        "segment-speed-file",
+        boost::program_options::value<std::string>(&contractor_config.segment_speed_lookup_path),
+        "Lookup file containing nodeA,nodeB,speed data to adjust edge weights")(
+        "level-cache,o", boost::program_options::value<bool>(&contractor_config.use_cached_priority)
+                             ->default_value(false),
+        "Use .level file to retain the contaction level for each node from the last run.")(
+        "keep-intermediate-files",
+        boost::program_options::value<bool>(&keep_intermediate_files)
+            ->implicit_value(true)
+            ->default_value(false),
+        "Also write the .ebg and .enw files, e.g. to run osrm-prepare again later");
+
+    // hidden options, will not be shown to the user
+    boost::program_options::options_description hidden_options("Hidden options");
+    hidden_options.add_options()("input,i", boost::program_options::value<boost::filesystem::path>(
+                                                &extractor_config.input_path),
+                                 "Input file in .osm, .osm.bz2 or .osm.pbf format");
+
+    // positional option
+    boost::program_options::positional_options_description positional_options;
+    positional_options.add("input", 1);
+
+    // combine above options for parsing
+    boost::program_options::options_description cmdline_options;
+    cmdline_options.add(generic_options).add(config_options).add(hidden_options);
+
+    boost::program_options::options_description visible_options(
+        boost::filesystem::basename(argv[0]) + " <input.osm/.osm.bz2/.osm.pbf> [options]");
+    visible_options.add(generic_options).add(config_options);
+
+    // parse command line options
+    try
+    {
+        boost::program_options::variables_map option_variables;
+        boost::program_options::store(boost::program_options::command_line_parser(argc, argv)
+                                          .options(cmdline_options)
+                                          .positional(positional_options)
+                                          .run(),
+                                      option_variables);
+        if (option_variables.count("version"))
+        {
+            util::SimpleLogger().Write() << OSRM_VERSION;
+            return return_code::exit;
+        }
+
+        if (option_variables.count("help"))
+        {
+            util::SimpleLogger().Write() << visible_options;
+            return return_code::exit;
+        }
+
+        boost::program_options::notify(option_variables);
+
+        if (!option_variables.count("input"))
+        {
+            util::SimpleLogger().Write() << visible_options;
+            return return_code::exit;
+        }
+    }
+    catch (std::exception &e)
+    {
+        util::SimpleLogger().Write(logWARNING) << e.what();
+        return return_code::fail;
+    }
+
+    extractor_config.requested_num_threads = requested_num_threads;
+    contractor_config.requested_num_threads = requested_num_threads;
+    contractor_config.profile_path = extractor_config.profile_path;
+    extractor_config.write_edge_expanded_graph = keep_intermediate_files;
+    // the speed updates are looked up by the OSM nodes of every edge
+    extractor_config.generate_edge_lookup = !contractor_config.segment_speed_lookup_path.empty();
+
+    return return_code::ok;
+}
+
+// Runs osrm-extract and osrm-prepare in one process. The edge-expanded graph stays in memory
+// between the two steps instead of going through the .ebg and .enw files.
+int main(int argc, char *argv[]) try
+{
+    util::LogPolicy::GetInstance().Unmute();
+    extractor::ExtractorConfig extractor_config;
+    contractor::ContractorConfig contractor_config;
+
+    const auto result = parseArguments(argc, argv, extractor_config, contractor_config);
+
+    if (return_code::fail == result)
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (return_code::exit == result)
+    {
+        return EXIT_SUCCESS;
+    }
+
+    extractor_config.UseDefaultOutputNames();
+    contractor_config.osrm_input_path = extractor_config.output_file_name;
+    contractor_config.UseDefaultOutputNames();
+
+    if (1 > extractor_config.requested_num_threads)
+    {
+        util::SimpleLogger().Write(logWARNING) << "Number of threads must be 1 or larger";
+        return EXIT_FAILURE;
+    }
+
+    if (!boost::filesystem::is_regular_file(extractor_config.input_path))
+    {
+        util::SimpleLogger().Write(logWARNING)
+            << "Input file " << extractor_config.input_path.string() << " not found!";
+        return EXIT_FAILURE;
+    }
+
+    if (!boost::filesystem::is_regular_file(extractor_config.profile_path))
+    {
+        util::SimpleLogger().Write(logWARNING)
+            << "Profile " << extractor_config.profile_path.string() << " not found!";
+        return EXIT_FAILURE;
+    }
+
+    extractor::EdgeExpandedGraph edge_expanded_graph;
+    const int extractor_result = extractor::Extractor(extractor_config).run(&edge_expanded_graph);
+    if (0 != extractor_result)
+    {
+        return extractor_result;
+    }
+
+    tbb::task_scheduler_init init(contractor_config.requested_num_threads);
+    return contractor::Contractor(contractor_config).Run(&edge_expanded_graph);
+}
+catch (const std::bad_alloc &e)
+{
+    util::SimpleLogger().Write(logWARNING) << "[exception] " << e.what();
+    util::SimpleLogger().Write(logWARNING)
+        << "Please provide more memory or consider using a larger swapfile";
+    return EXIT_FAILURE;
+}
+catch (const std::exception &e)
+{
+    util::SimpleLogger().Write(logWARNING) << "[exception] " << e.what();
+    return EXIT_FAILURE;
+}
@@ -1,6 +1,7 @@
 #include "server/server.hpp"
 #include "util/ini_file.hpp"
 #include "util/routed_options.hpp"
+#include "util/make_unique.hpp"
 #include "util/simple_logger.hpp"
 
 #include "osrm/osrm.hpp"
@@ -8,17 +9,26 @@
 
 #ifdef __linux__
 #include <sys/mman.h>
+#include <unistd.h>
 #endif
 
+#include <cstdint>
 #include <cstdlib>
 
 #include <signal.h>
 
+#include <algorithm>
 #include <chrono>
+#include <fstream>
 #include <future>
 #include <iostream>
+#include <memory>
 #include <new>
+#include <string>
 #include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #ifdef _WIN32
 boost::function0<void> console_ctrl_function;
@@ -41,20 +51,39 @@ BOOL WINAPI console_ctrl_handler(DWORD ctrl_type)
 
 using namespace osrm;
 
+// resident memory of the process, 0 where unknown
+std::uint64_t residentBytes()
+{
+#ifdef __linux__
+    std::ifstream statm("/proc/self/statm");
+    std::uint64_t size = 0, resident = 0;
+    if (statm >> size >> resident)
+    {
+        return resident * static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+    }
+#endif
+    return 0;
+}
+
 int main(int argc, const char *argv[]) try
 {
     util::LogPolicy::GetInstance().Unmute();
 
     bool trial_run = false;
     std::string ip_address;
-    int ip_port, requested_thread_num;
+    int ip_port, requested_thread_num, requested_io_thread_num;
+    std::vector<std::string> service_limit_options;
+    std::vector<std::string> dataset_options;
+    bool reuse_port = false, pin_threads = false;
 
     EngineConfig config;
     const unsigned init_result = util::GenerateServerProgramOptions(
         argc, argv, config.server_paths, ip_address, ip_port, requested_thread_num,
-        config.use_shared_memory, trial_run, config.max_locations_trip,
+        requested_io_thread_num, service_limit_options, dataset_options, reuse_port, pin_threads,
+        config.use_shared_memory, config.use_search_graph, trial_run, config.max_locations_trip,
         config.max_locations_viaroute, config.max_locations_distance_table,
-        config.max_locations_map_matching);
+        config.max_locations_map_matching, config.min_rphast_table_size,
+        config.max_result_cache_size, config.max_query_duration, config.max_settled_nodes);
     if (init_result == util::INIT_OK_DO_NOT_START_ENGINE)
     {
         return EXIT_SUCCESS;
@@ -90,7 +119,20 @@ int main(int argc, const char *argv[]) try
         util::SimpleLogger().Write(logDEBUG) << "Loading from shared memory";
     }
 
+    std::unordered_map<std::string, server::ServiceLimit> service_limits;
+    for (const auto &service_limit_option : service_limit_options)
+    {
+        std::string service;
+        server::ServiceLimit limit{1, server::DEFAULT_SERVICE_QUEUE_DEPTH};
+        if (!server::ParseServiceLimit(service_limit_option, service, limit))
+        {
+            throw util::exception("Invalid service limit: " + service_limit_option);
+        }
+        service_limits[service] = limit;
+    }
+
     util::SimpleLogger().Write(logDEBUG) << "Threads:\t" << requested_thread_num;
+    util::SimpleLogger().Write(logDEBUG) << "IO threads:\t" << requested_io_thread_num;
     util::SimpleLogger().Write(logDEBUG) << "IP address:\t" << ip_address;
     util::SimpleLogger().Write(logDEBUG) << "IP port:\t" << ip_port;
 
@@ -102,10 +144,56 @@ int main(int argc, const char *argv[]) try
     pthread_sigmask(SIG_BLOCK, &new_mask, &old_mask);
 #endif
 
-    OSRM osrm_lib(config);
-    auto routing_server = server::Server::CreateServer(ip_address, ip_port, requested_thread_num);
+    // All datasets share the server, its workers and their search heaps. The default dataset is
+    // optional if named ones are given.
+    std::vector<std::pair<std::string, std::unique_ptr<OSRM>>> routing_machines;
+    std::vector<std::uint64_t> dataset_resident_bytes;
+    const auto load_dataset = [&](const std::string &name, EngineConfig &dataset_config)
+    {
+        const auto resident_bytes_before = residentBytes();
+        routing_machines.emplace_back(name, util::make_unique<OSRM>(dataset_config));
+        const auto resident_bytes_after = residentBytes();
+        dataset_resident_bytes.push_back(std::max(resident_bytes_after, resident_bytes_before) -
+                                         resident_bytes_before);
+    };
+    if (config.use_shared_memory || dataset_options.empty() ||
+        !config.server_paths["base"].empty() || !config.server_paths["hsgrdata"].empty())
+    {
+        load_dataset("", config);
+    }
+    for (const auto &dataset_option : dataset_options)
+    {
+        std::string name, base_path;
+        if (!server::ParseDataset(dataset_option, name, base_path))
+        {
+            throw util::exception("Invalid dataset: " + dataset_option);
+        }
+        if (std::any_of(routing_machines.begin(), routing_machines.end(),
+                        [&name](const std::pair<std::string, std::unique_ptr<OSRM>> &machine)
+                        {
+                            return machine.first == name;
+                        }))
+        {
+            throw util::exception("Dataset given twice: " + name);
+        }
+        util::SimpleLogger().Write() << "loading dataset " << name << " from " << base_path;
+        EngineConfig dataset_config = config;
+        dataset_config.use_shared_memory = false;
+        dataset_config.server_paths.clear();
+        dataset_config.server_paths["base"] = base_path;
+        load_dataset(name, dataset_config);
+    }
 
-    routing_server->GetRequestHandlerPtr().RegisterRoutingMachine(&osrm_lib);
+    auto routing_server = server::Server::CreateServer(
+        ip_address, ip_port, requested_io_thread_num, requested_thread_num, service_limits,
+        reuse_port, pin_threads);
+
+    for (std::size_t i = 0; i < routing_machines.size(); ++i)
+    {
+        routing_server->GetRequestHandlerPtr().RegisterRoutingMachine(
+            routing_machines[i].second.get(), routing_machines[i].first,
+            dataset_resident_bytes[i]);
+    }
 
     if (trial_run)
     {
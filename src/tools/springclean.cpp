@@ -32,8 +32,14 @@ void deleteRegion(const SharedDataType region)
                 return "DATA_2";
             case LAYOUT_NONE:
                 return "LAYOUT_NONE";
-            default: // DATA_NONE:
+            case DATA_NONE:
                 return "DATA_NONE";
+            case GRAPH_1:
+                return "GRAPH_1";
+            case GRAPH_2:
+                return "GRAPH_2";
+            default: // GRAPH_NONE:
+                return "GRAPH_NONE";
             }
         }();
 
@@ -46,8 +52,10 @@ void springclean()
 {
     util::SimpleLogger().Write() << "spring-cleaning all shared memory regions";
     deleteRegion(DATA_1);
+    deleteRegion(GRAPH_1);
     deleteRegion(LAYOUT_1);
     deleteRegion(DATA_2);
+    deleteRegion(GRAPH_2);
     deleteRegion(LAYOUT_2);
     deleteRegion(CURRENT_REGIONS);
 }
@@ -13,7 +13,10 @@ using namespace osrm;
 // generate boost::program_options object for the routing part
 bool generateDataStoreOptions(const int argc,
                               const char *argv[],
-                              storage::DataPaths &paths)
+                              storage::DataPaths &paths,
+                              storage::SharedMemoryOptions &memory_options,
+                              bool &graph_only,
+                              bool &search_graph)
 {
     // declare a group of options that will be allowed only on command line
     boost::program_options::options_description generic_options("Options");
@@ -21,7 +24,26 @@ bool generateDataStoreOptions(const int argc,
         "springclean,s", "Remove all regions in shared memory")(
         "config,c", boost::program_options::value<boost::filesystem::path>(&paths["config"])
                         ->default_value("server.ini"),
-        "Path to a configuration file");
+        "Path to a configuration file")(
+        "huge-pages", boost::program_options::value<bool>(&memory_options.huge_pages)
+                          ->implicit_value(true)
+                          ->default_value(false),
+        "Back the data with huge pages reserved with vm.nr_hugepages, without any with transparent "
+        "huge pages if /sys/kernel/mm/transparent_hugepage/shmem_enabled allows them")(
+        "numa-interleave", boost::program_options::value<bool>(&memory_options.interleave)
+                               ->implicit_value(true)
+                               ->default_value(false),
+        "Interleave the data over all NUMA nodes")(
+        "graph-only", boost::program_options::value<bool>(&graph_only)
+                          ->implicit_value(true)
+                          ->default_value(false),
+        "Only replace the .hsgr, .core and .level data, e.g. after new segment speeds. The rest "
+        "stays shared with the loaded dataset, which has to come from the same extract")(
+        "search-graph", boost::program_options::value<bool>(&search_graph)
+                            ->implicit_value(true)
+                            ->default_value(false),
+        "Add per-direction search lists to the graph, 8 more bytes per edge and direction for "
+        "faster searches");
 
     // declare a group of options that will be allowed both on command line
     // as well as in a config file
@@ -41,6 +63,8 @@ bool generateDataStoreOptions(const int argc,
         ".fileIndex file")("core",
                            boost::program_options::value<boost::filesystem::path>(&paths["core"]),
                            ".core file")(
+        "levels", boost::program_options::value<boost::filesystem::path>(&paths["levels"]),
+        ".level file, optional")(
         "namesdata", boost::program_options::value<boost::filesystem::path>(&paths["namesdata"]),
         ".names file")("timestamp",
                        boost::program_options::value<boost::filesystem::path>(&paths["timestamp"]),
@@ -111,6 +135,7 @@ bool generateDataStoreOptions(const int argc,
         (paths.find("fileindex") != paths.end() &&
          !paths.find("fileindex")->second.string().empty()) ||
         (paths.find("core") != paths.end() && !paths.find("core")->second.string().empty()) ||
+        (paths.find("levels") != paths.end() && !paths.find("levels")->second.string().empty()) ||
         (paths.find("timestamp") != paths.end() &&
          !paths.find("timestamp")->second.string().empty());
 
@@ -186,6 +211,12 @@ bool generateDataStoreOptions(const int argc,
             path_iterator->second = base_string + ".core";
         }
 
+        path_iterator = paths.find("levels");
+        if (path_iterator != paths.end())
+        {
+            path_iterator->second = base_string + ".level";
+        }
+
         path_iterator = paths.find("namesdata");
         if (path_iterator != paths.end())
         {
@@ -263,12 +294,15 @@ int main(const int argc, const char *argv[]) try
     util::LogPolicy::GetInstance().Unmute();
 
     storage::DataPaths paths;
-    if (!generateDataStoreOptions(argc, argv, paths))
+    storage::SharedMemoryOptions memory_options;
+    bool graph_only = false;
+    bool search_graph = false;
+    if (!generateDataStoreOptions(argc, argv, paths, memory_options, graph_only, search_graph))
     {
         return EXIT_SUCCESS;
     }
 
-    storage::Storage storage(paths);
+    storage::Storage storage(paths, memory_options, graph_only, search_graph);
     return storage.Run();
 }
 catch (const std::bad_alloc &e)
@@ -0,0 +1,138 @@
+#include "contractor/graph_contractor.hpp"
+#include "contractor/query_edge.hpp"
+#include "extractor/edge_based_edge.hpp"
+#include "util/deallocating_vector.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <ostream>
+#include <tuple>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(graph_contractor)
+
+using namespace osrm;
+using namespace osrm::contractor;
+
+namespace
+{
+struct Shortcut
+{
+    NodeID source;
+    NodeID target;
+    EdgeWeight distance;
+    bool forward;
+    bool backward;
+    NodeID middle;
+
+    bool operator<(const Shortcut &other) const
+    {
+        return std::tie(source, target, distance, forward, backward, middle) <
+               std::tie(other.source, other.target, other.distance, other.forward,
+                        other.backward, other.middle);
+    }
+
+    bool operator==(const Shortcut &other) const
+    {
+        return std::tie(source, target, distance, forward, backward, middle) ==
+               std::tie(other.source, other.target, other.distance, other.forward,
+                        other.backward, other.middle);
+    }
+
+    bool operator!=(const Shortcut &other) const { return !(*this == other); }
+};
+
+std::ostream &operator<<(std::ostream &out, const Shortcut &shortcut)
+{
+    return out << "{" << shortcut.source << ", " << shortcut.target << ", " << shortcut.distance
+               << ", " << shortcut.forward << ", " << shortcut.backward << ", "
+               << shortcut.middle << "}";
+}
+
+// Contracts a grid of side x side nodes, numbered row by row. The weights and the one-way
+// edges follow a fixed pattern so the hierarchy is the same on every run.
+std::vector<Shortcut> ContractGrid(const NodeID side)
+{
+    util::DeallocatingVector<extractor::EdgeBasedEdge> edges;
+    NodeID edge_id = 0;
+    const auto add_edge = [&](const NodeID source, const NodeID target)
+    {
+        edges.push_back(extractor::EdgeBasedEdge(source, target, edge_id,
+                                                 1 + (edge_id * 7) % 13, edge_id % 5 != 4,
+                                                 edge_id % 5 != 3));
+        ++edge_id;
+    };
+    for (NodeID row = 0; row < side; ++row)
+    {
+        for (NodeID column = 0; column < side; ++column)
+        {
+            const NodeID node = row * side + column;
+            if (column + 1 < side)
+            {
+                add_edge(node, node + 1);
+            }
+            if (row + 1 < side)
+            {
+                add_edge(node, node + side);
+            }
+        }
+    }
+
+    const NodeID number_of_nodes = side * side;
+    GraphContractor contractor(number_of_nodes, edges, {},
+                               std::vector<EdgeWeight>(number_of_nodes, 1));
+    contractor.Run();
+    util::DeallocatingVector<QueryEdge> contracted_edges;
+    contractor.GetEdges(contracted_edges);
+
+    std::vector<Shortcut> shortcuts;
+    for (const QueryEdge &edge : contracted_edges)
+    {
+        if (edge.data.shortcut)
+        {
+            shortcuts.push_back({edge.source, edge.target, edge.data.distance, edge.data.forward,
+                                 edge.data.backward, edge.data.id});
+        }
+    }
+    std::sort(shortcuts.begin(), shortcuts.end());
+    return shortcuts;
+}
+}
+
+BOOST_AUTO_TEST_CASE(grid_shortcuts_test)
+{
+    // Shortcuts of the plain bounded Dijkstra witness search. The short-witness checks and the
+    // cached simulations must neither add nor drop any of them.
+    const std::vector<Shortcut> expected = {
+        {0, 6, 20, false, true, 5},
+        {1, 6, 21, false, true, 0},
+        {2, 6, 11, true, false, 1},
+        {3, 9, 9, true, false, 4},
+        {5, 11, 16, true, false, 10},
+        {5, 16, 18, false, true, 10},
+        {7, 12, 22, true, false, 8},
+        {8, 2, 14, true, false, 3},
+        {8, 12, 21, true, false, 13},
+        {9, 18, 15, false, true, 14},
+        {10, 16, 12, false, true, 15},
+        {14, 18, 12, false, true, 19},
+        {14, 18, 19, true, false, 19},
+        {16, 0, 26, true, false, 5},
+        {16, 22, 16, true, false, 21},
+        {17, 0, 35, true, false, 16},
+        {17, 11, 14, true, false, 16},
+        {18, 11, 24, true, false, 17},
+        {18, 12, 16, false, true, 17},
+        {19, 18, 18, true, false, 23},
+        {22, 18, 12, true, false, 23},
+        {23, 19, 13, false, true, 24},
+    };
+
+    const auto shortcuts = ContractGrid(5);
+    BOOST_CHECK_EQUAL_COLLECTIONS(shortcuts.begin(), shortcuts.end(), expected.begin(),
+                                  expected.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,116 @@
+#include "engine/binary_response.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(binary_response)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+namespace
+{
+// local copies, the class constants are not defined out of line
+const std::size_t HEADER_SIZE = BinaryResponse::HEADER_SIZE;
+const std::uint16_t VERSION = BinaryResponse::VERSION;
+
+std::uint32_t ReadUInt32(const std::vector<char> &buffer, const std::size_t position)
+{
+    std::uint32_t value = 0;
+    for (const auto i : {3u, 2u, 1u, 0u})
+    {
+        value = (value << 8) | static_cast<unsigned char>(buffer[position + i]);
+    }
+    return value;
+}
+
+std::uint16_t ReadUInt16(const std::vector<char> &buffer, const std::size_t position)
+{
+    return static_cast<std::uint16_t>(static_cast<unsigned char>(buffer[position]) |
+                                      (static_cast<unsigned char>(buffer[position + 1]) << 8));
+}
+}
+
+BOOST_AUTO_TEST_CASE(header_test)
+{
+    BinaryResponse response;
+    response.SetStatus(207);
+
+    const auto &buffer = response.Buffer();
+    BOOST_REQUIRE_EQUAL(buffer.size(), HEADER_SIZE);
+    BOOST_CHECK_EQUAL(std::string(buffer.begin(), buffer.begin() + 4), "OSRB");
+    BOOST_CHECK_EQUAL(ReadUInt16(buffer, 4), VERSION);
+    BOOST_CHECK_EQUAL(ReadUInt16(buffer, 6), 207);
+}
+
+BOOST_AUTO_TEST_CASE(table_test)
+{
+    BinaryResponse response;
+    const std::vector<std::int32_t> table = {0, 1, -1, 0x12345678, 2147483647, 42};
+    response.WriteTable(2, 3, table.data());
+
+    const auto &buffer = response.Buffer();
+    auto position = HEADER_SIZE;
+    BOOST_CHECK_EQUAL(ReadUInt16(buffer, position),
+                      static_cast<std::uint16_t>(BinarySection::DistanceTable));
+    BOOST_CHECK_EQUAL(ReadUInt32(buffer, position + 2), 8 + 6 * 4);
+    position += 6;
+    BOOST_CHECK_EQUAL(ReadUInt32(buffer, position), 2);
+    BOOST_CHECK_EQUAL(ReadUInt32(buffer, position + 4), 3);
+    position += 8;
+    for (const auto weight : table)
+    {
+        BOOST_CHECK_EQUAL(static_cast<std::int32_t>(ReadUInt32(buffer, position)), weight);
+        position += 4;
+    }
+    BOOST_CHECK_EQUAL(position, buffer.size());
+    // little endian on the wire, independent of the host
+    BOOST_CHECK_EQUAL(static_cast<unsigned char>(buffer[HEADER_SIZE + 14 + 12]), 0x78);
+}
+
+BOOST_AUTO_TEST_CASE(sections_test)
+{
+    BinaryResponse response;
+    response.WriteStatusMessage("Found route between points");
+    response.WriteCoordinates(BinarySection::ViaPoints,
+                              {util::FixedPointCoordinate(52500000, 13400000),
+                               util::FixedPointCoordinate(-33900000, 18400000)});
+    response.WriteHints(7, {"abc", ""});
+
+    const auto &buffer = response.Buffer();
+    auto position = HEADER_SIZE;
+
+    // sections can be skipped by their size alone
+    std::vector<std::uint16_t> tags;
+    while (position < buffer.size())
+    {
+        tags.push_back(ReadUInt16(buffer, position));
+        position += 6 + ReadUInt32(buffer, position + 2);
+    }
+    BOOST_CHECK_EQUAL(position, buffer.size());
+    const std::vector<std::uint16_t> expected_tags = {
+        static_cast<std::uint16_t>(BinarySection::StatusMessage),
+        static_cast<std::uint16_t>(BinarySection::ViaPoints),
+        static_cast<std::uint16_t>(BinarySection::Hints)};
+    BOOST_CHECK_EQUAL_COLLECTIONS(tags.begin(), tags.end(), expected_tags.begin(),
+                                  expected_tags.end());
+
+    position = HEADER_SIZE + 6;
+    const auto message_size = ReadUInt32(buffer, position);
+    BOOST_CHECK_EQUAL(std::string(buffer.begin() + position + 4,
+                                  buffer.begin() + position + 4 + message_size),
+                      "Found route between points");
+
+    position += 4 + message_size + 6;
+    BOOST_CHECK_EQUAL(ReadUInt32(buffer, position), 2);
+    BOOST_CHECK_EQUAL(static_cast<std::int32_t>(ReadUInt32(buffer, position + 12)), -33900000);
+
+    // dropping the sections keeps the header
+    response.Clear();
+    BOOST_CHECK_EQUAL(response.Buffer().size(), HEADER_SIZE);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -6,6 +6,7 @@
 
 #include <osrm/coordinate.hpp>
 
+#include <algorithm>
 #include <cmath>
 #include <vector>
 
@@ -50,4 +51,60 @@ BOOST_AUTO_TEST_CASE(decode)
     }
 }
 
+std::vector<SegmentInformation> makeSegments(const std::vector<util::FixedPointCoordinate> &coords)
+{
+    std::vector<SegmentInformation> segments;
+    for (const auto &coordinate : coords)
+    {
+        segments.emplace_back(coordinate, 0, 0, 0, extractor::TurnInstruction::NoTurn, true, false,
+                              TRAVEL_MODE_DEFAULT);
+    }
+    return segments;
+}
+
+BOOST_AUTO_TEST_CASE(encode_precision_5)
+{
+    // example of the polyline algorithm documentation
+    std::vector<util::FixedPointCoordinate> coords = {{38500000, -120200000},
+                                                      {40700000, -120950000},
+                                                      {43252000, -126453000}};
+    auto segments = makeSegments(coords);
+    // points that are not necessary are skipped
+    segments.insert(segments.begin() + 1, segments[2]);
+    segments[1].necessary = false;
+
+    BOOST_CHECK_EQUAL(polylineEncode(segments, POLYLINE_PRECISION_5),
+                      "_p~iF~ps|U_ulLnnqC_mqNvxq`@");
+
+    const auto decoded = polylineDecode("_p~iF~ps|U_ulLnnqC_mqNvxq`@", POLYLINE_PRECISION_5);
+    BOOST_CHECK_EQUAL(decoded.size(), coords.size());
+    for (unsigned i = 0; i < std::min(decoded.size(), coords.size()); ++i)
+    {
+        BOOST_CHECK_EQUAL(decoded[i].lat, coords[i].lat);
+        BOOST_CHECK_EQUAL(decoded[i].lon, coords[i].lon);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(round_trip_precision_6)
+{
+    std::vector<util::FixedPointCoordinate> coords = {
+        {52520008, 13404954}, {52520009, 13404950}, {-33868820, 151209296}, {0, 0}};
+    const auto encoded = polylineEncode(makeSegments(coords), POLYLINE_PRECISION_6);
+    const auto decoded = polylineDecode(encoded, POLYLINE_PRECISION_6);
+    BOOST_CHECK_EQUAL(decoded.size(), coords.size());
+    for (unsigned i = 0; i < std::min(decoded.size(), coords.size()); ++i)
+    {
+        BOOST_CHECK_EQUAL(decoded[i].lat, coords[i].lat);
+        BOOST_CHECK_EQUAL(decoded[i].lon, coords[i].lon);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(decode_truncated)
+{
+    // the last coordinate misses its longitude
+    const auto coords = polylineDecode("_p~iF~ps|U_ulL", POLYLINE_PRECISION_5);
+    BOOST_CHECK_EQUAL(coords.size(), 1);
+    BOOST_CHECK(polylineDecode("_p~iF~ps|", POLYLINE_PRECISION_5).empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,404 @@
+#include "engine/routing_algorithms/many_to_many.hpp"
+#include "engine/routing_algorithms/phast.hpp"
+#include "engine/search_engine_data.hpp"
+#include "engine/phantom_node.hpp"
+#include "engine/query_budget.hpp"
+#include "contractor/query_edge.hpp"
+#include "util/integer_range.hpp"
+#include "util/search_graph.hpp"
+#include "util/static_graph.hpp"
+#include "util/sweep_order.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(phast)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+namespace
+{
+using EdgeData = contractor::QueryEdge::EdgeData;
+using QueryGraph = util::StaticGraph<EdgeData>;
+using Adjacency = std::vector<std::map<NodeID, EdgeWeight>>;
+
+// Only what the one-to-many and many-to-many searches ask of a facade
+class ContractedGraphFacade
+{
+  public:
+    using EdgeData = contractor::QueryEdge::EdgeData;
+
+    ContractedGraphFacade(const unsigned number_of_nodes,
+                          const std::vector<QueryGraph::InputEdge> &edges,
+                          std::vector<bool> is_core_node,
+                          std::vector<NodeID> sweep_order,
+                          const bool build_search_graph)
+        : graph(number_of_nodes, edges), is_core_node(std::move(is_core_node)),
+          sweep_order(std::move(sweep_order))
+    {
+        if (!build_search_graph)
+        {
+            return;
+        }
+        std::vector<QueryGraph::NodeArrayEntry> node_array;
+        for (const auto node : util::irange(0u, number_of_nodes))
+        {
+            node_array.push_back({graph.BeginEdges(node)});
+        }
+        node_array.push_back({graph.GetNumberOfEdges()});
+        std::vector<QueryGraph::EdgeArrayEntry> edge_array;
+        for (const auto edge : util::irange(0u, graph.GetNumberOfEdges()))
+        {
+            edge_array.push_back({graph.GetTarget(edge), graph.GetEdgeData(edge)});
+        }
+
+        std::size_t number_of_forward_edges = 0;
+        std::size_t number_of_backward_edges = 0;
+        util::SearchGraph<>::CountEdges(edge_array.data(), edge_array.size(),
+                                        number_of_forward_edges, number_of_backward_edges);
+        util::SearchGraph<>::OffsetVector forward_offsets(node_array.size());
+        util::SearchGraph<>::EdgeVector forward_edges(number_of_forward_edges);
+        util::SearchGraph<>::OffsetVector backward_offsets(node_array.size());
+        util::SearchGraph<>::EdgeVector backward_edges(number_of_backward_edges);
+        util::SearchGraph<>::Build(node_array.data(), node_array.size(), edge_array.data(),
+                                   forward_offsets.data(), forward_edges.data(),
+                                   backward_offsets.data(), backward_edges.data());
+        search_graph = util::SearchGraph<>(forward_offsets, forward_edges, backward_offsets,
+                                           backward_edges);
+    }
+
+    unsigned GetNumberOfNodes() const { return graph.GetNumberOfNodes(); }
+
+    util::range<EdgeID> GetAdjacentEdgeRange(const NodeID node) const
+    {
+        return graph.GetAdjacentEdgeRange(node);
+    }
+
+    NodeID GetTarget(const EdgeID edge) const { return graph.GetTarget(edge); }
+
+    const EdgeData &GetEdgeData(const EdgeID edge) const { return graph.GetEdgeData(edge); }
+
+    util::SearchEdgeRange<EdgeData> GetSearchEdges(const NodeID node,
+                                                   const bool forward_direction) const
+    {
+        return search_graph.GetEdges(graph, node, forward_direction);
+    }
+
+    util::SweepOrderRange GetSweepOrder() const
+    {
+        return util::SweepOrderRange(sweep_order.data(), sweep_order.data() + sweep_order.size());
+    }
+
+    bool IsCoreNode(const NodeID node) const { return is_core_node[node]; }
+
+  private:
+    QueryGraph graph;
+    util::SearchGraph<> search_graph;
+    std::vector<bool> is_core_node;
+    std::vector<NodeID> sweep_order;
+};
+
+// Random one- and two-way roads, the last nodes have no roads and stay unreachable
+Adjacency MakeRoads(const unsigned number_of_nodes,
+                    const unsigned number_of_isolated_nodes,
+                    const unsigned number_of_roads,
+                    std::mt19937 &generator)
+{
+    std::uniform_int_distribution<NodeID> node_distribution(
+        0, number_of_nodes - number_of_isolated_nodes - 1);
+    std::uniform_int_distribution<EdgeWeight> weight_distribution(1, 100);
+    std::bernoulli_distribution is_oneway(0.3);
+
+    Adjacency roads(number_of_nodes);
+    for (unsigned road = 0; road < number_of_roads; ++road)
+    {
+        const auto from = node_distribution(generator);
+        const auto to = node_distribution(generator);
+        if (from == to)
+        {
+            continue;
+        }
+        const auto weight = weight_distribution(generator);
+        const auto add = [&roads](const NodeID source, const NodeID target, const EdgeWeight weight)
+        {
+            const auto inserted = roads[source].emplace(target, weight);
+            inserted.first->second = std::min(inserted.first->second, weight);
+        };
+        add(from, to, weight);
+        if (!is_oneway(generator))
+        {
+            add(to, from, weight);
+        }
+    }
+    return roads;
+}
+
+// Contracts the nodes in a random order without witness searches, the last number_of_core_nodes
+// nodes of the order stay uncontracted in the core
+std::vector<QueryGraph::InputEdge> Contract(Adjacency outgoing,
+                                            const unsigned number_of_core_nodes,
+                                            std::mt19937 &generator,
+                                            std::vector<bool> &is_core_node,
+                                            std::vector<float> &node_levels)
+{
+    const auto number_of_nodes = static_cast<unsigned>(outgoing.size());
+    Adjacency incoming(number_of_nodes);
+    for (const auto node : util::irange(0u, number_of_nodes))
+    {
+        for (const auto &road : outgoing[node])
+        {
+            incoming[road.first][node] = road.second;
+        }
+    }
+
+    std::vector<NodeID> order(number_of_nodes);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), generator);
+
+    std::vector<QueryGraph::InputEdge> edges;
+    const auto add_edge =
+        [&edges](const NodeID node, const NodeID target, const EdgeWeight weight, bool forward)
+    {
+        EdgeData data;
+        data.distance = weight;
+        data.forward = forward;
+        data.backward = !forward;
+        edges.emplace_back(node, target, data);
+    };
+
+    is_core_node.assign(number_of_nodes, true);
+    node_levels.assign(number_of_nodes, 0);
+    for (const auto rank : util::irange(0u, number_of_nodes - number_of_core_nodes))
+    {
+        const auto node = order[rank];
+        for (const auto &in : incoming[node])
+        {
+            for (const auto &out : outgoing[node])
+            {
+                if (in.first == out.first)
+                {
+                    continue;
+                }
+                const auto weight = in.second + out.second;
+                const auto shortcut = outgoing[in.first].emplace(out.first, weight);
+                shortcut.first->second = std::min(shortcut.first->second, weight);
+                incoming[out.first][in.first] = shortcut.first->second;
+            }
+        }
+        // what is left of the graph is contracted later, the edges lead upwards
+        for (const auto &out : outgoing[node])
+        {
+            add_edge(node, out.first, out.second, true);
+            incoming[out.first].erase(node);
+        }
+        for (const auto &in : incoming[node])
+        {
+            add_edge(node, in.first, in.second, false);
+            outgoing[in.first].erase(node);
+        }
+        outgoing[node].clear();
+        incoming[node].clear();
+        is_core_node[node] = false;
+        node_levels[node] = static_cast<float>(rank);
+    }
+
+    // roads between core nodes can be used from both ends
+    for (const auto node : util::irange(0u, number_of_nodes))
+    {
+        for (const auto &out : outgoing[node])
+        {
+            add_edge(node, out.first, out.second, true);
+            add_edge(out.first, node, out.second, false);
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    return edges;
+}
+
+std::vector<EdgeWeight> Dijkstra(const Adjacency &roads, const NodeID source)
+{
+    std::vector<EdgeWeight> distances(roads.size(), INVALID_EDGE_WEIGHT);
+    using QueueEntry = std::pair<EdgeWeight, NodeID>;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+    distances[source] = 0;
+    queue.emplace(0, source);
+    while (!queue.empty())
+    {
+        const auto entry = queue.top();
+        queue.pop();
+        if (entry.first > distances[entry.second])
+        {
+            continue;
+        }
+        for (const auto &road : roads[entry.second])
+        {
+            const auto distance = entry.first + road.second;
+            if (distance < distances[road.first])
+            {
+                distances[road.first] = distance;
+                queue.emplace(distance, road.first);
+            }
+        }
+    }
+    return distances;
+}
+
+PhantomNode MakePhantom(const NodeID forward_node, const NodeID reverse_node)
+{
+    PhantomNode phantom;
+    phantom.forward_node_id = forward_node;
+    phantom.reverse_node_id = reverse_node;
+    phantom.forward_weight = 0;
+    phantom.reverse_weight = 0;
+    return phantom;
+}
+
+void CheckTables(const bool build_search_graph)
+{
+    constexpr unsigned NUMBER_OF_NODES = 60;
+    constexpr unsigned NUMBER_OF_ISOLATED_NODES = 3;
+    constexpr unsigned NUMBER_OF_CORE_NODES = 8;
+    // Chosen by a fair W20 dice roll (this value is completely arbitrary)
+    std::mt19937 generator(7);
+
+    const auto roads = MakeRoads(NUMBER_OF_NODES, NUMBER_OF_ISOLATED_NODES, 150, generator);
+    std::vector<bool> is_core_node;
+    std::vector<float> node_levels;
+    const auto edges =
+        Contract(roads, NUMBER_OF_CORE_NODES, generator, is_core_node, node_levels);
+    std::vector<NodeID> sweep_order(NUMBER_OF_NODES);
+    util::BuildSweepOrder(node_levels,
+                          [&is_core_node](const NodeID node)
+                          {
+                              return is_core_node[node];
+                          },
+                          sweep_order.data());
+    BOOST_REQUIRE(std::count(is_core_node.begin(), is_core_node.end(), true) ==
+                  NUMBER_OF_CORE_NODES);
+
+    ContractedGraphFacade facade(NUMBER_OF_NODES, edges, is_core_node, sweep_order,
+                                 build_search_graph);
+    SearchEngineData engine_working_data;
+    routing_algorithms::PHASTRouting<ContractedGraphFacade> one_to_many(&facade,
+                                                                        engine_working_data);
+    routing_algorithms::ManyToManyRouting<ContractedGraphFacade> many_to_many(
+        &facade, engine_working_data);
+    BOOST_REQUIRE(one_to_many.IsAvailable());
+
+    // every node as a target, some phantoms lie on two nodes
+    std::vector<PhantomNode> sources;
+    for (NodeID node = 0; node < NUMBER_OF_NODES; node += 3)
+    {
+        sources.push_back(MakePhantom(node, SPECIAL_NODEID));
+    }
+    sources.push_back(MakePhantom(NUMBER_OF_NODES - 1, SPECIAL_NODEID));
+    sources.push_back(MakePhantom(4, 5));
+    std::vector<PhantomNode> targets;
+    for (const auto node : util::irange(0u, NUMBER_OF_NODES))
+    {
+        targets.push_back(MakePhantom(node, SPECIAL_NODEID));
+    }
+    targets.push_back(MakePhantom(7, 11));
+
+    const auto rphast_table = one_to_many(sources, targets);
+    const auto many_to_many_table = many_to_many(sources, targets);
+    BOOST_REQUIRE_EQUAL(rphast_table->size(), sources.size() * targets.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(rphast_table->begin(), rphast_table->end(),
+                                  many_to_many_table->begin(), many_to_many_table->end());
+
+    std::size_t number_of_unreachable = 0;
+    std::vector<EdgeWeight> phast_distances;
+    for (const auto source_id : util::irange<std::size_t>(0, sources.size()))
+    {
+        const auto &source = sources[source_id];
+        std::vector<std::vector<EdgeWeight>> source_distances = {
+            Dijkstra(roads, source.forward_node_id)};
+        if (SPECIAL_NODEID != source.reverse_node_id)
+        {
+            source_distances.push_back(Dijkstra(roads, source.reverse_node_id));
+        }
+
+        for (const auto target_id : util::irange<std::size_t>(0, targets.size()))
+        {
+            const auto &target = targets[target_id];
+            EdgeWeight expected = INVALID_EDGE_WEIGHT;
+            for (const auto &distances : source_distances)
+            {
+                for (const auto node : {target.forward_node_id, target.reverse_node_id})
+                {
+                    if (SPECIAL_NODEID != node)
+                    {
+                        expected = std::min(expected, distances[node]);
+                    }
+                }
+            }
+            number_of_unreachable += INVALID_EDGE_WEIGHT == expected;
+            BOOST_CHECK_EQUAL((*rphast_table)[source_id * targets.size() + target_id], expected);
+        }
+
+        // the full sweep reaches the same nodes at the same distances
+        one_to_many(source, phast_distances);
+        for (const auto node : util::irange(0u, NUMBER_OF_NODES))
+        {
+            BOOST_CHECK_EQUAL(phast_distances[node],
+                              std::min(source_distances.front()[node],
+                                       source_distances.back()[node]));
+        }
+    }
+    BOOST_CHECK(number_of_unreachable > 0);
+}
+}
+
+BOOST_AUTO_TEST_CASE(rphast_matches_many_to_many_test) { CheckTables(false); }
+
+BOOST_AUTO_TEST_CASE(rphast_matches_many_to_many_with_search_graph_test) { CheckTables(true); }
+
+BOOST_AUTO_TEST_CASE(sweep_keeps_to_budget_test)
+{
+    constexpr unsigned NUMBER_OF_NODES = 4 * QueryBudget::CHECK_INTERVAL;
+    std::mt19937 generator(7);
+
+    // without roads the upward search settles the source only, all the work is in the sweep
+    std::vector<bool> is_core_node;
+    std::vector<float> node_levels;
+    const auto edges = Contract(Adjacency(NUMBER_OF_NODES), 1, generator, is_core_node,
+                                node_levels);
+    std::vector<NodeID> sweep_order(NUMBER_OF_NODES);
+    util::BuildSweepOrder(node_levels,
+                          [&is_core_node](const NodeID node)
+                          {
+                              return is_core_node[node];
+                          },
+                          sweep_order.data());
+
+    ContractedGraphFacade facade(NUMBER_OF_NODES, edges, is_core_node, sweep_order, false);
+    SearchEngineData engine_working_data;
+    routing_algorithms::PHASTRouting<ContractedGraphFacade> one_to_many(&facade,
+                                                                        engine_working_data);
+    BOOST_REQUIRE(one_to_many.IsAvailable());
+
+    std::vector<EdgeWeight> distances;
+    std::atomic<bool> cancelled(true);
+    auto &budget = QueryBudget::Get();
+    budget.SetCancellationFlag(&cancelled);
+    {
+        ScopedQueryBudget scoped_budget(std::chrono::milliseconds(0), 0);
+        BOOST_CHECK_THROW(one_to_many(MakePhantom(0, SPECIAL_NODEID), distances), QueryAborted);
+    }
+    budget.SetCancellationFlag(nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,98 @@
+#include "engine/query_budget.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+BOOST_AUTO_TEST_SUITE(query_budget)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+namespace
+{
+QueryAborted::Reason ChargeUntilAborted(QueryBudget &budget, const unsigned max_charges)
+{
+    try
+    {
+        for (unsigned i = 0; i < max_charges; ++i)
+        {
+            budget.Charge();
+        }
+    }
+    catch (const QueryAborted &aborted)
+    {
+        return aborted.reason;
+    }
+    BOOST_FAIL("query was not aborted");
+    return QueryAborted::Reason::Cancelled;
+}
+}
+
+BOOST_AUTO_TEST_CASE(unlimited_test)
+{
+    auto &budget = QueryBudget::Get();
+    BOOST_CHECK_EQUAL(&budget, &QueryBudget::Get());
+
+    // charging outside of a request never throws
+    for (unsigned i = 0; i < 10 * QueryBudget::CHECK_INTERVAL; ++i)
+    {
+        budget.Charge();
+    }
+
+    ScopedQueryBudget scoped_budget(std::chrono::milliseconds(0), 0);
+    for (unsigned i = 0; i < 10 * QueryBudget::CHECK_INTERVAL; ++i)
+    {
+        budget.Charge();
+    }
+    budget.Poll();
+}
+
+BOOST_AUTO_TEST_CASE(node_limit_test)
+{
+    auto &budget = QueryBudget::Get();
+    {
+        ScopedQueryBudget scoped_budget(std::chrono::milliseconds(0), 100);
+        for (unsigned i = 0; i < 99; ++i)
+        {
+            budget.Charge();
+        }
+        BOOST_CHECK(QueryAborted::Reason::NodeLimit == ChargeUntilAborted(budget, 1));
+    }
+
+    // the next request starts with a fresh budget
+    ScopedQueryBudget scoped_budget(std::chrono::milliseconds(0), 100);
+    for (unsigned i = 0; i < 99; ++i)
+    {
+        budget.Charge();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(time_limit_test)
+{
+    auto &budget = QueryBudget::Get();
+    ScopedQueryBudget scoped_budget(std::chrono::milliseconds(1), 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    BOOST_CHECK(QueryAborted::Reason::TimeLimit ==
+                ChargeUntilAborted(budget, QueryBudget::CHECK_INTERVAL));
+}
+
+BOOST_AUTO_TEST_CASE(cancellation_test)
+{
+    auto &budget = QueryBudget::Get();
+    std::atomic<bool> cancelled(false);
+    budget.SetCancellationFlag(&cancelled);
+    {
+        ScopedQueryBudget scoped_budget(std::chrono::milliseconds(0), 0);
+        budget.Poll();
+        cancelled = true;
+        BOOST_CHECK_THROW(budget.Poll(), QueryAborted);
+        BOOST_CHECK(QueryAborted::Reason::Cancelled ==
+                    ChargeUntilAborted(budget, QueryBudget::CHECK_INTERVAL));
+    }
+    budget.SetCancellationFlag(nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,83 @@
+#include "engine/query_statistics.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(query_statistics)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+BOOST_AUTO_TEST_CASE(request_counters_test)
+{
+    auto &statistics = QueryStatistics::Get();
+    BOOST_CHECK_EQUAL(&statistics, &QueryStatistics::Get());
+
+    statistics.BeginRequest();
+    statistics.Count(QueryCounter::SettledNodes);
+    statistics.Count(QueryCounter::SettledNodes, 4);
+    statistics.Count(QueryCounter::HeapInserts, 2);
+    {
+        ScopedQueryPhase search_phase(QueryPhase::Search);
+        ScopedQueryPhase unpack_phase(QueryPhase::Unpack);
+    }
+
+    auto json_statistics = statistics.RequestStatistics();
+    BOOST_CHECK_EQUAL(json_statistics.values["settled_nodes"].get<util::json::Number>().value, 5);
+    BOOST_CHECK_EQUAL(json_statistics.values["heap_inserts"].get<util::json::Number>().value, 2);
+    BOOST_CHECK_EQUAL(json_statistics.values["stalled_nodes"].get<util::json::Number>().value, 0);
+
+    auto &phases = json_statistics.values["phase_milliseconds"].get<util::json::Object>().values;
+    BOOST_CHECK_EQUAL(phases.count("search"), 1);
+    BOOST_CHECK_EQUAL(phases.count("unpack"), 1);
+    BOOST_CHECK_EQUAL(phases.count("snap"), 0);
+
+    statistics.EndRequest();
+
+    // a new request starts from zero
+    statistics.BeginRequest();
+    json_statistics = statistics.RequestStatistics();
+    BOOST_CHECK_EQUAL(json_statistics.values["settled_nodes"].get<util::json::Number>().value, 0);
+    statistics.EndRequest();
+}
+
+BOOST_AUTO_TEST_CASE(render_metrics_test)
+{
+    auto &statistics = QueryStatistics::Get();
+    statistics.BeginRequest();
+    statistics.MarkQuery();
+    statistics.Count(QueryCounter::RelaxedEdges, 1000);
+    statistics.EndRequest();
+
+    const std::string metrics = QueryStatistics::RenderMetrics();
+    BOOST_CHECK(metrics.find("# TYPE osrm_requests_total counter") != std::string::npos);
+    BOOST_CHECK(metrics.find("# TYPE osrm_query_relaxed_edges histogram") != std::string::npos);
+    BOOST_CHECK(metrics.find("osrm_query_relaxed_edges_bucket{le=\"+Inf\"}") !=
+                std::string::npos);
+    BOOST_CHECK(metrics.find("osrm_query_phase_seconds_bucket{phase=\"search\",le=\"0.0001\"}") !=
+                std::string::npos);
+    BOOST_CHECK(metrics.find("osrm_query_phase_seconds_count{phase=\"unpack\"}") !=
+                std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(requests_without_query_test)
+{
+    auto &statistics = QueryStatistics::Get();
+    const std::string metrics = QueryStatistics::RenderMetrics();
+
+    // e.g. a metrics scrape or a malformed request, no plugin ran
+    statistics.BeginRequest();
+    {
+        ScopedQueryPhase parse_phase(QueryPhase::Parse);
+    }
+    statistics.EndRequest();
+    BOOST_CHECK_EQUAL(metrics, QueryStatistics::RenderMetrics());
+
+    statistics.BeginRequest();
+    statistics.MarkQuery();
+    statistics.EndRequest();
+    BOOST_CHECK_NE(metrics, QueryStatistics::RenderMetrics());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,82 @@
+#include "engine/result_cache.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(result_cache)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+ResultCacheKey makeKey(const std::uint32_t word)
+{
+    ResultCacheKey key;
+    key.words.push_back(word);
+    return key;
+}
+
+BOOST_AUTO_TEST_CASE(find_insert_test)
+{
+    ResultCache<int> cache(1024 * 1024);
+    BOOST_CHECK(!cache.Find(1, makeKey(42)));
+
+    cache.Insert(1, makeKey(42), std::make_shared<const int>(7), sizeof(int));
+    const auto value = cache.Find(1, makeKey(42));
+    BOOST_REQUIRE(value);
+    BOOST_CHECK_EQUAL(*value, 7);
+    BOOST_CHECK(!cache.Find(1, makeKey(43)));
+}
+
+BOOST_AUTO_TEST_CASE(dataset_change_test)
+{
+    ResultCache<int> cache(1024 * 1024);
+    cache.Insert(1, makeKey(42), std::make_shared<const int>(7), sizeof(int));
+    BOOST_CHECK(!cache.Find(2, makeKey(42)));
+    // the old entries are gone for good
+    BOOST_CHECK(!cache.Find(1, makeKey(42)));
+}
+
+BOOST_AUTO_TEST_CASE(shared_words_test)
+{
+    ResultCache<int> cache(1024 * 1024);
+    const auto targets = std::make_shared<const std::vector<std::uint32_t>>(3, 5);
+    auto key = makeKey(1);
+    key.shared_words = targets;
+    cache.Insert(1, key, std::make_shared<const int>(7), sizeof(int));
+
+    auto equal_key = makeKey(1);
+    equal_key.shared_words = std::make_shared<const std::vector<std::uint32_t>>(3, 5);
+    BOOST_CHECK(cache.Find(1, equal_key));
+
+    auto other_key = makeKey(1);
+    other_key.shared_words = std::make_shared<const std::vector<std::uint32_t>>(3, 6);
+    BOOST_CHECK(!cache.Find(1, other_key));
+}
+
+BOOST_AUTO_TEST_CASE(memory_limit_test)
+{
+    // every shard holds a few entries of 1KiB
+    ResultCache<std::vector<char>> cache(16 * 4 * 1024);
+    for (std::uint32_t word = 0; word < 1000; ++word)
+    {
+        cache.Insert(1, makeKey(word), std::make_shared<const std::vector<char>>(1024), 1024);
+    }
+
+    std::size_t number_of_cached = 0;
+    for (std::uint32_t word = 0; word < 1000; ++word)
+    {
+        number_of_cached += cache.Find(1, makeKey(word)) ? 1 : 0;
+    }
+    BOOST_CHECK_GT(number_of_cached, 0);
+    BOOST_CHECK_LE(number_of_cached, 16 * 4);
+    // the most recent entry is never evicted
+    BOOST_CHECK(cache.Find(1, makeKey(999)));
+
+    // entries larger than a shard are not cached at all
+    cache.Insert(1, makeKey(5000), std::make_shared<const std::vector<char>>(), 1024 * 1024);
+    BOOST_CHECK(!cache.Find(1, makeKey(5000)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,67 @@
+#include "storage/shared_datatype.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdint>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(shared_datatype)
+
+using namespace osrm;
+using namespace osrm::storage;
+
+namespace
+{
+SharedDataLayout MakeLayout(const std::uint64_t number_of_graph_edges)
+{
+    SharedDataLayout layout;
+    for (auto i = 0; i < SharedDataLayout::NUM_BLOCKS; ++i)
+    {
+        layout.SetBlockSize<std::uint32_t>(static_cast<SharedDataLayout::BlockID>(i), i + 1);
+    }
+    layout.SetBlockSize<std::uint64_t>(SharedDataLayout::GRAPH_EDGE_LIST, number_of_graph_edges);
+    return layout;
+}
+}
+
+BOOST_AUTO_TEST_CASE(blocks_fit_into_their_region_test)
+{
+    auto layout = MakeLayout(10);
+    std::vector<char> data(layout.GetSizeOfLayout());
+    std::vector<char> graph(layout.GetSizeOfGraph());
+
+    // writing all canaries must neither overlap nor overflow, reading checks them afterwards
+    for (auto i = 0; i < SharedDataLayout::NUM_BLOCKS; ++i)
+    {
+        const auto bid = static_cast<SharedDataLayout::BlockID>(i);
+        char *memory = SharedDataLayout::IsGraphBlock(bid) ? graph.data() : data.data();
+        BOOST_CHECK(layout.GetBlockOffset(bid) + layout.GetBlockSize(bid) + sizeof(CANARY) <=
+                    (SharedDataLayout::IsGraphBlock(bid) ? graph.size() : data.size()));
+        layout.GetBlockPtr<char, true>(memory, bid);
+    }
+    for (auto i = 0; i < SharedDataLayout::NUM_BLOCKS; ++i)
+    {
+        const auto bid = static_cast<SharedDataLayout::BlockID>(i);
+        char *memory = SharedDataLayout::IsGraphBlock(bid) ? graph.data() : data.data();
+        BOOST_CHECK_NO_THROW(layout.GetBlockPtr<char>(memory, bid));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(new_graph_keeps_data_offsets_test)
+{
+    const auto layout = MakeLayout(10);
+    const auto updated_layout = MakeLayout(1000);
+
+    BOOST_CHECK_EQUAL(layout.GetSizeOfLayout(), updated_layout.GetSizeOfLayout());
+    BOOST_CHECK_LT(layout.GetSizeOfGraph(), updated_layout.GetSizeOfGraph());
+    for (auto i = 0; i < SharedDataLayout::NUM_BLOCKS; ++i)
+    {
+        const auto bid = static_cast<SharedDataLayout::BlockID>(i);
+        if (!SharedDataLayout::IsGraphBlock(bid))
+        {
+            BOOST_CHECK_EQUAL(layout.GetBlockOffset(bid), updated_layout.GetBlockOffset(bid));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
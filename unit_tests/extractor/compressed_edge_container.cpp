@@ -4,6 +4,8 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/test/test_case_template.hpp>
 
+#include <vector>
+
 BOOST_AUTO_TEST_SUITE(compressed_edge_container)
 
 using namespace osrm;
@@ -15,32 +17,25 @@ BOOST_AUTO_TEST_CASE(long_road_test)
     // 0---1----2----3----4
     CompressedEdgeContainer container;
 
-    // compress 0---1---2 to 0---2
-    container.CompressEdge(0, 1, 1, 2, 1, 1);
-    BOOST_CHECK(container.HasEntryForID(0));
-    BOOST_CHECK(!container.HasEntryForID(1));
-    BOOST_CHECK(!container.HasEntryForID(2));
-    BOOST_CHECK(!container.HasEntryForID(3));
-    BOOST_CHECK_EQUAL(container.GetFirstEdgeTargetID(0), 1);
-    BOOST_CHECK_EQUAL(container.GetLastEdgeSourceID(0), 1);
-
-    // compress 2---3---4 to 2---4
-    container.CompressEdge(2, 3, 3, 4, 1, 1);
-    BOOST_CHECK(container.HasEntryForID(0));
-    BOOST_CHECK(!container.HasEntryForID(1));
-    BOOST_CHECK(container.HasEntryForID(2));
-    BOOST_CHECK(!container.HasEntryForID(3));
-    BOOST_CHECK_EQUAL(container.GetFirstEdgeTargetID(2), 3);
-    BOOST_CHECK_EQUAL(container.GetLastEdgeSourceID(2), 3);
-
-    // compress 0---2---4 to 0---4
-    container.CompressEdge(0, 2, 2, 4, 2, 2);
+    // compress 0---1---2---3---4 to 0---4, edge 0 from 0 and edge 3 from 4 remain
+    container.SetGeometries({0, 3}, {0, 4, 8}, {{1, 1}, {2, 1}, {3, 1}, {4, 1},
+                                                {3, 2}, {2, 2}, {1, 2}, {0, 2}});
     BOOST_CHECK(container.HasEntryForID(0));
     BOOST_CHECK(!container.HasEntryForID(1));
     BOOST_CHECK(!container.HasEntryForID(2));
-    BOOST_CHECK(!container.HasEntryForID(3));
+    BOOST_CHECK(container.HasEntryForID(3));
+    BOOST_CHECK(!container.HasEntryForID(4));
+    BOOST_CHECK_EQUAL(container.GetPositionForID(0), 0);
+    BOOST_CHECK_EQUAL(container.GetPositionForID(3), 1);
     BOOST_CHECK_EQUAL(container.GetFirstEdgeTargetID(0), 1);
     BOOST_CHECK_EQUAL(container.GetLastEdgeSourceID(0), 3);
+    BOOST_CHECK_EQUAL(container.GetFirstEdgeTargetID(3), 3);
+    BOOST_CHECK_EQUAL(container.GetLastEdgeSourceID(3), 1);
+
+    const auto bucket = container.GetBucketReference(3);
+    BOOST_REQUIRE_EQUAL(bucket.size(), 4);
+    BOOST_CHECK_EQUAL(bucket.back().first, 0);
+    BOOST_CHECK_EQUAL(bucket.back().second, 2);
 }
 
 BOOST_AUTO_TEST_CASE(t_crossing)
@@ -53,38 +48,20 @@ BOOST_AUTO_TEST_CASE(t_crossing)
     //         6
     CompressedEdgeContainer container;
 
-    // compress 0---1---2 to 0---2
-    container.CompressEdge(0, 1, 1, 2, 1, 1);
-    BOOST_CHECK(container.HasEntryForID(0));
-    BOOST_CHECK(!container.HasEntryForID(1));
-    BOOST_CHECK(!container.HasEntryForID(2));
-    BOOST_CHECK(!container.HasEntryForID(3));
-    BOOST_CHECK(!container.HasEntryForID(4));
-    BOOST_CHECK(!container.HasEntryForID(5));
-    BOOST_CHECK_EQUAL(container.GetFirstEdgeTargetID(0), 1);
-    BOOST_CHECK_EQUAL(container.GetLastEdgeSourceID(0), 1);
-
-    // compress 2---5---6 to 2---6
-    container.CompressEdge(4, 5, 5, 6, 1, 1);
-    BOOST_CHECK(container.HasEntryForID(0));
-    BOOST_CHECK(!container.HasEntryForID(1));
-    BOOST_CHECK(!container.HasEntryForID(2));
-    BOOST_CHECK(!container.HasEntryForID(3));
-    BOOST_CHECK(container.HasEntryForID(4));
-    BOOST_CHECK(!container.HasEntryForID(5));
+    // 0---1---2 to 0---2, 2---3---4 to 2---4 and 2---5---6 to 2---6
+    container.SetGeometries({0, 1, 2, 3, 4, 5}, {0, 2, 4, 6, 8, 10, 12},
+                            {{1, 1}, {2, 1}, {1, 1}, {0, 1}, {3, 1}, {4, 1},
+                             {3, 1}, {2, 1}, {5, 1}, {6, 1}, {5, 1}, {2, 1}});
+    for (const EdgeID edge : {0, 1, 2, 3, 4, 5})
+    {
+        BOOST_CHECK(container.HasEntryForID(edge));
+        BOOST_CHECK_EQUAL(container.GetPositionForID(edge), edge);
+        BOOST_CHECK_EQUAL(container.GetFirstEdgeTargetID(edge),
+                          container.GetLastEdgeSourceID(edge));
+    }
+    BOOST_CHECK(!container.HasEntryForID(6));
+    BOOST_CHECK(!container.HasEntryForID(SPECIAL_EDGEID));
     BOOST_CHECK_EQUAL(container.GetFirstEdgeTargetID(4), 5);
-    BOOST_CHECK_EQUAL(container.GetLastEdgeSourceID(4), 5);
-
-    // compress 2---3---4 to 2---4
-    container.CompressEdge(2, 3, 3, 4, 1, 1);
-    BOOST_CHECK(container.HasEntryForID(0));
-    BOOST_CHECK(!container.HasEntryForID(1));
-    BOOST_CHECK(container.HasEntryForID(2));
-    BOOST_CHECK(!container.HasEntryForID(3));
-    BOOST_CHECK(container.HasEntryForID(4));
-    BOOST_CHECK(!container.HasEntryForID(5));
-    BOOST_CHECK_EQUAL(container.GetFirstEdgeTargetID(2), 3);
-    BOOST_CHECK_EQUAL(container.GetLastEdgeSourceID(2), 3);
 }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -9,6 +9,7 @@
 #include <boost/test/test_case_template.hpp>
 
 #include <iostream>
+#include <vector>
 
 BOOST_AUTO_TEST_SUITE(graph_compressor)
 
@@ -53,7 +54,83 @@ BOOST_AUTO_TEST_CASE(long_road_test)
     BOOST_CHECK_EQUAL(graph.FindEdge(1, 2), SPECIAL_EDGEID);
     BOOST_CHECK_EQUAL(graph.FindEdge(2, 3), SPECIAL_EDGEID);
     BOOST_CHECK_EQUAL(graph.FindEdge(3, 4), SPECIAL_EDGEID);
+    const auto forward_edge = graph.FindEdge(0, 4);
+    const auto reverse_edge = graph.FindEdge(4, 0);
+    BOOST_REQUIRE(forward_edge != SPECIAL_EDGEID);
+    BOOST_REQUIRE(reverse_edge != SPECIAL_EDGEID);
+    BOOST_CHECK_EQUAL(graph.GetEdgeData(forward_edge).distance, 4);
+
+    const std::vector<NodeID> forward_nodes = {1, 2, 3, 4};
+    const std::vector<NodeID> reverse_nodes = {3, 2, 1, 0};
+    std::vector<NodeID> nodes;
+    for (const auto &node : container.GetBucketReference(forward_edge))
+    {
+        nodes.push_back(node.first);
+    }
+    BOOST_CHECK_EQUAL_COLLECTIONS(nodes.begin(), nodes.end(), forward_nodes.begin(),
+                                  forward_nodes.end());
+    nodes.clear();
+    for (const auto &node : container.GetBucketReference(reverse_edge))
+    {
+        nodes.push_back(node.first);
+    }
+    BOOST_CHECK_EQUAL_COLLECTIONS(nodes.begin(), nodes.end(), reverse_nodes.begin(),
+                                  reverse_nodes.end());
+}
+
+BOOST_AUTO_TEST_CASE(parallel_roads)
+{
+    //   1---2
+    //   |   |
+    //   0---5
+    //   |   |
+    //   3---4
+    //
+    SpeedProfileProperties speed_profile;
+    speed_profile.traffic_signal_penalty = 10;
+    GraphCompressor compressor(speed_profile);
+
+    std::unordered_set<NodeID> barrier_nodes;
+    std::unordered_set<NodeID> traffic_lights = {3};
+    RestrictionMap map;
+    CompressedEdgeContainer container;
+
+    std::vector<InputEdge> edges = {
+        // source, target, distance, edge_id, name_id, access_restricted, reversed, roundabout,
+        // travel_mode
+        {0, 1, 1, SPECIAL_EDGEID, 0, false, false, false, true, TRAVEL_MODE_DEFAULT},
+        {0, 3, 1, SPECIAL_EDGEID, 0, false, false, false, true, TRAVEL_MODE_DEFAULT},
+        {0, 5, 1, SPECIAL_EDGEID, 0, false, false, false, true, TRAVEL_MODE_DEFAULT},
+        {1, 0, 1, SPECIAL_EDGEID, 0, false, false, false, true, TRAVEL_MODE_DEFAULT},
+        {1, 2, 1, SPECIAL_EDGEID, 0, false, false, false, true, TRAVEL_MODE_DEFAULT},
+        {2, 1, 1, SPECIAL_EDGEID, 0, false, false, false, true, TRAVEL_MODE_DEFAULT},
+        {2, 5, 1, SPECIAL_EDGEID, 0, false, false, false, true, TRAVEL_MODE_DEFAULT},
+        {3, 0, 1, SPECIAL_EDGEID, 0, false, false, false, true, TRAVEL_MODE_DEFAULT},
+        {3, 4, 1, SPECIAL_EDGEID, 0, false, false, false, true, TRAVEL_MODE_DEFAULT},
+        {4, 3, 1, SPECIAL_EDGEID, 0, false, false, false, true, TRAVEL_MODE_DEFAULT},
+        {4, 5, 1, SPECIAL_EDGEID, 0, false, false, false, true, TRAVEL_MODE_DEFAULT},
+        {5, 0, 1, SPECIAL_EDGEID, 0, false, false, false, true, TRAVEL_MODE_DEFAULT},
+        {5, 2, 1, SPECIAL_EDGEID, 0, false, false, false, true, TRAVEL_MODE_DEFAULT},
+        {5, 4, 1, SPECIAL_EDGEID, 0, false, false, false, true, TRAVEL_MODE_DEFAULT},
+    };
+
+    Graph graph(6, edges);
+    compressor.Compress(barrier_nodes, traffic_lights, map, graph, container);
+
+    // the largest node of both roads stays since 0 and 5 are already connected
+    BOOST_CHECK(graph.FindEdge(0, 5) != SPECIAL_EDGEID);
+    BOOST_CHECK(graph.FindEdge(0, 2) != SPECIAL_EDGEID);
+    BOOST_CHECK(graph.FindEdge(2, 5) != SPECIAL_EDGEID);
     BOOST_CHECK(graph.FindEdge(0, 4) != SPECIAL_EDGEID);
+    BOOST_CHECK(graph.FindEdge(4, 5) != SPECIAL_EDGEID);
+    BOOST_CHECK_EQUAL(graph.GetOutDegree(1), 0);
+    BOOST_CHECK_EQUAL(graph.GetOutDegree(3), 0);
+
+    // the signal penalty is added in both directions
+    BOOST_CHECK_EQUAL(graph.GetEdgeData(graph.FindEdge(0, 4)).distance, 12);
+    BOOST_CHECK_EQUAL(graph.GetEdgeData(graph.FindEdge(4, 0)).distance, 12);
+    BOOST_CHECK_EQUAL(graph.GetEdgeData(graph.FindEdge(0, 2)).distance, 2);
+    BOOST_CHECK(!container.HasEntryForID(graph.FindEdge(0, 5)));
 }
 
 BOOST_AUTO_TEST_CASE(loop_test)
@@ -0,0 +1,122 @@
+#include "extractor/parallel_scc.hpp"
+#include "extractor/tarjan_scc.hpp"
+#include "util/static_graph.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(parallel_scc)
+
+using namespace osrm;
+using namespace osrm::extractor;
+
+struct TestData
+{
+};
+
+using TestGraph = util::StaticGraph<TestData>;
+using TestEdge = TestGraph::InputEdge;
+
+std::shared_ptr<const TestGraph> makeGraph(const unsigned number_of_nodes,
+                                           std::vector<TestEdge> edges)
+{
+    std::sort(edges.begin(), edges.end());
+    return std::make_shared<const TestGraph>(number_of_nodes, edges);
+}
+
+// two nodes are in the same component for both algorithms
+template <typename LhsT, typename RhsT>
+void checkSameComponents(const unsigned number_of_nodes, const LhsT &lhs, const RhsT &rhs)
+{
+    BOOST_REQUIRE_EQUAL(lhs.get_number_of_components(), rhs.get_number_of_components());
+    BOOST_CHECK_EQUAL(lhs.get_size_one_count(), rhs.get_size_one_count());
+
+    std::vector<unsigned> lhs_to_rhs(lhs.get_number_of_components(), SPECIAL_NODEID);
+    for (NodeID node = 0; node < number_of_nodes; ++node)
+    {
+        const auto lhs_id = lhs.get_component_id(node);
+        const auto rhs_id = rhs.get_component_id(node);
+        if (lhs_to_rhs[lhs_id] == SPECIAL_NODEID)
+        {
+            lhs_to_rhs[lhs_id] = rhs_id;
+        }
+        BOOST_CHECK_EQUAL(lhs_to_rhs[lhs_id], rhs_id);
+        BOOST_CHECK_EQUAL(lhs.get_component_size(lhs_id), rhs.get_component_size(rhs_id));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(small_graph_test)
+{
+    // 0 <-> 1 -> 2 <-> 3 -> 4 with a self loop on 4 and a cycle 5 -> 6 -> 7 -> 5
+    const auto graph = makeGraph(8, {{0, 1}, {1, 0}, {1, 2}, {2, 3}, {3, 2}, {3, 4}, {4, 4},
+                                     {5, 6}, {6, 7}, {7, 5}});
+    ParallelSCC<TestGraph> scc(graph);
+    scc.run();
+
+    BOOST_CHECK_EQUAL(scc.get_number_of_components(), 4);
+    BOOST_CHECK_EQUAL(scc.get_size_one_count(), 1);
+    BOOST_CHECK_EQUAL(scc.get_component_id(0), scc.get_component_id(1));
+    BOOST_CHECK_EQUAL(scc.get_component_id(2), scc.get_component_id(3));
+    BOOST_CHECK_EQUAL(scc.get_component_id(5), scc.get_component_id(7));
+    BOOST_CHECK_NE(scc.get_component_id(1), scc.get_component_id(2));
+    BOOST_CHECK_EQUAL(scc.get_component_size(scc.get_component_id(6)), 3);
+    // numbered by the smallest node
+    BOOST_CHECK_EQUAL(scc.get_component_id(0), 0);
+    BOOST_CHECK_EQUAL(scc.get_component_id(4), 2);
+}
+
+BOOST_AUTO_TEST_CASE(random_graph_test)
+{
+    constexpr unsigned NUMBER_OF_NODES = 2000;
+    // Chosen by a fair W20 dice roll (this value is completely arbitrary)
+    std::mt19937 generator(15);
+    std::uniform_int_distribution<NodeID> node_distribution(0, NUMBER_OF_NODES - 1);
+
+    // sparse enough to have a large component and lots of small ones
+    for (const unsigned number_of_edges : {1000u, 2000u, 3000u})
+    {
+        std::vector<TestEdge> edges;
+        for (unsigned i = 0; i < number_of_edges; ++i)
+        {
+            edges.push_back({node_distribution(generator), node_distribution(generator)});
+        }
+        const auto graph = makeGraph(NUMBER_OF_NODES, edges);
+
+        TarjanSCC<TestGraph> tarjan(graph);
+        tarjan.run();
+        ParallelSCC<TestGraph> scc(graph);
+        scc.run();
+        checkSameComponents(NUMBER_OF_NODES, scc, tarjan);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(descending_chain_test)
+{
+    // a one-way chain with descending ids, coloring would assign one node per round. Every
+    // hundredth node closes a small cycle so the chain has components of size three, too.
+    constexpr unsigned NUMBER_OF_NODES = 20000;
+    std::vector<TestEdge> edges;
+    for (NodeID node = NUMBER_OF_NODES - 1; node > 0; --node)
+    {
+        edges.push_back({node, node - 1});
+        if (node % 100 == 0 && node + 2 < NUMBER_OF_NODES)
+        {
+            edges.push_back({node, node + 2});
+        }
+    }
+    const auto graph = makeGraph(NUMBER_OF_NODES, edges);
+
+    TarjanSCC<TestGraph> tarjan(graph);
+    tarjan.run();
+    ParallelSCC<TestGraph> scc(graph);
+    scc.run();
+    checkSameComponents(NUMBER_OF_NODES, scc, tarjan);
+    BOOST_CHECK_EQUAL(scc.get_component_size(scc.get_component_id(5000)), 3);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,104 @@
+#include "extractor/way_result_cache.hpp"
+
+#include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/way.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(way_result_cache)
+
+using namespace osrm;
+using namespace osrm::extractor;
+
+namespace
+{
+std::size_t
+AddWay(osmium::memory::Buffer &buffer,
+       const std::initializer_list<std::pair<const char *, const char *>> &tags)
+{
+    {
+        osmium::builder::WayBuilder builder(buffer);
+        builder.add_user("");
+        builder.add_tags(tags);
+    }
+    return buffer.commit();
+}
+
+struct CountingProfile
+{
+    // stands in for way_function, the speed tells calls apart
+    void operator()(ExtractionWay &result) const
+    {
+        ++calls;
+        result.clear();
+        result.forward_speed = calls;
+    }
+
+    mutable int calls = 0;
+};
+}
+
+BOOST_AUTO_TEST_CASE(same_tags_test)
+{
+    osmium::memory::Buffer buffer(4096, osmium::memory::Buffer::auto_grow::yes);
+    const auto primary = AddWay(buffer, {{"highway", "primary"}, {"name", "Main Street"}});
+    const auto other_primary = AddWay(buffer, {{"highway", "primary"}, {"name", "Side Street"}});
+    const auto residential = AddWay(buffer, {{"highway", "residential"}});
+
+    WayResultCache cache({"highway", "oneway"});
+    BOOST_CHECK(cache.Enabled());
+    CountingProfile profile;
+    ExtractionWay result;
+
+    cache.Get(buffer.get<osmium::Way>(primary), result, profile);
+    BOOST_CHECK_EQUAL(result.forward_speed, 1);
+    // tags that are not listed do not matter
+    cache.Get(buffer.get<osmium::Way>(other_primary), result, profile);
+    BOOST_CHECK_EQUAL(result.forward_speed, 1);
+    cache.Get(buffer.get<osmium::Way>(residential), result, profile);
+    BOOST_CHECK_EQUAL(result.forward_speed, 2);
+
+    BOOST_CHECK_EQUAL(profile.calls, 2);
+    BOOST_CHECK_EQUAL(cache.Hits(), 1);
+    BOOST_CHECK_EQUAL(cache.Misses(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(absent_tag_test)
+{
+    osmium::memory::Buffer buffer(4096, osmium::memory::Buffer::auto_grow::yes);
+    const auto without_oneway = AddWay(buffer, {{"highway", "primary"}});
+    const auto empty_oneway = AddWay(buffer, {{"highway", "primary"}, {"oneway", ""}});
+    const auto shifted_values = AddWay(buffer, {{"highway", ""}, {"oneway", "primary"}});
+
+    WayResultCache cache({"highway", "oneway"});
+    CountingProfile profile;
+    ExtractionWay result;
+    for (const auto offset : {without_oneway, empty_oneway, shifted_values})
+    {
+        cache.Get(buffer.get<osmium::Way>(offset), result, profile);
+    }
+    BOOST_CHECK_EQUAL(profile.calls, 3);
+}
+
+BOOST_AUTO_TEST_CASE(disabled_test)
+{
+    osmium::memory::Buffer buffer(4096, osmium::memory::Buffer::auto_grow::yes);
+    const auto way = AddWay(buffer, {{"highway", "primary"}});
+
+    WayResultCache cache({});
+    BOOST_CHECK(!cache.Enabled());
+    CountingProfile profile;
+    ExtractionWay result;
+    cache.Get(buffer.get<osmium::Way>(way), result, profile);
+    cache.Get(buffer.get<osmium::Way>(way), result, profile);
+    BOOST_CHECK_EQUAL(profile.calls, 2);
+    BOOST_CHECK_EQUAL(cache.Hits(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,82 @@
+#include "server/api_grammar.hpp"
+#include "engine/polyline_compressor.hpp"
+#include "engine/route_parameters.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(api_grammar)
+
+using namespace osrm;
+using namespace osrm::server;
+
+namespace
+{
+// true if the grammar accepts the whole query
+bool Parse(std::string query, engine::RouteParameters &parameters)
+{
+    APIGrammar<std::string::iterator, engine::RouteParameters> api_parser(&parameters);
+    auto iterator = query.begin();
+    return boost::spirit::qi::parse(iterator, query.end(), api_parser) && iterator == query.end();
+}
+
+// example of the polyline algorithm documentation
+const std::string POLYLINE_5 = "_p~iF~ps|U_ulLnnqC_mqNvxq`@";
+
+void CheckDocumentationCoordinates(const engine::RouteParameters &parameters)
+{
+    BOOST_REQUIRE_EQUAL(parameters.coordinates.size(), 3u);
+    BOOST_CHECK_EQUAL(parameters.coordinates[0].lat, 38500000);
+    BOOST_CHECK_EQUAL(parameters.coordinates[0].lon, -120200000);
+    BOOST_CHECK_EQUAL(parameters.coordinates[1].lat, 40700000);
+    BOOST_CHECK_EQUAL(parameters.coordinates[1].lon, -120950000);
+    BOOST_CHECK_EQUAL(parameters.coordinates[2].lat, 43252000);
+    BOOST_CHECK_EQUAL(parameters.coordinates[2].lon, -126453000);
+}
+}
+
+BOOST_AUTO_TEST_CASE(locs_precision_5_test)
+{
+    // the precision applies to locs= wherever it appears in the query
+    for (const auto &query : {"/viaroute?locs=" + POLYLINE_5 + "&polyline_precision=5",
+                              "/viaroute?polyline_precision=5&locs=" + POLYLINE_5})
+    {
+        engine::RouteParameters parameters;
+        BOOST_CHECK(Parse(query, parameters));
+        BOOST_CHECK_EQUAL(parameters.polyline_precision, engine::POLYLINE_PRECISION_5);
+        CheckDocumentationCoordinates(parameters);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(locs_default_precision_test)
+{
+    const std::vector<util::FixedPointCoordinate> coordinates = {
+        {38500000, -120200000}, {40700000, -120950000}, {43252000, -126453000}};
+    std::vector<engine::SegmentInformation> segments;
+    for (const auto &coordinate : coordinates)
+    {
+        segments.emplace_back(coordinate, 0, 0, 0, extractor::TurnInstruction::NoTurn, true,
+                              false, TRAVEL_MODE_DEFAULT);
+    }
+
+    engine::RouteParameters parameters;
+    BOOST_CHECK(Parse("/viaroute?locs=" +
+                          engine::polylineEncode(segments, engine::POLYLINE_PRECISION_6),
+                      parameters));
+    CheckDocumentationCoordinates(parameters);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_polyline_precision_test)
+{
+    for (const auto &query : {std::string("/viaroute?loc=1,2&polyline_precision=7"),
+                              std::string("/viaroute?loc=1,2&polyline_precision=0"),
+                              "/viaroute?polyline_precision=4&locs=" + POLYLINE_5})
+    {
+        engine::RouteParameters parameters;
+        BOOST_CHECK_MESSAGE(!Parse(query, parameters), query);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
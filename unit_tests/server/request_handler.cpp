@@ -0,0 +1,93 @@
+#include "server/http/reply.hpp"
+#include "server/http/request.hpp"
+#include "server/request_handler.hpp"
+#include "server/worker_pool.hpp"
+
+#include "engine/query_statistics.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <future>
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(request_handler)
+
+using namespace osrm;
+using namespace osrm::server;
+
+namespace
+{
+// only the names of the datasets matter here, the routing machines are never queried
+void RegisterDataset(RequestHandler &handler, const std::string &dataset)
+{
+    handler.RegisterRoutingMachine(reinterpret_cast<OSRM *>(&handler), dataset);
+}
+}
+
+BOOST_AUTO_TEST_CASE(service_test)
+{
+    RequestHandler handler;
+    RegisterDataset(handler, "");
+    RegisterDataset(handler, "car");
+
+    BOOST_CHECK_EQUAL(handler.GetService("/table?loc=1,2&loc=3,4"), "table");
+    BOOST_CHECK_EQUAL(handler.GetService("/car/table?loc=1,2&loc=3,4"), "table");
+    BOOST_CHECK_EQUAL(handler.GetService("/car/viaroute"), "viaroute");
+    // the uri is decoded before the dataset and the service are read off it
+    BOOST_CHECK_EQUAL(handler.GetService("/car%2F%74able?loc=1,2"), "table");
+    // no dataset of that name, the default dataset is asked
+    BOOST_CHECK_EQUAL(handler.GetService("/bike/table?loc=1,2"), "bike");
+    BOOST_CHECK_EQUAL(handler.GetService("/car?loc=1,2"), "car");
+    BOOST_CHECK_EQUAL(handler.GetService("/"), "");
+}
+
+BOOST_AUTO_TEST_CASE(dataset_service_limit_test)
+{
+    RequestHandler handler;
+    RegisterDataset(handler, "car");
+
+    const ServiceLimit default_limit{1, DEFAULT_SERVICE_QUEUE_DEPTH};
+    WorkerPool worker_pool(1, default_limit, {{"table", ServiceLimit{1, 1}}});
+
+    // the only worker runs a table query until it is released
+    std::promise<void> started, released;
+    auto release = released.get_future().share();
+    BOOST_CHECK(worker_pool.Submit(handler.GetService("/car/table?loc=1,2&loc=3,4"), [&]
+                                   {
+                                       started.set_value();
+                                       release.wait();
+                                   }));
+    started.get_future().wait();
+
+    // the queue of the table service holds one more, whichever dataset it asks
+    BOOST_CHECK(worker_pool.Submit(handler.GetService("/car/table?loc=1,2&loc=3,4"), [] {}));
+    BOOST_CHECK(!worker_pool.Submit(handler.GetService("/car/table?loc=1,2&loc=3,4"), [] {}));
+    BOOST_CHECK(!worker_pool.Submit(handler.GetService("/table?loc=1,2&loc=3,4"), [] {}));
+    // other services still have room in the shared queue
+    BOOST_CHECK(worker_pool.Submit(handler.GetService("/car/viaroute?loc=1,2&loc=3,4"), [] {}));
+
+    released.set_value();
+}
+
+BOOST_AUTO_TEST_CASE(metrics_scrape_test)
+{
+    // no dataset registered, every query is rejected before a plugin runs
+    RequestHandler handler;
+    auto &statistics = engine::QueryStatistics::Get();
+    const std::string metrics = engine::QueryStatistics::RenderMetrics();
+
+    for (const auto uri : {"/metrics", "/viaroute?loc=1,2&loc=3,4", "/viaroute?loc=x"})
+    {
+        http::request request;
+        request.uri = uri;
+        http::reply reply;
+        reply.status = http::reply::ok;
+        statistics.BeginRequest();
+        handler.handle_request(request, reply);
+        statistics.EndRequest();
+    }
+
+    BOOST_CHECK_EQUAL(metrics, engine::QueryStatistics::RenderMetrics());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,210 @@
+#include "server/worker_pool.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(worker_pool)
+
+using namespace osrm;
+using namespace osrm::server;
+
+namespace
+{
+// Holds the tasks submitted through it until it is opened, counting how many run at once
+class Gate
+{
+  public:
+    WorkerPool::Task Task(const std::string &service)
+    {
+        return [this, service]
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ++running;
+            max_running = std::max(max_running, running);
+            changed.notify_all();
+            changed.wait(lock, [this]
+                         {
+                             return open;
+                         });
+            --running;
+            finished.push_back(service);
+            changed.notify_all();
+        };
+    }
+
+    void WaitForRunning(const unsigned number_of_tasks)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this, number_of_tasks]
+                     {
+                         return running >= number_of_tasks;
+                     });
+    }
+
+    void WaitForFinished(const std::size_t number_of_tasks)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this, number_of_tasks]
+                     {
+                         return finished.size() >= number_of_tasks;
+                     });
+    }
+
+    void Open()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        open = true;
+        changed.notify_all();
+    }
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool open = false;
+    unsigned running = 0;
+    unsigned max_running = 0;
+    std::vector<std::string> finished;
+};
+
+const ServiceLimit DEFAULT_LIMIT{4, DEFAULT_SERVICE_QUEUE_DEPTH};
+}
+
+BOOST_AUTO_TEST_CASE(parse_service_limit_test)
+{
+    std::string service;
+    ServiceLimit limit{0, DEFAULT_SERVICE_QUEUE_DEPTH};
+    BOOST_CHECK(ParseServiceLimit("table=4", service, limit));
+    BOOST_CHECK_EQUAL(service, "table");
+    BOOST_CHECK_EQUAL(limit.max_concurrency, 4u);
+    // the queue depth stays as it was
+    BOOST_CHECK_EQUAL(limit.max_queue_depth, DEFAULT_SERVICE_QUEUE_DEPTH);
+}
+
+BOOST_AUTO_TEST_CASE(parse_service_limit_with_queue_depth_test)
+{
+    std::string service;
+    ServiceLimit limit{0, DEFAULT_SERVICE_QUEUE_DEPTH};
+    BOOST_CHECK(ParseServiceLimit("match=2:16", service, limit));
+    BOOST_CHECK_EQUAL(service, "match");
+    BOOST_CHECK_EQUAL(limit.max_concurrency, 2u);
+    BOOST_CHECK_EQUAL(limit.max_queue_depth, 16u);
+}
+
+BOOST_AUTO_TEST_CASE(parse_invalid_service_limit_test)
+{
+    for (const auto input : {"table", "table4", "=4", "table=", "table=0", "table=-1", "table= 4",
+                             "table=4x", "table=4:", "table=4:x", "table=4:-1", "table=:16"})
+    {
+        std::string service = "unchanged";
+        ServiceLimit limit{0, DEFAULT_SERVICE_QUEUE_DEPTH};
+        BOOST_CHECK_MESSAGE(!ParseServiceLimit(input, service, limit), input);
+        // a rejected limit leaves everything as it was
+        BOOST_CHECK_EQUAL(service, "unchanged");
+        BOOST_CHECK_EQUAL(limit.max_concurrency, 0u);
+        BOOST_CHECK_EQUAL(limit.max_queue_depth, DEFAULT_SERVICE_QUEUE_DEPTH);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(queue_depth_test)
+{
+    Gate gate;
+    WorkerPool worker_pool(1, DEFAULT_LIMIT, {{"table", ServiceLimit{1, 2}}});
+    BOOST_CHECK(worker_pool.Submit("table", gate.Task("table")));
+    gate.WaitForRunning(1);
+
+    // the running query does not take a place in the queue
+    BOOST_CHECK(worker_pool.Submit("table", gate.Task("table")));
+    BOOST_CHECK(worker_pool.Submit("table", gate.Task("table")));
+    // a full queue rejects the query, the connection answers it with 503
+    BOOST_CHECK(!worker_pool.Submit("table", gate.Task("table")));
+    // services without a limit of their own wait in the default queue
+    BOOST_CHECK(worker_pool.Submit("viaroute", gate.Task("viaroute")));
+
+    gate.Open();
+    gate.WaitForFinished(4);
+    BOOST_CHECK_EQUAL(gate.finished.size(), 4u);
+    // the queue has room again
+    BOOST_CHECK(worker_pool.Submit("table", gate.Task("table")));
+    gate.WaitForFinished(5);
+}
+
+BOOST_AUTO_TEST_CASE(concurrency_test)
+{
+    Gate table_gate;
+    Gate route_gate;
+    WorkerPool worker_pool(4, DEFAULT_LIMIT, {{"table", ServiceLimit{2, 16}}});
+    for (auto i = 0; i < 6; ++i)
+    {
+        BOOST_CHECK(worker_pool.Submit("table", table_gate.Task("table")));
+    }
+    table_gate.WaitForRunning(2);
+
+    // the tables hold two workers, the others still serve the cheap queries
+    BOOST_CHECK(worker_pool.Submit("viaroute", route_gate.Task("viaroute")));
+    BOOST_CHECK(worker_pool.Submit("viaroute", route_gate.Task("viaroute")));
+    route_gate.WaitForRunning(2);
+    {
+        std::lock_guard<std::mutex> lock(table_gate.mutex);
+        BOOST_CHECK_EQUAL(table_gate.running, 2u);
+    }
+
+    route_gate.Open();
+    table_gate.Open();
+    table_gate.WaitForFinished(6);
+    route_gate.WaitForFinished(2);
+    BOOST_CHECK_EQUAL(table_gate.max_running, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(round_robin_test)
+{
+    Gate blocking_gate;
+    Gate gate;
+    gate.Open();
+    WorkerPool worker_pool(1, DEFAULT_LIMIT,
+                           {{"table", ServiceLimit{1, 16}}, {"match", ServiceLimit{1, 16}}});
+    BOOST_CHECK(worker_pool.Submit("match", blocking_gate.Task("match")));
+    blocking_gate.WaitForRunning(1);
+
+    // a backlog of tables does not hold up the routes queued after it
+    for (auto i = 0; i < 3; ++i)
+    {
+        BOOST_CHECK(worker_pool.Submit("table", gate.Task("table")));
+    }
+    for (auto i = 0; i < 3; ++i)
+    {
+        BOOST_CHECK(worker_pool.Submit("viaroute", gate.Task("viaroute")));
+    }
+    blocking_gate.Open();
+    gate.WaitForFinished(6);
+
+    for (std::size_t i = 1; i < gate.finished.size(); ++i)
+    {
+        BOOST_CHECK_NE(gate.finished[i - 1], gate.finished[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(stop_test)
+{
+    Gate gate;
+    {
+        WorkerPool worker_pool(1, DEFAULT_LIMIT, {});
+        BOOST_CHECK(worker_pool.Submit("viaroute", gate.Task("running")));
+        gate.WaitForRunning(1);
+        BOOST_CHECK(worker_pool.Submit("viaroute", gate.Task("queued")));
+
+        worker_pool.Stop();
+        BOOST_CHECK(!worker_pool.Submit("viaroute", gate.Task("rejected")));
+        gate.Open();
+        // the destructor waits for the running query
+    }
+
+    // the queued query was dropped
+    BOOST_REQUIRE_EQUAL(gate.finished.size(), 1u);
+    BOOST_CHECK_EQUAL(gate.finished.front(), "running");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
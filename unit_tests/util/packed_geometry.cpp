@@ -0,0 +1,56 @@
+#include "util/packed_geometry.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <limits>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(packed_geometry)
+
+using namespace osrm;
+using namespace osrm::util;
+
+std::vector<unsigned char> Pack(const std::vector<NodeID> &nodes)
+{
+    std::vector<unsigned char> packed;
+    NodeID previous_node = 0;
+    for (const auto node : nodes)
+    {
+        AppendPackedGeometryNode(previous_node, node, packed);
+        previous_node = node;
+    }
+    return packed;
+}
+
+BOOST_AUTO_TEST_CASE(round_trip_test)
+{
+    const std::vector<NodeID> nodes = {5, 6, 7, 3, 1000000, 999999, 0,
+                                       std::numeric_limits<NodeID>::max() - 1, 42};
+    const auto packed = Pack(nodes);
+
+    const PackedGeometryView view(packed.data(), packed.data() + packed.size());
+    BOOST_CHECK_EQUAL(view.size(), nodes.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(view.begin(), view.end(), nodes.begin(), nodes.end());
+
+    std::vector<NodeID> decoded(1, 17);
+    view.DecodeInto(decoded);
+    BOOST_CHECK_EQUAL_COLLECTIONS(decoded.begin(), decoded.end(), nodes.begin(), nodes.end());
+}
+
+BOOST_AUTO_TEST_CASE(small_deltas_test)
+{
+    // neighbouring node ids take a single byte each
+    const std::vector<NodeID> nodes = {1, 2, 3, 4, 3, 2};
+    BOOST_CHECK_EQUAL(Pack(nodes).size(), nodes.size());
+}
+
+BOOST_AUTO_TEST_CASE(empty_test)
+{
+    const PackedGeometryView view;
+    BOOST_CHECK(view.empty());
+    BOOST_CHECK_EQUAL(view.size(), 0);
+    BOOST_CHECK(view.begin() == view.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
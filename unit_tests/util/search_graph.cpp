@@ -0,0 +1,133 @@
+#include "util/search_graph.hpp"
+#include "util/static_graph.hpp"
+#include "contractor/query_edge.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(search_graph)
+
+using namespace osrm;
+using namespace osrm::util;
+
+using QueryGraph = StaticGraph<contractor::QueryEdge::EdgeData>;
+using InputEdge = QueryGraph::InputEdge;
+
+std::vector<InputEdge> makeEdges(const unsigned number_of_nodes, const unsigned number_of_edges)
+{
+    // Chosen by a fair W20 dice roll (this value is completely arbitrary)
+    std::mt19937 generator(15);
+    std::uniform_int_distribution<NodeID> node_distribution(0, number_of_nodes - 1);
+    std::uniform_int_distribution<int> weight_distribution(1, 1000);
+    std::uniform_int_distribution<int> direction_distribution(1, 3);
+
+    std::vector<InputEdge> edges;
+    for (unsigned i = 0; i < number_of_edges; ++i)
+    {
+        contractor::QueryEdge::EdgeData data;
+        data.id = i;
+        data.distance = weight_distribution(generator);
+        const auto direction = direction_distribution(generator);
+        data.forward = direction & 1;
+        data.backward = direction & 2;
+        edges.emplace_back(node_distribution(generator), node_distribution(generator), data);
+    }
+    std::sort(edges.begin(), edges.end());
+    return edges;
+}
+
+std::vector<std::pair<NodeID, EdgeWeight>>
+expectedEdges(const QueryGraph &graph, const NodeID node, const bool forward_direction)
+{
+    std::vector<std::pair<NodeID, EdgeWeight>> expected;
+    for (const auto edge : graph.GetAdjacentEdgeRange(node))
+    {
+        const auto &data = graph.GetEdgeData(edge);
+        if (forward_direction ? data.forward : data.backward)
+        {
+            expected.emplace_back(graph.GetTarget(edge), data.distance);
+        }
+    }
+    return expected;
+}
+
+template <typename SearchGraphT>
+std::vector<std::pair<NodeID, EdgeWeight>> foundEdges(const SearchGraphT &search_graph,
+                                                      const QueryGraph &graph,
+                                                      const NodeID node,
+                                                      const bool forward_direction)
+{
+    std::vector<std::pair<NodeID, EdgeWeight>> found;
+    for (const auto &edge : search_graph.GetEdges(graph, node, forward_direction))
+    {
+        found.emplace_back(edge.target, edge.weight);
+    }
+    return found;
+}
+
+BOOST_AUTO_TEST_CASE(split_by_direction_test)
+{
+    constexpr unsigned NUMBER_OF_NODES = 100;
+    const auto edges = makeEdges(NUMBER_OF_NODES, 500);
+    const QueryGraph graph(NUMBER_OF_NODES, edges);
+
+    std::vector<QueryGraph::NodeArrayEntry> nodes;
+    for (const auto node : irange(0u, NUMBER_OF_NODES + 1))
+    {
+        nodes.push_back({node < NUMBER_OF_NODES ? graph.BeginEdges(node)
+                                                : graph.GetNumberOfEdges()});
+    }
+    std::vector<QueryGraph::EdgeArrayEntry> edge_array;
+    for (const auto edge : irange(0u, graph.GetNumberOfEdges()))
+    {
+        edge_array.push_back({graph.GetTarget(edge), graph.GetEdgeData(edge)});
+    }
+
+    std::size_t number_of_forward_edges = 0;
+    std::size_t number_of_backward_edges = 0;
+    SearchGraph<>::CountEdges(edge_array.data(), edge_array.size(), number_of_forward_edges,
+                              number_of_backward_edges);
+    SearchGraph<>::OffsetVector forward_offsets(nodes.size());
+    SearchGraph<>::EdgeVector forward_edges(number_of_forward_edges);
+    SearchGraph<>::OffsetVector backward_offsets(nodes.size());
+    SearchGraph<>::EdgeVector backward_edges(number_of_backward_edges);
+    SearchGraph<>::Build(nodes.data(), nodes.size(), edge_array.data(), forward_offsets.data(),
+                         forward_edges.data(), backward_offsets.data(), backward_edges.data());
+    const SearchGraph<> search_graph(forward_offsets, forward_edges, backward_offsets,
+                                     backward_edges);
+
+    for (const auto node : irange(0u, NUMBER_OF_NODES))
+    {
+        for (const bool forward_direction : {true, false})
+        {
+            BOOST_CHECK(foundEdges(search_graph, graph, node, forward_direction) ==
+                        expectedEdges(graph, node, forward_direction));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(without_lists_test)
+{
+    constexpr unsigned NUMBER_OF_NODES = 100;
+    const auto edges = makeEdges(NUMBER_OF_NODES, 500);
+    const QueryGraph graph(NUMBER_OF_NODES, edges);
+
+    // nothing was built, the edges come from the graph itself
+    const SearchGraph<> search_graph;
+    BOOST_CHECK(search_graph.Empty());
+    for (const auto node : irange(0u, NUMBER_OF_NODES))
+    {
+        for (const bool forward_direction : {true, false})
+        {
+            BOOST_CHECK(foundEdges(search_graph, graph, node, forward_direction) ==
+                        expectedEdges(graph, node, forward_direction));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
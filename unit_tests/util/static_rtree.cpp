@@ -165,6 +165,8 @@ struct GraphFixture
             // to examine during tests.
             d.forward_edge_based_node_id = pair.second;
             d.reverse_edge_based_node_id = pair.first;
+            // stored apart from the coordinates in the leaf file
+            d.name_id = edges.size();
             edges.emplace_back(d);
         }
     }
@@ -186,6 +188,9 @@ typedef RandomGraphFixture<TEST_LEAF_NODE_SIZE * TEST_BRANCHING_FACTOR * 3,
 typedef RandomGraphFixture<TEST_LEAF_NODE_SIZE * TEST_BRANCHING_FACTOR * 3,
                            TEST_LEAF_NODE_SIZE * TEST_BRANCHING_FACTOR * 2>
     TestRandomGraphFixture_MultipleLevels;
+// more leaves than are packed in one batch
+typedef RandomGraphFixture<TEST_LEAF_NODE_SIZE * 70 * 3, TEST_LEAF_NODE_SIZE * 70>
+    TestRandomGraphFixture_MultipleBatches;
 
 template <typename RTreeT>
 void simple_verify_rtree(RTreeT &rtree,
@@ -299,6 +304,11 @@ BOOST_FIXTURE_TEST_CASE(construct_multiple_levels_test, TestRandomGraphFixture_M
     construction_test("test_5", this);
 }
 
+BOOST_FIXTURE_TEST_CASE(construct_multiple_batches_test, TestRandomGraphFixture_MultipleBatches)
+{
+    construction_test("test_6", this);
+}
+
 // Bug: If you querry a point that lies between two BBs that have a gap,
 // one BB will be pruned, even if it could contain a nearer match.
 BOOST_AUTO_TEST_CASE(regression_test)
@@ -336,6 +346,9 @@ BOOST_AUTO_TEST_CASE(regression_test)
 
     BOOST_CHECK_EQUAL(result_ls.front().u, result_rtree.front().u);
     BOOST_CHECK_EQUAL(result_ls.front().v, result_rtree.front().v);
+    BOOST_CHECK_EQUAL(result_ls.front().name_id, result_rtree.front().name_id);
+    BOOST_CHECK_EQUAL(result_ls.front().forward_edge_based_node_id,
+                      result_rtree.front().forward_edge_based_node_id);
 }
 
 void TestRectangle(double width, double height, double center_lat, double center_lon)
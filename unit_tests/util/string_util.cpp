@@ -20,6 +20,10 @@ BOOST_AUTO_TEST_CASE(json_escaping)
     input = "Aleja \"Solidarnosci\"";
     output = escape_JSON(input);
     BOOST_CHECK_EQUAL(output, "Aleja \\\"Solidarnosci\\\"");
+
+    BOOST_CHECK(requires_JSON_escaping(input));
+    BOOST_CHECK(requires_JSON_escaping("_p~iF~ps|U\\"));
+    BOOST_CHECK(!requires_JSON_escaping("_p~iF~ps|U_ulLnnqC"));
 }
 
 BOOST_AUTO_TEST_CASE(print_int)
@@ -0,0 +1,60 @@
+#include "util/sweep_order.hpp"
+#include "util/osrm_exception.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(sweep_order)
+
+using namespace osrm;
+using namespace osrm::util;
+
+BOOST_AUTO_TEST_CASE(descending_level_test)
+{
+    const std::vector<float> levels = {0, 2, 1, 0, 3, 2};
+    std::vector<NodeID> order(levels.size());
+    BuildSweepOrder(levels,
+                    [](const NodeID)
+                    {
+                        return false;
+                    },
+                    order.data());
+
+    // nodes of the same level keep their order
+    const std::vector<NodeID> expected = {4, 1, 5, 2, 0, 3};
+    BOOST_CHECK_EQUAL_COLLECTIONS(order.begin(), order.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(core_first_test)
+{
+    // core nodes keep level 0 in the .level file
+    const std::vector<float> levels = {0, 1, 0, 2, 0};
+    const std::vector<bool> is_core = {false, false, true, false, true};
+    std::vector<NodeID> order(levels.size());
+    BuildSweepOrder(levels,
+                    [&is_core](const NodeID node)
+                    {
+                        return is_core[node];
+                    },
+                    order.data());
+
+    const std::vector<NodeID> expected = {2, 4, 3, 1, 0};
+    BOOST_CHECK_EQUAL_COLLECTIONS(order.begin(), order.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(invalid_level_test)
+{
+    const std::vector<float> levels = {0, -1};
+    std::vector<NodeID> order(levels.size());
+    BOOST_CHECK_THROW(BuildSweepOrder(levels,
+                                      [](const NodeID)
+                                      {
+                                          return false;
+                                      },
+                                      order.data()),
+                      util::exception);
+}
+
+BOOST_AUTO_TEST_SUITE_END()